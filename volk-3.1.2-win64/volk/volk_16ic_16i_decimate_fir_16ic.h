@@ -0,0 +1,255 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_16ic_16i_decimate_fir_16ic
+ *
+ * \b Overview
+ *
+ * Filters a complex 16 bit integer vector with real 16 bit taps and keeps
+ * every decimation-th output:
+ *
+ * outVector[n] = sat16(round((sum_k inVector[n * decimation + k] * taps[k]) >> shift))
+ *
+ * The taps are applied in memory order, so store them time reversed for
+ * an asymmetric filter. Products are accumulated exactly in 32 bit, which
+ * holds as long as the sum of |taps| is below 65536 (a Q15 filter with
+ * less than 6 dB gain); at 65536 a full scale -32768 input reaches 2^31.
+ * The accumulator is rounded to nearest when shifted right and saturated
+ * to the int16 range, so use shift = 15 for Q15 taps.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_16ic_16i_decimate_fir_16ic(lv_16sc_t* outVector, const lv_16sc_t* inVector,
+ * const int16_t* taps, unsigned int num_taps, unsigned int decimation, unsigned int
+ * shift, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li inVector: The input vector, holding (num_points - 1) * decimation + num_taps
+ * samples.
+ * \li taps: The real filter taps.
+ * \li num_taps: The number of taps.
+ * \li decimation: The input samples per output sample, at least 1.
+ * \li shift: The right shift applied to the accumulator, 0 to 31.
+ * \li num_points: The number of output samples.
+ *
+ * \b Outputs
+ * \li outVector: The filtered and decimated vector.
+ *
+ * \b Example
+ * Decimate CS16 samples by 4 with a Q15 lowpass, keeping the history for the
+ * next block.
+ * \code
+ *   unsigned int D = 4, T = 32, N = 1024;
+ *   unsigned int alignment = volk_get_alignment();
+ *   lv_16sc_t* in = (lv_16sc_t*)volk_malloc(sizeof(lv_16sc_t) * (N * D + T - 1), alignment);
+ *   lv_16sc_t* out = (lv_16sc_t*)volk_malloc(sizeof(lv_16sc_t) * N, alignment);
+ *   int16_t* taps = (int16_t*)volk_malloc(sizeof(int16_t) * T, alignment);
+ *
+ *   // design taps summing to 32767, then per block: T - 1 samples of history
+ *   // followed by N * D new CS16 samples from SoapySDR::Device::readStream
+ *
+ *   volk_16ic_16i_decimate_fir_16ic(out, in, taps, T, D, 15, N);
+ *   memmove(in, in + N * D, sizeof(lv_16sc_t) * (T - 1));
+ *
+ *   volk_free(in);
+ *   volk_free(out);
+ *   volk_free(taps);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_16ic_16i_decimate_fir_16ic_H
+#define INCLUDED_volk_16ic_16i_decimate_fir_16ic_H
+
+#include <inttypes.h>
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+static inline int16_t volk_16ic_16i_decimate_fir_round(int64_t acc, unsigned int shift)
+{
+    if (shift > 0)
+        acc = (acc + ((int64_t)1 << (shift - 1))) >> shift;
+    if (acc > INT16_MAX)
+        return INT16_MAX;
+    if (acc < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t)acc;
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_16ic_16i_decimate_fir_16ic_generic(lv_16sc_t* outVector,
+                                                           const lv_16sc_t* inVector,
+                                                           const int16_t* taps,
+                                                           unsigned int num_taps,
+                                                           unsigned int decimation,
+                                                           unsigned int shift,
+                                                           unsigned int num_points)
+{
+    int16_t* outPtr = (int16_t*)outVector;
+    unsigned int n, k;
+    for (n = 0; n < num_points; n++) {
+        const int16_t* inPtr = (const int16_t*)(inVector + (size_t)n * decimation);
+        int64_t acc_re = 0, acc_im = 0;
+        for (k = 0; k < num_taps; k++) {
+            acc_re += (int32_t)inPtr[2 * k] * taps[k];
+            acc_im += (int32_t)inPtr[2 * k + 1] * taps[k];
+        }
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_re, shift);
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_im, shift);
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_16ic_16i_decimate_fir_16ic_u_avx2(lv_16sc_t* outVector,
+                                                          const lv_16sc_t* inVector,
+                                                          const int16_t* taps,
+                                                          unsigned int num_taps,
+                                                          unsigned int decimation,
+                                                          unsigned int shift,
+                                                          unsigned int num_points)
+{
+    const unsigned int eighthTaps = num_taps / 8;
+    int16_t* outPtr = (int16_t*)outVector;
+
+    // r0 i0 r1 i1 r2 i2 r3 i3 -> r0 r1 r2 r3 i0 i1 i2 i3 in each lane
+    const __m256i deinterleave = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13,
+                                                  2, 3, 6, 7, 10, 11, 14, 15,
+                                                  0, 1, 4, 5, 8, 9, 12, 13,
+                                                  2, 3, 6, 7, 10, 11, 14, 15);
+    // h0..h7 -> h0..h3 h0..h3 | h4..h7 h4..h7
+    const __m256i tapIdx = _mm256_setr_epi32(0, 1, 0, 1, 2, 3, 2, 3);
+    unsigned int n, k;
+
+    for (n = 0; n < num_points; n++) {
+        const int16_t* inPtr = (const int16_t*)(inVector + (size_t)n * decimation);
+        __m256i acc = _mm256_setzero_si256();
+        __m256i samples, tapVal;
+
+        for (k = 0; k < eighthTaps; k++) {
+            samples = _mm256_loadu_si256((const __m256i*)(inPtr + 16 * k));
+            samples = _mm256_shuffle_epi8(samples, deinterleave);
+            tapVal = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(taps + 8 * k)));
+            tapVal = _mm256_permutevar8x32_epi32(tapVal, tapIdx);
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(samples, tapVal));
+        }
+
+        // re re im im
+        __m128i sum =
+            _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        int32_t acc_re = _mm_cvtsi128_si32(sum);
+        int32_t acc_im = _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+
+        for (k = eighthTaps * 8; k < num_taps; k++) {
+            acc_re += (int32_t)inPtr[2 * k] * taps[k];
+            acc_im += (int32_t)inPtr[2 * k + 1] * taps[k];
+        }
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_re, shift);
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_im, shift);
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_16ic_16i_decimate_fir_16ic_u_sse2(lv_16sc_t* outVector,
+                                                          const lv_16sc_t* inVector,
+                                                          const int16_t* taps,
+                                                          unsigned int num_taps,
+                                                          unsigned int decimation,
+                                                          unsigned int shift,
+                                                          unsigned int num_points)
+{
+    const unsigned int quarterTaps = num_taps / 4;
+    int16_t* outPtr = (int16_t*)outVector;
+    unsigned int n, k;
+
+    for (n = 0; n < num_points; n++) {
+        const int16_t* inPtr = (const int16_t*)(inVector + (size_t)n * decimation);
+        __m128i acc = _mm_setzero_si128();
+        __m128i samples, tapVal;
+
+        for (k = 0; k < quarterTaps; k++) {
+            // r0 i0 r1 i1 r2 i2 r3 i3 -> r0 r1 r2 r3 i0 i1 i2 i3
+            samples = _mm_loadu_si128((const __m128i*)(inPtr + 8 * k));
+            samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+            samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+            samples = _mm_shuffle_epi32(samples, _MM_SHUFFLE(3, 1, 2, 0));
+            tapVal = _mm_loadl_epi64((const __m128i*)(taps + 4 * k));
+            tapVal = _mm_unpacklo_epi64(tapVal, tapVal);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(samples, tapVal));
+        }
+
+        // re re im im
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+        int32_t acc_re = _mm_cvtsi128_si32(acc);
+        int32_t acc_im = _mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc));
+
+        for (k = quarterTaps * 4; k < num_taps; k++) {
+            acc_re += (int32_t)inPtr[2 * k] * taps[k];
+            acc_im += (int32_t)inPtr[2 * k + 1] * taps[k];
+        }
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_re, shift);
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_im, shift);
+    }
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_16ic_16i_decimate_fir_16ic_neon(lv_16sc_t* outVector,
+                                                        const lv_16sc_t* inVector,
+                                                        const int16_t* taps,
+                                                        unsigned int num_taps,
+                                                        unsigned int decimation,
+                                                        unsigned int shift,
+                                                        unsigned int num_points)
+{
+    const unsigned int quarterTaps = num_taps / 4;
+    int16_t* outPtr = (int16_t*)outVector;
+    unsigned int n, k;
+
+    for (n = 0; n < num_points; n++) {
+        const int16_t* inPtr = (const int16_t*)(inVector + (size_t)n * decimation);
+        int32x4_t acc_re_vec = vdupq_n_s32(0);
+        int32x4_t acc_im_vec = vdupq_n_s32(0);
+
+        for (k = 0; k < quarterTaps; k++) {
+            const int16x4x2_t samples = vld2_s16(inPtr + 8 * k);
+            const int16x4_t tapVal = vld1_s16(taps + 4 * k);
+            acc_re_vec = vmlal_s16(acc_re_vec, samples.val[0], tapVal);
+            acc_im_vec = vmlal_s16(acc_im_vec, samples.val[1], tapVal);
+        }
+
+        int32x2_t sum_re = vadd_s32(vget_low_s32(acc_re_vec), vget_high_s32(acc_re_vec));
+        int32x2_t sum_im = vadd_s32(vget_low_s32(acc_im_vec), vget_high_s32(acc_im_vec));
+        int32_t acc_re = vget_lane_s32(vpadd_s32(sum_re, sum_re), 0);
+        int32_t acc_im = vget_lane_s32(vpadd_s32(sum_im, sum_im), 0);
+
+        for (k = quarterTaps * 4; k < num_taps; k++) {
+            acc_re += (int32_t)inPtr[2 * k] * taps[k];
+            acc_im += (int32_t)inPtr[2 * k + 1] * taps[k];
+        }
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_re, shift);
+        *outPtr++ = volk_16ic_16i_decimate_fir_round(acc_im, shift);
+    }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_16ic_16i_decimate_fir_16ic_H */
@@ -0,0 +1,250 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_16ic_magnitude_squared_32i
+ *
+ * \b Overview
+ *
+ * Calculates the magnitude squared of the complexVector in full 32 bit
+ * integer precision and stores the results in the magnitudeVector.
+ *
+ * real * real + imag * imag is exact for every input except
+ * (-32768, -32768), whose result 2^31 saturates to INT32_MAX.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_16ic_magnitude_squared_32i(int32_t* magnitudeVector, const lv_16sc_t*
+ * complexVector, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li complexVector: The complex input vector.
+ * \li num_points: The number of samples.
+ *
+ * \b Outputs
+ * \li magnitudeVector: The output value.
+ *
+ * \b Example
+ * Power of CS16 samples read from a device, without converting to float.
+ * \code
+ *   int N = 1024;
+ *   unsigned int alignment = volk_get_alignment();
+ *   lv_16sc_t* in = (lv_16sc_t*)volk_malloc(sizeof(lv_16sc_t) * N, alignment);
+ *   int32_t* power = (int32_t*)volk_malloc(sizeof(int32_t) * N, alignment);
+ *
+ *   // fill in with CS16 samples from SoapySDR::Device::readStream
+ *
+ *   volk_16ic_magnitude_squared_32i(power, in, N);
+ *
+ *   volk_free(in);
+ *   volk_free(power);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_16ic_magnitude_squared_32i_a_H
+#define INCLUDED_volk_16ic_magnitude_squared_32i_a_H
+
+#include <inttypes.h>
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_16ic_magnitude_squared_32i_generic(int32_t* magnitudeVector,
+                                                           const lv_16sc_t* complexVector,
+                                                           unsigned int num_points)
+{
+    const int16_t* complexVectorPtr = (const int16_t*)complexVector;
+    int32_t* magnitudeVectorPtr = magnitudeVector;
+    unsigned int number = 0;
+    for (number = 0; number < num_points; number++) {
+        const int32_t real = *complexVectorPtr++;
+        const int32_t imag = *complexVectorPtr++;
+        const uint32_t mag = (uint32_t)(real * real) + (uint32_t)(imag * imag);
+        *magnitudeVectorPtr++ = mag > INT32_MAX ? INT32_MAX : (int32_t)mag;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_16ic_magnitude_squared_32i_a_avx2(int32_t* magnitudeVector,
+                                                          const lv_16sc_t* complexVector,
+                                                          unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+
+    const int16_t* complexVectorPtr = (const int16_t*)complexVector;
+    int32_t* magnitudeVectorPtr = magnitudeVector;
+
+    // pmaddwd wraps only for (-32768, -32768), to INT32_MIN
+    const __m256i wrapped = _mm256_set1_epi32(INT32_MIN);
+    __m256i cplxValue, result;
+
+    for (; number < eighthPoints; number++) {
+        cplxValue = _mm256_load_si256((const __m256i*)complexVectorPtr);
+        result = _mm256_madd_epi16(cplxValue, cplxValue);
+        result = _mm256_add_epi32(result, _mm256_cmpeq_epi32(result, wrapped));
+        _mm256_store_si256((__m256i*)magnitudeVectorPtr, result);
+
+        complexVectorPtr += 16;
+        magnitudeVectorPtr += 8;
+    }
+
+    number = eighthPoints * 8;
+    volk_16ic_magnitude_squared_32i_generic(
+        magnitudeVectorPtr, (const lv_16sc_t*)complexVectorPtr, num_points - number);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_16ic_magnitude_squared_32i_a_sse2(int32_t* magnitudeVector,
+                                                          const lv_16sc_t* complexVector,
+                                                          unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+
+    const int16_t* complexVectorPtr = (const int16_t*)complexVector;
+    int32_t* magnitudeVectorPtr = magnitudeVector;
+
+    const __m128i wrapped = _mm_set1_epi32(INT32_MIN);
+    __m128i cplxValue, result;
+
+    for (; number < quarterPoints; number++) {
+        cplxValue = _mm_load_si128((const __m128i*)complexVectorPtr);
+        result = _mm_madd_epi16(cplxValue, cplxValue);
+        result = _mm_add_epi32(result, _mm_cmpeq_epi32(result, wrapped));
+        _mm_store_si128((__m128i*)magnitudeVectorPtr, result);
+
+        complexVectorPtr += 8;
+        magnitudeVectorPtr += 4;
+    }
+
+    number = quarterPoints * 4;
+    volk_16ic_magnitude_squared_32i_generic(
+        magnitudeVectorPtr, (const lv_16sc_t*)complexVectorPtr, num_points - number);
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_16ic_magnitude_squared_32i_neon(int32_t* magnitudeVector,
+                                                        const lv_16sc_t* complexVector,
+                                                        unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+
+    const int16_t* complexVectorPtr = (const int16_t*)complexVector;
+    int32_t* magnitudeVectorPtr = magnitudeVector;
+
+    for (; number < quarterPoints; number++) {
+        const int16x4x2_t cplxValue = vld2_s16(complexVectorPtr);
+        __VOLK_PREFETCH(complexVectorPtr + 8);
+        const int32x4_t real2 = vmull_s16(cplxValue.val[0], cplxValue.val[0]);
+        const int32x4_t imag2 = vmull_s16(cplxValue.val[1], cplxValue.val[1]);
+        vst1q_s32(magnitudeVectorPtr, vqaddq_s32(real2, imag2));
+
+        complexVectorPtr += 8;
+        magnitudeVectorPtr += 4;
+    }
+
+    number = quarterPoints * 4;
+    volk_16ic_magnitude_squared_32i_generic(
+        magnitudeVectorPtr, (const lv_16sc_t*)complexVectorPtr, num_points - number);
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_16ic_magnitude_squared_32i_a_H */
+
+
+#ifndef INCLUDED_volk_16ic_magnitude_squared_32i_u_H
+#define INCLUDED_volk_16ic_magnitude_squared_32i_u_H
+
+#include <inttypes.h>
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_16ic_magnitude_squared_32i_u_avx2(int32_t* magnitudeVector,
+                                                          const lv_16sc_t* complexVector,
+                                                          unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+
+    const int16_t* complexVectorPtr = (const int16_t*)complexVector;
+    int32_t* magnitudeVectorPtr = magnitudeVector;
+
+    const __m256i wrapped = _mm256_set1_epi32(INT32_MIN);
+    __m256i cplxValue, result;
+
+    for (; number < eighthPoints; number++) {
+        cplxValue = _mm256_loadu_si256((const __m256i*)complexVectorPtr);
+        result = _mm256_madd_epi16(cplxValue, cplxValue);
+        result = _mm256_add_epi32(result, _mm256_cmpeq_epi32(result, wrapped));
+        _mm256_storeu_si256((__m256i*)magnitudeVectorPtr, result);
+
+        complexVectorPtr += 16;
+        magnitudeVectorPtr += 8;
+    }
+
+    number = eighthPoints * 8;
+    volk_16ic_magnitude_squared_32i_generic(
+        magnitudeVectorPtr, (const lv_16sc_t*)complexVectorPtr, num_points - number);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_16ic_magnitude_squared_32i_u_sse2(int32_t* magnitudeVector,
+                                                          const lv_16sc_t* complexVector,
+                                                          unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+
+    const int16_t* complexVectorPtr = (const int16_t*)complexVector;
+    int32_t* magnitudeVectorPtr = magnitudeVector;
+
+    const __m128i wrapped = _mm_set1_epi32(INT32_MIN);
+    __m128i cplxValue, result;
+
+    for (; number < quarterPoints; number++) {
+        cplxValue = _mm_loadu_si128((const __m128i*)complexVectorPtr);
+        result = _mm_madd_epi16(cplxValue, cplxValue);
+        result = _mm_add_epi32(result, _mm_cmpeq_epi32(result, wrapped));
+        _mm_storeu_si128((__m128i*)magnitudeVectorPtr, result);
+
+        complexVectorPtr += 8;
+        magnitudeVectorPtr += 4;
+    }
+
+    number = quarterPoints * 4;
+    volk_16ic_magnitude_squared_32i_generic(
+        magnitudeVectorPtr, (const lv_16sc_t*)complexVectorPtr, num_points - number);
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+#endif /* INCLUDED_volk_16ic_magnitude_squared_32i_u_H */
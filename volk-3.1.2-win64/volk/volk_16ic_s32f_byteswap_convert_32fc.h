@@ -0,0 +1,206 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_16ic_s32f_byteswap_convert_32fc
+ *
+ * \b Overview
+ *
+ * Converts big-endian complex 16-bit integers, as sent by netSDR and
+ * VITA-49 style sources, into complex floats divided by scalar. This is
+ * volk_16u_byteswap followed by volk_16ic_convert_32fc and a scale in a
+ * single pass: the SIMD versions do the swap and the widening to 32 bits
+ * with one byte shuffle.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_16ic_s32f_byteswap_convert_32fc(lv_32fc_t* outputVector, const lv_16sc_t*
+ * inputVector, const float scalar, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li inputVector: The big-endian complex 16-bit integer input buffer.
+ * \li scalar: The value the converted samples are divided by.
+ * \li num_points: The number of complex samples.
+ *
+ * \b Outputs
+ * \li outputVector: The complex float output buffer.
+ *
+ * \b Example
+ * Convert a payload received from the network to full scale 1.0.
+ * \code
+ * int N = 8192;
+ * unsigned int alignment = volk_get_alignment();
+ * lv_16sc_t* payload = (lv_16sc_t*)volk_malloc(sizeof(lv_16sc_t) * N, alignment);
+ * lv_32fc_t* output = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ *
+ * // recv() the samples into payload
+ *
+ * volk_16ic_s32f_byteswap_convert_32fc(output, payload, 32768.0f, N);
+ *
+ * volk_free(payload);
+ * volk_free(output);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_16ic_s32f_byteswap_convert_32fc_u_H
+#define INCLUDED_volk_16ic_s32f_byteswap_convert_32fc_u_H
+
+#include <inttypes.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void
+volk_16ic_s32f_byteswap_convert_32fc_generic(lv_32fc_t* outputVector,
+                                             const lv_16sc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const uint16_t* inputPtr = (const uint16_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    unsigned int number = 0;
+    for (number = 0; number < num_points * 2; number++) {
+        const uint16_t value = *inputPtr++;
+        const int16_t swapped = (int16_t)(uint16_t)((value >> 8) | (value << 8));
+        *outputPtr++ = (float)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+/*
+ * The shuffles below move each big-endian int16 into the top half of a
+ * 32-bit lane, low byte first, and zero the bottom half. The lane then
+ * holds the sample times 65536, which converts to float exactly, so the
+ * sign extension folds into the scale factor.
+ */
+
+#if LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void
+volk_16ic_s32f_byteswap_convert_32fc_u_avx2(lv_32fc_t* outputVector,
+                                            const lv_16sc_t* inputVector,
+                                            const float scalar,
+                                            unsigned int num_points)
+{
+    const int16_t* inputPtr = (const int16_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    // both 128-bit lanes see the same 8 samples, each picks its half
+    const __m256i swapWiden = _mm256_setr_epi8(-1, -1, 1, 0, -1, -1, 3, 2, -1, -1, 5, 4,
+                                               -1, -1, 7, 6, -1, -1, 9, 8, -1, -1, 11, 10,
+                                               -1, -1, 13, 12, -1, -1, 15, 14);
+    const __m256 scale = _mm256_set1_ps(invScalar / 65536.0f);
+
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+    for (; number < eighthPoints; number++) {
+        const __m256i in0 =
+            _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)inputPtr));
+        const __m256i in1 =
+            _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(inputPtr + 8)));
+        const __m256 out0 = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(in0, swapWiden));
+        const __m256 out1 = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(in1, swapWiden));
+        _mm256_storeu_ps(outputPtr, _mm256_mul_ps(out0, scale));
+        _mm256_storeu_ps(outputPtr + 8, _mm256_mul_ps(out1, scale));
+        inputPtr += 16;
+        outputPtr += 16;
+    }
+
+    number = eighthPoints * 16;
+    for (; number < num_points * 2; number++) {
+        const uint16_t value = (uint16_t)*inputPtr++;
+        const int16_t swapped = (int16_t)(uint16_t)((value >> 8) | (value << 8));
+        *outputPtr++ = (float)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSSE3
+#include <tmmintrin.h>
+
+static inline void
+volk_16ic_s32f_byteswap_convert_32fc_u_ssse3(lv_32fc_t* outputVector,
+                                             const lv_16sc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const int16_t* inputPtr = (const int16_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    const __m128i swapWidenLo =
+        _mm_setr_epi8(-1, -1, 1, 0, -1, -1, 3, 2, -1, -1, 5, 4, -1, -1, 7, 6);
+    const __m128i swapWidenHi =
+        _mm_setr_epi8(-1, -1, 9, 8, -1, -1, 11, 10, -1, -1, 13, 12, -1, -1, 15, 14);
+    const __m128 scale = _mm_set1_ps(invScalar / 65536.0f);
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        const __m128i in = _mm_loadu_si128((const __m128i*)inputPtr);
+        const __m128 out0 = _mm_cvtepi32_ps(_mm_shuffle_epi8(in, swapWidenLo));
+        const __m128 out1 = _mm_cvtepi32_ps(_mm_shuffle_epi8(in, swapWidenHi));
+        _mm_storeu_ps(outputPtr, _mm_mul_ps(out0, scale));
+        _mm_storeu_ps(outputPtr + 4, _mm_mul_ps(out1, scale));
+        inputPtr += 8;
+        outputPtr += 8;
+    }
+
+    number = quarterPoints * 8;
+    for (; number < num_points * 2; number++) {
+        const uint16_t value = (uint16_t)*inputPtr++;
+        const int16_t swapped = (int16_t)(uint16_t)((value >> 8) | (value << 8));
+        *outputPtr++ = (float)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_SSSE3 */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_16ic_s32f_byteswap_convert_32fc_neon(lv_32fc_t* outputVector,
+                                                             const lv_16sc_t* inputVector,
+                                                             const float scalar,
+                                                             unsigned int num_points)
+{
+    const uint8_t* inputPtr = (const uint8_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        const int16x8_t in = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(inputPtr)));
+        const float32x4_t out0 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(in)));
+        const float32x4_t out1 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(in)));
+        vst1q_f32(outputPtr, vmulq_n_f32(out0, invScalar));
+        vst1q_f32(outputPtr + 4, vmulq_n_f32(out1, invScalar));
+        inputPtr += 16;
+        outputPtr += 8;
+    }
+
+    const uint16_t* tailPtr = (const uint16_t*)inputPtr;
+    number = quarterPoints * 8;
+    for (; number < num_points * 2; number++) {
+        const uint16_t value = *tailPtr++;
+        const int16_t swapped = (int16_t)(uint16_t)((value >> 8) | (value << 8));
+        *outputPtr++ = (float)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_16ic_s32f_byteswap_convert_32fc_u_H */
@@ -0,0 +1,557 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_16ic_s32fc_x2_rotator_16ic
+ *
+ * \b Overview
+ *
+ * Rotate a complex 16 bit integer input vector at fixed rate per sample
+ * from initial phase offset.
+ *
+ * The phase is tracked in single precision like
+ * volk_32fc_s32fc_x2_rotator2_32fc and renormalized periodically, so it
+ * does not drift. Each sample is multiplied by the phasor rounded to Q15.
+ * The 32 bit product is rounded to nearest and saturated back to 16 bit,
+ * so full scale inputs rotated onto a diagonal clip instead of wrapping.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_16ic_s32fc_x2_rotator_16ic(lv_16sc_t* outVector, const lv_16sc_t* inVector,
+ * const lv_32fc_t* phase_inc, lv_32fc_t* phase, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li inVector: Vector to be rotated.
+ * \li phase_inc: rotational velocity (scalar, input).
+ * \li phase: phase offset (scalar, input & output).
+ * \li num_points: The number of values in inVector to be rotated and stored into
+ * outVector.
+ *
+ * \b Outputs
+ * \li outVector: The vector where the results will be stored.
+ *
+ * \b Example
+ * Shift CS16 samples from a device down by 100 kHz at 2 MS/s.
+ * \code
+ *   int N = 4096;
+ *   unsigned int alignment = volk_get_alignment();
+ *   lv_16sc_t* in = (lv_16sc_t*)volk_malloc(sizeof(lv_16sc_t) * N, alignment);
+ *   lv_16sc_t* out = (lv_16sc_t*)volk_malloc(sizeof(lv_16sc_t) * N, alignment);
+ *
+ *   // fill in with CS16 samples from SoapySDR::Device::readStream
+ *
+ *   float w = -2.0f * 3.14159265f * 100e3f / 2e6f;
+ *   lv_32fc_t phase_increment = lv_cmake(cosf(w), sinf(w));
+ *   lv_32fc_t phase = lv_cmake(1.f, 0.0f);
+ *
+ *   // phase carries over to the next call
+ *   volk_16ic_s32fc_x2_rotator_16ic(out, in, &phase_increment, &phase, N);
+ *
+ *   volk_free(in);
+ *   volk_free(out);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_16ic_s32fc_x2_rotator_16ic_a_H
+#define INCLUDED_volk_16ic_s32fc_x2_rotator_16ic_a_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+#define ROTATOR_16IC_RELOAD 512
+
+static inline int16_t volk_16ic_rotator_phasor_q15(float x)
+{
+    const float scaled = x * 32767.0f;
+    if (scaled >= 32767.0f)
+        return 32767;
+    if (scaled <= -32767.0f)
+        return -32767;
+    return (int16_t)lrintf(scaled);
+}
+
+static inline int16_t volk_16ic_rotator_round_q15(int32_t acc)
+{
+    acc = (acc + (1 << 14)) >> 15;
+    if (acc > INT16_MAX)
+        return INT16_MAX;
+    if (acc < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t)acc;
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_16ic_s32fc_x2_rotator_16ic_generic(lv_16sc_t* outVector,
+                                                           const lv_16sc_t* inVector,
+                                                           const lv_32fc_t* phase_inc,
+                                                           lv_32fc_t* phase,
+                                                           unsigned int num_points)
+{
+    const int16_t* inPtr = (const int16_t*)inVector;
+    int16_t* outPtr = (int16_t*)outVector;
+    unsigned int i = 0;
+    int j = 0;
+    for (i = 0; i < num_points; i++) {
+        const int32_t pr = volk_16ic_rotator_phasor_q15(lv_creal(*phase));
+        const int32_t pi = volk_16ic_rotator_phasor_q15(lv_cimag(*phase));
+        const int32_t re = inPtr[0];
+        const int32_t im = inPtr[1];
+        outPtr[0] = volk_16ic_rotator_round_q15(re * pr - im * pi);
+        outPtr[1] = volk_16ic_rotator_round_q15(re * pi + im * pr);
+        inPtr += 2;
+        outPtr += 2;
+
+        (*phase) *= (*phase_inc);
+        if (++j == ROTATOR_16IC_RELOAD) {
+            (*phase) /= hypotf(lv_creal(*phase), lv_cimag(*phase));
+            j = 0;
+        }
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+/*
+ * Rotates 8 samples by the phasors in (re, im). Each output component is a
+ * pmaddwd of the interleaved input with a (pr, -pi) or (pi, pr) pair, which
+ * is exact in 32 bit; packs_epi32 does the saturation.
+ */
+static inline __m256i
+volk_16ic_s32fc_x2_rotator_16ic_rotate_avx2(__m256i x, __m256 re, __m256 im)
+{
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    const __m256 neg_scale = _mm256_set1_ps(-32767.0f);
+    const __m256i low16 = _mm256_set1_epi32(0xffff);
+    const __m256i half = _mm256_set1_epi32(1 << 14);
+
+    const __m256i pr = _mm256_cvtps_epi32(
+        _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(re, scale), scale), neg_scale));
+    const __m256i pi = _mm256_cvtps_epi32(
+        _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(im, scale), scale), neg_scale));
+    const __m256i neg_pi = _mm256_sub_epi32(_mm256_setzero_si256(), pi);
+
+    const __m256i coef_re =
+        _mm256_or_si256(_mm256_and_si256(pr, low16), _mm256_slli_epi32(neg_pi, 16));
+    const __m256i coef_im =
+        _mm256_or_si256(_mm256_and_si256(pi, low16), _mm256_slli_epi32(pr, 16));
+
+    __m256i out_re = _mm256_madd_epi16(x, coef_re);
+    __m256i out_im = _mm256_madd_epi16(x, coef_im);
+    out_re = _mm256_srai_epi32(_mm256_add_epi32(out_re, half), 15);
+    out_im = _mm256_srai_epi32(_mm256_add_epi32(out_im, half), 15);
+
+    // re0..re3 im0..im3 per lane, then interleave within the lane
+    const __m256i packed = _mm256_packs_epi32(out_re, out_im);
+    return _mm256_unpacklo_epi16(packed, _mm256_unpackhi_epi64(packed, packed));
+}
+
+static inline void volk_16ic_s32fc_x2_rotator_16ic_a_avx2(lv_16sc_t* outVector,
+                                                          const lv_16sc_t* inVector,
+                                                          const lv_32fc_t* phase_inc,
+                                                          lv_32fc_t* phase,
+                                                          unsigned int num_points)
+{
+    const lv_16sc_t* inPtr = inVector;
+    lv_16sc_t* outPtr = outVector;
+    double incr_re = 1.0, incr_im = 0.0, tmp_re;
+    __VOLK_ATTR_ALIGNED(32) float phase_re[8];
+    __VOLK_ATTR_ALIGNED(32) float phase_im[8];
+    unsigned int i, j = 0;
+
+    // phase_inc^8 in double, its error accumulates over num_points / 8 steps
+    for (i = 0; i < 8; ++i) {
+        phase_re[i] = (float)(lv_creal(*phase) * incr_re - lv_cimag(*phase) * incr_im);
+        phase_im[i] = (float)(lv_creal(*phase) * incr_im + lv_cimag(*phase) * incr_re);
+        tmp_re = incr_re * lv_creal(*phase_inc) - incr_im * lv_cimag(*phase_inc);
+        incr_im = incr_re * lv_cimag(*phase_inc) + incr_im * lv_creal(*phase_inc);
+        incr_re = tmp_re;
+    }
+
+    __m256 re = _mm256_load_ps(phase_re);
+    __m256 im = _mm256_load_ps(phase_im);
+    const __m256 inc_re = _mm256_set1_ps((float)incr_re);
+    const __m256 inc_im = _mm256_set1_ps((float)incr_im);
+    __m256 tmp, mag;
+    __m256i x;
+
+    for (i = 0; i < (unsigned int)(num_points / ROTATOR_16IC_RELOAD); i++) {
+        for (j = 0; j < ROTATOR_16IC_RELOAD / 8; ++j) {
+            x = _mm256_load_si256((const __m256i*)inPtr);
+            _mm256_store_si256((__m256i*)outPtr,
+                               volk_16ic_s32fc_x2_rotator_16ic_rotate_avx2(x, re, im));
+            tmp = _mm256_sub_ps(_mm256_mul_ps(re, inc_re), _mm256_mul_ps(im, inc_im));
+            im = _mm256_add_ps(_mm256_mul_ps(re, inc_im), _mm256_mul_ps(im, inc_re));
+            re = tmp;
+            inPtr += 8;
+            outPtr += 8;
+        }
+        mag = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+        re = _mm256_div_ps(re, mag);
+        im = _mm256_div_ps(im, mag);
+    }
+    for (i = 0; i < (num_points % ROTATOR_16IC_RELOAD) / 8; ++i) {
+        x = _mm256_load_si256((const __m256i*)inPtr);
+        _mm256_store_si256((__m256i*)outPtr,
+                           volk_16ic_s32fc_x2_rotator_16ic_rotate_avx2(x, re, im));
+        tmp = _mm256_sub_ps(_mm256_mul_ps(re, inc_re), _mm256_mul_ps(im, inc_im));
+        im = _mm256_add_ps(_mm256_mul_ps(re, inc_im), _mm256_mul_ps(im, inc_re));
+        re = tmp;
+        inPtr += 8;
+        outPtr += 8;
+    }
+    if (i) {
+        mag = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+        re = _mm256_div_ps(re, mag);
+        im = _mm256_div_ps(im, mag);
+    }
+
+    (*phase) = lv_cmake(_mm256_cvtss_f32(re), _mm256_cvtss_f32(im));
+    volk_16ic_s32fc_x2_rotator_16ic_generic(
+        outPtr, inPtr, phase_inc, phase, num_points % 8);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline __m128i
+volk_16ic_s32fc_x2_rotator_16ic_rotate_sse2(__m128i x, __m128 re, __m128 im)
+{
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 neg_scale = _mm_set1_ps(-32767.0f);
+    const __m128i low16 = _mm_set1_epi32(0xffff);
+    const __m128i half = _mm_set1_epi32(1 << 14);
+
+    const __m128i pr =
+        _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(re, scale), scale), neg_scale));
+    const __m128i pi =
+        _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(im, scale), scale), neg_scale));
+    const __m128i neg_pi = _mm_sub_epi32(_mm_setzero_si128(), pi);
+
+    const __m128i coef_re = _mm_or_si128(_mm_and_si128(pr, low16), _mm_slli_epi32(neg_pi, 16));
+    const __m128i coef_im = _mm_or_si128(_mm_and_si128(pi, low16), _mm_slli_epi32(pr, 16));
+
+    __m128i out_re = _mm_madd_epi16(x, coef_re);
+    __m128i out_im = _mm_madd_epi16(x, coef_im);
+    out_re = _mm_srai_epi32(_mm_add_epi32(out_re, half), 15);
+    out_im = _mm_srai_epi32(_mm_add_epi32(out_im, half), 15);
+
+    const __m128i packed = _mm_packs_epi32(out_re, out_im);
+    return _mm_unpacklo_epi16(packed, _mm_unpackhi_epi64(packed, packed));
+}
+
+static inline void volk_16ic_s32fc_x2_rotator_16ic_a_sse2(lv_16sc_t* outVector,
+                                                          const lv_16sc_t* inVector,
+                                                          const lv_32fc_t* phase_inc,
+                                                          lv_32fc_t* phase,
+                                                          unsigned int num_points)
+{
+    const lv_16sc_t* inPtr = inVector;
+    lv_16sc_t* outPtr = outVector;
+    double incr_re = 1.0, incr_im = 0.0, tmp_re;
+    __VOLK_ATTR_ALIGNED(16) float phase_re[4];
+    __VOLK_ATTR_ALIGNED(16) float phase_im[4];
+    unsigned int i, j = 0;
+
+    // phase_inc^4 in double, its error accumulates over num_points / 4 steps
+    for (i = 0; i < 4; ++i) {
+        phase_re[i] = (float)(lv_creal(*phase) * incr_re - lv_cimag(*phase) * incr_im);
+        phase_im[i] = (float)(lv_creal(*phase) * incr_im + lv_cimag(*phase) * incr_re);
+        tmp_re = incr_re * lv_creal(*phase_inc) - incr_im * lv_cimag(*phase_inc);
+        incr_im = incr_re * lv_cimag(*phase_inc) + incr_im * lv_creal(*phase_inc);
+        incr_re = tmp_re;
+    }
+
+    __m128 re = _mm_load_ps(phase_re);
+    __m128 im = _mm_load_ps(phase_im);
+    const __m128 inc_re = _mm_set1_ps((float)incr_re);
+    const __m128 inc_im = _mm_set1_ps((float)incr_im);
+    __m128 tmp, mag;
+    __m128i x;
+
+    for (i = 0; i < (unsigned int)(num_points / ROTATOR_16IC_RELOAD); i++) {
+        for (j = 0; j < ROTATOR_16IC_RELOAD / 4; ++j) {
+            x = _mm_load_si128((const __m128i*)inPtr);
+            _mm_store_si128((__m128i*)outPtr,
+                            volk_16ic_s32fc_x2_rotator_16ic_rotate_sse2(x, re, im));
+            tmp = _mm_sub_ps(_mm_mul_ps(re, inc_re), _mm_mul_ps(im, inc_im));
+            im = _mm_add_ps(_mm_mul_ps(re, inc_im), _mm_mul_ps(im, inc_re));
+            re = tmp;
+            inPtr += 4;
+            outPtr += 4;
+        }
+        mag = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+        re = _mm_div_ps(re, mag);
+        im = _mm_div_ps(im, mag);
+    }
+    for (i = 0; i < (num_points % ROTATOR_16IC_RELOAD) / 4; ++i) {
+        x = _mm_load_si128((const __m128i*)inPtr);
+        _mm_store_si128((__m128i*)outPtr,
+                        volk_16ic_s32fc_x2_rotator_16ic_rotate_sse2(x, re, im));
+        tmp = _mm_sub_ps(_mm_mul_ps(re, inc_re), _mm_mul_ps(im, inc_im));
+        im = _mm_add_ps(_mm_mul_ps(re, inc_im), _mm_mul_ps(im, inc_re));
+        re = tmp;
+        inPtr += 4;
+        outPtr += 4;
+    }
+    if (i) {
+        mag = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+        re = _mm_div_ps(re, mag);
+        im = _mm_div_ps(im, mag);
+    }
+
+    (*phase) = lv_cmake(_mm_cvtss_f32(re), _mm_cvtss_f32(im));
+    volk_16ic_s32fc_x2_rotator_16ic_generic(
+        outPtr, inPtr, phase_inc, phase, num_points % 4);
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+#include <volk/volk_neon_intrinsics.h>
+
+static inline int16x4_t volk_16ic_s32fc_x2_rotator_16ic_phasor_neon(float32x4_t x)
+{
+    const float32x4_t scale = vdupq_n_f32(32767.0f);
+    x = vmaxq_f32(vminq_f32(vmulq_f32(x, scale), scale), vnegq_f32(scale));
+    // vcvtq_s32_f32 truncates, add +-0.5 to round to nearest
+    x = vaddq_f32(
+        x, vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f)));
+    return vmovn_s32(vcvtq_s32_f32(x));
+}
+
+static inline void volk_16ic_s32fc_x2_rotator_16ic_neon(lv_16sc_t* outVector,
+                                                        const lv_16sc_t* inVector,
+                                                        const lv_32fc_t* phase_inc,
+                                                        lv_32fc_t* phase,
+                                                        unsigned int num_points)
+{
+    const int16_t* inPtr = (const int16_t*)inVector;
+    int16_t* outPtr = (int16_t*)outVector;
+    double incr_re = 1.0, incr_im = 0.0, tmp_re;
+    __VOLK_ATTR_ALIGNED(16) float phase_re[4];
+    __VOLK_ATTR_ALIGNED(16) float phase_im[4];
+    unsigned int i;
+    int j = 0;
+
+    // phase_inc^4 in double, its error accumulates over num_points / 4 steps
+    for (i = 0; i < 4; ++i) {
+        phase_re[i] = (float)(lv_creal(*phase) * incr_re - lv_cimag(*phase) * incr_im);
+        phase_im[i] = (float)(lv_creal(*phase) * incr_im + lv_cimag(*phase) * incr_re);
+        tmp_re = incr_re * lv_creal(*phase_inc) - incr_im * lv_cimag(*phase_inc);
+        incr_im = incr_re * lv_cimag(*phase_inc) + incr_im * lv_creal(*phase_inc);
+        incr_re = tmp_re;
+    }
+
+    float32x4_t re = vld1q_f32(phase_re);
+    float32x4_t im = vld1q_f32(phase_im);
+    const float32x4_t inc_re = vdupq_n_f32((float)incr_re);
+    const float32x4_t inc_im = vdupq_n_f32((float)incr_im);
+    float32x4_t tmp, inv_mag;
+    int32x4_t out_re, out_im;
+    int16x4x2_t x, y;
+
+    for (i = 0; i < num_points / 4; ++i) {
+        x = vld2_s16(inPtr);
+        __VOLK_PREFETCH(inPtr + 8);
+        const int16x4_t pr = volk_16ic_s32fc_x2_rotator_16ic_phasor_neon(re);
+        const int16x4_t pi = volk_16ic_s32fc_x2_rotator_16ic_phasor_neon(im);
+
+        out_re = vmlsl_s16(vmull_s16(x.val[0], pr), x.val[1], pi);
+        out_im = vmlal_s16(vmull_s16(x.val[0], pi), x.val[1], pr);
+        // rounding, saturating narrow
+        y.val[0] = vqrshrn_n_s32(out_re, 15);
+        y.val[1] = vqrshrn_n_s32(out_im, 15);
+        vst2_s16(outPtr, y);
+
+        tmp = vmlsq_f32(vmulq_f32(re, inc_re), im, inc_im);
+        im = vmlaq_f32(vmulq_f32(re, inc_im), im, inc_re);
+        re = tmp;
+        inPtr += 8;
+        outPtr += 8;
+
+        if (++j == ROTATOR_16IC_RELOAD / 4) {
+            inv_mag = _vinvsqrtq_f32(vaddq_f32(vmulq_f32(re, re), vmulq_f32(im, im)));
+            re = vmulq_f32(re, inv_mag);
+            im = vmulq_f32(im, inv_mag);
+            j = 0;
+        }
+    }
+    inv_mag = _vinvsqrtq_f32(vaddq_f32(vmulq_f32(re, re), vmulq_f32(im, im)));
+    re = vmulq_f32(re, inv_mag);
+    im = vmulq_f32(im, inv_mag);
+
+    (*phase) = lv_cmake(vgetq_lane_f32(re, 0), vgetq_lane_f32(im, 0));
+    volk_16ic_s32fc_x2_rotator_16ic_generic((lv_16sc_t*)outPtr,
+                                            (const lv_16sc_t*)inPtr,
+                                            phase_inc,
+                                            phase,
+                                            num_points % 4);
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_16ic_s32fc_x2_rotator_16ic_a_H */
+
+
+#ifndef INCLUDED_volk_16ic_s32fc_x2_rotator_16ic_u_H
+#define INCLUDED_volk_16ic_s32fc_x2_rotator_16ic_u_H
+
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_16ic_s32fc_x2_rotator_16ic_u_avx2(lv_16sc_t* outVector,
+                                                          const lv_16sc_t* inVector,
+                                                          const lv_32fc_t* phase_inc,
+                                                          lv_32fc_t* phase,
+                                                          unsigned int num_points)
+{
+    const lv_16sc_t* inPtr = inVector;
+    lv_16sc_t* outPtr = outVector;
+    double incr_re = 1.0, incr_im = 0.0, tmp_re;
+    __VOLK_ATTR_ALIGNED(32) float phase_re[8];
+    __VOLK_ATTR_ALIGNED(32) float phase_im[8];
+    unsigned int i, j = 0;
+
+    // phase_inc^8 in double, its error accumulates over num_points / 8 steps
+    for (i = 0; i < 8; ++i) {
+        phase_re[i] = (float)(lv_creal(*phase) * incr_re - lv_cimag(*phase) * incr_im);
+        phase_im[i] = (float)(lv_creal(*phase) * incr_im + lv_cimag(*phase) * incr_re);
+        tmp_re = incr_re * lv_creal(*phase_inc) - incr_im * lv_cimag(*phase_inc);
+        incr_im = incr_re * lv_cimag(*phase_inc) + incr_im * lv_creal(*phase_inc);
+        incr_re = tmp_re;
+    }
+
+    __m256 re = _mm256_load_ps(phase_re);
+    __m256 im = _mm256_load_ps(phase_im);
+    const __m256 inc_re = _mm256_set1_ps((float)incr_re);
+    const __m256 inc_im = _mm256_set1_ps((float)incr_im);
+    __m256 tmp, mag;
+    __m256i x;
+
+    for (i = 0; i < (unsigned int)(num_points / ROTATOR_16IC_RELOAD); i++) {
+        for (j = 0; j < ROTATOR_16IC_RELOAD / 8; ++j) {
+            x = _mm256_loadu_si256((const __m256i*)inPtr);
+            _mm256_storeu_si256((__m256i*)outPtr,
+                                volk_16ic_s32fc_x2_rotator_16ic_rotate_avx2(x, re, im));
+            tmp = _mm256_sub_ps(_mm256_mul_ps(re, inc_re), _mm256_mul_ps(im, inc_im));
+            im = _mm256_add_ps(_mm256_mul_ps(re, inc_im), _mm256_mul_ps(im, inc_re));
+            re = tmp;
+            inPtr += 8;
+            outPtr += 8;
+        }
+        mag = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+        re = _mm256_div_ps(re, mag);
+        im = _mm256_div_ps(im, mag);
+    }
+    for (i = 0; i < (num_points % ROTATOR_16IC_RELOAD) / 8; ++i) {
+        x = _mm256_loadu_si256((const __m256i*)inPtr);
+        _mm256_storeu_si256((__m256i*)outPtr,
+                            volk_16ic_s32fc_x2_rotator_16ic_rotate_avx2(x, re, im));
+        tmp = _mm256_sub_ps(_mm256_mul_ps(re, inc_re), _mm256_mul_ps(im, inc_im));
+        im = _mm256_add_ps(_mm256_mul_ps(re, inc_im), _mm256_mul_ps(im, inc_re));
+        re = tmp;
+        inPtr += 8;
+        outPtr += 8;
+    }
+    if (i) {
+        mag = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+        re = _mm256_div_ps(re, mag);
+        im = _mm256_div_ps(im, mag);
+    }
+
+    (*phase) = lv_cmake(_mm256_cvtss_f32(re), _mm256_cvtss_f32(im));
+    volk_16ic_s32fc_x2_rotator_16ic_generic(
+        outPtr, inPtr, phase_inc, phase, num_points % 8);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_16ic_s32fc_x2_rotator_16ic_u_sse2(lv_16sc_t* outVector,
+                                                          const lv_16sc_t* inVector,
+                                                          const lv_32fc_t* phase_inc,
+                                                          lv_32fc_t* phase,
+                                                          unsigned int num_points)
+{
+    const lv_16sc_t* inPtr = inVector;
+    lv_16sc_t* outPtr = outVector;
+    double incr_re = 1.0, incr_im = 0.0, tmp_re;
+    __VOLK_ATTR_ALIGNED(16) float phase_re[4];
+    __VOLK_ATTR_ALIGNED(16) float phase_im[4];
+    unsigned int i, j = 0;
+
+    // phase_inc^4 in double, its error accumulates over num_points / 4 steps
+    for (i = 0; i < 4; ++i) {
+        phase_re[i] = (float)(lv_creal(*phase) * incr_re - lv_cimag(*phase) * incr_im);
+        phase_im[i] = (float)(lv_creal(*phase) * incr_im + lv_cimag(*phase) * incr_re);
+        tmp_re = incr_re * lv_creal(*phase_inc) - incr_im * lv_cimag(*phase_inc);
+        incr_im = incr_re * lv_cimag(*phase_inc) + incr_im * lv_creal(*phase_inc);
+        incr_re = tmp_re;
+    }
+
+    __m128 re = _mm_load_ps(phase_re);
+    __m128 im = _mm_load_ps(phase_im);
+    const __m128 inc_re = _mm_set1_ps((float)incr_re);
+    const __m128 inc_im = _mm_set1_ps((float)incr_im);
+    __m128 tmp, mag;
+    __m128i x;
+
+    for (i = 0; i < (unsigned int)(num_points / ROTATOR_16IC_RELOAD); i++) {
+        for (j = 0; j < ROTATOR_16IC_RELOAD / 4; ++j) {
+            x = _mm_loadu_si128((const __m128i*)inPtr);
+            _mm_storeu_si128((__m128i*)outPtr,
+                             volk_16ic_s32fc_x2_rotator_16ic_rotate_sse2(x, re, im));
+            tmp = _mm_sub_ps(_mm_mul_ps(re, inc_re), _mm_mul_ps(im, inc_im));
+            im = _mm_add_ps(_mm_mul_ps(re, inc_im), _mm_mul_ps(im, inc_re));
+            re = tmp;
+            inPtr += 4;
+            outPtr += 4;
+        }
+        mag = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+        re = _mm_div_ps(re, mag);
+        im = _mm_div_ps(im, mag);
+    }
+    for (i = 0; i < (num_points % ROTATOR_16IC_RELOAD) / 4; ++i) {
+        x = _mm_loadu_si128((const __m128i*)inPtr);
+        _mm_storeu_si128((__m128i*)outPtr,
+                         volk_16ic_s32fc_x2_rotator_16ic_rotate_sse2(x, re, im));
+        tmp = _mm_sub_ps(_mm_mul_ps(re, inc_re), _mm_mul_ps(im, inc_im));
+        im = _mm_add_ps(_mm_mul_ps(re, inc_im), _mm_mul_ps(im, inc_re));
+        re = tmp;
+        inPtr += 4;
+        outPtr += 4;
+    }
+    if (i) {
+        mag = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+        re = _mm_div_ps(re, mag);
+        im = _mm_div_ps(im, mag);
+    }
+
+    (*phase) = lv_cmake(_mm_cvtss_f32(re), _mm_cvtss_f32(im));
+    volk_16ic_s32fc_x2_rotator_16ic_generic(
+        outPtr, inPtr, phase_inc, phase, num_points % 4);
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+#endif /* INCLUDED_volk_16ic_s32fc_x2_rotator_16ic_u_H */
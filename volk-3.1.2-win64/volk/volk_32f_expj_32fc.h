@@ -0,0 +1,327 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32f_expj_32fc
+ *
+ * \b Overview
+ *
+ * Computes the complex exponential exp(j * phase) for every input phase.
+ * Sine and cosine share one range reduction, and the result is written
+ * interleaved in the same pass. This replaces volk_32f_sin_32f,
+ * volk_32f_cos_32f and volk_32f_x2_interleave_32fc.
+ *
+ * c[i] = cos(a[i]) + j * sin(a[i])
+ *
+ * The SIMD protokernels are accurate to about 8e-8 absolute for
+ * |a[i]| <= 8192. Past that, the range reduction loses precision.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32f_expj_32fc(lv_32fc_t* outVector, const float* inVector,
+ *                         unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li inVector: The input vector of phases in radians.
+ * \li num_points: The number of data points.
+ *
+ * \b Outputs
+ * \li outVector: The output vector of unit magnitude complex numbers.
+ *
+ * \b Example
+ * Build a linear chirp.
+ * \code
+ *   int N = 1024;
+ *   unsigned int alignment = volk_get_alignment();
+ *   float* phase = (float*)volk_malloc(sizeof(float)*N, alignment);
+ *   lv_32fc_t* out = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t)*N, alignment);
+ *
+ *   for(unsigned int ii = 0; ii < N; ++ii){
+ *       phase[ii] = 3.14159265f * ii * ii / N;
+ *   }
+ *
+ *   volk_32f_expj_32fc(out, phase, N);
+ *
+ *   volk_free(phase);
+ *   volk_free(out);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32f_expj_32fc_a_H
+#define INCLUDED_volk_32f_expj_32fc_a_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_AVX512F
+#include <immintrin.h>
+
+/* Cephes sinf/cosf with a shared range reduction, see _m256_sincos_avx2_fma */
+static inline void
+volk_32f_expj_32fc_sincos_avx512f(const __m512 x, __m512* sine, __m512* cosine)
+{
+    const __m512i sign_bit = _mm512_set1_epi32(0x80000000);
+    const __m512i twos = _mm512_set1_epi32(2);
+    const __m512i fours = _mm512_set1_epi32(4);
+    const __m512 dp1 = _mm512_set1_ps(0.78515625f);
+    const __m512 dp2 = _mm512_set1_ps(2.4187564849853515625e-4f);
+    const __m512 dp3 = _mm512_set1_ps(3.77489497744594108e-8f);
+
+    __m512i sign_sin = _mm512_and_epi32(_mm512_castps_si512(x), sign_bit);
+    __m512 ax = _mm512_castsi512_ps(_mm512_andnot_epi32(sign_bit, _mm512_castps_si512(x)));
+
+    __m512i j = _mm512_cvttps_epi32(_mm512_mul_ps(ax, _mm512_set1_ps(1.27323954473516f)));
+    j = _mm512_and_epi32(_mm512_add_epi32(j, _mm512_set1_epi32(1)), _mm512_set1_epi32(~1));
+    const __m512 y = _mm512_cvtepi32_ps(j);
+
+    const __mmask16 poly_mask = _mm512_test_epi32_mask(j, twos);
+    sign_sin = _mm512_xor_epi32(sign_sin, _mm512_slli_epi32(_mm512_and_epi32(j, fours), 29));
+    const __m512i sign_cos =
+        _mm512_slli_epi32(_mm512_andnot_epi32(_mm512_sub_epi32(j, twos), fours), 29);
+
+    ax = _mm512_fnmadd_ps(y, dp1, ax);
+    ax = _mm512_fnmadd_ps(y, dp2, ax);
+    ax = _mm512_fnmadd_ps(y, dp3, ax);
+
+    const __m512 z = _mm512_mul_ps(ax, ax);
+    __m512 y1 = _mm512_fmadd_ps(
+        _mm512_set1_ps(2.443315711809948e-5f), z, _mm512_set1_ps(-1.388731625493765e-3f));
+    y1 = _mm512_fmadd_ps(y1, z, _mm512_set1_ps(4.166664568298827e-2f));
+    y1 = _mm512_mul_ps(_mm512_mul_ps(y1, z), z);
+    y1 = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), y1);
+    y1 = _mm512_add_ps(y1, _mm512_set1_ps(1.0f));
+
+    __m512 y2 = _mm512_fmadd_ps(
+        _mm512_set1_ps(-1.9515295891e-4f), z, _mm512_set1_ps(8.3321608736e-3f));
+    y2 = _mm512_fmadd_ps(y2, z, _mm512_set1_ps(-1.6666654611e-1f));
+    y2 = _mm512_mul_ps(y2, z);
+    y2 = _mm512_fmadd_ps(y2, ax, ax);
+
+    *sine = _mm512_castsi512_ps(_mm512_xor_epi32(
+        _mm512_castps_si512(_mm512_mask_blend_ps(poly_mask, y2, y1)), sign_sin));
+    *cosine = _mm512_castsi512_ps(_mm512_xor_epi32(
+        _mm512_castps_si512(_mm512_mask_blend_ps(poly_mask, y1, y2)), sign_cos));
+}
+
+static inline void volk_32f_expj_32fc_a_avx512f(lv_32fc_t* outVector,
+                                                const float* inVector,
+                                                unsigned int num_points)
+{
+    float* outPtr = (float*)outVector;
+    const float* inPtr = inVector;
+
+    unsigned int number = 0;
+    const unsigned int sixteenthPoints = num_points / 16;
+
+    const __m512i idx_lo =
+        _mm512_set_epi32(23, 7, 22, 6, 21, 5, 20, 4, 19, 3, 18, 2, 17, 1, 16, 0);
+    const __m512i idx_hi =
+        _mm512_set_epi32(31, 15, 30, 14, 29, 13, 28, 12, 27, 11, 26, 10, 25, 9, 24, 8);
+    __m512 aVal, sine, cosine;
+
+    for (; number < sixteenthPoints; number++) {
+        aVal = _mm512_load_ps(inPtr);
+        volk_32f_expj_32fc_sincos_avx512f(aVal, &sine, &cosine);
+
+        _mm512_store_ps(outPtr, _mm512_permutex2var_ps(cosine, idx_lo, sine));
+        _mm512_store_ps(outPtr + 16, _mm512_permutex2var_ps(cosine, idx_hi, sine));
+
+        inPtr += 16;
+        outPtr += 32;
+    }
+
+    number = sixteenthPoints * 16;
+    for (; number < num_points; number++) {
+        *outPtr++ = cosf(*inPtr);
+        *outPtr++ = sinf(*inPtr++);
+    }
+}
+
+#endif /* LV_HAVE_AVX512F for aligned */
+
+#if LV_HAVE_AVX2 && LV_HAVE_FMA
+#include <immintrin.h>
+#include <volk/volk_avx2_fma_intrinsics.h>
+
+static inline void volk_32f_expj_32fc_a_avx2_fma(lv_32fc_t* outVector,
+                                                 const float* inVector,
+                                                 unsigned int num_points)
+{
+    float* outPtr = (float*)outVector;
+    const float* inPtr = inVector;
+
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+
+    __m256 aVal, sine, cosine, lo, hi;
+
+    for (; number < eighthPoints; number++) {
+        aVal = _mm256_load_ps(inPtr);
+        _m256_sincos_avx2_fma(aVal, &sine, &cosine);
+
+        // c0 s0 c1 s1 c4 s4 c5 s5 | c2 s2 c3 s3 c6 s6 c7 s7
+        lo = _mm256_unpacklo_ps(cosine, sine);
+        hi = _mm256_unpackhi_ps(cosine, sine);
+        _mm256_store_ps(outPtr, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_store_ps(outPtr + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+
+        inPtr += 8;
+        outPtr += 16;
+    }
+
+    number = eighthPoints * 8;
+    for (; number < num_points; number++) {
+        *outPtr++ = cosf(*inPtr);
+        *outPtr++ = sinf(*inPtr++);
+    }
+}
+
+#endif /* LV_HAVE_AVX2 && LV_HAVE_FMA for aligned */
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void
+volk_32f_expj_32fc_generic(lv_32fc_t* outVector, const float* inVector, unsigned int num_points)
+{
+    float* outPtr = (float*)outVector;
+    const float* inPtr = inVector;
+    unsigned int number = 0;
+
+    for (; number < num_points; number++) {
+        *outPtr++ = cosf(*inPtr);
+        *outPtr++ = sinf(*inPtr++);
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+#include <volk/volk_neon_intrinsics.h>
+
+static inline void
+volk_32f_expj_32fc_neon(lv_32fc_t* outVector, const float* inVector, unsigned int num_points)
+{
+    float* outPtr = (float*)outVector;
+    const float* inPtr = inVector;
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+
+    float32x4x2_t sincos, expj;
+
+    for (; number < quarterPoints; number++) {
+        sincos = _vsincosq_f32(vld1q_f32(inPtr));
+        __VOLK_PREFETCH(inPtr + 4);
+        expj.val[0] = sincos.val[1];
+        expj.val[1] = sincos.val[0];
+        vst2q_f32(outPtr, expj);
+
+        inPtr += 4;
+        outPtr += 8;
+    }
+
+    number = quarterPoints * 4;
+    for (; number < num_points; number++) {
+        *outPtr++ = cosf(*inPtr);
+        *outPtr++ = sinf(*inPtr++);
+    }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_32f_expj_32fc_a_H */
+
+#ifndef INCLUDED_volk_32f_expj_32fc_u_H
+#define INCLUDED_volk_32f_expj_32fc_u_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_AVX512F
+#include <immintrin.h>
+
+static inline void volk_32f_expj_32fc_u_avx512f(lv_32fc_t* outVector,
+                                                const float* inVector,
+                                                unsigned int num_points)
+{
+    float* outPtr = (float*)outVector;
+    const float* inPtr = inVector;
+
+    unsigned int number = 0;
+    const unsigned int sixteenthPoints = num_points / 16;
+
+    const __m512i idx_lo =
+        _mm512_set_epi32(23, 7, 22, 6, 21, 5, 20, 4, 19, 3, 18, 2, 17, 1, 16, 0);
+    const __m512i idx_hi =
+        _mm512_set_epi32(31, 15, 30, 14, 29, 13, 28, 12, 27, 11, 26, 10, 25, 9, 24, 8);
+    __m512 aVal, sine, cosine;
+
+    for (; number < sixteenthPoints; number++) {
+        aVal = _mm512_loadu_ps(inPtr);
+        volk_32f_expj_32fc_sincos_avx512f(aVal, &sine, &cosine);
+
+        _mm512_storeu_ps(outPtr, _mm512_permutex2var_ps(cosine, idx_lo, sine));
+        _mm512_storeu_ps(outPtr + 16, _mm512_permutex2var_ps(cosine, idx_hi, sine));
+
+        inPtr += 16;
+        outPtr += 32;
+    }
+
+    number = sixteenthPoints * 16;
+    for (; number < num_points; number++) {
+        *outPtr++ = cosf(*inPtr);
+        *outPtr++ = sinf(*inPtr++);
+    }
+}
+
+#endif /* LV_HAVE_AVX512F for unaligned */
+
+#if LV_HAVE_AVX2 && LV_HAVE_FMA
+#include <immintrin.h>
+#include <volk/volk_avx2_fma_intrinsics.h>
+
+static inline void volk_32f_expj_32fc_u_avx2_fma(lv_32fc_t* outVector,
+                                                 const float* inVector,
+                                                 unsigned int num_points)
+{
+    float* outPtr = (float*)outVector;
+    const float* inPtr = inVector;
+
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+
+    __m256 aVal, sine, cosine, lo, hi;
+
+    for (; number < eighthPoints; number++) {
+        aVal = _mm256_loadu_ps(inPtr);
+        _m256_sincos_avx2_fma(aVal, &sine, &cosine);
+
+        lo = _mm256_unpacklo_ps(cosine, sine);
+        hi = _mm256_unpackhi_ps(cosine, sine);
+        _mm256_storeu_ps(outPtr, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(outPtr + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+
+        inPtr += 8;
+        outPtr += 16;
+    }
+
+    number = eighthPoints * 8;
+    for (; number < num_points; number++) {
+        *outPtr++ = cosf(*inPtr);
+        *outPtr++ = sinf(*inPtr++);
+    }
+}
+
+#endif /* LV_HAVE_AVX2 && LV_HAVE_FMA for unaligned */
+
+#endif /* INCLUDED_volk_32f_expj_32fc_u_H */
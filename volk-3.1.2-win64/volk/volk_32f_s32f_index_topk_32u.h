@@ -0,0 +1,547 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32f_s32f_index_topk_32u
+ *
+ * \b Overview
+ *
+ * Finds the k strongest peaks in a vector in one pass. The result is the
+ * same as calling volk_32f_index_max_32u k times and masking out every bin
+ * closer than \p min_separation to a found peak before the next call:
+ * peaks are reported strongest first, ties resolve to the lowest index, and
+ * only values strictly above \p threshold are considered.
+ *
+ * A SIMD compare against the weakest retained candidate rejects most of the
+ * input; the survivors go into a bounded heap of the k * (2 * min_separation
+ * - 1) best values, which always contains every peak the masked search would
+ * pick. The greedy separation is then applied to that small set. If the
+ * candidate count exceeds VOLK_INDEX_TOPK_MAX_CANDIDATES the kernel falls
+ * back to k scalar passes.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32f_s32f_index_topk_32u(uint32_t* target, float* values, uint32_t*
+ * num_found, const float* src0, const float threshold, uint32_t min_separation,
+ * uint32_t k, uint32_t num_points) \endcode
+ *
+ * \b Inputs
+ * \li src0: The input vector of floats.
+ * \li threshold: Only values greater than this are reported.
+ * \li min_separation: Bins closer than this to an already found peak are
+ * skipped. 0 and 1 both only exclude the peak itself.
+ * \li k: The maximum number of peaks to find.
+ * \li num_points: The number of data points.
+ *
+ * \b Outputs
+ * \li target: The indices of the peaks, strongest first (k entries).
+ * \li values: The values at those indices (k entries).
+ * \li num_found: The number of peaks found, at most k.
+ *
+ * \b Example
+ * \code
+ *   int N = 1024;
+ *   uint32_t alignment = volk_get_alignment();
+ *   float* psd = (float*)volk_malloc(sizeof(float)*N, alignment);
+ *   uint32_t idx[4];
+ *   float val[4];
+ *   uint32_t found;
+ *
+ *   // fill psd with a power spectrum in dB
+ *
+ *   volk_32f_s32f_index_topk_32u(idx, val, &found, psd, -80.f, 3, 4, N);
+ *
+ *   for(uint32_t ii = 0; ii < found; ++ii){
+ *       printf("peak %u: %1.2f dB at bin %u\n", ii, val[ii], idx[ii]);
+ *   }
+ *
+ *   volk_free(psd);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32f_s32f_index_topk_32u_a_H
+#define INCLUDED_volk_32f_s32f_index_topk_32u_a_H
+
+#include <inttypes.h>
+#include <volk/volk_common.h>
+
+#ifndef VOLK_INDEX_TOPK_MAX_CANDIDATES
+#define VOLK_INDEX_TOPK_MAX_CANDIDATES 1024
+#endif
+
+/*
+ * Bounded min-heap of (value, index) candidates. The root is the worst
+ * candidate: the lowest value, and of equal values the highest index.
+ */
+typedef struct {
+    float value[VOLK_INDEX_TOPK_MAX_CANDIDATES];
+    uint32_t index[VOLK_INDEX_TOPK_MAX_CANDIDATES];
+    uint32_t size;
+    uint32_t capacity;
+    float bound; // values must exceed this to be inserted
+    float threshold;
+} volk_index_topk_heap_t;
+
+static inline int volk_index_topk_worse(const volk_index_topk_heap_t* h,
+                                        uint32_t a,
+                                        uint32_t b)
+{
+    return h->value[a] < h->value[b] ||
+           (h->value[a] == h->value[b] && h->index[a] > h->index[b]);
+}
+
+static inline void volk_index_topk_swap(volk_index_topk_heap_t* h, uint32_t a, uint32_t b)
+{
+    const float v = h->value[a];
+    const uint32_t i = h->index[a];
+    h->value[a] = h->value[b];
+    h->index[a] = h->index[b];
+    h->value[b] = v;
+    h->index[b] = i;
+}
+
+static inline void volk_index_topk_sift_down(volk_index_topk_heap_t* h, uint32_t pos)
+{
+    for (;;) {
+        const uint32_t l = 2 * pos + 1;
+        const uint32_t r = l + 1;
+        uint32_t worst = pos;
+        if (l < h->size && volk_index_topk_worse(h, l, worst))
+            worst = l;
+        if (r < h->size && volk_index_topk_worse(h, r, worst))
+            worst = r;
+        if (worst == pos)
+            return;
+        volk_index_topk_swap(h, pos, worst);
+        pos = worst;
+    }
+}
+
+static inline void
+volk_index_topk_init(volk_index_topk_heap_t* h, uint32_t capacity, float threshold)
+{
+    h->size = 0;
+    h->capacity = capacity;
+    h->bound = threshold;
+    h->threshold = threshold;
+}
+
+/*
+ * Inputs must be pushed in increasing index order: a later value equal to
+ * the root then always ranks below it, so a strict compare against bound is
+ * enough.
+ */
+static inline void
+volk_index_topk_push(volk_index_topk_heap_t* h, float value, uint32_t index)
+{
+    if (!(value > h->bound))
+        return;
+
+    if (h->size < h->capacity) {
+        uint32_t pos = h->size++;
+        h->value[pos] = value;
+        h->index[pos] = index;
+        while (pos > 0 && volk_index_topk_worse(h, pos, (pos - 1) / 2)) {
+            volk_index_topk_swap(h, pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+        }
+    } else {
+        h->value[0] = value;
+        h->index[0] = index;
+        volk_index_topk_sift_down(h, 0);
+    }
+
+    if (h->size == h->capacity)
+        h->bound = h->value[0] > h->threshold ? h->value[0] : h->threshold;
+}
+
+/*
+ * Empties the heap best-first and applies the greedy minimum separation.
+ */
+static inline void volk_index_topk_select(volk_index_topk_heap_t* h,
+                                          uint32_t* target,
+                                          float* values,
+                                          uint32_t* num_found,
+                                          uint32_t min_separation,
+                                          uint32_t k)
+{
+    uint32_t n = h->size;
+    uint32_t found = 0;
+    uint32_t i, j;
+
+    // in-place heap sort leaves the candidates best-first
+    while (h->size > 1) {
+        volk_index_topk_swap(h, 0, --h->size);
+        volk_index_topk_sift_down(h, 0);
+    }
+
+    for (i = 0; i < n && found < k; i++) {
+        const uint32_t index = h->index[i];
+        int blocked = 0;
+        for (j = 0; j < found; j++) {
+            const uint32_t d = index > target[j] ? index - target[j] : target[j] - index;
+            if (d < min_separation) {
+                blocked = 1;
+                break;
+            }
+        }
+        if (!blocked) {
+            target[found] = index;
+            values[found] = h->value[i];
+            found++;
+        }
+    }
+
+    *num_found = found;
+}
+
+/*
+ * Candidate count that guarantees the masked search result, or 0 when it
+ * does not fit on the stack.
+ */
+static inline uint32_t volk_index_topk_capacity(uint32_t min_separation, uint32_t k)
+{
+    const uint64_t span = min_separation > 1 ? 2 * (uint64_t)min_separation - 1 : 1;
+    const uint64_t capacity = span * k;
+    return capacity <= VOLK_INDEX_TOPK_MAX_CANDIDATES ? (uint32_t)capacity : 0;
+}
+
+/*
+ * Reference k-pass search, also the fallback for very large k * min_separation.
+ */
+static inline void volk_index_topk_masked_search(uint32_t* target,
+                                                 float* values,
+                                                 uint32_t* num_found,
+                                                 const float* src0,
+                                                 const float threshold,
+                                                 uint32_t min_separation,
+                                                 uint32_t k,
+                                                 uint32_t num_points)
+{
+    uint32_t found = 0;
+    uint32_t i, j;
+
+    while (found < k) {
+        uint32_t best = num_points;
+        for (i = 0; i < num_points; i++) {
+            if (!(src0[i] > threshold) || (best < num_points && !(src0[i] > src0[best])))
+                continue;
+            int blocked = 0;
+            for (j = 0; j < found; j++) {
+                const uint32_t d = i > target[j] ? i - target[j] : target[j] - i;
+                if (d < min_separation || d == 0) {
+                    blocked = 1;
+                    break;
+                }
+            }
+            if (!blocked)
+                best = i;
+        }
+        if (best == num_points)
+            break;
+        target[found] = best;
+        values[found] = src0[best];
+        found++;
+    }
+
+    *num_found = found;
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_32f_s32f_index_topk_32u_generic(uint32_t* target,
+                                                        float* values,
+                                                        uint32_t* num_found,
+                                                        const float* src0,
+                                                        const float threshold,
+                                                        uint32_t min_separation,
+                                                        uint32_t k,
+                                                        uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    uint32_t number = 0;
+    for (; number < num_points; number++) {
+        volk_index_topk_push(&heap, src0[number], number);
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_SSE
+#include <xmmintrin.h>
+
+static inline void volk_32f_s32f_index_topk_32u_a_sse(uint32_t* target,
+                                                      float* values,
+                                                      uint32_t* num_found,
+                                                      const float* src0,
+                                                      const float threshold,
+                                                      uint32_t min_separation,
+                                                      uint32_t k,
+                                                      uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    uint32_t number = 0;
+    uint32_t i;
+    const uint32_t quarterPoints = num_points / 4;
+    const float* inputPtr = src0;
+
+    for (; number < quarterPoints; number++) {
+        const __m128 currentValues = _mm_load_ps(inputPtr);
+        const int hits =
+            _mm_movemask_ps(_mm_cmpgt_ps(currentValues, _mm_set1_ps(heap.bound)));
+        if (hits) {
+            for (i = 0; i < 4; i++) {
+                volk_index_topk_push(&heap, inputPtr[i], number * 4 + i);
+            }
+        }
+        inputPtr += 4;
+    }
+
+    number = quarterPoints * 4;
+    for (; number < num_points; number++) {
+        volk_index_topk_push(&heap, src0[number], number);
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_SSE*/
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32f_s32f_index_topk_32u_a_avx(uint32_t* target,
+                                                      float* values,
+                                                      uint32_t* num_found,
+                                                      const float* src0,
+                                                      const float threshold,
+                                                      uint32_t min_separation,
+                                                      uint32_t k,
+                                                      uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    uint32_t number = 0;
+    uint32_t i;
+    const uint32_t eighthPoints = num_points / 8;
+    const float* inputPtr = src0;
+
+    for (; number < eighthPoints; number++) {
+        const __m256 currentValues = _mm256_load_ps(inputPtr);
+        const int hits = _mm256_movemask_ps(
+            _mm256_cmp_ps(currentValues, _mm256_set1_ps(heap.bound), _CMP_GT_OQ));
+        if (hits) {
+            for (i = 0; i < 8; i++) {
+                volk_index_topk_push(&heap, inputPtr[i], number * 8 + i);
+            }
+        }
+        inputPtr += 8;
+    }
+
+    number = eighthPoints * 8;
+    for (; number < num_points; number++) {
+        volk_index_topk_push(&heap, src0[number], number);
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_AVX*/
+
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_32f_s32f_index_topk_32u_neon(uint32_t* target,
+                                                     float* values,
+                                                     uint32_t* num_found,
+                                                     const float* src0,
+                                                     const float threshold,
+                                                     uint32_t min_separation,
+                                                     uint32_t k,
+                                                     uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    uint32_t number = 0;
+    uint32_t i;
+    const uint32_t quarterPoints = num_points / 4;
+    const float* inputPtr = src0;
+
+    for (; number < quarterPoints; number++) {
+        const float32x4_t currentValues = vld1q_f32(inputPtr);
+        const uint32x4_t compareResults =
+            vcgtq_f32(currentValues, vdupq_n_f32(heap.bound));
+        const uint32x2_t folded =
+            vorr_u32(vget_low_u32(compareResults), vget_high_u32(compareResults));
+        if (vget_lane_u32(vpmax_u32(folded, folded), 0)) {
+            for (i = 0; i < 4; i++) {
+                volk_index_topk_push(&heap, inputPtr[i], number * 4 + i);
+            }
+        }
+        inputPtr += 4;
+    }
+
+    number = quarterPoints * 4;
+    for (; number < num_points; number++) {
+        volk_index_topk_push(&heap, src0[number], number);
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_NEON*/
+
+#endif /*INCLUDED_volk_32f_s32f_index_topk_32u_a_H*/
+
+
+#ifndef INCLUDED_volk_32f_s32f_index_topk_32u_u_H
+#define INCLUDED_volk_32f_s32f_index_topk_32u_u_H
+
+#include <inttypes.h>
+#include <volk/volk_common.h>
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32f_s32f_index_topk_32u_u_avx(uint32_t* target,
+                                                      float* values,
+                                                      uint32_t* num_found,
+                                                      const float* src0,
+                                                      const float threshold,
+                                                      uint32_t min_separation,
+                                                      uint32_t k,
+                                                      uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    uint32_t number = 0;
+    uint32_t i;
+    const uint32_t eighthPoints = num_points / 8;
+    const float* inputPtr = src0;
+
+    for (; number < eighthPoints; number++) {
+        const __m256 currentValues = _mm256_loadu_ps(inputPtr);
+        const int hits = _mm256_movemask_ps(
+            _mm256_cmp_ps(currentValues, _mm256_set1_ps(heap.bound), _CMP_GT_OQ));
+        if (hits) {
+            for (i = 0; i < 8; i++) {
+                volk_index_topk_push(&heap, inputPtr[i], number * 8 + i);
+            }
+        }
+        inputPtr += 8;
+    }
+
+    number = eighthPoints * 8;
+    for (; number < num_points; number++) {
+        volk_index_topk_push(&heap, src0[number], number);
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_AVX*/
+
+
+#ifdef LV_HAVE_SSE
+#include <xmmintrin.h>
+
+static inline void volk_32f_s32f_index_topk_32u_u_sse(uint32_t* target,
+                                                      float* values,
+                                                      uint32_t* num_found,
+                                                      const float* src0,
+                                                      const float threshold,
+                                                      uint32_t min_separation,
+                                                      uint32_t k,
+                                                      uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    uint32_t number = 0;
+    uint32_t i;
+    const uint32_t quarterPoints = num_points / 4;
+    const float* inputPtr = src0;
+
+    for (; number < quarterPoints; number++) {
+        const __m128 currentValues = _mm_loadu_ps(inputPtr);
+        const int hits =
+            _mm_movemask_ps(_mm_cmpgt_ps(currentValues, _mm_set1_ps(heap.bound)));
+        if (hits) {
+            for (i = 0; i < 4; i++) {
+                volk_index_topk_push(&heap, inputPtr[i], number * 4 + i);
+            }
+        }
+        inputPtr += 4;
+    }
+
+    number = quarterPoints * 4;
+    for (; number < num_points; number++) {
+        volk_index_topk_push(&heap, src0[number], number);
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_SSE*/
+
+#endif /*INCLUDED_volk_32f_s32f_index_topk_32u_u_H*/
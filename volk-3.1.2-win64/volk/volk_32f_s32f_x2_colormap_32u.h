@@ -0,0 +1,313 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32f_s32f_x2_colormap_32u
+ *
+ * \b Overview
+ *
+ * Renders one waterfall row: decimates num_bins dB values to num_pixels
+ * pixels by max hold, clamps them to [min_dB, max_dB] as
+ * volk_32f_s32f_x2_clamp_32f and looks the result up in a 256 entry
+ * palette.
+ *
+ * Pixel p holds the maximum of bins [p * num_bins / num_pixels,
+ * (p + 1) * num_bins / num_pixels), rounded down, or the single bin
+ * p * num_bins / num_pixels when there are fewer bins than pixels. NaN
+ * bins are skipped; a pixel without a number draws as min_dB. The clamped
+ * range is split into 256 equal steps, palette[0] at min_dB and
+ * palette[255] at max_dB.
+ *
+ * The AVX2 implementation reduces the span of each pixel with 8 wide
+ * (masked) loads, combines 8 pixels in one transposing max tree, and
+ * gathers their 8 palette entries.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32f_s32f_x2_colormap_32u(uint32_t* rgba, const float* dB,
+ * const uint32_t* palette, const float min_dB, const float max_dB,
+ * unsigned int num_bins, unsigned int num_pixels)
+ * \endcode
+ *
+ * \b Inputs
+ * \li dB: The power spectrum in dB, num_bins values.
+ * \li palette: 256 packed RGBA colors, stored to the output as they are.
+ * \li min_dB: The level drawn as palette[0].
+ * \li max_dB: The level drawn as palette[255], above min_dB.
+ * \li num_bins: The number of spectrum bins.
+ * \li num_pixels: The number of pixels in the row.
+ *
+ * \b Outputs
+ * \li rgba: The row of num_pixels colors.
+ *
+ * \b Example
+ * Draw a 65536 bin spectrum as a 3840 pixel waterfall row.
+ * \code
+ *   unsigned int N = 65536, W = 3840;
+ *   unsigned int alignment = volk_get_alignment();
+ *   float* psd = (float*)volk_malloc(sizeof(float) * N, alignment);
+ *   uint32_t* row = (uint32_t*)volk_malloc(sizeof(uint32_t) * W, alignment);
+ *   uint32_t palette[256];
+ *
+ *   // fill psd with the spectrum in dB, palette with the colormap
+ *
+ *   volk_32f_s32f_x2_colormap_32u(row, psd, palette, -120.f, -20.f, N, W);
+ *
+ *   volk_free(psd);
+ *   volk_free(row);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32f_s32f_x2_colormap_32u_H
+#define INCLUDED_volk_32f_s32f_x2_colormap_32u_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_common.h>
+
+// bins [*begin, end) of the next pixel; q and r are num_bins / num_pixels
+// and num_bins % num_pixels, rem carries the fraction between pixels
+static inline unsigned int volk_32f_s32f_x2_colormap_32u_span(unsigned int* begin,
+                                                              unsigned int* rem,
+                                                              unsigned int q,
+                                                              unsigned int r,
+                                                              unsigned int num_pixels)
+{
+    const unsigned int first = *begin;
+    unsigned int end = first + q;
+    *rem += r;
+    if (*rem >= num_pixels) {
+        *rem -= num_pixels;
+        end++;
+    }
+    *begin = end;
+    return end > first ? end - first : 1;
+}
+
+// max hold of num_bins values, NaN never wins the comparison
+static inline float volk_32f_s32f_x2_colormap_32u_hold(const float* dB,
+                                                       unsigned int num_bins)
+{
+    float held = -INFINITY;
+    unsigned int i;
+    for (i = 0; i < num_bins; i++) {
+        if (dB[i] > held)
+            held = dB[i];
+    }
+    return held;
+}
+
+static inline uint32_t volk_32f_s32f_x2_colormap_32u_color(const uint32_t* palette,
+                                                           float level,
+                                                           const float min_dB,
+                                                           const float max_dB,
+                                                           const float scale)
+{
+    int index;
+    if (level > max_dB)
+        level = max_dB;
+    if (!(level >= min_dB))
+        level = min_dB;
+    index = (int)((level - min_dB) * scale);
+    return palette[index > 255 ? 255 : index];
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_32f_s32f_x2_colormap_32u_generic(uint32_t* rgba,
+                                                         const float* dB,
+                                                         const uint32_t* palette,
+                                                         const float min_dB,
+                                                         const float max_dB,
+                                                         unsigned int num_bins,
+                                                         unsigned int num_pixels)
+{
+    const unsigned int q = num_bins / num_pixels;
+    const unsigned int r = num_bins % num_pixels;
+    const float scale = 256.0f / (max_dB - min_dB);
+    unsigned int begin = 0, rem = 0, p;
+
+    for (p = 0; p < num_pixels; p++) {
+        const unsigned int first = begin;
+        const unsigned int length =
+            volk_32f_s32f_x2_colormap_32u_span(&begin, &rem, q, r, num_pixels);
+        rgba[p] = volk_32f_s32f_x2_colormap_32u_color(
+            palette,
+            volk_32f_s32f_x2_colormap_32u_hold(dB + first, length),
+            min_dB,
+            max_dB,
+            scale);
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+// max hold of num_bins values in 8 lanes, lanes past the end hold -inf
+static inline __m256 volk_32f_s32f_x2_colormap_32u_hold_avx2(const float* dB,
+                                                             unsigned int num_bins)
+{
+    const __m256 lowest = _mm256_set1_ps(-INFINITY);
+    __m256 held = lowest;
+    unsigned int i = 0;
+    for (; i + 8 <= num_bins; i += 8)
+        held = _mm256_max_ps(_mm256_loadu_ps(dB + i), held);
+    if (i < num_bins) {
+        // masked lanes are not read, so a span may end at the last bin
+        const __m256i live =
+            _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(num_bins - i)),
+                               _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        held = _mm256_max_ps(_mm256_blendv_ps(lowest,
+                                              _mm256_maskload_ps(dB + i, live),
+                                              _mm256_castsi256_ps(live)),
+                             held);
+    }
+    return held;
+}
+
+static inline void volk_32f_s32f_x2_colormap_32u_u_avx2(uint32_t* rgba,
+                                                        const float* dB,
+                                                        const uint32_t* palette,
+                                                        const float min_dB,
+                                                        const float max_dB,
+                                                        unsigned int num_bins,
+                                                        unsigned int num_pixels)
+{
+    const unsigned int q = num_bins / num_pixels;
+    const unsigned int r = num_bins % num_pixels;
+    const float scale = 256.0f / (max_dB - min_dB);
+    const __m256 vmin = _mm256_set1_ps(min_dB);
+    const __m256 vmax = _mm256_set1_ps(max_dB);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256i top = _mm256_set1_epi32(255);
+    __m256 h[8], a01, a23, a45, a67, b03, b47, level;
+    unsigned int begin = 0, rem = 0, p = 0, k;
+
+    for (; p + 8 <= num_pixels; p += 8) {
+        for (k = 0; k < 8; k++) {
+            const unsigned int start = begin;
+            const unsigned int span =
+                volk_32f_s32f_x2_colormap_32u_span(&begin, &rem, q, r, num_pixels);
+            h[k] = volk_32f_s32f_x2_colormap_32u_hold_avx2(dB + start, span);
+        }
+
+        // transposing max tree, lane k ends up with the maximum of h[k]
+        a01 = _mm256_max_ps(_mm256_unpacklo_ps(h[0], h[1]),
+                            _mm256_unpackhi_ps(h[0], h[1]));
+        a23 = _mm256_max_ps(_mm256_unpacklo_ps(h[2], h[3]),
+                            _mm256_unpackhi_ps(h[2], h[3]));
+        a45 = _mm256_max_ps(_mm256_unpacklo_ps(h[4], h[5]),
+                            _mm256_unpackhi_ps(h[4], h[5]));
+        a67 = _mm256_max_ps(_mm256_unpacklo_ps(h[6], h[7]),
+                            _mm256_unpackhi_ps(h[6], h[7]));
+        b03 = _mm256_max_ps(_mm256_shuffle_ps(a01, a23, 0x44),
+                            _mm256_shuffle_ps(a01, a23, 0xee));
+        b47 = _mm256_max_ps(_mm256_shuffle_ps(a45, a67, 0x44),
+                            _mm256_shuffle_ps(a45, a67, 0xee));
+        level = _mm256_max_ps(_mm256_permute2f128_ps(b03, b47, 0x20),
+                              _mm256_permute2f128_ps(b03, b47, 0x31));
+
+        // pixels without a number hold -inf and clamp to min_dB
+        level = _mm256_min_ps(_mm256_max_ps(level, vmin), vmax);
+        const __m256i index = _mm256_min_epi32(
+            _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(level, vmin), vscale)), top);
+        _mm256_storeu_si256((__m256i*)(rgba + p),
+                            _mm256_i32gather_epi32((const int*)palette, index, 4));
+    }
+
+    for (; p < num_pixels; p++) {
+        const unsigned int start = begin;
+        const unsigned int span =
+            volk_32f_s32f_x2_colormap_32u_span(&begin, &rem, q, r, num_pixels);
+        rgba[p] = volk_32f_s32f_x2_colormap_32u_color(
+            palette,
+            volk_32f_s32f_x2_colormap_32u_hold(dB + start, span),
+            min_dB,
+            max_dB,
+            scale);
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE4_1
+#include <smmintrin.h>
+
+// max hold of num_bins values in 4 lanes
+static inline __m128 volk_32f_s32f_x2_colormap_32u_hold_sse4_1(const float* dB,
+                                                               unsigned int num_bins)
+{
+    __m128 held = _mm_set1_ps(-INFINITY);
+    unsigned int i = 0;
+    for (; i + 4 <= num_bins; i += 4)
+        held = _mm_max_ps(_mm_loadu_ps(dB + i), held);
+    for (; i < num_bins; i++)
+        held = _mm_max_ps(_mm_set1_ps(dB[i]), held);
+    return held;
+}
+
+static inline void volk_32f_s32f_x2_colormap_32u_u_sse4_1(uint32_t* rgba,
+                                                          const float* dB,
+                                                          const uint32_t* palette,
+                                                          const float min_dB,
+                                                          const float max_dB,
+                                                          unsigned int num_bins,
+                                                          unsigned int num_pixels)
+{
+    const unsigned int q = num_bins / num_pixels;
+    const unsigned int r = num_bins % num_pixels;
+    const float scale = 256.0f / (max_dB - min_dB);
+    const __m128 vmin = _mm_set1_ps(min_dB);
+    const __m128 vmax = _mm_set1_ps(max_dB);
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128i top = _mm_set1_epi32(255);
+    __m128 h[4], a01, a23, level;
+    __m128i index;
+    unsigned int begin = 0, rem = 0, p = 0, k;
+
+    for (; p + 4 <= num_pixels; p += 4) {
+        for (k = 0; k < 4; k++) {
+            const unsigned int start = begin;
+            const unsigned int span =
+                volk_32f_s32f_x2_colormap_32u_span(&begin, &rem, q, r, num_pixels);
+            h[k] = volk_32f_s32f_x2_colormap_32u_hold_sse4_1(dB + start, span);
+        }
+
+        // transposing max tree, lane k ends up with the maximum of h[k]
+        a01 = _mm_max_ps(_mm_unpacklo_ps(h[0], h[1]), _mm_unpackhi_ps(h[0], h[1]));
+        a23 = _mm_max_ps(_mm_unpacklo_ps(h[2], h[3]), _mm_unpackhi_ps(h[2], h[3]));
+        level = _mm_max_ps(_mm_movelh_ps(a01, a23), _mm_movehl_ps(a23, a01));
+
+        level = _mm_min_ps(_mm_max_ps(level, vmin), vmax);
+        index = _mm_min_epi32(
+            _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(level, vmin), vscale)), top);
+        rgba[p] = palette[_mm_cvtsi128_si32(index)];
+        rgba[p + 1] = palette[_mm_extract_epi32(index, 1)];
+        rgba[p + 2] = palette[_mm_extract_epi32(index, 2)];
+        rgba[p + 3] = palette[_mm_extract_epi32(index, 3)];
+    }
+
+    for (; p < num_pixels; p++) {
+        const unsigned int start = begin;
+        const unsigned int span =
+            volk_32f_s32f_x2_colormap_32u_span(&begin, &rem, q, r, num_pixels);
+        rgba[p] = volk_32f_s32f_x2_colormap_32u_color(
+            palette,
+            volk_32f_s32f_x2_colormap_32u_hold(dB + start, span),
+            min_dB,
+            max_dB,
+            scale);
+    }
+}
+
+#endif /* LV_HAVE_SSE4_1 */
+
+#endif /* INCLUDED_volk_32f_s32f_x2_colormap_32u_H */
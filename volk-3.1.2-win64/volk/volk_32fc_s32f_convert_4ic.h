@@ -0,0 +1,275 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32fc_s32f_convert_4ic
+ *
+ * \b Overview
+ *
+ * Quantizes complex floats to complex signed 4-bit integers packed one
+ * sample per byte, the SOAPY_SDR_CS4 layout: the in-phase part in the high
+ * nibble and the quadrature part in the low nibble, both two's complement.
+ * Each part is multiplied by scalar, rounded and saturated to [-8, 7], the
+ * same steps as volk_32f_s32f_convert_8i before the nibbles are packed.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32fc_s32f_convert_4ic(uint8_t* outputVector, const lv_32fc_t* inputVector,
+ * const float scalar, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li inputVector: The complex float input buffer.
+ * \li scalar: The value each part is multiplied by before rounding.
+ * \li num_points: The number of complex samples.
+ *
+ * \b Outputs
+ * \li outputVector: num_points bytes of packed CS4 samples.
+ *
+ * \b Example
+ * Quantize samples of full scale 1.0 for storage.
+ * \code
+ * int N = 8192;
+ * unsigned int alignment = volk_get_alignment();
+ * lv_32fc_t* input = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ * uint8_t* packed = (uint8_t*)volk_malloc(N, alignment);
+ *
+ * volk_32fc_s32f_convert_4ic(packed, input, 7.0f, N);
+ *
+ * volk_free(input);
+ * volk_free(packed);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32fc_s32f_convert_4ic_u_H
+#define INCLUDED_volk_32fc_s32f_convert_4ic_u_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_complex.h>
+
+static inline uint8_t volk_32fc_s32f_convert_4ic_single(float in_i, float in_q)
+{
+    const float min_val = -8.0f;
+    const float max_val = 7.0f;
+    in_i = in_i > max_val ? max_val : (in_i < min_val ? min_val : in_i);
+    in_q = in_q > max_val ? max_val : (in_q < min_val ? min_val : in_q);
+    const int i = (int)rintf(in_i);
+    const int q = (int)rintf(in_q);
+    return (uint8_t)(((i & 0x0f) << 4) | (q & 0x0f));
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_32fc_s32f_convert_4ic_generic(uint8_t* outputVector,
+                                                      const lv_32fc_t* inputVector,
+                                                      const float scalar,
+                                                      unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+
+    for (unsigned int number = 0; number < num_points; number++) {
+        outputVector[number] =
+            volk_32fc_s32f_convert_4ic_single(inputPtr[0] * scalar, inputPtr[1] * scalar);
+        inputPtr += 2;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+/* 16 samples from 32 floats as 16-bit lanes of I in bits 4-7, Q in bits 0-3 */
+static inline __m256i volk_32fc_s32f_convert_4ic_avx2_nibbles(const float* inputPtr,
+                                                              const __m256 vScalar)
+{
+    const __m256 vmin_val = _mm256_set1_ps(-8.0f);
+    const __m256 vmax_val = _mm256_set1_ps(7.0f);
+
+    __m256 inputVal1 = _mm256_loadu_ps(inputPtr);
+    __m256 inputVal2 = _mm256_loadu_ps(inputPtr + 8);
+    __m256 inputVal3 = _mm256_loadu_ps(inputPtr + 16);
+    __m256 inputVal4 = _mm256_loadu_ps(inputPtr + 24);
+
+    inputVal1 = _mm256_max_ps(
+        _mm256_min_ps(_mm256_mul_ps(inputVal1, vScalar), vmax_val), vmin_val);
+    inputVal2 = _mm256_max_ps(
+        _mm256_min_ps(_mm256_mul_ps(inputVal2, vScalar), vmax_val), vmin_val);
+    inputVal3 = _mm256_max_ps(
+        _mm256_min_ps(_mm256_mul_ps(inputVal3, vScalar), vmax_val), vmin_val);
+    inputVal4 = _mm256_max_ps(
+        _mm256_min_ps(_mm256_mul_ps(inputVal4, vScalar), vmax_val), vmin_val);
+
+    __m256i intInputVal1 = _mm256_cvtps_epi32(inputVal1);
+    __m256i intInputVal2 = _mm256_cvtps_epi32(inputVal2);
+    __m256i intInputVal3 = _mm256_cvtps_epi32(inputVal3);
+    __m256i intInputVal4 = _mm256_cvtps_epi32(inputVal4);
+
+    intInputVal1 = _mm256_packs_epi32(intInputVal1, intInputVal2);
+    intInputVal1 = _mm256_permute4x64_epi64(intInputVal1, 0xd8);
+    intInputVal3 = _mm256_packs_epi32(intInputVal3, intInputVal4);
+    intInputVal3 = _mm256_permute4x64_epi64(intInputVal3, 0xd8);
+    intInputVal1 = _mm256_packs_epi16(intInputVal1, intInputVal3);
+    intInputVal1 = _mm256_permute4x64_epi64(intInputVal1, 0xd8);
+
+    // each 16-bit lane now holds I in its low byte and Q in its high byte
+    const __m256i iPart =
+        _mm256_and_si256(_mm256_slli_epi16(intInputVal1, 4), _mm256_set1_epi16(0x00f0));
+    const __m256i qPart =
+        _mm256_and_si256(_mm256_srli_epi16(intInputVal1, 8), _mm256_set1_epi16(0x000f));
+    return _mm256_or_si256(iPart, qPart);
+}
+
+static inline void volk_32fc_s32f_convert_4ic_u_avx2(uint8_t* outputVector,
+                                                     const lv_32fc_t* inputVector,
+                                                     const float scalar,
+                                                     unsigned int num_points)
+{
+    const unsigned int thirtysecondPoints = num_points / 32;
+
+    const float* inputPtr = (const float*)inputVector;
+    uint8_t* outputPtr = outputVector;
+    const __m256 vScalar = _mm256_set1_ps(scalar);
+
+    for (unsigned int number = 0; number < thirtysecondPoints; number++) {
+        const __m256i lo =
+            volk_32fc_s32f_convert_4ic_avx2_nibbles(inputPtr, vScalar);
+        const __m256i hi =
+            volk_32fc_s32f_convert_4ic_avx2_nibbles(inputPtr + 32, vScalar);
+        const __m256i packed =
+            _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8);
+        _mm256_storeu_si256((__m256i*)outputPtr, packed);
+        inputPtr += 64;
+        outputPtr += 32;
+    }
+
+    for (unsigned int number = thirtysecondPoints * 32; number < num_points; number++) {
+        *outputPtr++ =
+            volk_32fc_s32f_convert_4ic_single(inputPtr[0] * scalar, inputPtr[1] * scalar);
+        inputPtr += 2;
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+/* 8 samples from 16 floats as 16-bit lanes of I in bits 4-7, Q in bits 0-3 */
+static inline __m128i volk_32fc_s32f_convert_4ic_sse2_nibbles(const float* inputPtr,
+                                                              const __m128 vScalar)
+{
+    const __m128 vmin_val = _mm_set_ps1(-8.0f);
+    const __m128 vmax_val = _mm_set_ps1(7.0f);
+
+    __m128 inputVal1 = _mm_loadu_ps(inputPtr);
+    __m128 inputVal2 = _mm_loadu_ps(inputPtr + 4);
+    __m128 inputVal3 = _mm_loadu_ps(inputPtr + 8);
+    __m128 inputVal4 = _mm_loadu_ps(inputPtr + 12);
+
+    inputVal1 = _mm_max_ps(
+        _mm_min_ps(_mm_mul_ps(inputVal1, vScalar), vmax_val), vmin_val);
+    inputVal2 = _mm_max_ps(
+        _mm_min_ps(_mm_mul_ps(inputVal2, vScalar), vmax_val), vmin_val);
+    inputVal3 = _mm_max_ps(
+        _mm_min_ps(_mm_mul_ps(inputVal3, vScalar), vmax_val), vmin_val);
+    inputVal4 = _mm_max_ps(
+        _mm_min_ps(_mm_mul_ps(inputVal4, vScalar), vmax_val), vmin_val);
+
+    __m128i intInputVal1 = _mm_packs_epi32(_mm_cvtps_epi32(inputVal1),
+                                           _mm_cvtps_epi32(inputVal2));
+    __m128i intInputVal3 = _mm_packs_epi32(_mm_cvtps_epi32(inputVal3),
+                                           _mm_cvtps_epi32(inputVal4));
+    intInputVal1 = _mm_packs_epi16(intInputVal1, intInputVal3);
+
+    const __m128i iPart =
+        _mm_and_si128(_mm_slli_epi16(intInputVal1, 4), _mm_set1_epi16(0x00f0));
+    const __m128i qPart =
+        _mm_and_si128(_mm_srli_epi16(intInputVal1, 8), _mm_set1_epi16(0x000f));
+    return _mm_or_si128(iPart, qPart);
+}
+
+static inline void volk_32fc_s32f_convert_4ic_u_sse2(uint8_t* outputVector,
+                                                     const lv_32fc_t* inputVector,
+                                                     const float scalar,
+                                                     unsigned int num_points)
+{
+    const unsigned int sixteenthPoints = num_points / 16;
+
+    const float* inputPtr = (const float*)inputVector;
+    uint8_t* outputPtr = outputVector;
+    const __m128 vScalar = _mm_set_ps1(scalar);
+
+    for (unsigned int number = 0; number < sixteenthPoints; number++) {
+        const __m128i lo =
+            volk_32fc_s32f_convert_4ic_sse2_nibbles(inputPtr, vScalar);
+        const __m128i hi =
+            volk_32fc_s32f_convert_4ic_sse2_nibbles(inputPtr + 16, vScalar);
+        _mm_storeu_si128((__m128i*)outputPtr, _mm_packus_epi16(lo, hi));
+        inputPtr += 32;
+        outputPtr += 16;
+    }
+
+    for (unsigned int number = sixteenthPoints * 16; number < num_points; number++) {
+        *outputPtr++ =
+            volk_32fc_s32f_convert_4ic_single(inputPtr[0] * scalar, inputPtr[1] * scalar);
+        inputPtr += 2;
+    }
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+#if LV_HAVE_NEONV8
+#include <arm_neon.h>
+
+static inline void volk_32fc_s32f_convert_4ic_neonv8(uint8_t* outputVector,
+                                                     const lv_32fc_t* inputVector,
+                                                     const float scalar,
+                                                     unsigned int num_points)
+{
+    const unsigned int eighthPoints = num_points / 8;
+
+    const float* inputPtr = (const float*)inputVector;
+    uint8_t* outputPtr = outputVector;
+    const float32x4_t vmin_val = vdupq_n_f32(-8.0f);
+    const float32x4_t vmax_val = vdupq_n_f32(7.0f);
+
+    for (unsigned int number = 0; number < eighthPoints; number++) {
+        // deinterleaving loads give the I and Q parts of 4 samples each
+        const float32x4x2_t a = vld2q_f32(inputPtr);
+        const float32x4x2_t b = vld2q_f32(inputPtr + 8);
+        int16x8_t parts[2];
+        for (int k = 0; k < 2; k++) {
+            float32x4_t x0 = vmulq_n_f32(a.val[k], scalar);
+            float32x4_t x1 = vmulq_n_f32(b.val[k], scalar);
+            x0 = vmaxq_f32(vminq_f32(x0, vmax_val), vmin_val);
+            x1 = vmaxq_f32(vminq_f32(x1, vmax_val), vmin_val);
+            // vrndiq takes into account the current rounding mode (as does rintf)
+            parts[k] = vcombine_s16(vmovn_s32(vcvtq_s32_f32(vrndiq_f32(x0))),
+                                    vmovn_s32(vcvtq_s32_f32(vrndiq_f32(x1))));
+        }
+        const uint8x8_t iPart = vshl_n_u8(vreinterpret_u8_s8(vmovn_s16(parts[0])), 4);
+        const uint8x8_t qPart =
+            vand_u8(vreinterpret_u8_s8(vmovn_s16(parts[1])), vdup_n_u8(0x0f));
+        vst1_u8(outputPtr, vorr_u8(iPart, qPart));
+        inputPtr += 16;
+        outputPtr += 8;
+    }
+
+    for (unsigned int number = eighthPoints * 8; number < num_points; number++) {
+        *outputPtr++ =
+            volk_32fc_s32f_convert_4ic_single(inputPtr[0] * scalar, inputPtr[1] * scalar);
+        inputPtr += 2;
+    }
+}
+
+#endif /* LV_HAVE_NEONV8 */
+
+#endif /* INCLUDED_volk_32fc_s32f_convert_4ic_u_H */
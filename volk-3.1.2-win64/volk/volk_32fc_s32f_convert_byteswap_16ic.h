@@ -0,0 +1,232 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32fc_s32f_convert_byteswap_16ic
+ *
+ * \b Overview
+ *
+ * Multiplies complex floats by scalar, rounds them to the nearest complex
+ * 16-bit integers and writes those big-endian, for transmitting to netSDR
+ * and VITA-49 style sinks. Values are saturated to the int16 range. This
+ * is volk_32fc_convert_16ic followed by volk_16u_byteswap in one pass.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32fc_s32f_convert_byteswap_16ic(lv_16sc_t* outputVector, const lv_32fc_t*
+ * inputVector, const float scalar, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li inputVector: The complex float input buffer.
+ * \li scalar: The value the input is multiplied by before rounding.
+ * \li num_points: The number of complex samples.
+ *
+ * \b Outputs
+ * \li outputVector: The big-endian complex 16-bit integer output buffer.
+ *
+ * \b Example
+ * \code
+ * int N = 8192;
+ * unsigned int alignment = volk_get_alignment();
+ * lv_32fc_t* input = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ * lv_16sc_t* payload = (lv_16sc_t*)volk_malloc(sizeof(lv_16sc_t) * N, alignment);
+ *
+ * // fill input with samples of full scale 1.0
+ *
+ * volk_32fc_s32f_convert_byteswap_16ic(payload, input, 32767.0f, N);
+ *
+ * volk_free(input);
+ * volk_free(payload);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32fc_s32f_convert_byteswap_16ic_u_H
+#define INCLUDED_volk_32fc_s32f_convert_byteswap_16ic_u_H
+
+#include <inttypes.h>
+#include <limits.h>
+#include <math.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void
+volk_32fc_s32f_convert_byteswap_16ic_generic(lv_16sc_t* outputVector,
+                                             const lv_32fc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint16_t* outputPtr = (uint16_t*)outputVector;
+    const float min_val = (float)SHRT_MIN;
+    const float max_val = (float)SHRT_MAX;
+
+    unsigned int number = 0;
+    for (number = 0; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint16_t value = (uint16_t)(int16_t)rintf(aux);
+        *outputPtr++ = (uint16_t)((value >> 8) | (value << 8));
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#if LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void
+volk_32fc_s32f_convert_byteswap_16ic_u_avx2(lv_16sc_t* outputVector,
+                                            const lv_32fc_t* inputVector,
+                                            const float scalar,
+                                            unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint16_t* outputPtr = (uint16_t*)outputVector;
+    const float min_val = (float)SHRT_MIN;
+    const float max_val = (float)SHRT_MAX;
+
+    const __m256 vScalar = _mm256_set1_ps(scalar);
+    const __m256 vmin_val = _mm256_set1_ps(min_val);
+    const __m256 vmax_val = _mm256_set1_ps(max_val);
+    const __m256i swap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12,
+                                          15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10,
+                                          13, 12, 15, 14);
+
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+    for (; number < eighthPoints; number++) {
+        __m256 in0 = _mm256_mul_ps(_mm256_loadu_ps(inputPtr), vScalar);
+        __m256 in1 = _mm256_mul_ps(_mm256_loadu_ps(inputPtr + 8), vScalar);
+        // clip first, cvtps returns INT_MIN for anything out of the int32 range
+        in0 = _mm256_max_ps(_mm256_min_ps(in0, vmax_val), vmin_val);
+        in1 = _mm256_max_ps(_mm256_min_ps(in1, vmax_val), vmin_val);
+
+        __m256i packed =
+            _mm256_packs_epi32(_mm256_cvtps_epi32(in0), _mm256_cvtps_epi32(in1));
+        packed = _mm256_permute4x64_epi64(packed, 0xd8);
+        _mm256_storeu_si256((__m256i*)outputPtr, _mm256_shuffle_epi8(packed, swap));
+        inputPtr += 16;
+        outputPtr += 16;
+    }
+
+    number = eighthPoints * 16;
+    for (; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint16_t value = (uint16_t)(int16_t)rintf(aux);
+        *outputPtr++ = (uint16_t)((value >> 8) | (value << 8));
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSSE3
+#include <tmmintrin.h>
+
+static inline void
+volk_32fc_s32f_convert_byteswap_16ic_u_ssse3(lv_16sc_t* outputVector,
+                                             const lv_32fc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint16_t* outputPtr = (uint16_t*)outputVector;
+    const float min_val = (float)SHRT_MIN;
+    const float max_val = (float)SHRT_MAX;
+
+    const __m128 vScalar = _mm_set1_ps(scalar);
+    const __m128 vmin_val = _mm_set1_ps(min_val);
+    const __m128 vmax_val = _mm_set1_ps(max_val);
+    const __m128i swap =
+        _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        __m128 in0 = _mm_mul_ps(_mm_loadu_ps(inputPtr), vScalar);
+        __m128 in1 = _mm_mul_ps(_mm_loadu_ps(inputPtr + 4), vScalar);
+        in0 = _mm_max_ps(_mm_min_ps(in0, vmax_val), vmin_val);
+        in1 = _mm_max_ps(_mm_min_ps(in1, vmax_val), vmin_val);
+
+        const __m128i packed =
+            _mm_packs_epi32(_mm_cvtps_epi32(in0), _mm_cvtps_epi32(in1));
+        _mm_storeu_si128((__m128i*)outputPtr, _mm_shuffle_epi8(packed, swap));
+        inputPtr += 8;
+        outputPtr += 8;
+    }
+
+    number = quarterPoints * 8;
+    for (; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint16_t value = (uint16_t)(int16_t)rintf(aux);
+        *outputPtr++ = (uint16_t)((value >> 8) | (value << 8));
+    }
+}
+
+#endif /* LV_HAVE_SSSE3 */
+
+#if LV_HAVE_NEONV8
+#include <arm_neon.h>
+
+static inline void
+volk_32fc_s32f_convert_byteswap_16ic_neonv8(lv_16sc_t* outputVector,
+                                            const lv_32fc_t* inputVector,
+                                            const float scalar,
+                                            unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint16_t* outputPtr = (uint16_t*)outputVector;
+    const float min_val = (float)SHRT_MIN;
+    const float max_val = (float)SHRT_MAX;
+
+    const float32x4_t vmin_val = vmovq_n_f32(min_val);
+    const float32x4_t vmax_val = vmovq_n_f32(max_val);
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        float32x4_t in0 = vmulq_n_f32(vld1q_f32(inputPtr), scalar);
+        float32x4_t in1 = vmulq_n_f32(vld1q_f32(inputPtr + 4), scalar);
+        in0 = vmaxq_f32(vminq_f32(in0, vmax_val), vmin_val);
+        in1 = vmaxq_f32(vminq_f32(in1, vmax_val), vmin_val);
+
+        // vrndiq takes into account the current rounding mode (as does rintf)
+        const int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vrndiq_f32(in0))),
+                                              vqmovn_s32(vcvtq_s32_f32(vrndiq_f32(in1))));
+        vst1q_u8((uint8_t*)outputPtr, vrev16q_u8(vreinterpretq_u8_s16(packed)));
+        inputPtr += 8;
+        outputPtr += 8;
+    }
+
+    number = quarterPoints * 8;
+    for (; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint16_t value = (uint16_t)(int16_t)rintf(aux);
+        *outputPtr++ = (uint16_t)((value >> 8) | (value << 8));
+    }
+}
+
+#endif /* LV_HAVE_NEONV8 */
+
+#endif /* INCLUDED_volk_32fc_s32f_convert_byteswap_16ic_u_H */
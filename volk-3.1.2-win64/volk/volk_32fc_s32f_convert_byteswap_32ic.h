@@ -0,0 +1,231 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32fc_s32f_convert_byteswap_32ic
+ *
+ * \b Overview
+ *
+ * Multiplies complex floats by scalar, rounds them to the nearest complex
+ * 32-bit integers and writes those big-endian. Values are saturated to the
+ * int32 range, whose top is 2147483520 as the largest float below 2^31.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32fc_s32f_convert_byteswap_32ic(lv_32sc_t* outputVector, const lv_32fc_t*
+ * inputVector, const float scalar, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li inputVector: The complex float input buffer.
+ * \li scalar: The value the input is multiplied by before rounding.
+ * \li num_points: The number of complex samples.
+ *
+ * \b Outputs
+ * \li outputVector: The big-endian complex 32-bit integer output buffer.
+ *
+ * \b Example
+ * \code
+ * int N = 8192;
+ * unsigned int alignment = volk_get_alignment();
+ * lv_32fc_t* input = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ * lv_32sc_t* payload = (lv_32sc_t*)volk_malloc(sizeof(lv_32sc_t) * N, alignment);
+ *
+ * // fill input with samples of full scale 1.0
+ *
+ * volk_32fc_s32f_convert_byteswap_32ic(payload, input, 2147483648.0f, N);
+ *
+ * volk_free(input);
+ * volk_free(payload);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32fc_s32f_convert_byteswap_32ic_u_H
+#define INCLUDED_volk_32fc_s32f_convert_byteswap_32ic_u_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void
+volk_32fc_s32f_convert_byteswap_32ic_generic(lv_32sc_t* outputVector,
+                                             const lv_32fc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint32_t* outputPtr = (uint32_t*)outputVector;
+    const float min_val = -2147483648.0f;
+    const float max_val = 2147483520.0f;
+
+    unsigned int number = 0;
+    for (number = 0; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint32_t value = (uint32_t)(int32_t)rintf(aux);
+        *outputPtr++ = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                       ((value << 8) & 0x00ff0000) | (value << 24);
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#if LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void
+volk_32fc_s32f_convert_byteswap_32ic_u_avx2(lv_32sc_t* outputVector,
+                                            const lv_32fc_t* inputVector,
+                                            const float scalar,
+                                            unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint32_t* outputPtr = (uint32_t*)outputVector;
+    const float min_val = -2147483648.0f;
+    const float max_val = 2147483520.0f;
+
+    const __m256 vScalar = _mm256_set1_ps(scalar);
+    const __m256 vmin_val = _mm256_set1_ps(min_val);
+    const __m256 vmax_val = _mm256_set1_ps(max_val);
+    const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14,
+                                          13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                                          15, 14, 13, 12);
+
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+    for (; number < eighthPoints; number++) {
+        __m256 in0 = _mm256_mul_ps(_mm256_loadu_ps(inputPtr), vScalar);
+        __m256 in1 = _mm256_mul_ps(_mm256_loadu_ps(inputPtr + 8), vScalar);
+        in0 = _mm256_max_ps(_mm256_min_ps(in0, vmax_val), vmin_val);
+        in1 = _mm256_max_ps(_mm256_min_ps(in1, vmax_val), vmin_val);
+
+        const __m256i out0 = _mm256_shuffle_epi8(_mm256_cvtps_epi32(in0), swap);
+        const __m256i out1 = _mm256_shuffle_epi8(_mm256_cvtps_epi32(in1), swap);
+        _mm256_storeu_si256((__m256i*)outputPtr, out0);
+        _mm256_storeu_si256((__m256i*)(outputPtr + 8), out1);
+        inputPtr += 16;
+        outputPtr += 16;
+    }
+
+    number = eighthPoints * 16;
+    for (; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint32_t value = (uint32_t)(int32_t)rintf(aux);
+        *outputPtr++ = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                       ((value << 8) & 0x00ff0000) | (value << 24);
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSSE3
+#include <tmmintrin.h>
+
+static inline void
+volk_32fc_s32f_convert_byteswap_32ic_u_ssse3(lv_32sc_t* outputVector,
+                                             const lv_32fc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint32_t* outputPtr = (uint32_t*)outputVector;
+    const float min_val = -2147483648.0f;
+    const float max_val = 2147483520.0f;
+
+    const __m128 vScalar = _mm_set1_ps(scalar);
+    const __m128 vmin_val = _mm_set1_ps(min_val);
+    const __m128 vmax_val = _mm_set1_ps(max_val);
+    const __m128i swap =
+        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        __m128 in0 = _mm_mul_ps(_mm_loadu_ps(inputPtr), vScalar);
+        __m128 in1 = _mm_mul_ps(_mm_loadu_ps(inputPtr + 4), vScalar);
+        in0 = _mm_max_ps(_mm_min_ps(in0, vmax_val), vmin_val);
+        in1 = _mm_max_ps(_mm_min_ps(in1, vmax_val), vmin_val);
+
+        const __m128i out0 = _mm_shuffle_epi8(_mm_cvtps_epi32(in0), swap);
+        const __m128i out1 = _mm_shuffle_epi8(_mm_cvtps_epi32(in1), swap);
+        _mm_storeu_si128((__m128i*)outputPtr, out0);
+        _mm_storeu_si128((__m128i*)(outputPtr + 4), out1);
+        inputPtr += 8;
+        outputPtr += 8;
+    }
+
+    number = quarterPoints * 8;
+    for (; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint32_t value = (uint32_t)(int32_t)rintf(aux);
+        *outputPtr++ = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                       ((value << 8) & 0x00ff0000) | (value << 24);
+    }
+}
+
+#endif /* LV_HAVE_SSSE3 */
+
+#if LV_HAVE_NEONV8
+#include <arm_neon.h>
+
+static inline void
+volk_32fc_s32f_convert_byteswap_32ic_neonv8(lv_32sc_t* outputVector,
+                                            const lv_32fc_t* inputVector,
+                                            const float scalar,
+                                            unsigned int num_points)
+{
+    const float* inputPtr = (const float*)inputVector;
+    uint32_t* outputPtr = (uint32_t*)outputVector;
+    const float min_val = -2147483648.0f;
+    const float max_val = 2147483520.0f;
+
+    const float32x4_t vmin_val = vmovq_n_f32(min_val);
+    const float32x4_t vmax_val = vmovq_n_f32(max_val);
+
+    unsigned int number = 0;
+    const unsigned int halfPoints = num_points / 2;
+    for (; number < halfPoints; number++) {
+        float32x4_t in = vmulq_n_f32(vld1q_f32(inputPtr), scalar);
+        in = vmaxq_f32(vminq_f32(in, vmax_val), vmin_val);
+
+        // vrndiq takes into account the current rounding mode (as does rintf)
+        const int32x4_t out = vcvtq_s32_f32(vrndiq_f32(in));
+        vst1q_u8((uint8_t*)outputPtr, vrev32q_u8(vreinterpretq_u8_s32(out)));
+        inputPtr += 4;
+        outputPtr += 4;
+    }
+
+    number = halfPoints * 4;
+    for (; number < num_points * 2; number++) {
+        float aux = *inputPtr++ * scalar;
+        if (aux > max_val)
+            aux = max_val;
+        else if (aux < min_val)
+            aux = min_val;
+        const uint32_t value = (uint32_t)(int32_t)rintf(aux);
+        *outputPtr++ = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                       ((value << 8) & 0x00ff0000) | (value << 24);
+    }
+}
+
+#endif /* LV_HAVE_NEONV8 */
+
+#endif /* INCLUDED_volk_32fc_s32f_convert_byteswap_32ic_u_H */
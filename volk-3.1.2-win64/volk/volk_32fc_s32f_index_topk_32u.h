@@ -0,0 +1,269 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32fc_s32f_index_topk_32u
+ *
+ * \b Overview
+ *
+ * Complex counterpart of volk_32f_s32f_index_topk_32u: finds the k strongest
+ * peaks by squared magnitude in one pass, with the same result as repeated
+ * volk_32fc_index_max_32u calls that mask out bins closer than
+ * \p min_separation to every found peak.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32fc_s32f_index_topk_32u(uint32_t* target, float* values, uint32_t*
+ * num_found, const lv_32fc_t* src0, const float threshold, uint32_t min_separation,
+ * uint32_t k, uint32_t num_points) \endcode
+ *
+ * \b Inputs
+ * \li src0: The complex input vector.
+ * \li threshold: Only squared magnitudes greater than this are reported.
+ * \li min_separation: Bins closer than this to an already found peak are
+ * skipped. 0 and 1 both only exclude the peak itself.
+ * \li k: The maximum number of peaks to find.
+ * \li num_points: The number of complex data points.
+ *
+ * \b Outputs
+ * \li target: The indices of the peaks, strongest first (k entries).
+ * \li values: The squared magnitudes at those indices (k entries).
+ * \li num_found: The number of peaks found, at most k.
+ *
+ * \b Example
+ * \code
+ *   int N = 4096;
+ *   uint32_t alignment = volk_get_alignment();
+ *   lv_32fc_t* bins = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t)*N, alignment);
+ *   uint32_t idx[8];
+ *   float mag2[8];
+ *   uint32_t found;
+ *
+ *   // fill bins with an FFT output
+ *
+ *   volk_32fc_s32f_index_topk_32u(idx, mag2, &found, bins, 1e-6f, 2, 8, N);
+ *
+ *   volk_free(bins);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32fc_s32f_index_topk_32u_a_H
+#define INCLUDED_volk_32fc_s32f_index_topk_32u_a_H
+
+#include <inttypes.h>
+#include <volk/volk_32f_s32f_index_topk_32u.h>
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+/*
+ * Fallback for very large k * min_separation: squared magnitudes are
+ * computed per pass instead of being stored.
+ */
+static inline void volk_32fc_index_topk_masked_search(uint32_t* target,
+                                                      float* values,
+                                                      uint32_t* num_found,
+                                                      const lv_32fc_t* src0,
+                                                      const float threshold,
+                                                      uint32_t min_separation,
+                                                      uint32_t k,
+                                                      uint32_t num_points)
+{
+    uint32_t found = 0;
+    uint32_t i, j;
+
+    while (found < k) {
+        uint32_t best = num_points;
+        float bestValue = threshold;
+        for (i = 0; i < num_points; i++) {
+            const float mag2 =
+                lv_creal(src0[i]) * lv_creal(src0[i]) + lv_cimag(src0[i]) * lv_cimag(src0[i]);
+            if (!(mag2 > bestValue))
+                continue;
+            int blocked = 0;
+            for (j = 0; j < found; j++) {
+                const uint32_t d = i > target[j] ? i - target[j] : target[j] - i;
+                if (d < min_separation || d == 0) {
+                    blocked = 1;
+                    break;
+                }
+            }
+            if (!blocked) {
+                best = i;
+                bestValue = mag2;
+            }
+        }
+        if (best == num_points)
+            break;
+        target[found] = best;
+        values[found] = bestValue;
+        found++;
+    }
+
+    *num_found = found;
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_32fc_s32f_index_topk_32u_generic(uint32_t* target,
+                                                         float* values,
+                                                         uint32_t* num_found,
+                                                         const lv_32fc_t* src0,
+                                                         const float threshold,
+                                                         uint32_t min_separation,
+                                                         uint32_t k,
+                                                         uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_32fc_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    const float* inputPtr = (const float*)src0;
+    uint32_t number = 0;
+    for (; number < num_points; number++) {
+        const float mag2 = inputPtr[0] * inputPtr[0] + inputPtr[1] * inputPtr[1];
+        volk_index_topk_push(&heap, mag2, number);
+        inputPtr += 2;
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+#include <volk/volk_avx_intrinsics.h>
+
+static inline void volk_32fc_s32f_index_topk_32u_a_avx(uint32_t* target,
+                                                       float* values,
+                                                       uint32_t* num_found,
+                                                       const lv_32fc_t* src0,
+                                                       const float threshold,
+                                                       uint32_t min_separation,
+                                                       uint32_t k,
+                                                       uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_32fc_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    __VOLK_ATTR_ALIGNED(32) float mag2Buffer[8];
+    const float* inputPtr = (const float*)src0;
+    uint32_t number = 0;
+    uint32_t i;
+    const uint32_t eighthPoints = num_points / 8;
+
+    for (; number < eighthPoints; number++) {
+        const __m256 cplxValue1 = _mm256_load_ps(inputPtr);
+        const __m256 cplxValue2 = _mm256_load_ps(inputPtr + 8);
+        const __m256 mag2 = _mm256_magnitudesquared_ps(cplxValue1, cplxValue2);
+        const int hits = _mm256_movemask_ps(
+            _mm256_cmp_ps(mag2, _mm256_set1_ps(heap.bound), _CMP_GT_OQ));
+        if (hits) {
+            _mm256_store_ps(mag2Buffer, mag2);
+            for (i = 0; i < 8; i++) {
+                volk_index_topk_push(&heap, mag2Buffer[i], number * 8 + i);
+            }
+        }
+        inputPtr += 16;
+    }
+
+    number = eighthPoints * 8;
+    for (; number < num_points; number++) {
+        const float mag2 = inputPtr[0] * inputPtr[0] + inputPtr[1] * inputPtr[1];
+        volk_index_topk_push(&heap, mag2, number);
+        inputPtr += 2;
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_AVX*/
+
+#endif /*INCLUDED_volk_32fc_s32f_index_topk_32u_a_H*/
+
+
+#ifndef INCLUDED_volk_32fc_s32f_index_topk_32u_u_H
+#define INCLUDED_volk_32fc_s32f_index_topk_32u_u_H
+
+#include <inttypes.h>
+#include <volk/volk_32f_s32f_index_topk_32u.h>
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+#include <volk/volk_avx_intrinsics.h>
+
+static inline void volk_32fc_s32f_index_topk_32u_u_avx(uint32_t* target,
+                                                       float* values,
+                                                       uint32_t* num_found,
+                                                       const lv_32fc_t* src0,
+                                                       const float threshold,
+                                                       uint32_t min_separation,
+                                                       uint32_t k,
+                                                       uint32_t num_points)
+{
+    const uint32_t capacity = volk_index_topk_capacity(min_separation, k);
+    if (capacity == 0) {
+        volk_32fc_index_topk_masked_search(
+            target, values, num_found, src0, threshold, min_separation, k, num_points);
+        return;
+    }
+
+    volk_index_topk_heap_t heap;
+    volk_index_topk_init(&heap, capacity, threshold);
+
+    __VOLK_ATTR_ALIGNED(32) float mag2Buffer[8];
+    const float* inputPtr = (const float*)src0;
+    uint32_t number = 0;
+    uint32_t i;
+    const uint32_t eighthPoints = num_points / 8;
+
+    for (; number < eighthPoints; number++) {
+        const __m256 cplxValue1 = _mm256_loadu_ps(inputPtr);
+        const __m256 cplxValue2 = _mm256_loadu_ps(inputPtr + 8);
+        const __m256 mag2 = _mm256_magnitudesquared_ps(cplxValue1, cplxValue2);
+        const int hits = _mm256_movemask_ps(
+            _mm256_cmp_ps(mag2, _mm256_set1_ps(heap.bound), _CMP_GT_OQ));
+        if (hits) {
+            _mm256_store_ps(mag2Buffer, mag2);
+            for (i = 0; i < 8; i++) {
+                volk_index_topk_push(&heap, mag2Buffer[i], number * 8 + i);
+            }
+        }
+        inputPtr += 16;
+    }
+
+    number = eighthPoints * 8;
+    for (; number < num_points; number++) {
+        const float mag2 = inputPtr[0] * inputPtr[0] + inputPtr[1] * inputPtr[1];
+        volk_index_topk_push(&heap, mag2, number);
+        inputPtr += 2;
+    }
+
+    volk_index_topk_select(&heap, target, values, num_found, min_separation, k);
+}
+
+#endif /*LV_HAVE_AVX*/
+
+#endif /*INCLUDED_volk_32fc_s32f_index_topk_32u_u_H*/
@@ -0,0 +1,495 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32fc_s32f_x2_fm_demod_32f
+ *
+ * \b Overview
+ *
+ * Fused FM receiver back end. For every input sample the phase difference
+ * to the previous sample is computed as arg(x[n] * conj(x[n-1])), scaled by
+ * 1 / normalizeFactor, passed through a one-pole de-emphasis filter
+ *
+ *   y[n] = y[n-1] + alpha * (phase[n] - y[n-1])
+ *
+ * and then decimated by averaging every \p decimation consecutive values of
+ * y (integrate and dump). This replaces the chain
+ * volk_32fc_s32f_atan2_32f -> volk_32f_s32f_32f_fm_detect_32f -> scalar IIR
+ * -> decimator with a single pass over the input.
+ *
+ * num_points must be a multiple of \p decimation. Only the previous sample
+ * and the de-emphasis state carry over between calls, not the decimation
+ * phase, so a partial group at the end of a call is lost.
+ *
+ * The SIMD implementations use the same arctan polynomial as
+ * volk_32fc_s32f_atan2_32f (maximum relative error ~6.6e-7) and evaluate the
+ * de-emphasis eight samples at a time in closed form, so the output matches
+ * the chain built from the dispatched kernels to within float rounding.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32fc_s32f_x2_fm_demod_32f(float* outputVector, const lv_32fc_t*
+ * inputVector, const float normalizeFactor, const float alpha, lv_32fc_t* lastSample,
+ * float* deemphState, unsigned int decimation, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li inputVector: The complex baseband input samples.
+ * \li normalizeFactor: The phase differences are divided by this factor, as in
+ * volk_32fc_s32f_atan2_32f. Use fs / (2 * pi * deviation) for unit output at full
+ * deviation.
+ * \li alpha: De-emphasis coefficient, 1 - exp(-1 / (fs * tau)). 1.0 disables
+ * de-emphasis.
+ * \li lastSample: The sample preceding inputVector[0]; updated to the last input
+ * sample on return.
+ * \li deemphState: The de-emphasis filter state y[n-1]; updated on return.
+ * \li decimation: Integer decimation factor (>= 1).
+ * \li num_points: The number of complex input samples. Must be a multiple of
+ * \p decimation.
+ *
+ * \b Outputs
+ * \li outputVector: num_points / decimation demodulated samples.
+ *
+ * \b Example
+ * Demodulate a 240 kS/s channel to 48 kS/s audio with 75 us de-emphasis.
+ * \code
+ *   unsigned int N = 2400;
+ *   unsigned int decim = 5;
+ *   unsigned int alignment = volk_get_alignment();
+ *   lv_32fc_t* in = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ *   float* audio = (float*)volk_malloc(sizeof(float) * N / decim, alignment);
+ *   lv_32fc_t last = lv_cmake(1.f, 0.f);
+ *   float deemph = 0.f;
+ *   const float fs = 240e3f;
+ *   const float alpha = 1.f - expf(-1.f / (fs * 75e-6f));
+ *   const float norm = fs / (2.f * 3.14159265f * 75e3f);
+ *
+ *   // fill in with baseband samples
+ *
+ *   volk_32fc_s32f_x2_fm_demod_32f(audio, in, norm, alpha, &last, &deemph, decim, N);
+ *
+ *   volk_free(in);
+ *   volk_free(audio);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32fc_s32f_x2_fm_demod_32f_a_H
+#define INCLUDED_volk_32fc_s32f_x2_fm_demod_32f_a_H
+
+#include <math.h>
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+/*
+ * Sample-by-sample de-emphasis and integrate-and-dump, used by the generic
+ * implementations and for the tails of the SIMD ones. The decimation phase
+ * is only carried within one call, which is why num_points has to be a
+ * multiple of decimation.
+ */
+static inline void volk_32fc_s32f_x2_fm_demod_32f_post(float** outPtr,
+                                                       const float* phase,
+                                                       unsigned int num_phases,
+                                                       const float alpha,
+                                                       float* y,
+                                                       float* acc,
+                                                       unsigned int* count,
+                                                       unsigned int decimation)
+{
+    const float invDecimation = 1.f / (float)decimation;
+    float yy = *y;
+    float aa = *acc;
+    unsigned int cc = *count;
+    unsigned int i;
+
+    for (i = 0; i < num_phases; i++) {
+        yy += alpha * (phase[i] - yy);
+        aa += yy;
+        if (++cc == decimation) {
+            *(*outPtr)++ = aa * invDecimation;
+            aa = 0.f;
+            cc = 0;
+        }
+    }
+
+    *y = yy;
+    *acc = aa;
+    *count = cc;
+}
+
+/*
+ * Integrate-and-dump on already de-emphasized values, used after the
+ * block-recursive de-emphasis of the SIMD implementations.
+ */
+static inline void volk_32fc_s32f_x2_fm_demod_32f_dump(float** outPtr,
+                                                       const float* y,
+                                                       unsigned int num_values,
+                                                       float* acc,
+                                                       unsigned int* count,
+                                                       unsigned int decimation)
+{
+    const float invDecimation = 1.f / (float)decimation;
+    float aa = *acc;
+    unsigned int cc = *count;
+    unsigned int i;
+
+    while (num_values > 0) {
+        unsigned int n = decimation - cc;
+        n = n < num_values ? n : num_values;
+        // two partial sums halve the add latency chain for longer groups
+        float a0 = 0.f, a1 = 0.f;
+        for (i = 0; i + 1 < n; i += 2) {
+            a0 += y[i];
+            a1 += y[i + 1];
+        }
+        if (i < n) {
+            a0 += y[i];
+        }
+        aa += a0 + a1;
+        y += n;
+        num_values -= n;
+        cc += n;
+        if (cc == decimation) {
+            *(*outPtr)++ = aa * invDecimation;
+            aa = 0.f;
+            cc = 0;
+        }
+    }
+
+    *acc = aa;
+    *count = cc;
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_32fc_s32f_x2_fm_demod_32f_generic(float* outputVector,
+                                                          const lv_32fc_t* inputVector,
+                                                          const float normalizeFactor,
+                                                          const float alpha,
+                                                          lv_32fc_t* lastSample,
+                                                          float* deemphState,
+                                                          unsigned int decimation,
+                                                          unsigned int num_points)
+{
+    const float invNormalizeFactor = 1.f / normalizeFactor;
+    float* outPtr = outputVector;
+    lv_32fc_t prev = *lastSample;
+    float acc = 0.f;
+    unsigned int count = 0;
+    unsigned int number;
+
+    for (number = 0; number < num_points; number++) {
+        const lv_32fc_t d = inputVector[number] * lv_conj(prev);
+        const float phase = atan2f(lv_cimag(d), lv_creal(d)) * invNormalizeFactor;
+        prev = inputVector[number];
+        volk_32fc_s32f_x2_fm_demod_32f_post(
+            &outPtr, &phase, 1, alpha, deemphState, &acc, &count, decimation);
+    }
+
+    *lastSample = prev;
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void
+volk_32fc_s32f_x2_fm_demod_32f_polynomial(float* outputVector,
+                                          const lv_32fc_t* inputVector,
+                                          const float normalizeFactor,
+                                          const float alpha,
+                                          lv_32fc_t* lastSample,
+                                          float* deemphState,
+                                          unsigned int decimation,
+                                          unsigned int num_points)
+{
+    const float invNormalizeFactor = 1.f / normalizeFactor;
+    float* outPtr = outputVector;
+    lv_32fc_t prev = *lastSample;
+    float acc = 0.f;
+    unsigned int count = 0;
+    unsigned int number;
+
+    for (number = 0; number < num_points; number++) {
+        const lv_32fc_t d = inputVector[number] * lv_conj(prev);
+        const float phase = volk_atan2(lv_cimag(d), lv_creal(d)) * invNormalizeFactor;
+        prev = inputVector[number];
+        volk_32fc_s32f_x2_fm_demod_32f_post(
+            &outPtr, &phase, 1, alpha, deemphState, &acc, &count, decimation);
+    }
+
+    *lastSample = prev;
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#if LV_HAVE_AVX2 && LV_HAVE_FMA
+#include <immintrin.h>
+#include <volk/volk_avx2_fma_intrinsics.h>
+#include <volk/volk_avx2_intrinsics.h>
+
+static inline void volk_32fc_s32f_x2_fm_demod_32f_a_avx2_fma(float* outputVector,
+                                                             const lv_32fc_t* inputVector,
+                                                             const float normalizeFactor,
+                                                             const float alpha,
+                                                             lv_32fc_t* lastSample,
+                                                             float* deemphState,
+                                                             unsigned int decimation,
+                                                             unsigned int num_points)
+{
+    const float* in = (const float*)inputVector;
+    float* outPtr = outputVector;
+    __VOLK_ATTR_ALIGNED(32) float phase[8];
+    __VOLK_ATTR_ALIGNED(32) float ybuf[64];
+    unsigned int fill = 0;
+    float acc = 0.f;
+    unsigned int count = 0;
+
+    const float invNormalizeFactor = 1.f / normalizeFactor;
+    const __m256 vinvNormalizeFactor = _mm256_set1_ps(invNormalizeFactor);
+    const __m256 pi = _mm256_set1_ps(0x1.921fb6p1f);
+    const __m256 pi_2 = _mm256_set1_ps(0x1.921fb6p0f);
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    const __m256 zero = _mm256_setzero_ps();
+    // rotate the four complex values in a register up by one: c3,c0,c1,c2
+    const __m256i delay_mask = _mm256_setr_epi32(6, 7, 0, 1, 2, 3, 4, 5);
+    const __m256i last_mask = _mm256_set1_epi32(7);
+
+    // low complex holds the sample preceding the next block
+    __m256 carry = _mm256_castpd_ps(_mm256_broadcast_sd((const double*)lastSample));
+
+    // y[k] = (1-alpha)^(k+1) * y[-1] + sum_{j<=k} alpha * (1-alpha)^(k-j) * phase[j]
+    __VOLK_ATTR_ALIGNED(32) float decay[8];
+    __m256 taps[8];
+    unsigned int j, k;
+    decay[0] = 1.f - alpha;
+    for (k = 1; k < 8; k++) {
+        decay[k] = decay[k - 1] * (1.f - alpha);
+    }
+    for (j = 0; j < 8; j++) {
+        for (k = 0; k < 8; k++) {
+            phase[k] = k < j ? 0.f : (k == j ? alpha : alpha * decay[k - j - 1]);
+        }
+        taps[j] = _mm256_load_ps(phase);
+    }
+    const __m256 vdecay = _mm256_load_ps(decay);
+    __m256 yprev = _mm256_set1_ps(*deemphState);
+
+    unsigned int number = 0;
+    const unsigned int eighth_points = num_points / 8;
+    for (; number < eighth_points; number++) {
+        const __m256 z1 = _mm256_load_ps(in);
+        const __m256 z2 = _mm256_load_ps(in + 8);
+        in += 16;
+
+        const __m256 r1 = _mm256_permutevar8x32_ps(z1, delay_mask);
+        const __m256 r2 = _mm256_permutevar8x32_ps(z2, delay_mask);
+        const __m256 p1 = _mm256_blend_ps(r1, carry, 0x03);
+        const __m256 p2 = _mm256_blend_ps(r2, r1, 0x03);
+        carry = r2;
+
+        const __m256 d1 = _mm256_complexconjugatemul_ps(z1, p1);
+        const __m256 d2 = _mm256_complexconjugatemul_ps(z2, p2);
+        const __m256 x = _mm256_real(d1, d2);
+        const __m256 y = _mm256_imag(d1, d2);
+
+        const __m256 swap_mask = _mm256_cmp_ps(
+            _mm256_and_ps(y, abs_mask), _mm256_and_ps(x, abs_mask), _CMP_GT_OS);
+        __m256 input = _mm256_div_ps(_mm256_blendv_ps(y, x, swap_mask),
+                                     _mm256_blendv_ps(x, y, swap_mask));
+        const __m256 nan_mask = _mm256_cmp_ps(input, input, _CMP_UNORD_Q);
+        input = _mm256_blendv_ps(input, zero, nan_mask);
+        __m256 result = _m256_arctan_poly_avx2_fma(input);
+
+        input =
+            _mm256_sub_ps(_mm256_or_ps(pi_2, _mm256_and_ps(input, sign_mask)), result);
+        result = _mm256_blendv_ps(result, input, swap_mask);
+
+        const __m256 x_sign_mask =
+            _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(x), 31));
+
+        result = _mm256_add_ps(
+            _mm256_and_ps(_mm256_xor_ps(pi, _mm256_and_ps(sign_mask, y)), x_sign_mask),
+            result);
+        result = _mm256_mul_ps(result, vinvNormalizeFactor);
+
+        // broadcast through memory to keep the shuffle port free, and use two
+        // independent chains to keep the recursion off the critical path
+        _mm256_store_ps(phase, result);
+        __m256 s0 = _mm256_mul_ps(taps[0], _mm256_broadcast_ss(phase));
+        __m256 s1 = _mm256_mul_ps(taps[1], _mm256_broadcast_ss(phase + 1));
+        for (j = 2; j < 8; j += 2) {
+            s0 = _mm256_fmadd_ps(taps[j], _mm256_broadcast_ss(phase + j), s0);
+            s1 = _mm256_fmadd_ps(taps[j + 1], _mm256_broadcast_ss(phase + j + 1), s1);
+        }
+        const __m256 yv = _mm256_fmadd_ps(vdecay, yprev, _mm256_add_ps(s0, s1));
+        yprev = _mm256_permutevar8x32_ps(yv, last_mask);
+        _mm256_store_ps(ybuf + fill, yv);
+        fill += 8;
+
+        if (fill == 64) {
+            volk_32fc_s32f_x2_fm_demod_32f_dump(
+                &outPtr, ybuf, fill, &acc, &count, decimation);
+            fill = 0;
+        }
+    }
+
+    volk_32fc_s32f_x2_fm_demod_32f_dump(&outPtr, ybuf, fill, &acc, &count, decimation);
+    if (eighth_points > 0) {
+        *deemphState = _mm256_cvtss_f32(yprev);
+    }
+
+    lv_32fc_t prev = number > 0 ? inputVector[number * 8 - 1] : *lastSample;
+    for (number = eighth_points * 8; number < num_points; number++) {
+        const lv_32fc_t d = inputVector[number] * lv_conj(prev);
+        phase[0] = volk_atan2(lv_cimag(d), lv_creal(d)) * invNormalizeFactor;
+        prev = inputVector[number];
+        volk_32fc_s32f_x2_fm_demod_32f_post(
+            &outPtr, phase, 1, alpha, deemphState, &acc, &count, decimation);
+    }
+
+    *lastSample = prev;
+}
+
+#endif /* LV_HAVE_AVX2 && LV_HAVE_FMA for aligned */
+
+#endif /* INCLUDED_volk_32fc_s32f_x2_fm_demod_32f_a_H */
+
+#ifndef INCLUDED_volk_32fc_s32f_x2_fm_demod_32f_u_H
+#define INCLUDED_volk_32fc_s32f_x2_fm_demod_32f_u_H
+
+#if LV_HAVE_AVX2 && LV_HAVE_FMA
+#include <immintrin.h>
+#include <volk/volk_avx2_fma_intrinsics.h>
+#include <volk/volk_avx2_intrinsics.h>
+
+static inline void volk_32fc_s32f_x2_fm_demod_32f_u_avx2_fma(float* outputVector,
+                                                             const lv_32fc_t* inputVector,
+                                                             const float normalizeFactor,
+                                                             const float alpha,
+                                                             lv_32fc_t* lastSample,
+                                                             float* deemphState,
+                                                             unsigned int decimation,
+                                                             unsigned int num_points)
+{
+    const float* in = (const float*)inputVector;
+    float* outPtr = outputVector;
+    __VOLK_ATTR_ALIGNED(32) float phase[8];
+    __VOLK_ATTR_ALIGNED(32) float ybuf[64];
+    unsigned int fill = 0;
+    float acc = 0.f;
+    unsigned int count = 0;
+
+    const float invNormalizeFactor = 1.f / normalizeFactor;
+    const __m256 vinvNormalizeFactor = _mm256_set1_ps(invNormalizeFactor);
+    const __m256 pi = _mm256_set1_ps(0x1.921fb6p1f);
+    const __m256 pi_2 = _mm256_set1_ps(0x1.921fb6p0f);
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i delay_mask = _mm256_setr_epi32(6, 7, 0, 1, 2, 3, 4, 5);
+    const __m256i last_mask = _mm256_set1_epi32(7);
+
+    __m256 carry = _mm256_castpd_ps(_mm256_broadcast_sd((const double*)lastSample));
+
+    // y[k] = (1-alpha)^(k+1) * y[-1] + sum_{j<=k} alpha * (1-alpha)^(k-j) * phase[j]
+    __VOLK_ATTR_ALIGNED(32) float decay[8];
+    __m256 taps[8];
+    unsigned int j, k;
+    decay[0] = 1.f - alpha;
+    for (k = 1; k < 8; k++) {
+        decay[k] = decay[k - 1] * (1.f - alpha);
+    }
+    for (j = 0; j < 8; j++) {
+        for (k = 0; k < 8; k++) {
+            phase[k] = k < j ? 0.f : (k == j ? alpha : alpha * decay[k - j - 1]);
+        }
+        taps[j] = _mm256_load_ps(phase);
+    }
+    const __m256 vdecay = _mm256_load_ps(decay);
+    __m256 yprev = _mm256_set1_ps(*deemphState);
+
+    unsigned int number = 0;
+    const unsigned int eighth_points = num_points / 8;
+    for (; number < eighth_points; number++) {
+        const __m256 z1 = _mm256_loadu_ps(in);
+        const __m256 z2 = _mm256_loadu_ps(in + 8);
+        in += 16;
+
+        const __m256 r1 = _mm256_permutevar8x32_ps(z1, delay_mask);
+        const __m256 r2 = _mm256_permutevar8x32_ps(z2, delay_mask);
+        const __m256 p1 = _mm256_blend_ps(r1, carry, 0x03);
+        const __m256 p2 = _mm256_blend_ps(r2, r1, 0x03);
+        carry = r2;
+
+        const __m256 d1 = _mm256_complexconjugatemul_ps(z1, p1);
+        const __m256 d2 = _mm256_complexconjugatemul_ps(z2, p2);
+        const __m256 x = _mm256_real(d1, d2);
+        const __m256 y = _mm256_imag(d1, d2);
+
+        const __m256 swap_mask = _mm256_cmp_ps(
+            _mm256_and_ps(y, abs_mask), _mm256_and_ps(x, abs_mask), _CMP_GT_OS);
+        __m256 input = _mm256_div_ps(_mm256_blendv_ps(y, x, swap_mask),
+                                     _mm256_blendv_ps(x, y, swap_mask));
+        const __m256 nan_mask = _mm256_cmp_ps(input, input, _CMP_UNORD_Q);
+        input = _mm256_blendv_ps(input, zero, nan_mask);
+        __m256 result = _m256_arctan_poly_avx2_fma(input);
+
+        input =
+            _mm256_sub_ps(_mm256_or_ps(pi_2, _mm256_and_ps(input, sign_mask)), result);
+        result = _mm256_blendv_ps(result, input, swap_mask);
+
+        const __m256 x_sign_mask =
+            _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(x), 31));
+
+        result = _mm256_add_ps(
+            _mm256_and_ps(_mm256_xor_ps(pi, _mm256_and_ps(sign_mask, y)), x_sign_mask),
+            result);
+        result = _mm256_mul_ps(result, vinvNormalizeFactor);
+
+        // broadcast through memory to keep the shuffle port free, and use two
+        // independent chains to keep the recursion off the critical path
+        _mm256_store_ps(phase, result);
+        __m256 s0 = _mm256_mul_ps(taps[0], _mm256_broadcast_ss(phase));
+        __m256 s1 = _mm256_mul_ps(taps[1], _mm256_broadcast_ss(phase + 1));
+        for (j = 2; j < 8; j += 2) {
+            s0 = _mm256_fmadd_ps(taps[j], _mm256_broadcast_ss(phase + j), s0);
+            s1 = _mm256_fmadd_ps(taps[j + 1], _mm256_broadcast_ss(phase + j + 1), s1);
+        }
+        const __m256 yv = _mm256_fmadd_ps(vdecay, yprev, _mm256_add_ps(s0, s1));
+        yprev = _mm256_permutevar8x32_ps(yv, last_mask);
+        _mm256_store_ps(ybuf + fill, yv);
+        fill += 8;
+
+        if (fill == 64) {
+            volk_32fc_s32f_x2_fm_demod_32f_dump(
+                &outPtr, ybuf, fill, &acc, &count, decimation);
+            fill = 0;
+        }
+    }
+
+    volk_32fc_s32f_x2_fm_demod_32f_dump(&outPtr, ybuf, fill, &acc, &count, decimation);
+    if (eighth_points > 0) {
+        *deemphState = _mm256_cvtss_f32(yprev);
+    }
+
+    lv_32fc_t prev = number > 0 ? inputVector[number * 8 - 1] : *lastSample;
+    for (number = eighth_points * 8; number < num_points; number++) {
+        const lv_32fc_t d = inputVector[number] * lv_conj(prev);
+        phase[0] = volk_atan2(lv_cimag(d), lv_creal(d)) * invNormalizeFactor;
+        prev = inputVector[number];
+        volk_32fc_s32f_x2_fm_demod_32f_post(
+            &outPtr, phase, 1, alpha, deemphState, &acc, &count, decimation);
+    }
+
+    *lastSample = prev;
+}
+
+#endif /* LV_HAVE_AVX2 && LV_HAVE_FMA for unaligned */
+
+#endif /* INCLUDED_volk_32fc_s32f_x2_fm_demod_32f_u_H */
@@ -0,0 +1,562 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32fc_s32f_x2_max_log_llr_32f
+ *
+ * \b Overview
+ *
+ * Computes the max-log log likelihood ratios of the bits of Gray coded
+ * BPSK, QPSK and square QAM symbols:
+ *
+ * llr = (min |y - s0|^2 - min |y - s1|^2) / noiseVariance
+ *
+ * where s0 and s1 range over the constellation points whose bit is 0 and 1.
+ * A positive LLR favours 1, so volk_32f_binary_slicer_8i of the output
+ * gives the hard decisions.
+ *
+ * Square QAM with Gray labels is two Gray coded PAM constellations, one on
+ * each axis. For PAM with levels at the odd multiples of amplitude, the
+ * distance to the nearest level boundary of bit k is |u_k|, where
+ *
+ * u_0 = y / amplitude, u_k = |u_(k-1)| - 2^(m-k)
+ *
+ * for m bits per axis. The nearest level with the other value of bit k lies
+ * just across that boundary, and the nearest level overall is at
+ * e = ||u_(m-1)| - 1|. This gives the exact max-log LLR of each bit in
+ * O(log M) operations per symbol, instead of a distance to each of the M
+ * points.
+ *
+ * The bits of a symbol follow 3GPP TS 38.211: bit 2k comes from the in
+ * phase axis and bit 2k+1 from the quadrature axis. Bits 0 and 1 are 0 for
+ * a positive coordinate, and each following bit is 0 on the inner half of
+ * the previous one. With bitsPerSymbol = 1, BPSK is on the real axis, 0 for
+ * a positive value, with one LLR per symbol.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32fc_s32f_x2_max_log_llr_32f(float* llrVector, const lv_32fc_t* symbols,
+ * const float amplitude, const float noiseVariance, unsigned int bitsPerSymbol,
+ * unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li symbols: The equalized received symbols.
+ * \li amplitude: Half the spacing between adjacent levels on an axis, for
+ * example 1/sqrt(2) for unit energy QPSK, 1/sqrt(10) for 16-QAM and
+ * sqrt(3 / (2 * (M - 1))) for M-QAM.
+ * \li noiseVariance: The complex noise variance E|n|^2.
+ * \li bitsPerSymbol: 1 for BPSK, or an even number of bits for square QAM
+ * (2, 4, 6, 8 for QPSK to 256-QAM).
+ * \li num_points: The number of symbols.
+ *
+ * \b Outputs
+ * \li llrVector: bitsPerSymbol * num_points LLRs.
+ *
+ * \b Example
+ * Soft and hard decisions for 64-QAM.
+ * \code
+ *   int N = 1024;
+ *   unsigned int alignment = volk_get_alignment();
+ *   lv_32fc_t* symbols = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ *   float* llr = (float*)volk_malloc(sizeof(float) * 6 * N, alignment);
+ *   int8_t* bits = (int8_t*)volk_malloc(6 * N, alignment);
+ *
+ *   // fill symbols with equalized 64-QAM symbols of unit mean energy
+ *
+ *   volk_32fc_s32f_x2_max_log_llr_32f(llr, symbols, sqrtf(3.0f / 126.0f), 0.01f, 6, N);
+ *   volk_32f_binary_slicer_8i(bits, llr, 6 * N);
+ *
+ *   volk_free(symbols);
+ *   volk_free(llr);
+ *   volk_free(bits);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32fc_s32f_x2_max_log_llr_32f_a_H
+#define INCLUDED_volk_32fc_s32f_x2_max_log_llr_32f_a_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_32fc_s32f_x2_max_log_llr_32f_generic(float* llrVector,
+                                                             const lv_32fc_t* symbols,
+                                                             const float amplitude,
+                                                             const float noiseVariance,
+                                                             unsigned int bitsPerSymbol,
+                                                             unsigned int num_points)
+{
+    const float* symbolPtr = (const float*)symbols;
+    const float invAmplitude = 1.0f / amplitude;
+    const float scale = amplitude * amplitude / noiseVariance;
+    unsigned int number, k, d;
+
+    if (bitsPerSymbol == 1) {
+        // e = ||y| - 1|, so the LLR is linear: ((|y| + 1)^2 - e^2) = 4|y|
+        for (number = 0; number < num_points; number++) {
+            *llrVector++ = -4.0f * scale * invAmplitude * symbolPtr[0];
+            symbolPtr += 2;
+        }
+        return;
+    }
+
+    const unsigned int bitsPerAxis = bitsPerSymbol / 2;
+    for (number = 0; number < num_points; number++) {
+        for (d = 0; d < 2; d++) {
+            const float y = symbolPtr[d] * invAmplitude;
+
+            float u = y;
+            for (k = 1; k < bitsPerAxis; k++)
+                u = fabsf(u) - (float)(1u << (bitsPerAxis - k));
+            const float e = fabsf(fabsf(u) - 1.0f);
+
+            u = y;
+            for (k = 0; k < bitsPerAxis; k++) {
+                if (k > 0)
+                    u = fabsf(u) - (float)(1u << (bitsPerAxis - k));
+                const float a = fabsf(u) + 1.0f;
+                const float mag = (a * a - e * e) * scale;
+                llrVector[2 * k + d] = copysignf(mag, k == 0 ? -u : u);
+            }
+        }
+        symbolPtr += 2;
+        llrVector += bitsPerSymbol;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32fc_s32f_x2_max_log_llr_32f_a_avx(float* llrVector,
+                                                           const lv_32fc_t* symbols,
+                                                           const float amplitude,
+                                                           const float noiseVariance,
+                                                           unsigned int bitsPerSymbol,
+                                                           unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+
+    const float* symbolPtr = (const float*)symbols;
+    float* llrPtr = llrVector;
+
+    const float invAmplitude = 1.0f / amplitude;
+    const float scale = amplitude * amplitude / noiseVariance;
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    unsigned int k;
+
+    if (bitsPerSymbol == 1) {
+        const unsigned int eighthPoints = num_points / 8;
+        const __m256 gain = _mm256_set1_ps(-4.0f * scale * invAmplitude);
+        __m256 x0, x1, re;
+        for (; number < eighthPoints; number++) {
+            x0 = _mm256_load_ps(symbolPtr);
+            x1 = _mm256_load_ps(symbolPtr + 8);
+            re = _mm256_shuffle_ps(_mm256_permute2f128_ps(x0, x1, 0x20),
+                                   _mm256_permute2f128_ps(x0, x1, 0x31),
+                                   _MM_SHUFFLE(2, 0, 2, 0));
+            _mm256_storeu_ps(llrPtr, _mm256_mul_ps(re, gain));
+            symbolPtr += 16;
+            llrPtr += 8;
+        }
+        number = eighthPoints * 8;
+    } else {
+        const unsigned int bitsPerAxis = bitsPerSymbol / 2;
+        const __m256 invAmp = _mm256_set1_ps(invAmplitude);
+        const __m256 posScale = _mm256_set1_ps(scale);
+        const __m256 negScale = _mm256_set1_ps(-scale);
+        __m256 y, u, e2, a, llr;
+        __m128 lo, hi;
+
+        for (; number < quarterPoints; number++) {
+            // I0 Q0 I1 Q1 I2 Q2 I3 Q3, both axes fold the same way
+            y = _mm256_mul_ps(_mm256_load_ps(symbolPtr), invAmp);
+
+            u = y;
+            for (k = 1; k < bitsPerAxis; k++)
+                u = _mm256_sub_ps(_mm256_andnot_ps(signMask, u),
+                                  _mm256_set1_ps((float)(1u << (bitsPerAxis - k))));
+            e2 = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_andnot_ps(signMask, u), one));
+            e2 = _mm256_mul_ps(e2, e2);
+
+            u = y;
+            for (k = 0; k < bitsPerAxis; k++) {
+                if (k > 0)
+                    u = _mm256_sub_ps(_mm256_andnot_ps(signMask, u),
+                                      _mm256_set1_ps((float)(1u << (bitsPerAxis - k))));
+                a = _mm256_add_ps(_mm256_andnot_ps(signMask, u), one);
+                llr = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(a, a), e2),
+                                    k == 0 ? negScale : posScale);
+                llr = _mm256_xor_ps(llr, _mm256_and_ps(u, signMask));
+
+                lo = _mm256_castps256_ps128(llr);
+                hi = _mm256_extractf128_ps(llr, 1);
+                _mm_storel_pi((__m64*)(llrPtr + 2 * k), lo);
+                _mm_storeh_pi((__m64*)(llrPtr + bitsPerSymbol + 2 * k), lo);
+                _mm_storel_pi((__m64*)(llrPtr + 2 * bitsPerSymbol + 2 * k), hi);
+                _mm_storeh_pi((__m64*)(llrPtr + 3 * bitsPerSymbol + 2 * k), hi);
+            }
+            symbolPtr += 8;
+            llrPtr += 4 * bitsPerSymbol;
+        }
+        number = quarterPoints * 4;
+    }
+
+    volk_32fc_s32f_x2_max_log_llr_32f_generic(llrPtr,
+                                              (const lv_32fc_t*)symbolPtr,
+                                              amplitude,
+                                              noiseVariance,
+                                              bitsPerSymbol,
+                                              num_points - number);
+}
+
+#endif /* LV_HAVE_AVX */
+
+#ifdef LV_HAVE_SSE
+#include <xmmintrin.h>
+
+static inline void volk_32fc_s32f_x2_max_log_llr_32f_a_sse(float* llrVector,
+                                                           const lv_32fc_t* symbols,
+                                                           const float amplitude,
+                                                           const float noiseVariance,
+                                                           unsigned int bitsPerSymbol,
+                                                           unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int halfPoints = num_points / 2;
+
+    const float* symbolPtr = (const float*)symbols;
+    float* llrPtr = llrVector;
+
+    const float invAmplitude = 1.0f / amplitude;
+    const float scale = amplitude * amplitude / noiseVariance;
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    unsigned int k;
+
+    if (bitsPerSymbol == 1) {
+        const unsigned int quarterPoints = num_points / 4;
+        const __m128 gain = _mm_set1_ps(-4.0f * scale * invAmplitude);
+        __m128 re;
+        for (; number < quarterPoints; number++) {
+            re = _mm_shuffle_ps(
+                _mm_load_ps(symbolPtr), _mm_load_ps(symbolPtr + 4), _MM_SHUFFLE(2, 0, 2, 0));
+            _mm_storeu_ps(llrPtr, _mm_mul_ps(re, gain));
+            symbolPtr += 8;
+            llrPtr += 4;
+        }
+        number = quarterPoints * 4;
+    } else {
+        const unsigned int bitsPerAxis = bitsPerSymbol / 2;
+        const __m128 invAmp = _mm_set1_ps(invAmplitude);
+        const __m128 posScale = _mm_set1_ps(scale);
+        const __m128 negScale = _mm_set1_ps(-scale);
+        __m128 y, u, e2, a, llr;
+
+        for (; number < halfPoints; number++) {
+            // I0 Q0 I1 Q1, both axes fold the same way
+            y = _mm_mul_ps(_mm_load_ps(symbolPtr), invAmp);
+
+            u = y;
+            for (k = 1; k < bitsPerAxis; k++)
+                u = _mm_sub_ps(_mm_andnot_ps(signMask, u),
+                               _mm_set1_ps((float)(1u << (bitsPerAxis - k))));
+            e2 = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_andnot_ps(signMask, u), one));
+            e2 = _mm_mul_ps(e2, e2);
+
+            u = y;
+            for (k = 0; k < bitsPerAxis; k++) {
+                if (k > 0)
+                    u = _mm_sub_ps(_mm_andnot_ps(signMask, u),
+                                   _mm_set1_ps((float)(1u << (bitsPerAxis - k))));
+                a = _mm_add_ps(_mm_andnot_ps(signMask, u), one);
+                llr = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(a, a), e2),
+                                 k == 0 ? negScale : posScale);
+                llr = _mm_xor_ps(llr, _mm_and_ps(u, signMask));
+
+                _mm_storel_pi((__m64*)(llrPtr + 2 * k), llr);
+                _mm_storeh_pi((__m64*)(llrPtr + bitsPerSymbol + 2 * k), llr);
+            }
+            symbolPtr += 4;
+            llrPtr += 2 * bitsPerSymbol;
+        }
+        number = halfPoints * 2;
+    }
+
+    volk_32fc_s32f_x2_max_log_llr_32f_generic(llrPtr,
+                                              (const lv_32fc_t*)symbolPtr,
+                                              amplitude,
+                                              noiseVariance,
+                                              bitsPerSymbol,
+                                              num_points - number);
+}
+
+#endif /* LV_HAVE_SSE */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_32fc_s32f_x2_max_log_llr_32f_neon(float* llrVector,
+                                                          const lv_32fc_t* symbols,
+                                                          const float amplitude,
+                                                          const float noiseVariance,
+                                                          unsigned int bitsPerSymbol,
+                                                          unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int halfPoints = num_points / 2;
+
+    const float* symbolPtr = (const float*)symbols;
+    float* llrPtr = llrVector;
+
+    const float invAmplitude = 1.0f / amplitude;
+    const float scale = amplitude * amplitude / noiseVariance;
+    const uint32x4_t signMask = vdupq_n_u32(0x80000000);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    unsigned int k;
+
+    if (bitsPerSymbol == 1) {
+        const unsigned int quarterPoints = num_points / 4;
+        const float gain = -4.0f * scale * invAmplitude;
+        for (; number < quarterPoints; number++) {
+            const float32x4x2_t x = vld2q_f32(symbolPtr);
+            vst1q_f32(llrPtr, vmulq_n_f32(x.val[0], gain));
+            symbolPtr += 8;
+            llrPtr += 4;
+        }
+        number = quarterPoints * 4;
+    } else {
+        const unsigned int bitsPerAxis = bitsPerSymbol / 2;
+        float32x4_t y, u, e, a, llr;
+
+        for (; number < halfPoints; number++) {
+            // I0 Q0 I1 Q1, both axes fold the same way
+            y = vmulq_n_f32(vld1q_f32(symbolPtr), invAmplitude);
+
+            u = y;
+            for (k = 1; k < bitsPerAxis; k++)
+                u = vsubq_f32(vabsq_f32(u), vdupq_n_f32((float)(1u << (bitsPerAxis - k))));
+            e = vabsq_f32(vsubq_f32(vabsq_f32(u), one));
+            e = vmulq_f32(e, e);
+
+            u = y;
+            for (k = 0; k < bitsPerAxis; k++) {
+                if (k > 0)
+                    u = vsubq_f32(vabsq_f32(u),
+                                  vdupq_n_f32((float)(1u << (bitsPerAxis - k))));
+                a = vaddq_f32(vabsq_f32(u), one);
+                llr = vmulq_n_f32(vsubq_f32(vmulq_f32(a, a), e), k == 0 ? -scale : scale);
+                llr = vreinterpretq_f32_u32(
+                    veorq_u32(vreinterpretq_u32_f32(llr),
+                              vandq_u32(vreinterpretq_u32_f32(u), signMask)));
+
+                vst1_f32(llrPtr + 2 * k, vget_low_f32(llr));
+                vst1_f32(llrPtr + bitsPerSymbol + 2 * k, vget_high_f32(llr));
+            }
+            symbolPtr += 4;
+            llrPtr += 2 * bitsPerSymbol;
+        }
+        number = halfPoints * 2;
+    }
+
+    volk_32fc_s32f_x2_max_log_llr_32f_generic(llrPtr,
+                                              (const lv_32fc_t*)symbolPtr,
+                                              amplitude,
+                                              noiseVariance,
+                                              bitsPerSymbol,
+                                              num_points - number);
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_32fc_s32f_x2_max_log_llr_32f_a_H */
+
+
+#ifndef INCLUDED_volk_32fc_s32f_x2_max_log_llr_32f_u_H
+#define INCLUDED_volk_32fc_s32f_x2_max_log_llr_32f_u_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32fc_s32f_x2_max_log_llr_32f_u_avx(float* llrVector,
+                                                           const lv_32fc_t* symbols,
+                                                           const float amplitude,
+                                                           const float noiseVariance,
+                                                           unsigned int bitsPerSymbol,
+                                                           unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+
+    const float* symbolPtr = (const float*)symbols;
+    float* llrPtr = llrVector;
+
+    const float invAmplitude = 1.0f / amplitude;
+    const float scale = amplitude * amplitude / noiseVariance;
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    unsigned int k;
+
+    if (bitsPerSymbol == 1) {
+        const unsigned int eighthPoints = num_points / 8;
+        const __m256 gain = _mm256_set1_ps(-4.0f * scale * invAmplitude);
+        __m256 x0, x1, re;
+        for (; number < eighthPoints; number++) {
+            x0 = _mm256_loadu_ps(symbolPtr);
+            x1 = _mm256_loadu_ps(symbolPtr + 8);
+            re = _mm256_shuffle_ps(_mm256_permute2f128_ps(x0, x1, 0x20),
+                                   _mm256_permute2f128_ps(x0, x1, 0x31),
+                                   _MM_SHUFFLE(2, 0, 2, 0));
+            _mm256_storeu_ps(llrPtr, _mm256_mul_ps(re, gain));
+            symbolPtr += 16;
+            llrPtr += 8;
+        }
+        number = eighthPoints * 8;
+    } else {
+        const unsigned int bitsPerAxis = bitsPerSymbol / 2;
+        const __m256 invAmp = _mm256_set1_ps(invAmplitude);
+        const __m256 posScale = _mm256_set1_ps(scale);
+        const __m256 negScale = _mm256_set1_ps(-scale);
+        __m256 y, u, e2, a, llr;
+        __m128 lo, hi;
+
+        for (; number < quarterPoints; number++) {
+            y = _mm256_mul_ps(_mm256_loadu_ps(symbolPtr), invAmp);
+
+            u = y;
+            for (k = 1; k < bitsPerAxis; k++)
+                u = _mm256_sub_ps(_mm256_andnot_ps(signMask, u),
+                                  _mm256_set1_ps((float)(1u << (bitsPerAxis - k))));
+            e2 = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_andnot_ps(signMask, u), one));
+            e2 = _mm256_mul_ps(e2, e2);
+
+            u = y;
+            for (k = 0; k < bitsPerAxis; k++) {
+                if (k > 0)
+                    u = _mm256_sub_ps(_mm256_andnot_ps(signMask, u),
+                                      _mm256_set1_ps((float)(1u << (bitsPerAxis - k))));
+                a = _mm256_add_ps(_mm256_andnot_ps(signMask, u), one);
+                llr = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(a, a), e2),
+                                    k == 0 ? negScale : posScale);
+                llr = _mm256_xor_ps(llr, _mm256_and_ps(u, signMask));
+
+                lo = _mm256_castps256_ps128(llr);
+                hi = _mm256_extractf128_ps(llr, 1);
+                _mm_storel_pi((__m64*)(llrPtr + 2 * k), lo);
+                _mm_storeh_pi((__m64*)(llrPtr + bitsPerSymbol + 2 * k), lo);
+                _mm_storel_pi((__m64*)(llrPtr + 2 * bitsPerSymbol + 2 * k), hi);
+                _mm_storeh_pi((__m64*)(llrPtr + 3 * bitsPerSymbol + 2 * k), hi);
+            }
+            symbolPtr += 8;
+            llrPtr += 4 * bitsPerSymbol;
+        }
+        number = quarterPoints * 4;
+    }
+
+    volk_32fc_s32f_x2_max_log_llr_32f_generic(llrPtr,
+                                              (const lv_32fc_t*)symbolPtr,
+                                              amplitude,
+                                              noiseVariance,
+                                              bitsPerSymbol,
+                                              num_points - number);
+}
+
+#endif /* LV_HAVE_AVX */
+
+#ifdef LV_HAVE_SSE
+#include <xmmintrin.h>
+
+static inline void volk_32fc_s32f_x2_max_log_llr_32f_u_sse(float* llrVector,
+                                                           const lv_32fc_t* symbols,
+                                                           const float amplitude,
+                                                           const float noiseVariance,
+                                                           unsigned int bitsPerSymbol,
+                                                           unsigned int num_points)
+{
+    unsigned int number = 0;
+    const unsigned int halfPoints = num_points / 2;
+
+    const float* symbolPtr = (const float*)symbols;
+    float* llrPtr = llrVector;
+
+    const float invAmplitude = 1.0f / amplitude;
+    const float scale = amplitude * amplitude / noiseVariance;
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    unsigned int k;
+
+    if (bitsPerSymbol == 1) {
+        const unsigned int quarterPoints = num_points / 4;
+        const __m128 gain = _mm_set1_ps(-4.0f * scale * invAmplitude);
+        __m128 re;
+        for (; number < quarterPoints; number++) {
+            re = _mm_shuffle_ps(_mm_loadu_ps(symbolPtr),
+                                _mm_loadu_ps(symbolPtr + 4),
+                                _MM_SHUFFLE(2, 0, 2, 0));
+            _mm_storeu_ps(llrPtr, _mm_mul_ps(re, gain));
+            symbolPtr += 8;
+            llrPtr += 4;
+        }
+        number = quarterPoints * 4;
+    } else {
+        const unsigned int bitsPerAxis = bitsPerSymbol / 2;
+        const __m128 invAmp = _mm_set1_ps(invAmplitude);
+        const __m128 posScale = _mm_set1_ps(scale);
+        const __m128 negScale = _mm_set1_ps(-scale);
+        __m128 y, u, e2, a, llr;
+
+        for (; number < halfPoints; number++) {
+            y = _mm_mul_ps(_mm_loadu_ps(symbolPtr), invAmp);
+
+            u = y;
+            for (k = 1; k < bitsPerAxis; k++)
+                u = _mm_sub_ps(_mm_andnot_ps(signMask, u),
+                               _mm_set1_ps((float)(1u << (bitsPerAxis - k))));
+            e2 = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_andnot_ps(signMask, u), one));
+            e2 = _mm_mul_ps(e2, e2);
+
+            u = y;
+            for (k = 0; k < bitsPerAxis; k++) {
+                if (k > 0)
+                    u = _mm_sub_ps(_mm_andnot_ps(signMask, u),
+                                   _mm_set1_ps((float)(1u << (bitsPerAxis - k))));
+                a = _mm_add_ps(_mm_andnot_ps(signMask, u), one);
+                llr = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(a, a), e2),
+                                 k == 0 ? negScale : posScale);
+                llr = _mm_xor_ps(llr, _mm_and_ps(u, signMask));
+
+                _mm_storel_pi((__m64*)(llrPtr + 2 * k), llr);
+                _mm_storeh_pi((__m64*)(llrPtr + bitsPerSymbol + 2 * k), llr);
+            }
+            symbolPtr += 4;
+            llrPtr += 2 * bitsPerSymbol;
+        }
+        number = halfPoints * 2;
+    }
+
+    volk_32fc_s32f_x2_max_log_llr_32f_generic(llrPtr,
+                                              (const lv_32fc_t*)symbolPtr,
+                                              amplitude,
+                                              noiseVariance,
+                                              bitsPerSymbol,
+                                              num_points - number);
+}
+
+#endif /* LV_HAVE_SSE */
+
+#endif /* INCLUDED_volk_32fc_s32f_x2_max_log_llr_32f_u_H */
@@ -0,0 +1,274 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32fc_s32fc_x2_iq_correct_32fc
+ *
+ * \b Overview
+ *
+ * Removes a DC offset and corrects IQ imbalance in one pass:
+ *
+ * out[i] = (in[i] - dc) + balance * conj(in[i] - dc)
+ *
+ * The conjugate term cancels the image that gain and phase mismatch
+ * between the I and Q paths leave at the mirrored frequency. Both terms
+ * fold into a real 2x2 matrix and an offset applied per sample, the same
+ * swap-and-multiply steps as volk_32fc_x2_multiply_32fc.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32fc_s32fc_x2_iq_correct_32fc(lv_32fc_t* outVector, const lv_32fc_t*
+ * inVector, const lv_32fc_t dc, const lv_32fc_t balance, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li inVector: The complex input samples.
+ * \li dc: The DC offset to subtract.
+ * \li balance: The image correction coefficient, 0 for none.
+ * \li num_points: The number of samples.
+ *
+ * \b Outputs
+ * \li outVector: The corrected samples; may be inVector.
+ *
+ * \b Example
+ * Correct a block read from a device without hardware IQ balance.
+ * \code
+ *   int N = 16384;
+ *   unsigned int alignment = volk_get_alignment();
+ *   lv_32fc_t* buf = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ *
+ *   // fill buf with CF32 samples from SoapySDR::Device::readStream
+ *
+ *   volk_32fc_s32fc_x2_iq_correct_32fc(
+ *       buf, buf, lv_cmake(0.01f, -0.004f), lv_cmake(-0.02f, 0.03f), N);
+ *
+ *   volk_free(buf);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32fc_s32fc_x2_iq_correct_32fc_u_H
+#define INCLUDED_volk_32fc_s32fc_x2_iq_correct_32fc_u_H
+
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+
+/*
+ * With w = balance and x = (xr, xi),
+ *   out.r = (1 + w.r) xr + w.i xi + k.r
+ *   out.i = w.i xr + (1 - w.r) xi + k.i
+ * where k = -(dc + w conj(dc)) collects the constant terms.
+ */
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_32fc_s32fc_x2_iq_correct_32fc_generic(lv_32fc_t* outVector,
+                                                              const lv_32fc_t* inVector,
+                                                              const lv_32fc_t dc,
+                                                              const lv_32fc_t balance,
+                                                              unsigned int num_points)
+{
+    const float wr = lv_creal(balance);
+    const float wi = lv_cimag(balance);
+    const float kr = -(lv_creal(dc) + wr * lv_creal(dc) + wi * lv_cimag(dc));
+    const float ki = -(lv_cimag(dc) + wi * lv_creal(dc) - wr * lv_cimag(dc));
+    const float* inPtr = (const float*)inVector;
+    float* outPtr = (float*)outVector;
+
+    unsigned int number = 0;
+    for (number = 0; number < num_points; number++) {
+        const float xr = *inPtr++;
+        const float xi = *inPtr++;
+        *outPtr++ = (1.0f + wr) * xr + wi * xi + kr;
+        *outPtr++ = wi * xr + (1.0f - wr) * xi + ki;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32fc_s32fc_x2_iq_correct_32fc_u_avx(lv_32fc_t* outVector,
+                                                            const lv_32fc_t* inVector,
+                                                            const lv_32fc_t dc,
+                                                            const lv_32fc_t balance,
+                                                            unsigned int num_points)
+{
+    const float wr = lv_creal(balance);
+    const float wi = lv_cimag(balance);
+    const float kr = -(lv_creal(dc) + wr * lv_creal(dc) + wi * lv_cimag(dc));
+    const float ki = -(lv_cimag(dc) + wi * lv_creal(dc) - wr * lv_cimag(dc));
+    const float* inPtr = (const float*)inVector;
+    float* outPtr = (float*)outVector;
+
+    const float dr = 1.0f + wr;
+    const float di = 1.0f - wr;
+    const __m256 direct = _mm256_setr_ps(dr, di, dr, di, dr, di, dr, di);
+    const __m256 cross = _mm256_set1_ps(wi);
+    const __m256 offset = _mm256_setr_ps(kr, ki, kr, ki, kr, ki, kr, ki);
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        const __m256 x = _mm256_loadu_ps(inPtr);
+        const __m256 swapped = _mm256_permute_ps(x, 0xb1); // xi, xr
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(x, direct), offset);
+        y = _mm256_add_ps(y, _mm256_mul_ps(swapped, cross));
+        _mm256_storeu_ps(outPtr, y);
+        inPtr += 8;
+        outPtr += 8;
+    }
+
+    number = quarterPoints * 4;
+    for (; number < num_points; number++) {
+        const float xr = *inPtr++;
+        const float xi = *inPtr++;
+        *outPtr++ = (1.0f + wr) * xr + wi * xi + kr;
+        *outPtr++ = wi * xr + (1.0f - wr) * xi + ki;
+    }
+}
+
+#endif /* LV_HAVE_AVX */
+
+#if LV_HAVE_AVX2 && LV_HAVE_FMA
+#include <immintrin.h>
+
+static inline void
+volk_32fc_s32fc_x2_iq_correct_32fc_u_avx2_fma(lv_32fc_t* outVector,
+                                              const lv_32fc_t* inVector,
+                                              const lv_32fc_t dc,
+                                              const lv_32fc_t balance,
+                                              unsigned int num_points)
+{
+    const float wr = lv_creal(balance);
+    const float wi = lv_cimag(balance);
+    const float kr = -(lv_creal(dc) + wr * lv_creal(dc) + wi * lv_cimag(dc));
+    const float ki = -(lv_cimag(dc) + wi * lv_creal(dc) - wr * lv_cimag(dc));
+    const float* inPtr = (const float*)inVector;
+    float* outPtr = (float*)outVector;
+
+    const float dr = 1.0f + wr;
+    const float di = 1.0f - wr;
+    const __m256 direct = _mm256_setr_ps(dr, di, dr, di, dr, di, dr, di);
+    const __m256 cross = _mm256_set1_ps(wi);
+    const __m256 offset = _mm256_setr_ps(kr, ki, kr, ki, kr, ki, kr, ki);
+
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+    for (; number < eighthPoints; number++) {
+        // two registers per iteration to cover the latency of the FMA chain
+        const __m256 x0 = _mm256_loadu_ps(inPtr);
+        const __m256 x1 = _mm256_loadu_ps(inPtr + 8);
+        __m256 y0 = _mm256_fmadd_ps(x0, direct, offset);
+        __m256 y1 = _mm256_fmadd_ps(x1, direct, offset);
+        y0 = _mm256_fmadd_ps(_mm256_permute_ps(x0, 0xb1), cross, y0);
+        y1 = _mm256_fmadd_ps(_mm256_permute_ps(x1, 0xb1), cross, y1);
+        _mm256_storeu_ps(outPtr, y0);
+        _mm256_storeu_ps(outPtr + 8, y1);
+        inPtr += 16;
+        outPtr += 16;
+    }
+
+    number = eighthPoints * 8;
+    for (; number < num_points; number++) {
+        const float xr = *inPtr++;
+        const float xi = *inPtr++;
+        *outPtr++ = (1.0f + wr) * xr + wi * xi + kr;
+        *outPtr++ = wi * xr + (1.0f - wr) * xi + ki;
+    }
+}
+
+#endif /* LV_HAVE_AVX2 && LV_HAVE_FMA */
+
+#ifdef LV_HAVE_SSE
+#include <xmmintrin.h>
+
+static inline void volk_32fc_s32fc_x2_iq_correct_32fc_u_sse(lv_32fc_t* outVector,
+                                                            const lv_32fc_t* inVector,
+                                                            const lv_32fc_t dc,
+                                                            const lv_32fc_t balance,
+                                                            unsigned int num_points)
+{
+    const float wr = lv_creal(balance);
+    const float wi = lv_cimag(balance);
+    const float kr = -(lv_creal(dc) + wr * lv_creal(dc) + wi * lv_cimag(dc));
+    const float ki = -(lv_cimag(dc) + wi * lv_creal(dc) - wr * lv_cimag(dc));
+    const float* inPtr = (const float*)inVector;
+    float* outPtr = (float*)outVector;
+
+    const __m128 direct = _mm_setr_ps(1.0f + wr, 1.0f - wr, 1.0f + wr, 1.0f - wr);
+    const __m128 cross = _mm_set1_ps(wi);
+    const __m128 offset = _mm_setr_ps(kr, ki, kr, ki);
+
+    unsigned int number = 0;
+    const unsigned int halfPoints = num_points / 2;
+    for (; number < halfPoints; number++) {
+        const __m128 x = _mm_loadu_ps(inPtr);
+        const __m128 swapped = _mm_shuffle_ps(x, x, 0xb1); // xi, xr
+        __m128 y = _mm_add_ps(_mm_mul_ps(x, direct), offset);
+        y = _mm_add_ps(y, _mm_mul_ps(swapped, cross));
+        _mm_storeu_ps(outPtr, y);
+        inPtr += 4;
+        outPtr += 4;
+    }
+
+    number = halfPoints * 2;
+    for (; number < num_points; number++) {
+        const float xr = *inPtr++;
+        const float xi = *inPtr++;
+        *outPtr++ = (1.0f + wr) * xr + wi * xi + kr;
+        *outPtr++ = wi * xr + (1.0f - wr) * xi + ki;
+    }
+}
+
+#endif /* LV_HAVE_SSE */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_32fc_s32fc_x2_iq_correct_32fc_neon(lv_32fc_t* outVector,
+                                                           const lv_32fc_t* inVector,
+                                                           const lv_32fc_t dc,
+                                                           const lv_32fc_t balance,
+                                                           unsigned int num_points)
+{
+    const float wr = lv_creal(balance);
+    const float wi = lv_cimag(balance);
+    const float kr = -(lv_creal(dc) + wr * lv_creal(dc) + wi * lv_cimag(dc));
+    const float ki = -(lv_cimag(dc) + wi * lv_creal(dc) - wr * lv_cimag(dc));
+    const float* inPtr = (const float*)inVector;
+    float* outPtr = (float*)outVector;
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        // deinterleaved, so the cross terms need no swap
+        const float32x4x2_t x = vld2q_f32(inPtr);
+        float32x4x2_t y;
+        y.val[0] = vmlaq_n_f32(vdupq_n_f32(kr), x.val[0], 1.0f + wr);
+        y.val[0] = vmlaq_n_f32(y.val[0], x.val[1], wi);
+        y.val[1] = vmlaq_n_f32(vdupq_n_f32(ki), x.val[0], wi);
+        y.val[1] = vmlaq_n_f32(y.val[1], x.val[1], 1.0f - wr);
+        vst2q_f32(outPtr, y);
+        inPtr += 8;
+        outPtr += 8;
+    }
+
+    number = quarterPoints * 4;
+    for (; number < num_points; number++) {
+        const float xr = *inPtr++;
+        const float xi = *inPtr++;
+        *outPtr++ = (1.0f + wr) * xr + wi * xi + kr;
+        *outPtr++ = wi * xr + (1.0f - wr) * xi + ki;
+    }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_32fc_s32fc_x2_iq_correct_32fc_u_H */
@@ -0,0 +1,192 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_32ic_s32f_byteswap_convert_32fc
+ *
+ * \b Overview
+ *
+ * Converts big-endian complex 32-bit integers into complex floats divided
+ * by scalar, swapping the bytes with a shuffle in the same pass.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_32ic_s32f_byteswap_convert_32fc(lv_32fc_t* outputVector, const lv_32sc_t*
+ * inputVector, const float scalar, unsigned int num_points) \endcode
+ *
+ * \b Inputs
+ * \li inputVector: The big-endian complex 32-bit integer input buffer.
+ * \li scalar: The value the converted samples are divided by.
+ * \li num_points: The number of complex samples.
+ *
+ * \b Outputs
+ * \li outputVector: The complex float output buffer.
+ *
+ * \b Example
+ * \code
+ * int N = 8192;
+ * unsigned int alignment = volk_get_alignment();
+ * lv_32sc_t* payload = (lv_32sc_t*)volk_malloc(sizeof(lv_32sc_t) * N, alignment);
+ * lv_32fc_t* output = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ *
+ * // recv() the samples into payload
+ *
+ * volk_32ic_s32f_byteswap_convert_32fc(output, payload, 2147483648.0f, N);
+ *
+ * volk_free(payload);
+ * volk_free(output);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_32ic_s32f_byteswap_convert_32fc_u_H
+#define INCLUDED_volk_32ic_s32f_byteswap_convert_32fc_u_H
+
+#include <inttypes.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void
+volk_32ic_s32f_byteswap_convert_32fc_generic(lv_32fc_t* outputVector,
+                                             const lv_32sc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const uint32_t* inputPtr = (const uint32_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    unsigned int number = 0;
+    for (number = 0; number < num_points * 2; number++) {
+        const uint32_t value = *inputPtr++;
+        const uint32_t swapped = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                                 ((value << 8) & 0x00ff0000) | (value << 24);
+        *outputPtr++ = (float)(int32_t)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#if LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void
+volk_32ic_s32f_byteswap_convert_32fc_u_avx2(lv_32fc_t* outputVector,
+                                            const lv_32sc_t* inputVector,
+                                            const float scalar,
+                                            unsigned int num_points)
+{
+    const uint32_t* inputPtr = (const uint32_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14,
+                                          13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                                          15, 14, 13, 12);
+    const __m256 scale = _mm256_set1_ps(invScalar);
+
+    unsigned int number = 0;
+    const unsigned int eighthPoints = num_points / 8;
+    for (; number < eighthPoints; number++) {
+        const __m256i in0 = _mm256_loadu_si256((const __m256i*)inputPtr);
+        const __m256i in1 = _mm256_loadu_si256((const __m256i*)(inputPtr + 8));
+        const __m256 out0 = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(in0, swap));
+        const __m256 out1 = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(in1, swap));
+        _mm256_storeu_ps(outputPtr, _mm256_mul_ps(out0, scale));
+        _mm256_storeu_ps(outputPtr + 8, _mm256_mul_ps(out1, scale));
+        inputPtr += 16;
+        outputPtr += 16;
+    }
+
+    number = eighthPoints * 16;
+    for (; number < num_points * 2; number++) {
+        const uint32_t value = *inputPtr++;
+        const uint32_t swapped = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                                 ((value << 8) & 0x00ff0000) | (value << 24);
+        *outputPtr++ = (float)(int32_t)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSSE3
+#include <tmmintrin.h>
+
+static inline void
+volk_32ic_s32f_byteswap_convert_32fc_u_ssse3(lv_32fc_t* outputVector,
+                                             const lv_32sc_t* inputVector,
+                                             const float scalar,
+                                             unsigned int num_points)
+{
+    const uint32_t* inputPtr = (const uint32_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    const __m128i swap =
+        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128 scale = _mm_set1_ps(invScalar);
+
+    unsigned int number = 0;
+    const unsigned int quarterPoints = num_points / 4;
+    for (; number < quarterPoints; number++) {
+        const __m128i in0 = _mm_loadu_si128((const __m128i*)inputPtr);
+        const __m128i in1 = _mm_loadu_si128((const __m128i*)(inputPtr + 4));
+        const __m128 out0 = _mm_cvtepi32_ps(_mm_shuffle_epi8(in0, swap));
+        const __m128 out1 = _mm_cvtepi32_ps(_mm_shuffle_epi8(in1, swap));
+        _mm_storeu_ps(outputPtr, _mm_mul_ps(out0, scale));
+        _mm_storeu_ps(outputPtr + 4, _mm_mul_ps(out1, scale));
+        inputPtr += 8;
+        outputPtr += 8;
+    }
+
+    number = quarterPoints * 8;
+    for (; number < num_points * 2; number++) {
+        const uint32_t value = *inputPtr++;
+        const uint32_t swapped = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                                 ((value << 8) & 0x00ff0000) | (value << 24);
+        *outputPtr++ = (float)(int32_t)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_SSSE3 */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_32ic_s32f_byteswap_convert_32fc_neon(lv_32fc_t* outputVector,
+                                                             const lv_32sc_t* inputVector,
+                                                             const float scalar,
+                                                             unsigned int num_points)
+{
+    const uint8_t* inputPtr = (const uint8_t*)inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    unsigned int number = 0;
+    const unsigned int halfPoints = num_points / 2;
+    for (; number < halfPoints; number++) {
+        const int32x4_t in = vreinterpretq_s32_u8(vrev32q_u8(vld1q_u8(inputPtr)));
+        vst1q_f32(outputPtr, vmulq_n_f32(vcvtq_f32_s32(in), invScalar));
+        inputPtr += 16;
+        outputPtr += 4;
+    }
+
+    const uint32_t* tailPtr = (const uint32_t*)inputPtr;
+    number = halfPoints * 4;
+    for (; number < num_points * 2; number++) {
+        const uint32_t value = *tailPtr++;
+        const uint32_t swapped = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+                                 ((value << 8) & 0x00ff0000) | (value << 24);
+        *outputPtr++ = (float)(int32_t)swapped * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_32ic_s32f_byteswap_convert_32fc_u_H */
@@ -0,0 +1,194 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_4ic_s32f_convert_32fc
+ *
+ * \b Overview
+ *
+ * Converts complex signed 4-bit integers packed one sample per byte, the
+ * SOAPY_SDR_CS4 layout written by volk_32fc_s32f_convert_4ic, into complex
+ * floats divided by scalar.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_4ic_s32f_convert_32fc(lv_32fc_t* outputVector, const uint8_t* inputVector,
+ * const float scalar, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li inputVector: num_points bytes of packed CS4 samples.
+ * \li scalar: The value the converted parts are divided by.
+ * \li num_points: The number of complex samples.
+ *
+ * \b Outputs
+ * \li outputVector: The complex float output buffer.
+ *
+ * \b Example
+ * \code
+ * int N = 8192;
+ * unsigned int alignment = volk_get_alignment();
+ * uint8_t* packed = (uint8_t*)volk_malloc(N, alignment);
+ * lv_32fc_t* output = (lv_32fc_t*)volk_malloc(sizeof(lv_32fc_t) * N, alignment);
+ *
+ * volk_4ic_s32f_convert_32fc(output, packed, 7.0f, N);
+ *
+ * volk_free(packed);
+ * volk_free(output);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_4ic_s32f_convert_32fc_u_H
+#define INCLUDED_volk_4ic_s32f_convert_32fc_u_H
+
+#include <inttypes.h>
+#include <string.h>
+#include <volk/volk_complex.h>
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_4ic_s32f_convert_32fc_generic(lv_32fc_t* outputVector,
+                                                      const uint8_t* inputVector,
+                                                      const float scalar,
+                                                      unsigned int num_points)
+{
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    for (unsigned int number = 0; number < num_points; number++) {
+        const uint8_t value = inputVector[number];
+        *outputPtr++ = (float)((int8_t)value >> 4) * invScalar;
+        *outputPtr++ = (float)((int8_t)(uint8_t)(value << 4) >> 4) * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_4ic_s32f_convert_32fc_u_avx2(lv_32fc_t* outputVector,
+                                                     const uint8_t* inputVector,
+                                                     const float scalar,
+                                                     unsigned int num_points)
+{
+    const unsigned int eighthPoints = num_points / 8;
+
+    const uint8_t* inputPtr = inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+    const __m256 vInvScalar = _mm256_set1_ps(invScalar);
+
+    for (unsigned int number = 0; number < eighthPoints; number++) {
+        // one sample per 32-bit lane, then sign extend each nibble from the top
+        const __m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)inputPtr));
+        const __m256i i = _mm256_srai_epi32(_mm256_slli_epi32(x, 24), 28);
+        const __m256i q = _mm256_srai_epi32(_mm256_slli_epi32(x, 28), 28);
+
+        const __m256i lo = _mm256_unpacklo_epi32(i, q); // samples 0, 1, 4, 5
+        const __m256i hi = _mm256_unpackhi_epi32(i, q); // samples 2, 3, 6, 7
+        const __m256 out0 = _mm256_cvtepi32_ps(_mm256_permute2x128_si256(lo, hi, 0x20));
+        const __m256 out1 = _mm256_cvtepi32_ps(_mm256_permute2x128_si256(lo, hi, 0x31));
+        _mm256_storeu_ps(outputPtr, _mm256_mul_ps(out0, vInvScalar));
+        _mm256_storeu_ps(outputPtr + 8, _mm256_mul_ps(out1, vInvScalar));
+        inputPtr += 8;
+        outputPtr += 16;
+    }
+
+    for (unsigned int number = eighthPoints * 8; number < num_points; number++) {
+        const uint8_t value = *inputPtr++;
+        *outputPtr++ = (float)((int8_t)value >> 4) * invScalar;
+        *outputPtr++ = (float)((int8_t)(uint8_t)(value << 4) >> 4) * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_4ic_s32f_convert_32fc_u_sse2(lv_32fc_t* outputVector,
+                                                     const uint8_t* inputVector,
+                                                     const float scalar,
+                                                     unsigned int num_points)
+{
+    const unsigned int quarterPoints = num_points / 4;
+
+    const uint8_t* inputPtr = inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+    const __m128 vInvScalar = _mm_set_ps1(invScalar);
+
+    for (unsigned int number = 0; number < quarterPoints; number++) {
+        int32_t word;
+        memcpy(&word, inputPtr, sizeof(word));
+        // repeat each byte across its 32-bit lane, so the top byte is the sample
+        __m128i x = _mm_cvtsi32_si128(word);
+        x = _mm_unpacklo_epi8(x, x);
+        x = _mm_unpacklo_epi16(x, x);
+        const __m128i i = _mm_srai_epi32(x, 28);
+        const __m128i q = _mm_srai_epi32(_mm_slli_epi32(x, 4), 28);
+
+        const __m128 out0 = _mm_cvtepi32_ps(_mm_unpacklo_epi32(i, q));
+        const __m128 out1 = _mm_cvtepi32_ps(_mm_unpackhi_epi32(i, q));
+        _mm_storeu_ps(outputPtr, _mm_mul_ps(out0, vInvScalar));
+        _mm_storeu_ps(outputPtr + 4, _mm_mul_ps(out1, vInvScalar));
+        inputPtr += 4;
+        outputPtr += 8;
+    }
+
+    for (unsigned int number = quarterPoints * 4; number < num_points; number++) {
+        const uint8_t value = *inputPtr++;
+        *outputPtr++ = (float)((int8_t)value >> 4) * invScalar;
+        *outputPtr++ = (float)((int8_t)(uint8_t)(value << 4) >> 4) * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_SSE2 */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_4ic_s32f_convert_32fc_neon(lv_32fc_t* outputVector,
+                                                   const uint8_t* inputVector,
+                                                   const float scalar,
+                                                   unsigned int num_points)
+{
+    const unsigned int eighthPoints = num_points / 8;
+
+    const uint8_t* inputPtr = inputVector;
+    float* outputPtr = (float*)outputVector;
+    const float invScalar = 1.0f / scalar;
+
+    for (unsigned int number = 0; number < eighthPoints; number++) {
+        const int8x8_t x = vreinterpret_s8_u8(vld1_u8(inputPtr));
+        const int8x8_t i = vshr_n_s8(x, 4);
+        const int8x8_t q = vshr_n_s8(vshl_n_s8(x, 4), 4);
+        const int8x8x2_t iq = vzip_s8(i, q);
+        for (int k = 0; k < 2; k++) {
+            const int16x8_t wide = vmovl_s8(iq.val[k]);
+            const float32x4_t out0 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(wide)));
+            const float32x4_t out1 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(wide)));
+            vst1q_f32(outputPtr, vmulq_n_f32(out0, invScalar));
+            vst1q_f32(outputPtr + 4, vmulq_n_f32(out1, invScalar));
+            outputPtr += 8;
+        }
+        inputPtr += 8;
+    }
+
+    for (unsigned int number = eighthPoints * 8; number < num_points; number++) {
+        const uint8_t value = *inputPtr++;
+        *outputPtr++ = (float)((int8_t)value >> 4) * invScalar;
+        *outputPtr++ = (float)((int8_t)(uint8_t)(value << 4) >> 4) * invScalar;
+    }
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_4ic_s32f_convert_32fc_u_H */
@@ -0,0 +1,414 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*!
+ * \page volk_8u_x2_hamming_distance_8u
+ *
+ * \b Overview
+ *
+ * Slides a bit pattern over a packed bit stream and computes the Hamming
+ * distance at every bit offset:
+ *
+ * distances[i] = sum_j (bit(packedBits, i + j) != bit(pattern, j)), j < patternBits
+ *
+ * Bits are packed most significant bit first, as by the MSB first packing
+ * of volk_32f_binary_slicer_8i decisions. A distance of 0 is an exact sync
+ * word match, and patternBits a match of the inverted word.
+ *
+ * The SIMD implementations shift the pattern to each of the 8 bit phases
+ * once per call, then compare every byte position against every phase,
+ * for 32 (AVX2) or 16 (SSSE3, NEON) byte positions at once. On x86 the
+ * masked mismatch count of a nibble is a 16 entry table lookup holding two
+ * phases per byte; NEON uses vcnt. The per phase counts are transposed
+ * back to bit offset order.
+ *
+ * <b>Dispatcher Prototype</b>
+ * \code
+ * void volk_8u_x2_hamming_distance_8u(uint8_t* distances, const uint8_t* packedBits,
+ * const uint8_t* pattern, unsigned int patternBits, unsigned int num_points)
+ * \endcode
+ *
+ * \b Inputs
+ * \li packedBits: The bit stream, holding (num_points + patternBits + 6) / 8 bytes.
+ * \li pattern: The sync word, (patternBits + 7) / 8 bytes, MSB first.
+ * \li patternBits: The sync word length, 1 to 128 bits.
+ * \li num_points: The number of bit offsets.
+ *
+ * \b Outputs
+ * \li distances: The Hamming distance at each bit offset.
+ *
+ * \b Example
+ * Find a CCSDS attached sync marker in 8192 bits.
+ * \code
+ *   unsigned int N = 8192;
+ *   const uint8_t asm_word[4] = { 0x1a, 0xcf, 0xfc, 0x1d };
+ *   unsigned int alignment = volk_get_alignment();
+ *   uint8_t* bits = (uint8_t*)volk_malloc((N + 32 + 6) / 8, alignment);
+ *   uint8_t* distances = (uint8_t*)volk_malloc(N, alignment);
+ *
+ *   // fill bits with packed hard decisions
+ *
+ *   volk_8u_x2_hamming_distance_8u(distances, bits, asm_word, 32, N);
+ *   for (unsigned int i = 0; i < N; i++)
+ *       if (distances[i] <= 3)
+ *           printf("sync at bit %u\n", i);
+ *
+ *   volk_free(bits);
+ *   volk_free(distances);
+ * \endcode
+ */
+
+#ifndef INCLUDED_volk_8u_x2_hamming_distance_8u_H
+#define INCLUDED_volk_8u_x2_hamming_distance_8u_H
+
+#include <inttypes.h>
+#include <volk/volk_common.h>
+
+// pattern bits and valid bit mask of stream byte t at bit phase s
+static inline void volk_8u_x2_hamming_distance_8u_slice(uint8_t* bits,
+                                                        uint8_t* mask,
+                                                        const uint8_t* pattern,
+                                                        unsigned int patternBits,
+                                                        unsigned int s,
+                                                        unsigned int t)
+{
+    unsigned int b;
+    *bits = 0;
+    *mask = 0;
+    for (b = 0; b < 8; b++) {
+        const int j = (int)(8 * t + b) - (int)s;
+        if (j >= 0 && j < (int)patternBits) {
+            *mask |= 0x80 >> b;
+            *bits |= ((pattern[j / 8] >> (7 - j % 8)) & 1) << (7 - b);
+        }
+    }
+}
+
+#ifdef LV_HAVE_GENERIC
+
+static inline void volk_8u_x2_hamming_distance_8u_generic(uint8_t* distances,
+                                                          const uint8_t* packedBits,
+                                                          const uint8_t* pattern,
+                                                          unsigned int patternBits,
+                                                          unsigned int num_points)
+{
+    unsigned int i, j;
+    for (i = 0; i < num_points; i++) {
+        unsigned int distance = 0;
+        for (j = 0; j < patternBits; j++) {
+            const unsigned int k = i + j;
+            distance += ((packedBits[k / 8] >> (7 - k % 8)) ^ (pattern[j / 8] >> (7 - j % 8))) & 1;
+        }
+        distances[i] = (uint8_t)distance;
+    }
+}
+
+#endif /* LV_HAVE_GENERIC */
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+
+static inline void volk_8u_x2_hamming_distance_8u_u_avx2(uint8_t* distances,
+                                                         const uint8_t* packedBits,
+                                                         const uint8_t* pattern,
+                                                         unsigned int patternBits,
+                                                         unsigned int num_points)
+{
+    // stream bytes touched by one bit phase of the pattern
+    const unsigned int T = (patternBits + 14) / 8;
+    const unsigned int numBytes = (num_points + patternBits + 6) / 8;
+    unsigned int p = 0, s, t;
+
+    if (patternBits > 0 && patternBits <= 128) {
+        // popcount((nibble ^ pattern) & mask) of the high and low nibble, for
+        // phase 2k in the low and phase 2k + 1 in the high half of each entry
+        __VOLK_ATTR_ALIGNED(32) uint8_t lut[4 * 17 * 2 * 32];
+        const __m256i nibbles =
+            _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                             0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m256i popcount4 =
+            _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low4 = _mm256_set1_epi8(0x0f);
+        for (s = 0; s < 4; s++) {
+            for (t = 0; t < T; t++) {
+                uint8_t bits0, mask0, bits1, mask1;
+                volk_8u_x2_hamming_distance_8u_slice(
+                    &bits0, &mask0, pattern, patternBits, 2 * s, t);
+                volk_8u_x2_hamming_distance_8u_slice(
+                    &bits1, &mask1, pattern, patternBits, 2 * s + 1, t);
+                __m256i* entry = (__m256i*)(lut + (s * 17 + t) * 64);
+                const __m256i hi0 = _mm256_shuffle_epi8(
+                    popcount4,
+                    _mm256_and_si256(_mm256_xor_si256(nibbles, _mm256_set1_epi8(bits0 >> 4)),
+                                     _mm256_set1_epi8(mask0 >> 4)));
+                const __m256i hi1 = _mm256_shuffle_epi8(
+                    popcount4,
+                    _mm256_and_si256(_mm256_xor_si256(nibbles, _mm256_set1_epi8(bits1 >> 4)),
+                                     _mm256_set1_epi8(mask1 >> 4)));
+                const __m256i lo0 = _mm256_shuffle_epi8(
+                    popcount4,
+                    _mm256_and_si256(_mm256_xor_si256(nibbles, _mm256_set1_epi8(bits0 & 0x0f)),
+                                     _mm256_set1_epi8(mask0 & 0x0f)));
+                const __m256i lo1 = _mm256_shuffle_epi8(
+                    popcount4,
+                    _mm256_and_si256(_mm256_xor_si256(nibbles, _mm256_set1_epi8(bits1 & 0x0f)),
+                                     _mm256_set1_epi8(mask1 & 0x0f)));
+                _mm256_store_si256(entry, _mm256_or_si256(hi0, _mm256_slli_epi16(hi1, 4)));
+                _mm256_store_si256(entry + 1, _mm256_or_si256(lo0, _mm256_slli_epi16(lo1, 4)));
+            }
+        }
+
+        __m256i acc[8], x, hi, lo, v;
+        __m256i a01l, a01h, a23l, a23h, a45l, a45h, a67l, a67h;
+        __m256i b0, b1, b2, b3, b4, b5, b6, b7, r0, r1, r2, r3, r4, r5, r6, r7;
+
+        // 32 byte positions times 8 phases, while every read stays in the stream
+        for (; 8 * (p + 32) <= num_points && p + 32 + T - 1 <= numBytes; p += 32) {
+            for (s = 0; s < 8; s++)
+                acc[s] = _mm256_setzero_si256();
+
+            for (t = 0; t < T; t++) {
+                x = _mm256_loadu_si256((const __m256i*)(packedBits + p + t));
+                hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), low4);
+                lo = _mm256_and_si256(x, low4);
+                for (s = 0; s < 4; s++) {
+                    // at most 8 per half, so the two phases do not mix
+                    const __m256i* entry = (const __m256i*)(lut + (s * 17 + t) * 64);
+                    v = _mm256_add_epi8(_mm256_shuffle_epi8(_mm256_load_si256(entry), hi),
+                                        _mm256_shuffle_epi8(_mm256_load_si256(entry + 1), lo));
+                    acc[2 * s] = _mm256_add_epi8(acc[2 * s], _mm256_and_si256(v, low4));
+                    acc[2 * s + 1] = _mm256_add_epi8(
+                        acc[2 * s + 1], _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+                }
+            }
+
+            // distances[8 * (p + q) + s] = acc[s][q]
+            a01l = _mm256_unpacklo_epi8(acc[0], acc[1]);
+            a01h = _mm256_unpackhi_epi8(acc[0], acc[1]);
+            a23l = _mm256_unpacklo_epi8(acc[2], acc[3]);
+            a23h = _mm256_unpackhi_epi8(acc[2], acc[3]);
+            a45l = _mm256_unpacklo_epi8(acc[4], acc[5]);
+            a45h = _mm256_unpackhi_epi8(acc[4], acc[5]);
+            a67l = _mm256_unpacklo_epi8(acc[6], acc[7]);
+            a67h = _mm256_unpackhi_epi8(acc[6], acc[7]);
+
+            b0 = _mm256_unpacklo_epi16(a01l, a23l);
+            b1 = _mm256_unpackhi_epi16(a01l, a23l);
+            b2 = _mm256_unpacklo_epi16(a01h, a23h);
+            b3 = _mm256_unpackhi_epi16(a01h, a23h);
+            b4 = _mm256_unpacklo_epi16(a45l, a67l);
+            b5 = _mm256_unpackhi_epi16(a45l, a67l);
+            b6 = _mm256_unpacklo_epi16(a45h, a67h);
+            b7 = _mm256_unpackhi_epi16(a45h, a67h);
+
+            // two positions each, the high lane holds positions 16 up
+            r0 = _mm256_unpacklo_epi32(b0, b4);
+            r1 = _mm256_unpackhi_epi32(b0, b4);
+            r2 = _mm256_unpacklo_epi32(b1, b5);
+            r3 = _mm256_unpackhi_epi32(b1, b5);
+            r4 = _mm256_unpacklo_epi32(b2, b6);
+            r5 = _mm256_unpackhi_epi32(b2, b6);
+            r6 = _mm256_unpacklo_epi32(b3, b7);
+            r7 = _mm256_unpackhi_epi32(b3, b7);
+
+            uint8_t* out = distances + 8 * p;
+            _mm256_storeu_si256((__m256i*)out, _mm256_permute2x128_si256(r0, r1, 0x20));
+            _mm256_storeu_si256((__m256i*)(out + 32), _mm256_permute2x128_si256(r2, r3, 0x20));
+            _mm256_storeu_si256((__m256i*)(out + 64), _mm256_permute2x128_si256(r4, r5, 0x20));
+            _mm256_storeu_si256((__m256i*)(out + 96), _mm256_permute2x128_si256(r6, r7, 0x20));
+            _mm256_storeu_si256((__m256i*)(out + 128), _mm256_permute2x128_si256(r0, r1, 0x31));
+            _mm256_storeu_si256((__m256i*)(out + 160), _mm256_permute2x128_si256(r2, r3, 0x31));
+            _mm256_storeu_si256((__m256i*)(out + 192), _mm256_permute2x128_si256(r4, r5, 0x31));
+            _mm256_storeu_si256((__m256i*)(out + 224), _mm256_permute2x128_si256(r6, r7, 0x31));
+        }
+    }
+
+    volk_8u_x2_hamming_distance_8u_generic(
+        distances + 8 * p, packedBits + p, pattern, patternBits, num_points - 8 * p);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSSE3
+#include <tmmintrin.h>
+
+static inline void volk_8u_x2_hamming_distance_8u_u_ssse3(uint8_t* distances,
+                                                          const uint8_t* packedBits,
+                                                          const uint8_t* pattern,
+                                                          unsigned int patternBits,
+                                                          unsigned int num_points)
+{
+    const unsigned int T = (patternBits + 14) / 8;
+    const unsigned int numBytes = (num_points + patternBits + 6) / 8;
+    unsigned int p = 0, s, t;
+
+    if (patternBits > 0 && patternBits <= 128) {
+        __VOLK_ATTR_ALIGNED(16) uint8_t lut[4 * 17 * 2 * 16];
+        const __m128i nibbles =
+            _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i popcount4 =
+            _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m128i low4 = _mm_set1_epi8(0x0f);
+        for (s = 0; s < 4; s++) {
+            for (t = 0; t < T; t++) {
+                uint8_t bits0, mask0, bits1, mask1;
+                volk_8u_x2_hamming_distance_8u_slice(
+                    &bits0, &mask0, pattern, patternBits, 2 * s, t);
+                volk_8u_x2_hamming_distance_8u_slice(
+                    &bits1, &mask1, pattern, patternBits, 2 * s + 1, t);
+                __m128i* entry = (__m128i*)(lut + (s * 17 + t) * 32);
+                const __m128i hi0 = _mm_shuffle_epi8(
+                    popcount4,
+                    _mm_and_si128(_mm_xor_si128(nibbles, _mm_set1_epi8(bits0 >> 4)),
+                                  _mm_set1_epi8(mask0 >> 4)));
+                const __m128i hi1 = _mm_shuffle_epi8(
+                    popcount4,
+                    _mm_and_si128(_mm_xor_si128(nibbles, _mm_set1_epi8(bits1 >> 4)),
+                                  _mm_set1_epi8(mask1 >> 4)));
+                const __m128i lo0 = _mm_shuffle_epi8(
+                    popcount4,
+                    _mm_and_si128(_mm_xor_si128(nibbles, _mm_set1_epi8(bits0 & 0x0f)),
+                                  _mm_set1_epi8(mask0 & 0x0f)));
+                const __m128i lo1 = _mm_shuffle_epi8(
+                    popcount4,
+                    _mm_and_si128(_mm_xor_si128(nibbles, _mm_set1_epi8(bits1 & 0x0f)),
+                                  _mm_set1_epi8(mask1 & 0x0f)));
+                _mm_store_si128(entry, _mm_or_si128(hi0, _mm_slli_epi16(hi1, 4)));
+                _mm_store_si128(entry + 1, _mm_or_si128(lo0, _mm_slli_epi16(lo1, 4)));
+            }
+        }
+
+        __m128i acc[8], x, hi, lo, v;
+        __m128i a01l, a01h, a23l, a23h, a45l, a45h, a67l, a67h;
+        __m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+        for (; 8 * (p + 16) <= num_points && p + 16 + T - 1 <= numBytes; p += 16) {
+            for (s = 0; s < 8; s++)
+                acc[s] = _mm_setzero_si128();
+
+            for (t = 0; t < T; t++) {
+                x = _mm_loadu_si128((const __m128i*)(packedBits + p + t));
+                hi = _mm_and_si128(_mm_srli_epi16(x, 4), low4);
+                lo = _mm_and_si128(x, low4);
+                for (s = 0; s < 4; s++) {
+                    const __m128i* entry = (const __m128i*)(lut + (s * 17 + t) * 32);
+                    v = _mm_add_epi8(_mm_shuffle_epi8(_mm_load_si128(entry), hi),
+                                     _mm_shuffle_epi8(_mm_load_si128(entry + 1), lo));
+                    acc[2 * s] = _mm_add_epi8(acc[2 * s], _mm_and_si128(v, low4));
+                    acc[2 * s + 1] =
+                        _mm_add_epi8(acc[2 * s + 1], _mm_and_si128(_mm_srli_epi16(v, 4), low4));
+                }
+            }
+
+            a01l = _mm_unpacklo_epi8(acc[0], acc[1]);
+            a01h = _mm_unpackhi_epi8(acc[0], acc[1]);
+            a23l = _mm_unpacklo_epi8(acc[2], acc[3]);
+            a23h = _mm_unpackhi_epi8(acc[2], acc[3]);
+            a45l = _mm_unpacklo_epi8(acc[4], acc[5]);
+            a45h = _mm_unpackhi_epi8(acc[4], acc[5]);
+            a67l = _mm_unpacklo_epi8(acc[6], acc[7]);
+            a67h = _mm_unpackhi_epi8(acc[6], acc[7]);
+
+            b0 = _mm_unpacklo_epi16(a01l, a23l);
+            b1 = _mm_unpackhi_epi16(a01l, a23l);
+            b2 = _mm_unpacklo_epi16(a01h, a23h);
+            b3 = _mm_unpackhi_epi16(a01h, a23h);
+            b4 = _mm_unpacklo_epi16(a45l, a67l);
+            b5 = _mm_unpackhi_epi16(a45l, a67l);
+            b6 = _mm_unpacklo_epi16(a45h, a67h);
+            b7 = _mm_unpackhi_epi16(a45h, a67h);
+
+            uint8_t* out = distances + 8 * p;
+            _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi32(b0, b4));
+            _mm_storeu_si128((__m128i*)(out + 16), _mm_unpackhi_epi32(b0, b4));
+            _mm_storeu_si128((__m128i*)(out + 32), _mm_unpacklo_epi32(b1, b5));
+            _mm_storeu_si128((__m128i*)(out + 48), _mm_unpackhi_epi32(b1, b5));
+            _mm_storeu_si128((__m128i*)(out + 64), _mm_unpacklo_epi32(b2, b6));
+            _mm_storeu_si128((__m128i*)(out + 80), _mm_unpackhi_epi32(b2, b6));
+            _mm_storeu_si128((__m128i*)(out + 96), _mm_unpacklo_epi32(b3, b7));
+            _mm_storeu_si128((__m128i*)(out + 112), _mm_unpackhi_epi32(b3, b7));
+        }
+    }
+
+    volk_8u_x2_hamming_distance_8u_generic(
+        distances + 8 * p, packedBits + p, pattern, patternBits, num_points - 8 * p);
+}
+
+#endif /* LV_HAVE_SSSE3 */
+
+#ifdef LV_HAVE_NEON
+#include <arm_neon.h>
+
+static inline void volk_8u_x2_hamming_distance_8u_neon(uint8_t* distances,
+                                                       const uint8_t* packedBits,
+                                                       const uint8_t* pattern,
+                                                       unsigned int patternBits,
+                                                       unsigned int num_points)
+{
+    const unsigned int T = (patternBits + 14) / 8;
+    const unsigned int numBytes = (num_points + patternBits + 6) / 8;
+    unsigned int p = 0, s, t;
+
+    if (patternBits > 0 && patternBits <= 128) {
+        uint8_t bits[8][17], mask[8][17];
+        for (s = 0; s < 8; s++)
+            for (t = 0; t < T; t++)
+                volk_8u_x2_hamming_distance_8u_slice(
+                    &bits[s][t], &mask[s][t], pattern, patternBits, s, t);
+
+        uint8x16_t acc[8], x;
+        uint8x16x2_t a01, a23, a45, a67;
+        uint16x8x2_t b0, b1, b2, b3;
+        uint32x4x2_t r;
+
+        for (; 8 * (p + 16) <= num_points && p + 16 + T - 1 <= numBytes; p += 16) {
+            for (s = 0; s < 8; s++)
+                acc[s] = vdupq_n_u8(0);
+
+            for (t = 0; t < T; t++) {
+                x = vld1q_u8(packedBits + p + t);
+                for (s = 0; s < 8; s++)
+                    acc[s] = vaddq_u8(acc[s],
+                                      vcntq_u8(vandq_u8(veorq_u8(x, vdupq_n_u8(bits[s][t])),
+                                                        vdupq_n_u8(mask[s][t]))));
+            }
+
+            a01 = vzipq_u8(acc[0], acc[1]);
+            a23 = vzipq_u8(acc[2], acc[3]);
+            a45 = vzipq_u8(acc[4], acc[5]);
+            a67 = vzipq_u8(acc[6], acc[7]);
+            b0 = vzipq_u16(vreinterpretq_u16_u8(a01.val[0]), vreinterpretq_u16_u8(a23.val[0]));
+            b1 = vzipq_u16(vreinterpretq_u16_u8(a01.val[1]), vreinterpretq_u16_u8(a23.val[1]));
+            b2 = vzipq_u16(vreinterpretq_u16_u8(a45.val[0]), vreinterpretq_u16_u8(a67.val[0]));
+            b3 = vzipq_u16(vreinterpretq_u16_u8(a45.val[1]), vreinterpretq_u16_u8(a67.val[1]));
+
+            uint8_t* out = distances + 8 * p;
+            r = vzipq_u32(vreinterpretq_u32_u16(b0.val[0]), vreinterpretq_u32_u16(b2.val[0]));
+            vst1q_u8(out, vreinterpretq_u8_u32(r.val[0]));
+            vst1q_u8(out + 16, vreinterpretq_u8_u32(r.val[1]));
+            r = vzipq_u32(vreinterpretq_u32_u16(b0.val[1]), vreinterpretq_u32_u16(b2.val[1]));
+            vst1q_u8(out + 32, vreinterpretq_u8_u32(r.val[0]));
+            vst1q_u8(out + 48, vreinterpretq_u8_u32(r.val[1]));
+            r = vzipq_u32(vreinterpretq_u32_u16(b1.val[0]), vreinterpretq_u32_u16(b3.val[0]));
+            vst1q_u8(out + 64, vreinterpretq_u8_u32(r.val[0]));
+            vst1q_u8(out + 80, vreinterpretq_u8_u32(r.val[1]));
+            r = vzipq_u32(vreinterpretq_u32_u16(b1.val[1]), vreinterpretq_u32_u16(b3.val[1]));
+            vst1q_u8(out + 96, vreinterpretq_u8_u32(r.val[0]));
+            vst1q_u8(out + 112, vreinterpretq_u8_u32(r.val[1]));
+        }
+    }
+
+    volk_8u_x2_hamming_distance_8u_generic(
+        distances + 8 * p, packedBits + p, pattern, patternBits, num_points - 8 * p);
+}
+
+#endif /* LV_HAVE_NEON */
+
+#endif /* INCLUDED_volk_8u_x2_hamming_distance_8u_H */
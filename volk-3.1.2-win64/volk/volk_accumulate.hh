@@ -0,0 +1,451 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_ACCUMULATE_H
+#define INCLUDED_VOLK_ACCUMULATE_H
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <volk/volk.h>
+
+namespace volk {
+
+/*!
+ * \brief How long reductions accumulate their partial sums
+ *
+ * \details
+ *   Error bounds below are relative to S = sum |x_i| (|a_i b_i| for dot
+ *   products), with eps = 2^-24 and n points:
+ *
+ *   - native: the float dispatcher kernel, |err| <= ~(n / lanes) eps S.
+ *   - pairwise: the dispatcher kernel on blocks of accumulation_block points,
+ *     block sums added as a balanced tree,
+ *     |err| <= ~(accumulation_block / lanes + log2(n / accumulation_block)) eps S.
+ *   - kahan: compensated float lanes (TwoSum, and TwoProduct when FMA is
+ *     available), |err| <= eps |sum| + ~n eps^2 S, plus eps S for the
+ *     rounded products on targets without FMA.
+ *   - float64: products and sums in double lanes as in volk_32f_64f_add_64f,
+ *     |err| <= eps |sum| + ~n 2^-53 S.
+ *
+ *   The compensated modes rely on IEEE evaluation order; do not build them
+ *   with -ffast-math or /fp:fast.
+ */
+enum class accumulation { native, pairwise, kahan, float64 };
+
+//! Block length of accumulation::pairwise
+static const unsigned int accumulation_block = 4096;
+
+namespace detail {
+
+// Knuth TwoSum running sum, the error of each addition goes into comp
+struct compensated_sum {
+    float sum = 0.0f;
+    float comp = 0.0f;
+
+    void add(float x)
+    {
+        const float s = sum + x;
+        const float bb = s - sum;
+        comp += (sum - (s - bb)) + (x - bb);
+        sum = s;
+    }
+
+    void add_product(float a, float b)
+    {
+        const float p = a * b;
+        add(p);
+#if defined(__FMA__)
+        comp += std::fma(a, b, -p);
+#endif
+    }
+
+    double value() const { return static_cast<double>(sum) + comp; }
+};
+
+#if defined(__AVX__)
+typedef __m256 fvec;
+static const unsigned int fvec_lanes = 8;
+inline fvec fvec_load(const float* p) { return _mm256_loadu_ps(p); }
+inline void fvec_store(float* p, fvec v) { _mm256_storeu_ps(p, v); }
+inline fvec fvec_zero() { return _mm256_setzero_ps(); }
+inline fvec fvec_add(fvec a, fvec b) { return _mm256_add_ps(a, b); }
+inline fvec fvec_sub(fvec a, fvec b) { return _mm256_sub_ps(a, b); }
+inline fvec fvec_mul(fvec a, fvec b) { return _mm256_mul_ps(a, b); }
+// swaps the real and imaginary part of every complex pair
+inline fvec fvec_swap_pairs(fvec a) { return _mm256_permute_ps(a, 0xb1); }
+#if defined(__FMA__)
+inline fvec fvec_product_error(fvec a, fvec b, fvec p) { return _mm256_fmsub_ps(a, b, p); }
+#endif
+#elif defined(__SSE2__) || defined(_M_X64)
+typedef __m128 fvec;
+static const unsigned int fvec_lanes = 4;
+inline fvec fvec_load(const float* p) { return _mm_loadu_ps(p); }
+inline void fvec_store(float* p, fvec v) { _mm_storeu_ps(p, v); }
+inline fvec fvec_zero() { return _mm_setzero_ps(); }
+inline fvec fvec_add(fvec a, fvec b) { return _mm_add_ps(a, b); }
+inline fvec fvec_sub(fvec a, fvec b) { return _mm_sub_ps(a, b); }
+inline fvec fvec_mul(fvec a, fvec b) { return _mm_mul_ps(a, b); }
+inline fvec fvec_swap_pairs(fvec a) { return _mm_shuffle_ps(a, a, 0xb1); }
+#endif
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+// TwoSum over fvec_lanes independent lanes
+struct compensated_lanes {
+    fvec sum = fvec_zero();
+    fvec comp = fvec_zero();
+
+    void add(fvec x)
+    {
+        const fvec s = fvec_add(sum, x);
+        const fvec bb = fvec_sub(s, sum);
+        comp = fvec_add(comp, fvec_add(fvec_sub(sum, fvec_sub(s, bb)), fvec_sub(x, bb)));
+        sum = s;
+    }
+
+    void add_product(fvec a, fvec b)
+    {
+        const fvec p = fvec_mul(a, b);
+        add(p);
+#if defined(__AVX__) && defined(__FMA__)
+        comp = fvec_add(comp, fvec_product_error(a, b, p));
+#endif
+    }
+
+    // lane l of the result, in double
+    void lanes(double* out) const
+    {
+        float s[fvec_lanes], c[fvec_lanes];
+        fvec_store(s, sum);
+        fvec_store(c, comp);
+        for (unsigned int l = 0; l < fvec_lanes; l++)
+            out[l] = static_cast<double>(s[l]) + c[l];
+    }
+};
+#endif
+
+inline float pairwise_dot(const float* input, const float* taps, unsigned int num_points)
+{
+    if (num_points <= accumulation_block) {
+        float r;
+        volk_32f_x2_dot_prod_32f(&r, input, taps, num_points);
+        return r;
+    }
+    const unsigned int half =
+        (num_points / 2 + accumulation_block - 1) / accumulation_block * accumulation_block;
+    return pairwise_dot(input, taps, half) +
+           pairwise_dot(input + half, taps + half, num_points - half);
+}
+
+inline lv_32fc_t
+pairwise_dot(const lv_32fc_t* input, const lv_32fc_t* taps, unsigned int num_points)
+{
+    if (num_points <= accumulation_block) {
+        lv_32fc_t r;
+        volk_32fc_x2_dot_prod_32fc(&r, input, taps, num_points);
+        return r;
+    }
+    const unsigned int half =
+        (num_points / 2 + accumulation_block - 1) / accumulation_block * accumulation_block;
+    return pairwise_dot(input, taps, half) +
+           pairwise_dot(input + half, taps + half, num_points - half);
+}
+
+inline float pairwise_sum(const float* input, unsigned int num_points)
+{
+    if (num_points <= accumulation_block) {
+        float r;
+        volk_32f_accumulator_s32f(&r, input, num_points);
+        return r;
+    }
+    const unsigned int half =
+        (num_points / 2 + accumulation_block - 1) / accumulation_block * accumulation_block;
+    return pairwise_sum(input, half) + pairwise_sum(input + half, num_points - half);
+}
+
+inline double kahan_dot(const float* input, const float* taps, unsigned int num_points)
+{
+    unsigned int number = 0;
+    double total = 0.0;
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    compensated_lanes acc;
+    for (; number + fvec_lanes <= num_points; number += fvec_lanes)
+        acc.add_product(fvec_load(input + number), fvec_load(taps + number));
+    double lane[fvec_lanes];
+    acc.lanes(lane);
+    for (unsigned int l = 0; l < fvec_lanes; l++)
+        total += lane[l];
+#endif
+    compensated_sum tail;
+    for (; number < num_points; number++)
+        tail.add_product(input[number], taps[number]);
+    return total + tail.value();
+}
+
+inline lv_64fc_t
+kahan_dot(const lv_32fc_t* input, const lv_32fc_t* taps, unsigned int num_points)
+{
+    const float* a = reinterpret_cast<const float*>(input);
+    const float* b = reinterpret_cast<const float*>(taps);
+    unsigned int number = 0;
+    double re = 0.0, im = 0.0;
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    // direct holds (ar br, ai bi) pairs, crossed holds (ar bi, ai br)
+    compensated_lanes direct, crossed;
+    const unsigned int points_per_vec = fvec_lanes / 2;
+    for (; number + points_per_vec <= num_points; number += points_per_vec) {
+        const fvec va = fvec_load(a + 2 * number);
+        const fvec vb = fvec_load(b + 2 * number);
+        direct.add_product(va, vb);
+        crossed.add_product(va, fvec_swap_pairs(vb));
+    }
+    double d[fvec_lanes], c[fvec_lanes];
+    direct.lanes(d);
+    crossed.lanes(c);
+    for (unsigned int l = 0; l < fvec_lanes; l += 2) {
+        re += d[l] - d[l + 1];
+        im += c[l] + c[l + 1];
+    }
+#endif
+    compensated_sum tail_re, tail_im;
+    for (; number < num_points; number++) {
+        const float ar = a[2 * number], ai = a[2 * number + 1];
+        const float br = b[2 * number], bi = b[2 * number + 1];
+        tail_re.add_product(ar, br);
+        tail_re.add_product(-ai, bi);
+        tail_im.add_product(ar, bi);
+        tail_im.add_product(ai, br);
+    }
+    return lv_64fc_t(re + tail_re.value(), im + tail_im.value());
+}
+
+inline double kahan_sum(const float* input, unsigned int num_points)
+{
+    unsigned int number = 0;
+    double total = 0.0;
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    compensated_lanes acc;
+    for (; number + fvec_lanes <= num_points; number += fvec_lanes)
+        acc.add(fvec_load(input + number));
+    double lane[fvec_lanes];
+    acc.lanes(lane);
+    for (unsigned int l = 0; l < fvec_lanes; l++)
+        total += lane[l];
+#endif
+    compensated_sum tail;
+    for (; number < num_points; number++)
+        tail.add(input[number]);
+    return total + tail.value();
+}
+
+inline double double_dot(const float* input, const float* taps, unsigned int num_points)
+{
+    unsigned int number = 0;
+    double total = 0.0;
+#if defined(__AVX__)
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; number + 8 <= num_points; number += 8) {
+        acc0 = _mm256_add_pd(acc0,
+                             _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(input + number)),
+                                           _mm256_cvtps_pd(_mm_loadu_ps(taps + number))));
+        acc1 = _mm256_add_pd(
+            acc1,
+            _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(input + number + 4)),
+                          _mm256_cvtps_pd(_mm_loadu_ps(taps + number + 4))));
+    }
+    __VOLK_ATTR_ALIGNED(32) double lane[4];
+    _mm256_store_pd(lane, _mm256_add_pd(acc0, acc1));
+    total = (lane[0] + lane[1]) + (lane[2] + lane[3]);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; number + 4 <= num_points; number += 4) {
+        const __m128 a = _mm_loadu_ps(input + number);
+        const __m128 b = _mm_loadu_ps(taps + number);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_cvtps_pd(a), _mm_cvtps_pd(b)));
+        acc1 = _mm_add_pd(acc1,
+                          _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)),
+                                     _mm_cvtps_pd(_mm_movehl_ps(b, b))));
+    }
+    __VOLK_ATTR_ALIGNED(16) double lane[2];
+    _mm_store_pd(lane, _mm_add_pd(acc0, acc1));
+    total = lane[0] + lane[1];
+#endif
+    for (; number < num_points; number++)
+        total += static_cast<double>(input[number]) * taps[number];
+    return total;
+}
+
+inline lv_64fc_t
+double_dot(const lv_32fc_t* input, const lv_32fc_t* taps, unsigned int num_points)
+{
+    const float* a = reinterpret_cast<const float*>(input);
+    const float* b = reinterpret_cast<const float*>(taps);
+    unsigned int number = 0;
+    double re = 0.0, im = 0.0;
+#if defined(__AVX__)
+    // two complex points per register: direct (ar br, ai bi), crossed (ar bi, ai br)
+    __m256d direct = _mm256_setzero_pd(), crossed = _mm256_setzero_pd();
+    for (; number + 2 <= num_points; number += 2) {
+        const __m256d va = _mm256_cvtps_pd(_mm_loadu_ps(a + 2 * number));
+        const __m256d vb = _mm256_cvtps_pd(_mm_loadu_ps(b + 2 * number));
+        direct = _mm256_add_pd(direct, _mm256_mul_pd(va, vb));
+        crossed = _mm256_add_pd(crossed, _mm256_mul_pd(va, _mm256_permute_pd(vb, 0x5)));
+    }
+    __VOLK_ATTR_ALIGNED(32) double d[4];
+    __VOLK_ATTR_ALIGNED(32) double c[4];
+    _mm256_store_pd(d, direct);
+    _mm256_store_pd(c, crossed);
+    re = (d[0] - d[1]) + (d[2] - d[3]);
+    im = (c[0] + c[1]) + (c[2] + c[3]);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128d direct = _mm_setzero_pd(), crossed = _mm_setzero_pd();
+    for (; number + 2 <= num_points; number += 2) {
+        const __m128 a4 = _mm_loadu_ps(a + 2 * number);
+        const __m128 b4 = _mm_loadu_ps(b + 2 * number);
+        const __m128d a0 = _mm_cvtps_pd(a4), a1 = _mm_cvtps_pd(_mm_movehl_ps(a4, a4));
+        const __m128d b0 = _mm_cvtps_pd(b4), b1 = _mm_cvtps_pd(_mm_movehl_ps(b4, b4));
+        direct = _mm_add_pd(direct, _mm_add_pd(_mm_mul_pd(a0, b0), _mm_mul_pd(a1, b1)));
+        crossed = _mm_add_pd(crossed,
+                             _mm_add_pd(_mm_mul_pd(a0, _mm_shuffle_pd(b0, b0, 1)),
+                                        _mm_mul_pd(a1, _mm_shuffle_pd(b1, b1, 1))));
+    }
+    __VOLK_ATTR_ALIGNED(16) double d[2];
+    __VOLK_ATTR_ALIGNED(16) double c[2];
+    _mm_store_pd(d, direct);
+    _mm_store_pd(c, crossed);
+    re = d[0] - d[1];
+    im = c[0] + c[1];
+#endif
+    for (; number < num_points; number++) {
+        const double ar = a[2 * number], ai = a[2 * number + 1];
+        const double br = b[2 * number], bi = b[2 * number + 1];
+        re += ar * br - ai * bi;
+        im += ar * bi + ai * br;
+    }
+    return lv_64fc_t(re, im);
+}
+
+inline double double_sum(const float* input, unsigned int num_points)
+{
+    unsigned int number = 0;
+    double total = 0.0;
+#if defined(__AVX__)
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; number + 8 <= num_points; number += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(input + number)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(input + number + 4)));
+    }
+    __VOLK_ATTR_ALIGNED(32) double lane[4];
+    _mm256_store_pd(lane, _mm256_add_pd(acc0, acc1));
+    total = (lane[0] + lane[1]) + (lane[2] + lane[3]);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; number + 4 <= num_points; number += 4) {
+        const __m128 a = _mm_loadu_ps(input + number);
+        acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(a));
+        acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(a, a)));
+    }
+    __VOLK_ATTR_ALIGNED(16) double lane[2];
+    _mm_store_pd(lane, _mm_add_pd(acc0, acc1));
+    total = lane[0] + lane[1];
+#endif
+    for (; number < num_points; number++)
+        total += input[number];
+    return total;
+}
+
+} // namespace detail
+
+/*!
+ * \brief volk_32f_x2_dot_prod_32f with a selectable accumulation mode
+ *
+ * \details
+ * example code:
+ *   float r;
+ *   volk::dot_prod(&r, x, y, 10000000, volk::accumulation::kahan);
+ */
+inline void dot_prod(float* result,
+                     const float* input,
+                     const float* taps,
+                     unsigned int num_points,
+                     accumulation mode = accumulation::native)
+{
+    switch (mode) {
+    case accumulation::pairwise:
+        *result = detail::pairwise_dot(input, taps, num_points);
+        break;
+    case accumulation::kahan:
+        *result = static_cast<float>(detail::kahan_dot(input, taps, num_points));
+        break;
+    case accumulation::float64:
+        *result = static_cast<float>(detail::double_dot(input, taps, num_points));
+        break;
+    default:
+        volk_32f_x2_dot_prod_32f(result, input, taps, num_points);
+    }
+}
+
+/*!
+ * \brief volk_32fc_x2_dot_prod_32fc with a selectable accumulation mode
+ */
+inline void dot_prod(lv_32fc_t* result,
+                     const lv_32fc_t* input,
+                     const lv_32fc_t* taps,
+                     unsigned int num_points,
+                     accumulation mode = accumulation::native)
+{
+    lv_64fc_t r;
+    switch (mode) {
+    case accumulation::pairwise:
+        *result = detail::pairwise_dot(input, taps, num_points);
+        return;
+    case accumulation::kahan:
+        r = detail::kahan_dot(input, taps, num_points);
+        break;
+    case accumulation::float64:
+        r = detail::double_dot(input, taps, num_points);
+        break;
+    default:
+        volk_32fc_x2_dot_prod_32fc(result, input, taps, num_points);
+        return;
+    }
+    *result = lv_cmake(static_cast<float>(lv_creal(r)), static_cast<float>(lv_cimag(r)));
+}
+
+/*!
+ * \brief volk_32f_accumulator_s32f with a selectable accumulation mode
+ */
+inline void accumulate(float* result,
+                       const float* input,
+                       unsigned int num_points,
+                       accumulation mode = accumulation::native)
+{
+    switch (mode) {
+    case accumulation::pairwise:
+        *result = detail::pairwise_sum(input, num_points);
+        break;
+    case accumulation::kahan:
+        *result = static_cast<float>(detail::kahan_sum(input, num_points));
+        break;
+    case accumulation::float64:
+        *result = static_cast<float>(detail::double_sum(input, num_points));
+        break;
+    default:
+        volk_32f_accumulator_s32f(result, input, num_points);
+    }
+}
+
+} // namespace volk
+#endif // INCLUDED_VOLK_ACCUMULATE_H
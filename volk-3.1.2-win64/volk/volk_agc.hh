@@ -0,0 +1,312 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_AGC_H
+#define INCLUDED_VOLK_AGC_H
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <volk/volk.h>
+
+namespace volk {
+
+namespace agc_detail {
+
+// Affine gain map g -> scale * g + offset * rate * reference
+struct step {
+    float scale;
+    float offset;
+};
+
+// a then b
+inline step compose(step a, step b)
+{
+    return { a.scale * b.scale, a.offset * b.scale + b.offset };
+}
+
+// n steps of g -> (1 - r) g + r ref / envelope, by binary powering
+inline step repeat(float base, unsigned int n)
+{
+    step result = { 1.0f, 0.0f };
+    step power = { base, 1.0f };
+    for (; n != 0; n >>= 1) {
+        if (n & 1)
+            result = compose(result, power);
+        power = compose(power, power);
+    }
+    return result;
+}
+
+// sum of |x| over num_points complex samples
+inline float envelope_sum(const lv_32fc_t* input, unsigned int num_points)
+{
+    const float* x = reinterpret_cast<const float*>(input);
+    unsigned int i = 0;
+    float sum = 0.0f;
+#if defined(__AVX__)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 4 <= num_points; i += 4) {
+        const __m256 v = _mm256_loadu_ps(x + 2 * i);
+        const __m256 p = _mm256_mul_ps(v, v);
+        // both floats of a pair hold |x|, halved below
+        const __m256 m2 = _mm256_add_ps(p, _mm256_permute_ps(p, 0xb1));
+        acc = _mm256_add_ps(acc, _mm256_sqrt_ps(m2));
+    }
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    sum = 0.5f * _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 2 <= num_points; i += 2) {
+        const __m128 v = _mm_loadu_ps(x + 2 * i);
+        const __m128 p = _mm_mul_ps(v, v);
+        const __m128 m2 = _mm_add_ps(p, _mm_shuffle_ps(p, p, 0xb1));
+        acc = _mm_add_ps(acc, _mm_sqrt_ps(m2));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    sum = 0.5f * _mm_cvtss_f32(_mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1)));
+#endif
+    for (; i < num_points; i++)
+        sum += std::sqrt(x[2 * i] * x[2 * i] + x[2 * i + 1] * x[2 * i + 1]);
+    return sum;
+}
+
+// sum of |x| over num_points real samples
+inline float envelope_sum(const float* x, unsigned int num_points)
+{
+    unsigned int i = 0;
+    float sum = 0.0f;
+#if defined(__AVX__)
+    const __m256 magnitude = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= num_points; i += 8)
+        acc = _mm256_add_ps(acc, _mm256_and_ps(_mm256_loadu_ps(x + i), magnitude));
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    sum = _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= num_points; i += 4)
+        acc = _mm_add_ps(acc, _mm_and_ps(_mm_loadu_ps(x + i), magnitude));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    sum = _mm_cvtss_f32(_mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1)));
+#endif
+    for (; i < num_points; i++)
+        sum += std::fabs(x[i]);
+    return sum;
+}
+
+// out[k] = in[k] * (gain + k * slope), as volk_32fc_s32f_multiply_32fc with a ramp
+inline void apply_ramp(
+    lv_32fc_t* out, const lv_32fc_t* in, float gain, float slope, unsigned int num_points)
+{
+    float* y = reinterpret_cast<float*>(out);
+    const float* x = reinterpret_cast<const float*>(in);
+    unsigned int i = 0;
+#if defined(__AVX__)
+    __m256 g = _mm256_setr_ps(gain,
+                              gain,
+                              gain + slope,
+                              gain + slope,
+                              gain + 2 * slope,
+                              gain + 2 * slope,
+                              gain + 3 * slope,
+                              gain + 3 * slope);
+    const __m256 dg = _mm256_set1_ps(4 * slope);
+    for (; i + 4 <= num_points; i += 4) {
+        _mm256_storeu_ps(y + 2 * i, _mm256_mul_ps(_mm256_loadu_ps(x + 2 * i), g));
+        g = _mm256_add_ps(g, dg);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 g = _mm_setr_ps(gain, gain, gain + slope, gain + slope);
+    const __m128 dg = _mm_set1_ps(2 * slope);
+    for (; i + 2 <= num_points; i += 2) {
+        _mm_storeu_ps(y + 2 * i, _mm_mul_ps(_mm_loadu_ps(x + 2 * i), g));
+        g = _mm_add_ps(g, dg);
+    }
+#endif
+    for (; i < num_points; i++) {
+        const float gi = gain + i * slope;
+        y[2 * i] = x[2 * i] * gi;
+        y[2 * i + 1] = x[2 * i + 1] * gi;
+    }
+}
+
+// out[k] = in[k] * (gain + k * slope), as volk_32f_s32f_multiply_32f with a ramp
+inline void
+apply_ramp(float* y, const float* x, float gain, float slope, unsigned int num_points)
+{
+    unsigned int i = 0;
+#if defined(__AVX__)
+    __m256 g = _mm256_add_ps(_mm256_set1_ps(gain),
+                             _mm256_mul_ps(_mm256_set1_ps(slope),
+                                           _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)));
+    const __m256 dg = _mm256_set1_ps(8 * slope);
+    for (; i + 8 <= num_points; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), g));
+        g = _mm256_add_ps(g, dg);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 g = _mm_setr_ps(gain, gain + slope, gain + 2 * slope, gain + 3 * slope);
+    const __m128 dg = _mm_set1_ps(4 * slope);
+    for (; i + 4 <= num_points; i += 4) {
+        _mm_storeu_ps(y + i, _mm_mul_ps(_mm_loadu_ps(x + i), g));
+        g = _mm_add_ps(g, dg);
+    }
+#endif
+    for (; i < num_points; i++)
+        y[i] = x[i] * (gain + i * slope);
+}
+
+} // namespace agc_detail
+
+/*!
+ * \brief Block automatic gain control for complex and real streams
+ *
+ * \details
+ *   The per-sample loop this replaces, run by process_per_sample(), is
+ *
+ *     out[n] = in[n] * g;
+ *     err = |out[n]| - reference;
+ *     g -= (err > 0 ? attack : decay) * err;   // then 0 <= g <= max_gain
+ *
+ *   process() splits the stream into sub-blocks of block_length samples.
+ *   The mean envelope m of each sub-block is summed in SIMD lanes as
+ *   volk_32fc_magnitude_32f would. With |in| held at m the loop above is
+ *   the affine map g -> (1 - rate m) g + rate reference, so the gain after
+ *   the sub-block is that map raised to block_length, evaluated by binary
+ *   powering. The rate is picked by the sign of the error at the start,
+ *   which the map does not change. The sub-block is then scaled with a gain
+ *   ramp from the old to the new gain.
+ *
+ *   The block gain is exact for a constant envelope. Otherwise it differs
+ *   from the per-sample loop by the envelope variation within a sub-block
+ *   times rate * block_length, so block_length should be short against the
+ *   attack time 1 / (attack * reference). Where rate m exceeds 1 the
+ *   per-sample loop overshoots; process() settles at reference / m instead.
+ *
+ * example code:
+ *   volk::agc agc(1.0f, 1e-2f, 1e-4f);
+ *   agc.process(out, in, n);
+ */
+class agc
+{
+public:
+    /*!
+     * \param reference target output magnitude
+     * \param attack gain rate when the output is above reference
+     * \param decay gain rate when the output is below reference
+     * \param max_gain upper gain limit
+     * \param block_length samples per gain update in process()
+     */
+    agc(float reference,
+        float attack,
+        float decay,
+        float max_gain = 65536.0f,
+        unsigned int block_length = 32)
+        : d_reference(reference),
+          d_attack(attack),
+          d_decay(decay),
+          d_max_gain(max_gain),
+          d_block(block_length)
+    {
+        if (!(reference > 0.0f))
+            throw std::invalid_argument("agc: reference must be positive");
+        if (!(attack > 0.0f) || !(decay > 0.0f))
+            throw std::invalid_argument("agc: attack and decay must be positive");
+        if (!(max_gain > 0.0f))
+            throw std::invalid_argument("agc: max_gain must be positive");
+        if (block_length == 0)
+            throw std::invalid_argument("agc: block_length must be positive");
+    }
+
+    float gain() const { return d_gain; }
+    void set_gain(float gain) { d_gain = std::min(std::max(gain, 0.0f), d_max_gain); }
+
+    float reference() const { return d_reference; }
+    unsigned int block_length() const { return d_block; }
+
+    void process(lv_32fc_t* out, const lv_32fc_t* in, unsigned int num_points)
+    {
+        blocks(out, in, num_points);
+    }
+
+    void process(float* out, const float* in, unsigned int num_points)
+    {
+        blocks(out, in, num_points);
+    }
+
+    //! The scalar per-sample loop, for comparison and for very short blocks
+    void process_per_sample(lv_32fc_t* out, const lv_32fc_t* in, unsigned int num_points)
+    {
+        for (unsigned int i = 0; i < num_points; i++) {
+            out[i] = in[i] * d_gain;
+            update(std::abs(out[i]));
+        }
+    }
+
+    void process_per_sample(float* out, const float* in, unsigned int num_points)
+    {
+        for (unsigned int i = 0; i < num_points; i++) {
+            out[i] = in[i] * d_gain;
+            update(std::fabs(out[i]));
+        }
+    }
+
+private:
+    void update(float magnitude)
+    {
+        const float err = magnitude - d_reference;
+        d_gain -= (err > 0.0f ? d_attack : d_decay) * err;
+        d_gain = std::min(std::max(d_gain, 0.0f), d_max_gain);
+    }
+
+    // gain after n samples of mean envelope m, starting from d_gain
+    float advance(float m, unsigned int n) const
+    {
+        const float rate = d_gain * m > d_reference ? d_attack : d_decay;
+        // rate m >= 1 would overshoot; step straight to reference / m
+        const float r = rate * m >= 1.0f ? 1.0f / m : rate;
+        const agc_detail::step s = agc_detail::repeat(1.0f - r * m, n);
+        const float g = s.scale * d_gain + s.offset * r * d_reference;
+        return std::min(std::max(g, 0.0f), d_max_gain);
+    }
+
+    template <class T>
+    void blocks(T* out, const T* in, unsigned int num_points)
+    {
+        for (unsigned int offset = 0; offset < num_points; offset += d_block) {
+            const unsigned int n = std::min(d_block, num_points - offset);
+            const float m = agc_detail::envelope_sum(in + offset, n) / n;
+            const float next = advance(m, n);
+            agc_detail::apply_ramp(
+                out + offset, in + offset, d_gain, (next - d_gain) / n, n);
+            d_gain = next;
+        }
+    }
+
+    float d_reference;
+    float d_attack;
+    float d_decay;
+    float d_max_gain;
+    unsigned int d_block;
+    float d_gain = 1.0f;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_AGC_H
@@ -0,0 +1,340 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_ARENA_H
+#define INCLUDED_VOLK_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include <volk/volk.h>
+
+namespace volk {
+
+/*!
+ * \brief Bump allocator over volk_malloc'd memory
+ *
+ * \details
+ *   Every allocation starts on a volk_get_alignment() boundary. Memory is
+ *   only given back by reset(), which rewinds the arena for the next
+ *   processing block. When a block needed more than the first chunk, reset()
+ *   replaces the chunks by a single one large enough for all of them, so the
+ *   steady state performs no volk_malloc calls at all.
+ *
+ *   Containers using the arena must release their memory before reset(),
+ *   by being destroyed or swapped with an empty container. clear() and
+ *   assigning {} keep the capacity, which reset() then hands out again
+ *   while the container still points at it. Not thread safe.
+ *
+ * example code:
+ *   volk::arena a(1 << 20);
+ *   for (;;) {
+ *       {
+ *           volk::arena_vector<float> tmp(n, volk::arena_alloc<float>(a));
+ *           ...
+ *       } // tmp is destroyed here
+ *       a.reset();
+ *   }
+ */
+class arena
+{
+public:
+    explicit arena(std::size_t chunk_bytes = 1 << 16)
+        : d_alignment(volk_get_alignment()), d_chunk_bytes(chunk_bytes)
+    {
+    }
+
+    ~arena()
+    {
+        for (auto& c : d_chunks)
+            volk_free(c.base);
+    }
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    void* allocate(std::size_t bytes)
+    {
+        bytes = round_up(bytes == 0 ? 1 : bytes);
+        if (d_chunks.empty() || d_chunks.back().size - d_offset < bytes)
+            grow(bytes);
+
+        chunk& c = d_chunks.back();
+        void* p = c.base + d_offset;
+        d_offset += bytes;
+        d_used += bytes;
+        d_last = p;
+        return p;
+    }
+
+    //! Only the most recent allocation is actually returned to the arena
+    void deallocate(void* p, std::size_t bytes) noexcept
+    {
+        if (p != nullptr && p == d_last) {
+            bytes = round_up(bytes == 0 ? 1 : bytes);
+            d_offset -= bytes;
+            d_used -= bytes;
+            d_last = nullptr;
+        }
+    }
+
+    //! Releases every allocation at once
+    void reset()
+    {
+        if (d_chunks.size() > 1) {
+            std::size_t total = 0;
+            for (auto& c : d_chunks) {
+                total += c.size;
+                volk_free(c.base);
+            }
+            d_chunks.clear();
+            add_chunk(total);
+        }
+        d_offset = 0;
+        d_used = 0;
+        d_last = nullptr;
+    }
+
+    //! Bytes handed out since the last reset(), including alignment padding
+    std::size_t used() const { return d_used; }
+
+    //! Bytes owned by the arena
+    std::size_t capacity() const
+    {
+        std::size_t total = 0;
+        for (auto& c : d_chunks)
+            total += c.size;
+        return total;
+    }
+
+private:
+    struct chunk {
+        char* base;
+        std::size_t size;
+    };
+
+    std::size_t round_up(std::size_t bytes) const
+    {
+        if (bytes > std::numeric_limits<std::size_t>::max() - d_alignment)
+            throw std::bad_alloc();
+        return (bytes + d_alignment - 1) / d_alignment * d_alignment;
+    }
+
+    void add_chunk(std::size_t bytes)
+    {
+        bytes = round_up(bytes);
+        auto base = static_cast<char*>(volk_malloc(bytes, d_alignment));
+        if (!base)
+            throw std::bad_alloc();
+        d_chunks.push_back({ base, bytes });
+    }
+
+    void grow(std::size_t bytes)
+    {
+        std::size_t size = d_chunk_bytes;
+        if (!d_chunks.empty())
+            size = std::max(size, 2 * d_chunks.back().size);
+        add_chunk(std::max(size, bytes));
+        d_offset = 0;
+    }
+
+    std::size_t d_alignment;
+    std::size_t d_chunk_bytes;
+    std::vector<chunk> d_chunks;
+    std::size_t d_offset = 0;
+    std::size_t d_used = 0;
+    void* d_last = nullptr;
+};
+
+/*!
+ * \brief Pool of fixed-size, volk_get_alignment() aligned blocks
+ *
+ * \details
+ *   Blocks are carved from slabs of blocks_per_slab blocks and recycled
+ *   through a free list, so once the pool has grown to the peak number of
+ *   live blocks no further volk_malloc calls happen. Requests larger than
+ *   block_bytes throw std::bad_alloc. reset() returns every block to the
+ *   pool at once; as with arena, containers must be destroyed or swapped
+ *   with an empty one first. Not thread safe.
+ *
+ * example code:
+ *   volk::pool p(4096 * sizeof(lv_32fc_t));
+ *   volk::pool_vector<lv_32fc_t> buf{ volk::pool_alloc<lv_32fc_t>(p) };
+ *   buf.reserve(4096);
+ */
+class pool
+{
+public:
+    explicit pool(std::size_t block_bytes, std::size_t blocks_per_slab = 16)
+        : d_alignment(volk_get_alignment()),
+          d_block_bytes(round_up(std::max(block_bytes, sizeof(void*)))),
+          d_blocks_per_slab(std::max<std::size_t>(1, blocks_per_slab))
+    {
+    }
+
+    ~pool()
+    {
+        for (char* s : d_slabs)
+            volk_free(s);
+    }
+
+    pool(const pool&) = delete;
+    pool& operator=(const pool&) = delete;
+
+    void* allocate(std::size_t bytes)
+    {
+        if (bytes > d_block_bytes)
+            throw std::bad_alloc();
+        if (!d_free)
+            add_slab();
+
+        void* p = d_free;
+        d_free = d_free->next;
+        d_live++;
+        return p;
+    }
+
+    void deallocate(void* p, std::size_t) noexcept
+    {
+        if (!p)
+            return;
+        auto n = static_cast<node*>(p);
+        n->next = d_free;
+        d_free = n;
+        d_live--;
+    }
+
+    //! Returns every block to the free list
+    void reset()
+    {
+        d_free = nullptr;
+        for (char* s : d_slabs)
+            thread_slab(s);
+        d_live = 0;
+    }
+
+    std::size_t block_bytes() const { return d_block_bytes; }
+
+    //! Blocks currently handed out
+    std::size_t live() const { return d_live; }
+
+    //! Blocks owned by the pool
+    std::size_t capacity() const { return d_slabs.size() * d_blocks_per_slab; }
+
+private:
+    struct node {
+        node* next;
+    };
+
+    std::size_t round_up(std::size_t bytes) const
+    {
+        return (bytes + d_alignment - 1) / d_alignment * d_alignment;
+    }
+
+    void thread_slab(char* slab)
+    {
+        for (std::size_t i = d_blocks_per_slab; i-- > 0;) {
+            auto n = reinterpret_cast<node*>(slab + i * d_block_bytes);
+            n->next = d_free;
+            d_free = n;
+        }
+    }
+
+    void add_slab()
+    {
+        if (d_block_bytes > std::numeric_limits<std::size_t>::max() / d_blocks_per_slab)
+            throw std::bad_alloc();
+        auto slab =
+            static_cast<char*>(volk_malloc(d_block_bytes * d_blocks_per_slab, d_alignment));
+        if (!slab)
+            throw std::bad_alloc();
+        d_slabs.push_back(slab);
+        thread_slab(slab);
+    }
+
+    std::size_t d_alignment;
+    std::size_t d_block_bytes;
+    std::size_t d_blocks_per_slab;
+    std::vector<char*> d_slabs;
+    node* d_free = nullptr;
+    std::size_t d_live = 0;
+};
+
+/*!
+ * \brief C++11 allocator drawing from a volk::arena or volk::pool
+ *
+ * \details
+ *   Allocators compare equal when they share the same resource. The
+ *   resource must outlive every container using it.
+ */
+template <class T, class Resource>
+struct resource_alloc {
+    typedef T value_type;
+
+    explicit resource_alloc(Resource& r) noexcept : resource(&r) {}
+
+    template <class U>
+    constexpr resource_alloc(resource_alloc<U, Resource> const& other) noexcept
+        : resource(other.resource)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T*>(resource->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept { resource->deallocate(p, n * sizeof(T)); }
+
+    Resource* resource;
+};
+
+template <class T, class U, class Resource>
+bool operator==(resource_alloc<T, Resource> const& a, resource_alloc<U, Resource> const& b)
+{
+    return a.resource == b.resource;
+}
+
+template <class T, class U, class Resource>
+bool operator!=(resource_alloc<T, Resource> const& a, resource_alloc<U, Resource> const& b)
+{
+    return a.resource != b.resource;
+}
+
+template <class T>
+using arena_alloc = resource_alloc<T, arena>;
+
+template <class T>
+using pool_alloc = resource_alloc<T, pool>;
+
+/*!
+ * \brief type alias for std::vector drawing from a volk::arena
+ *
+ * \details
+ * example code:
+ *   volk::arena a;
+ *   volk::arena_vector<float> v(100, volk::arena_alloc<float>(a));
+ */
+template <class T>
+using arena_vector = std::vector<T, arena_alloc<T>>;
+
+/*!
+ * \brief type alias for std::vector drawing from a volk::pool
+ */
+template <class T>
+using pool_vector = std::vector<T, pool_alloc<T>>;
+
+} // namespace volk
+#endif // INCLUDED_VOLK_ARENA_H
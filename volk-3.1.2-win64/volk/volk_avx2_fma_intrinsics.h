@@ -47,4 +47,61 @@ static inline __m256 _m256_arctan_poly_avx2_fma(const __m256 x)
     return arctan;
 }
 
+/*
+ * Sine and cosine of x with a shared range reduction
+ * Cephes sinf/cosf polynomials, same as _vsincosq_f32 for NEON
+ *
+ * Maximum absolute error ~8e-8 for |x| <= 8192
+ */
+static inline void _m256_sincos_avx2_fma(const __m256 x, __m256* sine, __m256* cosine)
+{
+    const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+    const __m256 dp1 = _mm256_set1_ps(0.78515625f);
+    const __m256 dp2 = _mm256_set1_ps(2.4187564849853515625e-4f);
+    const __m256 dp3 = _mm256_set1_ps(3.77489497744594108e-8f);
+    const __m256 sincof_p0 = _mm256_set1_ps(-1.9515295891e-4f);
+    const __m256 sincof_p1 = _mm256_set1_ps(8.3321608736e-3f);
+    const __m256 sincof_p2 = _mm256_set1_ps(-1.6666654611e-1f);
+    const __m256 coscof_p0 = _mm256_set1_ps(2.443315711809948e-5f);
+    const __m256 coscof_p1 = _mm256_set1_ps(-1.388731625493765e-3f);
+    const __m256 coscof_p2 = _mm256_set1_ps(4.166664568298827e-2f);
+    const __m256i twos = _mm256_set1_epi32(2);
+    const __m256i fours = _mm256_set1_epi32(4);
+
+    __m256 sign_sin = _mm256_and_ps(x, sign_bit);
+    __m256 ax = _mm256_andnot_ps(sign_bit, x);
+
+    /* j = (int)(|x| * 4/pi) rounded up to even, the octant pair */
+    __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(ax, _mm256_set1_ps(1.27323954473516f)));
+    j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    const __m256 y = _mm256_cvtepi32_ps(j);
+
+    const __m256 poly_mask =
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, twos), twos));
+    sign_sin = _mm256_xor_ps(
+        sign_sin, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, fours), 29)));
+    const __m256 sign_cos = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_andnot_si256(_mm256_sub_epi32(j, twos), fours), 29));
+
+    /* extended precision modular arithmetic */
+    ax = _mm256_fnmadd_ps(y, dp1, ax);
+    ax = _mm256_fnmadd_ps(y, dp2, ax);
+    ax = _mm256_fnmadd_ps(y, dp3, ax);
+
+    const __m256 z = _mm256_mul_ps(ax, ax);
+    __m256 y1 = _mm256_fmadd_ps(coscof_p0, z, coscof_p1);
+    y1 = _mm256_fmadd_ps(y1, z, coscof_p2);
+    y1 = _mm256_mul_ps(_mm256_mul_ps(y1, z), z);
+    y1 = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y1);
+    y1 = _mm256_add_ps(y1, _mm256_set1_ps(1.0f));
+
+    __m256 y2 = _mm256_fmadd_ps(sincof_p0, z, sincof_p1);
+    y2 = _mm256_fmadd_ps(y2, z, sincof_p2);
+    y2 = _mm256_mul_ps(y2, z);
+    y2 = _mm256_fmadd_ps(y2, ax, ax);
+
+    *sine = _mm256_xor_ps(_mm256_blendv_ps(y2, y1, poly_mask), sign_sin);
+    *cosine = _mm256_xor_ps(_mm256_blendv_ps(y1, y2, poly_mask), sign_cos);
+}
+
 #endif /* INCLUDE_VOLK_VOLK_AVX2_FMA_INTRINSICS_H_ */
@@ -0,0 +1,920 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_BENCHMARK_H
+#define INCLUDED_VOLK_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <volk/volk_report.hh>
+
+namespace volk {
+
+namespace benchmark_detail {
+
+/*
+ * Input and output buffers shared by all kernels, 8 bytes per point plus
+ * slack, reinterpreted as each kernel's types. Inputs hold values in
+ * [0.25, 0.75) as floats, which keeps every math kernel in its domain and
+ * gives finite non-denormal doubles; outputs are refilled per kernel so
+ * in-place kernels never see NaN or denormals left by another one.
+ */
+class buffers
+{
+public:
+    static constexpr unsigned int num_inputs = 6;
+    static constexpr unsigned int num_outputs = 4;
+
+    explicit buffers(unsigned int max_points)
+        : d_floats(2 * (std::size_t(max_points) + 64))
+    {
+        for (auto& in : d_in)
+            in.resize(d_floats);
+        for (auto& out : d_out)
+            out.resize(d_floats);
+        for (std::size_t i = 0; i < d_floats; i++) {
+            const uint32_t h = uint32_t(i + 1) * 2654435761u;
+            for (unsigned int k = 0; k < num_inputs; k++)
+                d_in[k][i] = 0.25f + 0.5f * float((h ^ (h >> (7 + k))) >> 8) * 0x1p-24f;
+        }
+        d_index.resize(d_floats);
+        for (std::size_t i = 0; i < d_floats; i++)
+            d_index[i] = int16_t((i * 7) % 16);
+        reset_outputs();
+    }
+
+    //! Shifts every pointer by one element, for the unaligned timings
+    void set_misaligned(bool misaligned) { d_shift = misaligned ? 1 : 0; }
+
+    void reset_outputs()
+    {
+        for (auto& out : d_out)
+            std::memcpy(out.data(), d_in[0].data(), d_floats * sizeof(float));
+    }
+
+    template <class T>
+    T* in(unsigned int k)
+    {
+        return reinterpret_cast<T*>(d_in[k].data()) + d_shift;
+    }
+
+    template <class T>
+    T* out(unsigned int k)
+    {
+        return reinterpret_cast<T*>(d_out[k].data()) + d_shift;
+    }
+
+    //! Output k, aligned even for the unaligned timings, for kernel state
+    template <class T>
+    T* state(unsigned int k)
+    {
+        return reinterpret_cast<T*>(d_out[k].data());
+    }
+
+    //! int16 indexes below 16, for permute kernels
+    short* index() { return d_index.data() + d_shift; }
+
+    lv_32fc_t phase_inc = lv_cmake(std::cos(0.001f), std::sin(0.001f));
+    lv_32fc_t phase = lv_cmake(1.0f, 0.0f);
+    lv_32fc_t scalar = lv_cmake(0.6f, 0.8f);
+    float save = 0.0f;
+
+private:
+    std::size_t d_floats;
+    volk::vector<float> d_in[num_inputs];
+    volk::vector<float> d_out[num_outputs];
+    volk::vector<short> d_index;
+    std::size_t d_shift = 0;
+};
+
+struct bench_case {
+    const char* name;
+    //! impl nullptr runs the dispatcher
+    void (*run)(buffers& b, unsigned int n, const char* impl);
+};
+
+struct skipped_kernel {
+    const char* name;
+    const char* reason;
+};
+
+// kernels without a per-point workload, or with one the puppet times
+inline const std::vector<skipped_kernel>& skipped_kernels()
+{
+    static const std::vector<skipped_kernel> skipped = {
+        { "volk_16i_branch_4_state_8", "fixed size butterfly without num_points" },
+        { "volk_32f_8u_polarbutterfly_32f",
+          "one butterfly per call, timed by volk_32f_8u_polarbutterflypuppet_32f" },
+        { "volk_32u_popcnt", "single value, timed by volk_32u_popcntpuppet_32u" },
+        { "volk_64u_popcnt", "single value, timed by volk_64u_popcntpuppet_64u" },
+        { "volk_8u_conv_k7_r2puppet_8u",
+          "sizes static buffers on its first call, timed by volk_8u_x4_conv_k7_r2_8u" },
+    };
+    return skipped;
+}
+
+#define VOLK_BENCH_CASE(kernel, ...)                                   \
+    {                                                                  \
+        #kernel, [](buffers& b, unsigned int n, const char* impl) {    \
+            (void)b;                                                   \
+            if (impl)                                                  \
+                kernel##_manual(__VA_ARGS__, impl);                    \
+            else                                                       \
+                kernel(__VA_ARGS__);                                   \
+        }                                                              \
+    }
+
+// every other dispatcher of volk.h, with inputs in[k] and outputs out[k]
+inline const std::vector<bench_case>& bench_cases()
+{
+    using c8 = lv_8sc_t;
+    using c16 = lv_16sc_t;
+    using c32 = lv_32fc_t;
+    using u8 = unsigned char;
+    static const std::vector<bench_case> cases = {
+        VOLK_BENCH_CASE(
+            volk_16i_32fc_dot_prod_32fc, b.out<c32>(0), b.in<short>(0), b.in<c32>(1), n),
+        VOLK_BENCH_CASE(volk_16i_convert_8i, b.out<int8_t>(0), b.in<int16_t>(0), n),
+        VOLK_BENCH_CASE(volk_16i_max_star_16i, b.out<short>(0), b.in<short>(0), n),
+        VOLK_BENCH_CASE(
+            volk_16i_max_star_horizontal_16i, b.out<int16_t>(0), b.in<int16_t>(0), n),
+        VOLK_BENCH_CASE(volk_16i_permute_and_scalar_add,
+                        b.out<short>(0),
+                        b.in<short>(0),
+                        b.index(),
+                        b.in<short>(1),
+                        b.in<short>(2),
+                        b.in<short>(3),
+                        b.in<short>(4),
+                        b.in<short>(5),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_16i_s32f_convert_32f, b.out<float>(0), b.in<int16_t>(0), 32768.0f, n),
+        VOLK_BENCH_CASE(volk_16i_x4_quad_max_star_16i,
+                        b.out<short>(0),
+                        b.in<short>(0),
+                        b.in<short>(1),
+                        b.in<short>(2),
+                        b.in<short>(3),
+                        n),
+        VOLK_BENCH_CASE(volk_16i_x5_add_quad_16i_x4,
+                        b.out<short>(0),
+                        b.out<short>(1),
+                        b.out<short>(2),
+                        b.out<short>(3),
+                        b.in<short>(0),
+                        b.in<short>(1),
+                        b.in<short>(2),
+                        b.in<short>(3),
+                        b.in<short>(4),
+                        n),
+        VOLK_BENCH_CASE(volk_16ic_convert_32fc, b.out<c32>(0), b.in<c16>(0), n),
+        VOLK_BENCH_CASE(volk_16ic_deinterleave_16i_x2,
+                        b.out<int16_t>(0),
+                        b.out<int16_t>(1),
+                        b.in<c16>(0),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_16ic_deinterleave_real_16i, b.out<int16_t>(0), b.in<c16>(0), n),
+        VOLK_BENCH_CASE(
+            volk_16ic_deinterleave_real_8i, b.out<int8_t>(0), b.in<c16>(0), n),
+        VOLK_BENCH_CASE(volk_16ic_magnitude_16i, b.out<int16_t>(0), b.in<c16>(0), n),
+        VOLK_BENCH_CASE(volk_16ic_s32f_deinterleave_32f_x2,
+                        b.out<float>(0),
+                        b.out<float>(1),
+                        b.in<c16>(0),
+                        32768.0f,
+                        n),
+        VOLK_BENCH_CASE(volk_16ic_s32f_deinterleave_real_32f,
+                        b.out<float>(0),
+                        b.in<c16>(0),
+                        32768.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_16ic_s32f_magnitude_32f, b.out<float>(0), b.in<c16>(0), 32768.0f, n),
+        VOLK_BENCH_CASE(
+            volk_16ic_x2_dot_prod_16ic, b.out<c16>(0), b.in<c16>(0), b.in<c16>(1), n),
+        VOLK_BENCH_CASE(
+            volk_16ic_x2_multiply_16ic, b.out<c16>(0), b.in<c16>(0), b.in<c16>(1), n),
+        VOLK_BENCH_CASE(volk_16u_byteswap, b.out<uint16_t>(0), n),
+        VOLK_BENCH_CASE(
+            volk_16u_byteswappuppet_16u, b.out<uint16_t>(0), b.out<uint16_t>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32f_64f_add_64f, b.out<double>(0), b.in<float>(0), b.in<double>(1), n),
+        VOLK_BENCH_CASE(volk_32f_64f_multiply_64f,
+                        b.out<double>(0),
+                        b.in<float>(0),
+                        b.in<double>(1),
+                        n),
+        VOLK_BENCH_CASE(volk_32f_8u_polarbutterflypuppet_32f,
+                        b.out<float>(0),
+                        b.in<float>(0),
+                        b.out<u8>(1),
+                        int(n)),
+        VOLK_BENCH_CASE(volk_32f_accumulator_s32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_acos_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_asin_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_atan_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_binary_slicer_32i, b.out<int>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_binary_slicer_8i, b.out<int8_t>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_convert_64f, b.out<double>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_cos_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_exp_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_expfast_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_index_max_16u, b.out<uint16_t>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_index_max_32u, b.out<uint32_t>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_index_min_16u, b.out<uint16_t>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_index_min_32u, b.out<uint32_t>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_invsqrt_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_log2_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_null_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_s32f_32f_fm_detect_32f,
+                        b.out<float>(0),
+                        b.in<float>(0),
+                        1.0f,
+                        &b.save,
+                        n),
+        VOLK_BENCH_CASE(volk_32f_s32f_add_32f, b.out<float>(0), b.in<float>(0), 0.5f, n),
+        VOLK_BENCH_CASE(volk_32f_s32f_calc_spectral_noise_floor_32f,
+                        b.out<float>(0),
+                        b.in<float>(0),
+                        20.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_clamppuppet_32f, b.out<float>(0), b.in<float>(0), 0.5f, n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_convert_16i, b.out<int16_t>(0), b.in<float>(0), 32767.0f, n),
+        VOLK_BENCH_CASE(volk_32f_s32f_convert_32i,
+                        b.out<int32_t>(0),
+                        b.in<float>(0),
+                        2147483647.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_convert_8i, b.out<int8_t>(0), b.in<float>(0), 127.0f, n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_convertpuppet_8u, b.out<uint8_t>(0), b.in<float>(0), 255.0f, n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_mod_rangepuppet_32f, b.out<float>(0), b.in<float>(0), 0.5f, n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_multiply_32f, b.out<float>(0), b.in<float>(0), 0.5f, n),
+        VOLK_BENCH_CASE(volk_32f_s32f_normalize, b.out<float>(0), 1.0f, n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_power_32f, b.out<float>(0), b.in<float>(0), 2.5f, n),
+        VOLK_BENCH_CASE(volk_32f_s32f_s32f_mod_range_32f,
+                        b.out<float>(0),
+                        b.in<float>(0),
+                        0.3f,
+                        0.6f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_stddev_32f, b.out<float>(0), b.in<float>(0), 0.5f, n),
+        VOLK_BENCH_CASE(
+            volk_32f_s32f_x2_clamp_32f, b.out<float>(0), b.in<float>(0), 0.3f, 0.6f, n),
+        VOLK_BENCH_CASE(volk_32f_s32f_x2_convert_8u,
+                        b.out<uint8_t>(0),
+                        b.in<float>(0),
+                        255.0f,
+                        0.0f,
+                        n),
+        VOLK_BENCH_CASE(volk_32f_sin_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_sqrt_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_stddev_and_mean_32f_x2,
+                        b.out<float>(0),
+                        b.out<float>(1),
+                        b.in<float>(0),
+                        n),
+        VOLK_BENCH_CASE(volk_32f_tan_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(volk_32f_tanh_32f, b.out<float>(0), b.in<float>(0), n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_add_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_divide_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(volk_32f_x2_dot_prod_16i,
+                        b.out<int16_t>(0),
+                        b.in<float>(0),
+                        b.in<float>(1),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_dot_prod_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_fm_detectpuppet_32f, b.out<float>(0), b.in<float>(0), &b.save, n),
+        VOLK_BENCH_CASE(volk_32f_x2_interleave_32fc,
+                        b.out<c32>(0),
+                        b.in<float>(0),
+                        b.in<float>(1),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_max_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_min_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_multiply_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_pow_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(volk_32f_x2_powpuppet_32f,
+                        b.out<float>(0),
+                        b.in<float>(0),
+                        b.in<float>(1),
+                        n),
+        VOLK_BENCH_CASE(volk_32f_x2_s32f_interleave_16ic,
+                        b.out<c16>(0),
+                        b.in<float>(0),
+                        b.in<float>(1),
+                        32767.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32f_x2_subtract_32f, b.out<float>(0), b.in<float>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(volk_32f_x3_sum_of_poly_32f,
+                        b.out<float>(0),
+                        b.in<float>(0),
+                        b.in<float>(1),
+                        b.in<float>(2),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_32f_add_32fc, b.out<c32>(0), b.in<c32>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32fc_32f_dot_prod_32fc, b.out<c32>(0), b.in<c32>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32fc_32f_multiply_32fc, b.out<c32>(0), b.in<c32>(0), b.in<float>(1), n),
+        VOLK_BENCH_CASE(volk_32fc_accumulator_s32fc, b.out<c32>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_conjugate_32fc, b.out<c32>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_convert_16ic, b.out<c16>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_deinterleave_32f_x2,
+                        b.out<float>(0),
+                        b.out<float>(1),
+                        b.in<c32>(0),
+                        n),
+        VOLK_BENCH_CASE(volk_32fc_deinterleave_64f_x2,
+                        b.out<double>(0),
+                        b.out<double>(1),
+                        b.in<c32>(0),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_deinterleave_imag_32f, b.out<float>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(
+            volk_32fc_deinterleave_real_32f, b.out<float>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(
+            volk_32fc_deinterleave_real_64f, b.out<double>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_index_max_16u, b.out<uint16_t>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_index_max_32u, b.out<uint32_t>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_index_min_16u, b.out<uint16_t>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_index_min_32u, b.out<uint32_t>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_magnitude_32f, b.out<float>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(
+            volk_32fc_magnitude_squared_32f, b.out<float>(0), b.in<c32>(0), n),
+        VOLK_BENCH_CASE(volk_32fc_s32f_atan2_32f, b.out<float>(0), b.in<c32>(0), 1.0f, n),
+        VOLK_BENCH_CASE(volk_32fc_s32f_deinterleave_real_16i,
+                        b.out<int16_t>(0),
+                        b.in<c32>(0),
+                        32767.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_s32f_magnitude_16i, b.out<int16_t>(0), b.in<c32>(0), 32767.0f, n),
+        VOLK_BENCH_CASE(volk_32fc_s32f_power_32fc, b.out<c32>(0), b.in<c32>(0), 2.5f, n),
+        VOLK_BENCH_CASE(volk_32fc_s32f_power_spectral_densitypuppet_32f,
+                        b.out<float>(0),
+                        b.in<c32>(0),
+                        1.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_s32f_power_spectrum_32f, b.out<float>(0), b.in<c32>(0), 1.0f, n),
+        VOLK_BENCH_CASE(volk_32fc_s32f_x2_power_spectral_density_32f,
+                        b.out<float>(0),
+                        b.in<c32>(0),
+                        1.0f,
+                        1000.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_s32fc_multiply2_32fc, b.out<c32>(0), b.in<c32>(0), &b.scalar, n),
+        VOLK_BENCH_CASE(
+            volk_32fc_s32fc_multiply_32fc, b.out<c32>(0), b.in<c32>(0), b.scalar, n),
+        VOLK_BENCH_CASE(volk_32fc_s32fc_rotator2puppet_32fc,
+                        b.out<c32>(0),
+                        b.in<c32>(0),
+                        &b.phase_inc,
+                        n),
+        VOLK_BENCH_CASE(volk_32fc_s32fc_x2_rotator2_32fc,
+                        b.out<c32>(0),
+                        b.in<c32>(0),
+                        &b.phase_inc,
+                        &b.phase,
+                        n),
+        VOLK_BENCH_CASE(volk_32fc_s32fc_x2_rotator_32fc,
+                        b.out<c32>(0),
+                        b.in<c32>(0),
+                        b.phase_inc,
+                        &b.phase,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_x2_add_32fc, b.out<c32>(0), b.in<c32>(0), b.in<c32>(1), n),
+        VOLK_BENCH_CASE(volk_32fc_x2_conjugate_dot_prod_32fc,
+                        b.out<c32>(0),
+                        b.in<c32>(0),
+                        b.in<c32>(1),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_x2_divide_32fc, b.out<c32>(0), b.in<c32>(0), b.in<c32>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32fc_x2_dot_prod_32fc, b.out<c32>(0), b.in<c32>(0), b.in<c32>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32fc_x2_multiply_32fc, b.out<c32>(0), b.in<c32>(0), b.in<c32>(1), n),
+        VOLK_BENCH_CASE(volk_32fc_x2_multiply_conjugate_32fc,
+                        b.out<c32>(0),
+                        b.in<c32>(0),
+                        b.in<c32>(1),
+                        n),
+        VOLK_BENCH_CASE(volk_32fc_x2_s32f_square_dist_scalar_mult_32f,
+                        b.out<float>(0),
+                        b.in<c32>(0),
+                        b.in<c32>(1),
+                        0.5f,
+                        n),
+        VOLK_BENCH_CASE(volk_32fc_x2_s32fc_multiply_conjugate_add2_32fc,
+                        b.out<c32>(0),
+                        b.in<c32>(0),
+                        b.in<c32>(1),
+                        &b.scalar,
+                        n),
+        VOLK_BENCH_CASE(volk_32fc_x2_s32fc_multiply_conjugate_add_32fc,
+                        b.out<c32>(0),
+                        b.in<c32>(0),
+                        b.in<c32>(1),
+                        b.scalar,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32fc_x2_square_dist_32f, b.out<float>(0), b.in<c32>(0), b.in<c32>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32i_s32f_convert_32f, b.out<float>(0), b.in<int32_t>(0), 1e-9f, n),
+        VOLK_BENCH_CASE(volk_32i_x2_and_32i,
+                        b.out<int32_t>(0),
+                        b.in<int32_t>(0),
+                        b.in<int32_t>(1),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_32i_x2_or_32i, b.out<int32_t>(0), b.in<int32_t>(0), b.in<int32_t>(1), n),
+        VOLK_BENCH_CASE(volk_32u_byteswap, b.out<uint32_t>(0), n),
+        VOLK_BENCH_CASE(
+            volk_32u_byteswappuppet_32u, b.out<uint32_t>(0), b.out<uint32_t>(1), n),
+        VOLK_BENCH_CASE(
+            volk_32u_popcntpuppet_32u, b.out<uint32_t>(0), b.in<uint32_t>(0), n),
+        VOLK_BENCH_CASE(volk_32u_reverse_32u, b.out<uint32_t>(0), b.in<uint32_t>(0), n),
+        VOLK_BENCH_CASE(volk_64f_convert_32f, b.out<float>(0), b.in<double>(0), n),
+        VOLK_BENCH_CASE(
+            volk_64f_x2_add_64f, b.out<double>(0), b.in<double>(0), b.in<double>(1), n),
+        VOLK_BENCH_CASE(
+            volk_64f_x2_max_64f, b.out<double>(0), b.in<double>(0), b.in<double>(1), n),
+        VOLK_BENCH_CASE(
+            volk_64f_x2_min_64f, b.out<double>(0), b.in<double>(0), b.in<double>(1), n),
+        VOLK_BENCH_CASE(volk_64f_x2_multiply_64f,
+                        b.out<double>(0),
+                        b.in<double>(0),
+                        b.in<double>(1),
+                        n),
+        VOLK_BENCH_CASE(volk_64u_byteswap, b.out<uint64_t>(0), n),
+        VOLK_BENCH_CASE(
+            volk_64u_byteswappuppet_64u, b.out<uint64_t>(0), b.out<uint64_t>(1), n),
+        VOLK_BENCH_CASE(
+            volk_64u_popcntpuppet_64u, b.out<uint64_t>(0), b.in<uint64_t>(0), n),
+        VOLK_BENCH_CASE(volk_8i_convert_16i, b.out<int16_t>(0), b.in<int8_t>(0), n),
+        VOLK_BENCH_CASE(
+            volk_8i_s32f_convert_32f, b.out<float>(0), b.in<int8_t>(0), 128.0f, n),
+        VOLK_BENCH_CASE(volk_8ic_deinterleave_16i_x2,
+                        b.out<int16_t>(0),
+                        b.out<int16_t>(1),
+                        b.in<c8>(0),
+                        n),
+        VOLK_BENCH_CASE(
+            volk_8ic_deinterleave_real_16i, b.out<int16_t>(0), b.in<c8>(0), n),
+        VOLK_BENCH_CASE(volk_8ic_deinterleave_real_8i, b.out<int8_t>(0), b.in<c8>(0), n),
+        VOLK_BENCH_CASE(volk_8ic_s32f_deinterleave_32f_x2,
+                        b.out<float>(0),
+                        b.out<float>(1),
+                        b.in<c8>(0),
+                        128.0f,
+                        n),
+        VOLK_BENCH_CASE(
+            volk_8ic_s32f_deinterleave_real_32f, b.out<float>(0), b.in<c8>(0), 128.0f, n),
+        VOLK_BENCH_CASE(volk_8ic_x2_multiply_conjugate_16ic,
+                        b.out<c16>(0),
+                        b.in<c8>(0),
+                        b.in<c8>(1),
+                        n),
+        VOLK_BENCH_CASE(volk_8ic_x2_s32f_multiply_conjugate_32fc,
+                        b.out<c32>(0),
+                        b.in<c8>(0),
+                        b.in<c8>(1),
+                        128.0f,
+                        n),
+        // polar frames are powers of two, as are all benchmark sizes
+        VOLK_BENCH_CASE(volk_8u_x2_encodeframepolar_8u, b.out<u8>(0), b.out<u8>(1), n),
+        VOLK_BENCH_CASE(volk_8u_x3_encodepolar_8u_x2,
+                        b.out<u8>(0),
+                        b.out<u8>(1),
+                        b.in<u8>(0),
+                        b.in<u8>(1),
+                        b.in<u8>(2),
+                        n),
+        VOLK_BENCH_CASE(volk_8u_x3_encodepolarpuppet_8u,
+                        b.out<u8>(0),
+                        b.out<u8>(1),
+                        b.in<u8>(1),
+                        b.in<u8>(2),
+                        n),
+        // n decoded bits plus 6 tail bits; the SIMD implementations load the
+        // 64 state metrics Y and X, the branch table and the decisions aligned
+        VOLK_BENCH_CASE(volk_8u_x4_conv_k7_r2_8u,
+                        b.state<u8>(1),
+                        b.state<u8>(1) + 64,
+                        b.in<u8>(0),
+                        b.state<u8>(0),
+                        n,
+                        6u,
+                        b.state<u8>(1) + 128),
+    };
+    return cases;
+}
+
+#undef VOLK_BENCH_CASE
+
+inline bool is_power_of_two(unsigned int n) { return n != 0 && (n & (n - 1)) == 0; }
+
+} // namespace benchmark_detail
+
+//! Sizes, timing and kernel selection of run_kernel_benchmarks()
+struct benchmark_options {
+    //! points per call, powers of two from 16
+    std::vector<unsigned int> sizes = { 16, 256, 4096, 65536, 1048576 };
+    double seconds = 2e-3; //!< minimum length of one timed run
+    int repeats = 3;       //!< the fastest run is kept
+    std::string filter;    //!< substring of the kernels to run, empty for all
+    bool dispatcher = true; //!< also time the volk_* dispatcher
+};
+
+//! One kernel implementation at one size and buffer alignment
+struct kernel_timing {
+    std::string kernel;
+    std::string impl; //!< "dispatcher" for the volk_* entry point
+    bool aligned = true; //!< buffers aligned to volk_get_alignment()
+    unsigned int num_points = 0;
+    double ns_per_point = 0.0;
+    //! the generic implementation, the loop one would write by hand
+    double generic_ns_per_point = 0.0;
+
+    double speedup() const
+    {
+        return ns_per_point > 0.0 ? generic_ns_per_point / ns_per_point : 0.0;
+    }
+};
+
+//! Results of run_kernel_benchmarks(), or a stored baseline
+struct benchmark_run {
+    std::string version;
+    std::string machine;
+    unsigned int lvarch = 0;
+    std::vector<kernel_timing> timings;
+    std::vector<std::pair<std::string, std::string>> skipped; //!< kernel, reason
+};
+
+/*!
+ * \brief Times every implementation of every kernel in volk.h
+ *
+ * \details
+ *   Each implementation the CPU supports runs through its *_manual entry
+ *   point at every size. Aligned (a_) implementations get aligned buffers;
+ *   the others run once on aligned buffers and once with every pointer
+ *   shifted by one element, which is what an unaligned caller pays. The
+ *   dispatcher is timed the same way. Every timing also carries the generic
+ *   time at the same size and alignment, so speedup() compares against the
+ *   scalar loop.
+ *
+ *   A kernel that has no per-point workload, or whose puppet stands in for
+ *   it as in volk_profile, is listed in skipped with the reason. With the
+ *   default options a full run takes a few minutes; filter narrows it to
+ *   the kernels of interest.
+ *
+ * example code:
+ *   volk::benchmark_run run = volk::run_kernel_benchmarks();
+ *   volk::write_benchmark_csv("volk_bench.csv", run);
+ *   json_object* baseline = json_object_from_file("volk_bench_baseline.json");
+ *   if (baseline) {
+ *       for (const auto& r : volk::compare_to_baseline(run, volk::from_json(baseline)))
+ *           printf("%s %s %u: %.2fx slower\n",
+ *                  r.kernel.c_str(), r.impl.c_str(), r.num_points, r.ratio());
+ *       json_object_put(baseline);
+ *   }
+ */
+inline benchmark_run run_kernel_benchmarks(const benchmark_options& options = {})
+{
+    if (options.sizes.empty() || options.repeats < 1)
+        throw std::invalid_argument("run_kernel_benchmarks: no sizes or repeats");
+    for (unsigned int n : options.sizes) {
+        if (n < 16 || !benchmark_detail::is_power_of_two(n))
+            throw std::invalid_argument(
+                "run_kernel_benchmarks: sizes must be powers of two from 16");
+    }
+
+    benchmark_run run;
+    run.version = std::to_string(VOLK_VERSION_MAJOR) + "." +
+                  std::to_string(VOLK_VERSION_MINOR) + "." +
+                  std::to_string(VOLK_VERSION_MAINT);
+    run.machine = volk_get_machine();
+    run.lvarch = volk_get_lvarch();
+
+    const unsigned int max_points =
+        *std::max_element(options.sizes.begin(), options.sizes.end());
+    benchmark_detail::buffers buffers(max_points);
+
+    const auto ns_per_point = [&](const benchmark_detail::bench_case& c,
+                                  const char* impl,
+                                  unsigned int n) {
+        c.run(buffers, n, impl); // warm up caches and resolve the dispatcher
+        double best = std::numeric_limits<double>::infinity();
+        for (int rep = 0; rep < options.repeats; rep++) {
+            std::size_t calls = 0;
+            const auto start = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed(0.0);
+            do {
+                c.run(buffers, n, impl);
+                calls++;
+                elapsed = std::chrono::steady_clock::now() - start;
+            } while (elapsed.count() < options.seconds);
+            best = std::min(best, elapsed.count() / (double(calls) * n));
+        }
+        return best * 1e9;
+    };
+
+    const auto& cases = benchmark_detail::bench_cases();
+    for (const auto& k : report_detail::kernel_table()) {
+        if (!options.filter.empty() &&
+            std::string(k.name).find(options.filter) == std::string::npos)
+            continue;
+        const auto skip = std::find_if(
+            benchmark_detail::skipped_kernels().begin(),
+            benchmark_detail::skipped_kernels().end(),
+            [&](const benchmark_detail::skipped_kernel& s) {
+                return std::strcmp(s.name, k.name) == 0;
+            });
+        if (skip != benchmark_detail::skipped_kernels().end()) {
+            run.skipped.emplace_back(k.name, skip->reason);
+            continue;
+        }
+        const auto c = std::find_if(
+            cases.begin(), cases.end(), [&](const benchmark_detail::bench_case& b) {
+                return std::strcmp(b.name, k.name) == 0;
+            });
+        if (c == cases.end()) {
+            run.skipped.emplace_back(k.name, "no benchmark case");
+            continue;
+        }
+
+        // runnable implementations, generic first for the reference time
+        const volk_func_desc_t desc = k.desc();
+        std::vector<std::pair<const char*, bool>> impls; // name, aligned only
+        for (std::size_t i = 0; i < desc.n_impls; i++) {
+            if ((unsigned int)desc.impl_deps[i] & ~run.lvarch)
+                continue;
+            impls.emplace_back(desc.impl_names[i], desc.impl_alignment[i]);
+        }
+        std::stable_partition(impls.begin(), impls.end(), [](const auto& impl) {
+            return std::strcmp(impl.first, "generic") == 0;
+        });
+        if (impls.empty() || std::strcmp(impls.front().first, "generic") != 0) {
+            run.skipped.emplace_back(k.name, "no generic implementation");
+            continue;
+        }
+        if (options.dispatcher)
+            impls.emplace_back(nullptr, false);
+
+        buffers.reset_outputs();
+        for (unsigned int n : options.sizes) {
+            for (const bool aligned : { true, false }) {
+                buffers.set_misaligned(!aligned);
+                double generic = 0.0;
+                for (const auto& impl : impls) {
+                    if (impl.second && !aligned)
+                        continue;
+                    kernel_timing t;
+                    t.kernel = k.name;
+                    t.impl = impl.first ? impl.first : "dispatcher";
+                    t.aligned = aligned;
+                    t.num_points = n;
+                    t.ns_per_point = ns_per_point(*c, impl.first, n);
+                    if (generic == 0.0)
+                        generic = t.ns_per_point;
+                    t.generic_ns_per_point = generic;
+                    run.timings.push_back(std::move(t));
+                }
+            }
+        }
+        buffers.set_misaligned(false);
+    }
+    return run;
+}
+
+/*!
+ * \brief Converts a benchmark run to a new json-c object
+ *
+ * \details
+ *   The caller owns the returned object and releases it with
+ *   json_object_put(). Written with json_object_to_file() it is the
+ *   baseline format read back by from_json().
+ */
+inline json_object* to_json(const benchmark_run& run)
+{
+    json_object* obj = json_object_new_object();
+    json_object_object_add(
+        obj, "volk_version", json_object_new_string(run.version.c_str()));
+    json_object_object_add(obj, "machine", json_object_new_string(run.machine.c_str()));
+    json_object_object_add(obj, "lvarch", json_object_new_int64(int64_t(run.lvarch)));
+
+    json_object* timings = json_object_new_array();
+    for (const auto& t : run.timings) {
+        json_object* tobj = json_object_new_object();
+        json_object_object_add(tobj, "kernel", json_object_new_string(t.kernel.c_str()));
+        json_object_object_add(tobj, "impl", json_object_new_string(t.impl.c_str()));
+        json_object_object_add(tobj, "aligned", json_object_new_boolean(t.aligned));
+        json_object_object_add(tobj, "num_points", json_object_new_int64(t.num_points));
+        json_object_object_add(
+            tobj, "ns_per_point", json_object_new_double(t.ns_per_point));
+        json_object_object_add(
+            tobj, "generic_ns_per_point", json_object_new_double(t.generic_ns_per_point));
+        json_object_object_add(tobj, "speedup", json_object_new_double(t.speedup()));
+        json_object_array_add(timings, tobj);
+    }
+    json_object_object_add(obj, "timings", timings);
+
+    json_object* skipped = json_object_new_object();
+    for (const auto& s : run.skipped)
+        json_object_object_add(
+            skipped, s.first.c_str(), json_object_new_string(s.second.c_str()));
+    json_object_object_add(obj, "skipped", skipped);
+    return obj;
+}
+
+//! Reads a run written by to_json(benchmark_run); missing fields stay empty
+inline benchmark_run from_json(json_object* obj)
+{
+    const auto field = [](json_object* o, const char* key) {
+        json_object* value = nullptr;
+        return json_object_object_get_ex(o, key, &value) ? value : nullptr;
+    };
+    const auto string = [&](json_object* o, const char* key) {
+        json_object* value = field(o, key);
+        return value ? std::string(json_object_get_string(value)) : std::string();
+    };
+
+    benchmark_run run;
+    run.version = string(obj, "volk_version");
+    run.machine = string(obj, "machine");
+    if (json_object* lvarch = field(obj, "lvarch"))
+        run.lvarch = (unsigned int)json_object_get_int64(lvarch);
+
+    json_object* timings = field(obj, "timings");
+    const std::size_t count =
+        json_object_is_type(timings, json_type_array) ? json_object_array_length(timings)
+                                                      : 0;
+    for (std::size_t i = 0; i < count; i++) {
+        json_object* tobj = json_object_array_get_idx(timings, i);
+        kernel_timing t;
+        t.kernel = string(tobj, "kernel");
+        t.impl = string(tobj, "impl");
+        t.aligned = json_object_get_boolean(field(tobj, "aligned"));
+        t.num_points = (unsigned int)json_object_get_int64(field(tobj, "num_points"));
+        t.ns_per_point = json_object_get_double(field(tobj, "ns_per_point"));
+        t.generic_ns_per_point =
+            json_object_get_double(field(tobj, "generic_ns_per_point"));
+        run.timings.push_back(std::move(t));
+    }
+
+    json_object* skipped = field(obj, "skipped");
+    if (json_object_is_type(skipped, json_type_object)) {
+        json_object_object_foreach(skipped, key, value)
+        {
+            run.skipped.emplace_back(key, json_object_get_string(value));
+        }
+    }
+    return run;
+}
+
+/*!
+ * \brief One timing per line, with a header
+ *
+ * \details
+ *   Columns: kernel, impl, aligned (0 / 1), num_points, ns_per_point,
+ *   generic_ns_per_point, speedup.
+ */
+inline std::string to_csv(const benchmark_run& run)
+{
+    std::string csv =
+        "kernel,impl,aligned,num_points,ns_per_point,generic_ns_per_point,speedup\n";
+    char line[256];
+    for (const auto& t : run.timings) {
+        std::snprintf(line,
+                      sizeof(line),
+                      "%s,%s,%d,%u,%.6g,%.6g,%.4g\n",
+                      t.kernel.c_str(),
+                      t.impl.c_str(),
+                      t.aligned ? 1 : 0,
+                      t.num_points,
+                      t.ns_per_point,
+                      t.generic_ns_per_point,
+                      t.speedup());
+        csv += line;
+    }
+    return csv;
+}
+
+//! Writes to_csv(run) to path, returns false when the file cannot be written
+inline bool write_benchmark_csv(const std::string& path, const benchmark_run& run)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const std::string csv = to_csv(run);
+    const bool ok = std::fwrite(csv.data(), 1, csv.size(), file) == csv.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+//! A timing slower than its baseline, or gone from the current run
+struct benchmark_regression {
+    std::string kernel;
+    std::string impl;
+    bool aligned = true;
+    unsigned int num_points = 0;
+    double baseline_ns_per_point = 0.0;
+    double ns_per_point = 0.0; //!< 0 when the implementation is gone
+
+    bool missing() const { return ns_per_point == 0.0; }
+    double ratio() const
+    {
+        return baseline_ns_per_point > 0.0 ? ns_per_point / baseline_ns_per_point : 0.0;
+    }
+};
+
+/*!
+ * \brief Timings of baseline that current missed by more than tolerance
+ *
+ * \details
+ *   Matches timings by kernel, implementation, alignment and size. A
+ *   timing is a regression when it is more than 1 + tolerance times its
+ *   baseline, or when the baseline has it and current, run over the same
+ *   kernels, does not, as when an upgrade drops an implementation. Only
+ *   kernels present in current are checked, so a filtered run compares
+ *   against a full baseline. Timings only in current are new and ignored.
+ *
+ *   Baselines only compare on the same machine: check machine and lvarch
+ *   of both runs first. Timings on a loaded or frequency scaling host vary
+ *   by more than the default tolerance at the smallest sizes.
+ */
+inline std::vector<benchmark_regression> compare_to_baseline(
+    const benchmark_run& current, const benchmark_run& baseline, double tolerance = 0.15)
+{
+    using key = std::tuple<std::string, std::string, bool, unsigned int>;
+    std::map<key, double> now;
+    std::set<std::string> kernels;
+    for (const auto& t : current.timings) {
+        now[key(t.kernel, t.impl, t.aligned, t.num_points)] = t.ns_per_point;
+        kernels.insert(t.kernel);
+    }
+
+    std::vector<benchmark_regression> regressions;
+    for (const auto& base : baseline.timings) {
+        if (kernels.count(base.kernel) == 0)
+            continue;
+        const auto it =
+            now.find(key(base.kernel, base.impl, base.aligned, base.num_points));
+        const double ns = it != now.end() ? it->second : 0.0;
+        if (ns == 0.0 || ns > base.ns_per_point * (1.0 + tolerance)) {
+            regressions.push_back({ base.kernel,
+                                    base.impl,
+                                    base.aligned,
+                                    base.num_points,
+                                    base.ns_per_point,
+                                    ns });
+        }
+    }
+    return regressions;
+}
+
+} // namespace volk
+#endif // INCLUDED_VOLK_BENCHMARK_H
@@ -0,0 +1,493 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_BIND_H
+#define INCLUDED_VOLK_BIND_H
+
+/*
+ * The kernel headers only compile the implementations whose LV_HAVE_*
+ * macro is set. Enable the ones the compiler targets for this translation
+ * unit. This header has to come before any kernel header it binds, which
+ * would otherwise be included without them.
+ */
+#ifndef LV_HAVE_GENERIC
+#define LV_HAVE_GENERIC 1
+#endif
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#ifndef LV_HAVE_SSE
+#define LV_HAVE_SSE 1
+#endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#ifndef LV_HAVE_SSE2
+#define LV_HAVE_SSE2 1
+#endif
+#endif
+// MSVC only announces /arch:AVX and up, which imply SSE3 to SSE4.1
+#if defined(__SSE3__) || defined(__AVX__)
+#ifndef LV_HAVE_SSE3
+#define LV_HAVE_SSE3 1
+#endif
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#ifndef LV_HAVE_SSSE3
+#define LV_HAVE_SSSE3 1
+#endif
+#endif
+#if defined(__SSE4_1__) || defined(__AVX__)
+#ifndef LV_HAVE_SSE4_1
+#define LV_HAVE_SSE4_1 1
+#endif
+#endif
+#if defined(__AVX__)
+#ifndef LV_HAVE_AVX
+#define LV_HAVE_AVX 1
+#endif
+#endif
+#if defined(__AVX2__)
+#ifndef LV_HAVE_AVX2
+#define LV_HAVE_AVX2 1
+#endif
+#endif
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#ifndef LV_HAVE_FMA
+#define LV_HAVE_FMA 1
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#ifndef LV_HAVE_NEON
+#define LV_HAVE_NEON 1
+#endif
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <volk/volk.h>
+
+// some kernels memset lv_32fc_t, which is std::complex in C++
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wclass-memaccess"
+#endif
+#include <volk/volk_32f_s32f_multiply_32f.h>
+#include <volk/volk_32f_x2_add_32f.h>
+#include <volk/volk_32f_x2_dot_prod_32f.h>
+#include <volk/volk_32f_x2_multiply_32f.h>
+#include <volk/volk_32fc_32f_dot_prod_32fc.h>
+#include <volk/volk_32fc_32f_multiply_32fc.h>
+#include <volk/volk_32fc_conjugate_32fc.h>
+#include <volk/volk_32fc_magnitude_squared_32f.h>
+#include <volk/volk_32fc_s32fc_multiply2_32fc.h>
+#include <volk/volk_32fc_s32fc_x2_rotator2_32fc.h>
+#include <volk/volk_32fc_x2_add_32fc.h>
+#include <volk/volk_32fc_x2_dot_prod_32fc.h>
+#include <volk/volk_32fc_x2_multiply_32fc.h>
+#include <volk/volk_32fc_x2_multiply_conjugate_32fc.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+__VOLK_DECL_BEGIN
+// exported by libvolk, declared in the private volk_rank_archs.h
+VOLK_API int volk_rank_archs(const char* kern_name,
+                             const char* impl_names[],
+                             const int* impl_deps,
+                             const bool* alignment,
+                             size_t n_impls,
+                             const bool align);
+__VOLK_DECL_END
+
+namespace volk {
+
+//! Instruction set levels an implementation can be bound to
+enum class arch {
+    generic,
+    sse,
+    sse2,
+    sse3,
+    ssse3,
+    sse4_1,
+    avx,
+    avx_fma,
+    avx2,
+    avx2_fma,
+    neon,
+};
+
+//! Highest level the compiler targets in this translation unit
+constexpr arch compiled_arch =
+#if defined(LV_HAVE_AVX2) && defined(LV_HAVE_FMA)
+    arch::avx2_fma;
+#elif defined(LV_HAVE_AVX2)
+    arch::avx2;
+#elif defined(LV_HAVE_AVX) && defined(LV_HAVE_FMA)
+    arch::avx_fma;
+#elif defined(LV_HAVE_AVX)
+    arch::avx;
+#elif defined(LV_HAVE_SSE4_1)
+    arch::sse4_1;
+#elif defined(LV_HAVE_SSSE3)
+    arch::ssse3;
+#elif defined(LV_HAVE_SSE3)
+    arch::sse3;
+#elif defined(LV_HAVE_SSE2)
+    arch::sse2;
+#elif defined(LV_HAVE_SSE)
+    arch::sse;
+#elif defined(LV_HAVE_NEON)
+    arch::neon;
+#else
+    arch::generic;
+#endif
+
+namespace bind_detail {
+
+enum : unsigned int {
+    f_sse = 1 << 0,
+    f_sse2 = 1 << 1,
+    f_sse3 = 1 << 2,
+    f_ssse3 = 1 << 3,
+    f_sse4_1 = 1 << 4,
+    f_avx = 1 << 5,
+    f_avx2 = 1 << 6,
+    f_fma = 1 << 7,
+    f_neon = 1 << 8,
+};
+
+constexpr unsigned int features(arch a)
+{
+    return a == arch::generic    ? 0u
+           : a == arch::sse      ? f_sse
+           : a == arch::sse2     ? features(arch::sse) | f_sse2
+           : a == arch::sse3     ? features(arch::sse2) | f_sse3
+           : a == arch::ssse3    ? features(arch::sse3) | f_ssse3
+           : a == arch::sse4_1   ? features(arch::ssse3) | f_sse4_1
+           : a == arch::avx      ? features(arch::sse4_1) | f_avx
+           : a == arch::avx_fma  ? features(arch::avx) | f_fma
+           : a == arch::avx2     ? features(arch::avx) | f_avx2
+           : a == arch::avx2_fma ? features(arch::avx2) | f_fma
+                                 : f_neon;
+}
+
+//! true when code built for level runs wherever target does
+constexpr bool includes(arch target, arch level)
+{
+    return (features(level) & ~features(target)) == 0;
+}
+
+// levels in order of preference, generic last
+constexpr arch preference[] = { arch::avx2_fma, arch::avx2,   arch::avx_fma,
+                                arch::avx,      arch::sse4_1, arch::ssse3,
+                                arch::sse3,     arch::sse2,   arch::sse,
+                                arch::neon,     arch::generic };
+constexpr std::size_t num_levels = sizeof(preference) / sizeof(preference[0]);
+
+// specialized by VOLK_BIND_ALIGNED / VOLK_BIND_UNALIGNED
+template <class K, arch A>
+struct impl_a {
+    static constexpr bool available = false;
+};
+
+template <class K, arch A>
+struct impl_u {
+    static constexpr bool available = false;
+};
+
+/*
+ * First implementation in preference order that A can run. An aligned
+ * call takes the unaligned implementation of a level before falling back
+ * to a lower one.
+ */
+template <class K, arch A, bool Aligned, std::size_t I = 0>
+struct resolve {
+    static constexpr arch level = preference[I];
+    static constexpr bool usable = includes(A, level);
+    using type = typename std::conditional<
+        usable && Aligned && impl_a<K, level>::available,
+        impl_a<K, level>,
+        typename std::conditional<usable && impl_u<K, level>::available,
+                                  impl_u<K, level>,
+                                  resolve<K, A, Aligned, I + 1>>::type>::type;
+    static constexpr typename K::pointer fn = type::fn;
+    static constexpr const char* name = type::name;
+    static constexpr arch bound_arch = type::bound_arch;
+};
+
+template <class K, arch A, bool Aligned>
+struct resolve<K, A, Aligned, num_levels>; // every kernel has a generic
+
+// one compiled in implementation, for the runtime ranking
+template <class K>
+struct candidate {
+    typename K::pointer fn;
+    const char* name;
+    bool aligned;
+};
+
+template <class K, std::size_t I = 0>
+void collect(std::vector<candidate<K>>& out)
+{
+    if constexpr (I < num_levels) {
+        constexpr arch level = preference[I];
+        if constexpr (includes(compiled_arch, level)) {
+            if constexpr (impl_a<K, level>::available)
+                out.push_back({ impl_a<K, level>::fn, impl_a<K, level>::name, true });
+            if constexpr (impl_u<K, level>::available)
+                out.push_back({ impl_u<K, level>::fn, impl_u<K, level>::name, false });
+        }
+        collect<K, I + 1>(out);
+    }
+}
+
+} // namespace bind_detail
+
+/*!
+ * \brief Compile time binding of a VOLK kernel to one implementation
+ *
+ * \details
+ *   Every volk_* call goes through the dispatcher function pointer, and the
+ *   default dispatcher checks the buffer alignment with volk_is_aligned
+ *   before a second indirect call. For a few dozen points per call this
+ *   costs more than the kernel itself. bind<K, A> names the best
+ *   implementation from the kernel headers that level A can run, as a
+ *   constant function pointer, so the compiler calls it directly and can
+ *   inline it into the caller's loop. A defaults to compiled_arch, the
+ *   instruction set this translation unit is compiled for.
+ *
+ *   a() requires every buffer to be aligned to volk_get_alignment(), as
+ *   returned by volk_malloc and volk::vector. u() accepts any alignment.
+ *   Only kernels declared with VOLK_BIND_KERNEL can be bound; the common
+ *   per symbol kernels are declared below, more can be added the same way
+ *   together with their VOLK_BIND_ALIGNED / VOLK_BIND_UNALIGNED entries.
+ *
+ * example code:
+ *   using mul = volk::bind<volk::kernels::volk_32fc_x2_multiply_32fc>;
+ *   for (std::size_t s = 0; s < num_symbols; s++)
+ *       mul::a(out + 64 * s, in + 64 * s, pilots, 64);
+ *
+ *   // or pin a level, for a translation unit built with -mavx2 -mfma
+ *   volk::bind<volk::kernels::volk_32fc_x2_multiply_32fc, volk::arch::avx2>::u(c, a, b, 16);
+ */
+template <class K, arch A = compiled_arch>
+struct bind {
+    static_assert(bind_detail::includes(compiled_arch, A),
+                  "volk::bind: arch not enabled for this translation unit");
+
+    using pointer = typename K::pointer;
+    using aligned_impl = bind_detail::resolve<K, A, true>;
+    using unaligned_impl = bind_detail::resolve<K, A, false>;
+
+    static constexpr pointer a = aligned_impl::fn;
+    static constexpr pointer u = unaligned_impl::fn;
+
+    //! Implementation names, as listed by volk_profile
+    static constexpr const char* name_a = aligned_impl::name;
+    static constexpr const char* name_u = unaligned_impl::name;
+};
+
+/*!
+ * \brief Picks a compiled in implementation once at init
+ *
+ * \details
+ *   Ranks the implementations of K that this translation unit compiled the
+ *   same way the dispatcher does: by the features of the running CPU and
+ *   the volk_profile results in volk_config. The returned pointer calls the
+ *   inline implementation directly, without the alignment check, so pass
+ *   aligned = true only for buffers aligned to volk_get_alignment().
+ *   Implementations libvolk does not know are skipped; when none is left
+ *   the compile time choice is returned.
+ *
+ * example code:
+ *   static const auto mul = volk::resolve<volk::kernels::volk_32fc_x2_multiply_32fc>(true);
+ *   mul(out, in, pilots, 64);
+ */
+template <class K>
+typename K::pointer resolve(bool aligned)
+{
+    std::vector<bind_detail::candidate<K>> all;
+    bind_detail::collect<K>(all);
+
+    // dependencies as registered in libvolk, matched by name
+    const volk_func_desc_t desc = K::desc();
+    std::vector<bind_detail::candidate<K>> known;
+    std::vector<const char*> names;
+    std::vector<int> deps;
+    for (const auto& c : all) {
+        for (std::size_t i = 0; i < desc.n_impls; i++) {
+            if (std::strcmp(desc.impl_names[i], c.name) == 0) {
+                known.push_back(c);
+                names.push_back(c.name);
+                deps.push_back(desc.impl_deps[i]);
+                break;
+            }
+        }
+    }
+    if (known.empty())
+        return aligned ? bind<K>::a : bind<K>::u;
+
+    std::unique_ptr<bool[]> alignment(new bool[known.size()]);
+    for (std::size_t i = 0; i < known.size(); i++)
+        alignment[i] = known[i].aligned;
+    const int index = volk_rank_archs(
+        K::name, names.data(), deps.data(), alignment.get(), known.size(), aligned);
+    if (index < 0 || std::size_t(index) >= known.size())
+        return aligned ? bind<K>::a : bind<K>::u;
+    return known[index].fn;
+}
+
+} // namespace volk
+
+/*!
+ * Declares volk::kernels::kernel for the dispatcher of the same name in
+ * volk.h. These macros are used at global scope.
+ */
+#define VOLK_BIND_KERNEL(kernel)                                               \
+    namespace volk {                                                           \
+    namespace kernels {                                                        \
+    struct kernel {                                                            \
+        using pointer = decltype(::kernel);                                    \
+        static constexpr const char* name = #kernel;                           \
+        static volk_func_desc_t desc() { return ::kernel##_get_func_desc(); } \
+    };                                                                         \
+    }                                                                          \
+    }
+
+#define VOLK_BIND_IMPL_(trait, kernel, level, impl)                       \
+    namespace volk {                                                      \
+    namespace bind_detail {                                               \
+    template <>                                                           \
+    struct trait<kernels::kernel, arch::level> {                          \
+        static constexpr bool available = true;                           \
+        static constexpr kernels::kernel::pointer fn = &::kernel##_##impl; \
+        static constexpr const char* name = #kernel "_" #impl;            \
+        static constexpr arch bound_arch = arch::level;                   \
+    };                                                                    \
+    }                                                                     \
+    }
+
+//! Registers kernel_impl as the aligned implementation at level
+#define VOLK_BIND_ALIGNED(kernel, level, impl) VOLK_BIND_IMPL_(impl_a, kernel, level, impl)
+
+//! Registers kernel_impl as the unaligned implementation at level
+#define VOLK_BIND_UNALIGNED(kernel, level, impl) \
+    VOLK_BIND_IMPL_(impl_u, kernel, level, impl)
+
+//! kernel_a_suffix and kernel_u_suffix at level
+#define VOLK_BIND_PAIR(kernel, level, suffix)      \
+    VOLK_BIND_ALIGNED(kernel, level, a_##suffix)   \
+    VOLK_BIND_UNALIGNED(kernel, level, u_##suffix)
+
+VOLK_BIND_KERNEL(volk_32f_s32f_multiply_32f)
+VOLK_BIND_KERNEL(volk_32f_x2_add_32f)
+VOLK_BIND_KERNEL(volk_32f_x2_dot_prod_32f)
+VOLK_BIND_KERNEL(volk_32f_x2_multiply_32f)
+VOLK_BIND_KERNEL(volk_32fc_32f_dot_prod_32fc)
+VOLK_BIND_KERNEL(volk_32fc_32f_multiply_32fc)
+VOLK_BIND_KERNEL(volk_32fc_conjugate_32fc)
+VOLK_BIND_KERNEL(volk_32fc_magnitude_squared_32f)
+VOLK_BIND_KERNEL(volk_32fc_s32fc_multiply2_32fc)
+VOLK_BIND_KERNEL(volk_32fc_s32fc_x2_rotator2_32fc)
+VOLK_BIND_KERNEL(volk_32fc_x2_add_32fc)
+VOLK_BIND_KERNEL(volk_32fc_x2_dot_prod_32fc)
+VOLK_BIND_KERNEL(volk_32fc_x2_multiply_32fc)
+VOLK_BIND_KERNEL(volk_32fc_x2_multiply_conjugate_32fc)
+
+// the generic implementations run anywhere and need no alignment
+VOLK_BIND_UNALIGNED(volk_32f_s32f_multiply_32f, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32f_x2_add_32f, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32f_x2_dot_prod_32f, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32f_x2_multiply_32f, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_32f_dot_prod_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_32f_multiply_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_conjugate_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_magnitude_squared_32f, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_s32fc_multiply2_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_s32fc_x2_rotator2_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_add_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_dot_prod_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_multiply_32fc, generic, generic)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_multiply_conjugate_32fc, generic, generic)
+
+#ifdef LV_HAVE_SSE
+VOLK_BIND_PAIR(volk_32f_s32f_multiply_32f, sse, sse)
+VOLK_BIND_PAIR(volk_32f_x2_add_32f, sse, sse)
+VOLK_BIND_PAIR(volk_32f_x2_dot_prod_32f, sse, sse)
+VOLK_BIND_PAIR(volk_32f_x2_multiply_32f, sse, sse)
+VOLK_BIND_PAIR(volk_32fc_32f_dot_prod_32fc, sse, sse)
+VOLK_BIND_ALIGNED(volk_32fc_32f_multiply_32fc, sse, a_sse)
+VOLK_BIND_PAIR(volk_32fc_magnitude_squared_32f, sse, sse)
+VOLK_BIND_PAIR(volk_32fc_x2_add_32fc, sse, sse)
+#endif
+
+#ifdef LV_HAVE_SSE3
+VOLK_BIND_PAIR(volk_32f_x2_dot_prod_32f, sse3, sse3)
+VOLK_BIND_PAIR(volk_32fc_conjugate_32fc, sse3, sse3)
+VOLK_BIND_PAIR(volk_32fc_magnitude_squared_32f, sse3, sse3)
+VOLK_BIND_PAIR(volk_32fc_s32fc_multiply2_32fc, sse3, sse3)
+VOLK_BIND_PAIR(volk_32fc_x2_dot_prod_32fc, sse3, sse3)
+VOLK_BIND_PAIR(volk_32fc_x2_multiply_32fc, sse3, sse3)
+VOLK_BIND_PAIR(volk_32fc_x2_multiply_conjugate_32fc, sse3, sse3)
+#endif
+
+#ifdef LV_HAVE_SSE4_1
+VOLK_BIND_PAIR(volk_32f_x2_dot_prod_32f, sse4_1, sse4_1)
+VOLK_BIND_PAIR(volk_32fc_s32fc_x2_rotator2_32fc, sse4_1, sse4_1)
+#endif
+
+#ifdef LV_HAVE_AVX
+VOLK_BIND_PAIR(volk_32f_s32f_multiply_32f, avx, avx)
+VOLK_BIND_PAIR(volk_32f_x2_add_32f, avx, avx)
+VOLK_BIND_PAIR(volk_32f_x2_dot_prod_32f, avx, avx)
+VOLK_BIND_PAIR(volk_32f_x2_multiply_32f, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_32f_dot_prod_32fc, avx, avx)
+VOLK_BIND_ALIGNED(volk_32fc_32f_multiply_32fc, avx, a_avx)
+VOLK_BIND_PAIR(volk_32fc_conjugate_32fc, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_magnitude_squared_32f, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_s32fc_multiply2_32fc, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_s32fc_x2_rotator2_32fc, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_x2_add_32fc, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_x2_dot_prod_32fc, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_x2_multiply_32fc, avx, avx)
+VOLK_BIND_PAIR(volk_32fc_x2_multiply_conjugate_32fc, avx, avx)
+#endif
+
+#if defined(LV_HAVE_AVX) && defined(LV_HAVE_FMA)
+VOLK_BIND_PAIR(volk_32fc_s32fc_multiply2_32fc, avx_fma, avx_fma)
+VOLK_BIND_PAIR(volk_32fc_s32fc_x2_rotator2_32fc, avx_fma, avx_fma)
+VOLK_BIND_PAIR(volk_32fc_x2_dot_prod_32fc, avx_fma, avx_fma)
+#endif
+
+#if defined(LV_HAVE_AVX2) && defined(LV_HAVE_FMA)
+VOLK_BIND_PAIR(volk_32f_x2_dot_prod_32f, avx2_fma, avx2_fma)
+VOLK_BIND_PAIR(volk_32fc_32f_dot_prod_32fc, avx2_fma, avx2_fma)
+VOLK_BIND_PAIR(volk_32fc_x2_multiply_32fc, avx2_fma, avx2_fma)
+#endif
+
+#ifdef LV_HAVE_NEON
+VOLK_BIND_UNALIGNED(volk_32f_s32f_multiply_32f, neon, u_neon)
+VOLK_BIND_UNALIGNED(volk_32f_x2_add_32f, neon, u_neon)
+VOLK_BIND_UNALIGNED(volk_32f_x2_dot_prod_32f, neon, neon)
+VOLK_BIND_UNALIGNED(volk_32f_x2_multiply_32f, neon, neon)
+VOLK_BIND_ALIGNED(volk_32fc_32f_dot_prod_32fc, neon, a_neon)
+VOLK_BIND_UNALIGNED(volk_32fc_32f_multiply_32fc, neon, neon)
+VOLK_BIND_ALIGNED(volk_32fc_conjugate_32fc, neon, a_neon)
+VOLK_BIND_UNALIGNED(volk_32fc_magnitude_squared_32f, neon, neon)
+VOLK_BIND_UNALIGNED(volk_32fc_s32fc_multiply2_32fc, neon, neon)
+VOLK_BIND_UNALIGNED(volk_32fc_s32fc_x2_rotator2_32fc, neon, neon)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_add_32fc, neon, u_neon)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_dot_prod_32fc, neon, neon)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_multiply_32fc, neon, neon)
+VOLK_BIND_UNALIGNED(volk_32fc_x2_multiply_conjugate_32fc, neon, neon)
+#endif
+
+#endif // INCLUDED_VOLK_BIND_H
@@ -0,0 +1,412 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_CFAR_H
+#define INCLUDED_VOLK_CFAR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+#include <volk/volk_parallel.hh>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace volk {
+
+namespace cfar_detail {
+
+/*
+ * The training cells of one bin, kept sorted. Sliding the window by one
+ * bin replaces the cell that leaves with the one that enters, moving only
+ * the values ranked between the two. Ranks are counted with SIMD compares
+ * instead of a binary search, whose branches are unpredictable on noise.
+ */
+class sorted_window
+{
+public:
+    void assign(const float* cells, std::size_t n)
+    {
+        d_size = 0;
+        append(cells, n);
+    }
+
+    void append(const float* cells, std::size_t n)
+    {
+        // padded with +inf up to a multiple of 8, never counted as below
+        d_v.resize((d_size + n + 7) / 8 * 8);
+        std::copy(cells, cells + n, d_v.begin() + d_size);
+        d_size += n;
+        std::fill(d_v.begin() + d_size, d_v.end(), std::numeric_limits<float>::infinity());
+        std::sort(d_v.begin(), d_v.begin() + d_size);
+    }
+
+    void replace(float old_value, float new_value)
+    {
+        std::size_t p, q;
+        count_below(old_value, new_value, p, q);
+        float* v = d_v.data();
+        if (q > p) {
+            std::memmove(v + p, v + p + 1, (q - p - 1) * sizeof(float));
+            v[q - 1] = new_value;
+        } else {
+            std::memmove(v + q + 1, v + q, (p - q) * sizeof(float));
+            v[q] = new_value;
+        }
+    }
+
+    //! rank-th smallest value, 1-based
+    float kth(unsigned int rank) const { return d_v[rank - 1]; }
+
+private:
+    void count_below(float a, float b, std::size_t& na, std::size_t& nb) const
+    {
+        const float* v = d_v.data();
+#if defined(__AVX__)
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 va = _mm256_set1_ps(a);
+        const __m256 vb = _mm256_set1_ps(b);
+        __m256 acc_a = _mm256_setzero_ps();
+        __m256 acc_b = _mm256_setzero_ps();
+        for (std::size_t i = 0; i < d_v.size(); i += 8) {
+            const __m256 x = _mm256_load_ps(v + i);
+            acc_a = _mm256_add_ps(acc_a, _mm256_and_ps(_mm256_cmp_ps(x, va, _CMP_LT_OQ), one));
+            acc_b = _mm256_add_ps(acc_b, _mm256_and_ps(_mm256_cmp_ps(x, vb, _CMP_LT_OQ), one));
+        }
+        __VOLK_ATTR_ALIGNED(32) float sum[8];
+        _mm256_store_ps(sum, _mm256_hadd_ps(acc_a, acc_b));
+        na = static_cast<std::size_t>(sum[0] + sum[1] + sum[4] + sum[5]);
+        nb = static_cast<std::size_t>(sum[2] + sum[3] + sum[6] + sum[7]);
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 va = _mm_set1_ps(a);
+        const __m128 vb = _mm_set1_ps(b);
+        __m128 acc_a = _mm_setzero_ps();
+        __m128 acc_b = _mm_setzero_ps();
+        for (std::size_t i = 0; i < d_v.size(); i += 4) {
+            const __m128 x = _mm_load_ps(v + i);
+            acc_a = _mm_add_ps(acc_a, _mm_and_ps(_mm_cmplt_ps(x, va), one));
+            acc_b = _mm_add_ps(acc_b, _mm_and_ps(_mm_cmplt_ps(x, vb), one));
+        }
+        __VOLK_ATTR_ALIGNED(16) float sum_a[4], sum_b[4];
+        _mm_store_ps(sum_a, acc_a);
+        _mm_store_ps(sum_b, acc_b);
+        na = static_cast<std::size_t>(sum_a[0] + sum_a[1] + sum_a[2] + sum_a[3]);
+        nb = static_cast<std::size_t>(sum_b[0] + sum_b[1] + sum_b[2] + sum_b[3]);
+#else
+        na = nb = 0;
+        for (std::size_t i = 0; i < d_size; i++) {
+            na += v[i] < a;
+            nb += v[i] < b;
+        }
+#endif
+    }
+
+    volk::vector<float> d_v;
+    std::size_t d_size = 0;
+};
+
+} // namespace cfar_detail
+
+/*!
+ * \brief Sliding window CFAR detector over linear power spectrum frames
+ *
+ * \details
+ *   Every bin is compared against a threshold derived from the
+ *   train_cells bins on each side of it, skipping guard_cells bins next to
+ *   the cell under test:
+ *
+ *     [ train | guard | CUT | guard | train ]
+ *
+ *   cell_average (CA-CFAR) uses the mean of the 2 * train_cells training
+ *   cells. The window sums come from one double precision running sum, and
+ *   the threshold, comparison and mask are VOLK kernel calls over the whole
+ *   frame. ordered_statistic (OS-CFAR) uses the rank-th smallest training
+ *   cell, so it tolerates up to 2 * train_cells - rank interferers in the
+ *   window. The sorted window is updated incrementally as it slides, and
+ *   the bins can be split across a volk::thread_pool.
+ *
+ *   The input is linear power, for example the output of
+ *   volk_32fc_magnitude_squared_32f, averaged or not. The threshold scale
+ *   is chosen for the requested false alarm probability under exponentially
+ *   distributed noise (a single square-law detected frame). The first and
+ *   last guard_cells + train_cells bins only have training cells on one
+ *   side. They use that side alone, with the scale recomputed for
+ *   train_cells cells.
+ *
+ *   mask[i] is 1 where psd[i] >= threshold[i], else 0.
+ *
+ * example code:
+ *   volk::cfar_detector cfar(bins, 4, 16, 1e-6);
+ *   std::vector<float> threshold(bins);
+ *   std::vector<uint8_t> mask(bins);
+ *   unsigned int hits = cfar.process(psd, threshold.data(), mask.data());
+ */
+class cfar_detector
+{
+public:
+    enum class method { cell_average, ordered_statistic };
+
+    /*!
+     * \param rank order statistic used by ordered_statistic, 1 to
+     *        2 * train_cells; 0 selects 3/4 of the training cells
+     */
+    cfar_detector(unsigned int num_bins,
+                  unsigned int guard_cells,
+                  unsigned int train_cells,
+                  double pfa = 1e-6,
+                  method m = method::cell_average,
+                  unsigned int rank = 0)
+        : d_bins(num_bins),
+          d_guard(guard_cells),
+          d_train(train_cells),
+          d_pfa(pfa),
+          d_method(m),
+          d_rank(rank != 0 ? rank : std::max(1u, 3 * train_cells / 2))
+    {
+        if (train_cells == 0)
+            throw std::invalid_argument("cfar_detector: train_cells must be > 0");
+        if (num_bins < 2 * (guard_cells + train_cells) + 1)
+            throw std::invalid_argument("cfar_detector: num_bins smaller than the window");
+        if (!(pfa > 0.0 && pfa < 1.0))
+            throw std::invalid_argument("cfar_detector: pfa must be in (0, 1)");
+        if (d_rank > 2 * train_cells)
+            throw std::invalid_argument("cfar_detector: rank exceeds the training cells");
+
+        // edge bins: one side, rank scaled to the halved window
+        d_edge_rank = std::max(1u, (d_rank + 1) / 2);
+        if (d_method == method::cell_average) {
+            d_scale = static_cast<float>(ca_scale(pfa, 2 * train_cells));
+            d_edge_scale = static_cast<float>(ca_scale(pfa, train_cells));
+        } else {
+            d_scale = static_cast<float>(os_scale(pfa, 2 * train_cells, d_rank));
+            d_edge_scale = static_cast<float>(os_scale(pfa, train_cells, d_edge_rank));
+        }
+
+        d_window.resize(num_bins - train_cells + 1);
+        d_diff.resize(num_bins);
+        d_threshold.resize(num_bins);
+        d_sorted.resize(1);
+    }
+
+    /*!
+     * \brief Threshold multiplier of the mean of `cells` exponential cells
+     *
+     * \details
+     *   pfa = (1 + scale / cells)^-cells.
+     */
+    static double ca_scale(double pfa, unsigned int cells)
+    {
+        return cells * (std::pow(pfa, -1.0 / cells) - 1.0);
+    }
+
+    /*!
+     * \brief Threshold multiplier of the rank-th smallest of `cells` cells
+     *
+     * \details
+     *   Solves pfa = prod_{i=0}^{rank-1} (cells - i) / (cells - i + scale)
+     *   by bisection.
+     */
+    static double os_scale(double pfa, unsigned int cells, unsigned int rank)
+    {
+        const auto log_pfa = [&](double scale) {
+            double sum = 0.0;
+            for (unsigned int i = 0; i < rank; i++)
+                sum += std::log((cells - i) / (cells - i + scale));
+            return sum;
+        };
+        const double target = std::log(pfa);
+        double lo = 0.0, hi = 1.0;
+        while (log_pfa(hi) > target)
+            hi *= 2.0;
+        for (int it = 0; it < 100; it++) {
+            const double mid = 0.5 * (lo + hi);
+            (log_pfa(mid) > target ? lo : hi) = mid;
+        }
+        return 0.5 * (lo + hi);
+    }
+
+    unsigned int num_bins() const { return d_bins; }
+    unsigned int guard_cells() const { return d_guard; }
+    unsigned int train_cells() const { return d_train; }
+    unsigned int rank() const { return d_rank; }
+    method detection_method() const { return d_method; }
+    double pfa() const { return d_pfa; }
+
+    //! Threshold multiplier of interior bins
+    float scale() const { return d_scale; }
+
+    /*!
+     * \brief Thresholds and detects one frame of num_bins() bins
+     *
+     * \details
+     *   threshold receives the per bin threshold, mask one byte per bin.
+     *   Returns the number of detections.
+     */
+    unsigned int process(const float* psd, float* threshold, uint8_t* mask)
+    {
+        if (d_method == method::cell_average)
+            threshold_ca(psd, threshold);
+        else
+            threshold_os(psd, threshold, 0, d_bins, d_sorted[0]);
+        return detect(psd, threshold, mask);
+    }
+
+    /*!
+     * \brief As above, splitting the ordered statistic bins across pool
+     *
+     * \details
+     *   Each chunk restarts its own sorted window, so the result is identical
+     *   to the single threaded call. cell_average frames are cheap enough to
+     *   stay on the calling thread.
+     */
+    unsigned int
+    process(const float* psd, float* threshold, uint8_t* mask, thread_pool& pool)
+    {
+        if (d_method == method::cell_average)
+            return process(psd, threshold, mask);
+
+        if (d_sorted.size() < pool.size())
+            d_sorted.resize(pool.size());
+        parallel_for<float>(
+            d_bins,
+            [&](unsigned int offset, unsigned int length, unsigned int chunk) {
+                threshold_os(psd, threshold, offset, offset + length, d_sorted[chunk]);
+            },
+            pool,
+            parallel_min_bins);
+        return detect(psd, threshold, mask);
+    }
+
+    //! As above, keeping the thresholds in last_threshold()
+    unsigned int process(const float* psd, uint8_t* mask)
+    {
+        return process(psd, d_threshold.data(), mask);
+    }
+
+    const float* last_threshold() const { return d_threshold.data(); }
+
+private:
+    //! ordered statistic bins per thread, each costs a few window updates
+    static const unsigned int parallel_min_bins = 4096;
+
+    unsigned int detect(const float* psd, const float* threshold, uint8_t* mask)
+    {
+        volk_32f_x2_subtract_32f(d_diff.data(), psd, threshold, d_bins);
+        volk_32f_binary_slicer_8i(reinterpret_cast<int8_t*>(mask), d_diff.data(), d_bins);
+
+        unsigned int hits = 0;
+        for (unsigned int i = 0; i < d_bins; i++)
+            hits += mask[i];
+        return hits;
+    }
+
+    void threshold_ca(const float* psd, float* threshold)
+    {
+        const unsigned int n = d_bins, g = d_guard, t = d_train;
+
+        // d_window[j] = psd[j] + ... + psd[j + t - 1]
+        double sum = 0.0;
+        for (unsigned int j = 0; j < t; j++)
+            sum += psd[j];
+        d_window[0] = static_cast<float>(sum);
+        for (unsigned int j = 1; j + t <= n; j++) {
+            sum += double(psd[j + t - 1]) - double(psd[j - 1]);
+            d_window[j] = static_cast<float>(sum);
+        }
+
+        // bin i trains on d_window[i - g - t] (lagging) and d_window[i + g + 1]
+        const unsigned int lo = g + t;
+        const unsigned int hi = n - g - t;
+        const float* window = d_window.data();
+        volk_32f_s32f_multiply_32f(threshold, window + g + 1, d_edge_scale / t, lo);
+        volk_32f_x2_add_32f(
+            threshold + lo, window + lo - g - t, window + lo + g + 1, hi - lo);
+        volk_32f_s32f_multiply_32f(
+            threshold + lo, threshold + lo, d_scale / (2 * t), hi - lo);
+        volk_32f_s32f_multiply_32f(
+            threshold + hi, window + hi - g - t, d_edge_scale / t, n - hi);
+    }
+
+    // bins [begin, end), sliding through the one sided and two sided regions
+    void threshold_os(const float* psd,
+                      float* threshold,
+                      unsigned int begin,
+                      unsigned int end,
+                      cfar_detail::sorted_window& window) const
+    {
+        const unsigned int n = d_bins, g = d_guard, t = d_train;
+        const unsigned int lo = g + t;
+        const unsigned int hi = n - g - t;
+        unsigned int i = begin;
+
+        // leading cells only
+        if (i < std::min(lo, end)) {
+            window.assign(psd + i + g + 1, t);
+            for (; i < std::min(lo, end); i++) {
+                if (i > begin)
+                    window.replace(psd[i + g], psd[i + g + t]);
+                threshold[i] = d_edge_scale * window.kth(d_edge_rank);
+            }
+        }
+
+        if (i < std::min(hi, end)) {
+            const unsigned int first = i;
+            window.assign(psd + i - g - t, t);
+            window.append(psd + i + g + 1, t);
+            for (; i < std::min(hi, end); i++) {
+                if (i > first) {
+                    window.replace(psd[i - g - t - 1], psd[i - g - 1]);
+                    window.replace(psd[i + g], psd[i + g + t]);
+                }
+                threshold[i] = d_scale * window.kth(d_rank);
+            }
+        }
+
+        // lagging cells only
+        if (i < end) {
+            const unsigned int first = i;
+            window.assign(psd + i - g - t, t);
+            for (; i < end; i++) {
+                if (i > first)
+                    window.replace(psd[i - g - t - 1], psd[i - g - 1]);
+                threshold[i] = d_edge_scale * window.kth(d_edge_rank);
+            }
+        }
+    }
+
+    unsigned int d_bins;
+    unsigned int d_guard;
+    unsigned int d_train;
+    double d_pfa;
+    method d_method;
+    unsigned int d_rank;
+    unsigned int d_edge_rank;
+    float d_scale;
+    float d_edge_scale;
+
+    volk::vector<float> d_window;
+    volk::vector<float> d_diff;
+    volk::vector<float> d_threshold;
+    std::vector<cfar_detail::sorted_window> d_sorted;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_CFAR_H
@@ -0,0 +1,513 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_CHANNELIZER_H
+#define INCLUDED_VOLK_CHANNELIZER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <fftw3.h>
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+#include <volk/volk_fftw.hh>
+#include <volk/volk_parallel.hh>
+#include <volk/volk_resampler.hh>
+
+namespace volk {
+
+namespace channelizer_detail {
+
+// FFTs per batched plan; a batch of 8 * M complex floats starts on 64 bytes
+static const unsigned int fft_group = 8;
+
+inline int64_t floor_div(int64_t a, int64_t b)
+{
+    const int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+} // namespace channelizer_detail
+
+/*!
+ * \brief Kaiser windowed-sinc prototype for a channelizer of channels channels
+ *
+ * \details
+ *   Returns channels * taps_per_channel taps with unity DC gain. cutoff is
+ *   the -6 dB edge in channel spacings from the channel center, 0.5 being
+ *   half way to the next channel.
+ */
+inline std::vector<float> channelizer_taps(unsigned int channels,
+                                           unsigned int taps_per_channel,
+                                           double cutoff = 0.5,
+                                           double atten_db = 80.0)
+{
+    // resampler_taps has one tap more and sums to channels
+    std::vector<float> taps =
+        resampler_taps(channels, taps_per_channel, cutoff, atten_db);
+    taps.pop_back();
+    double sum = 0.0;
+    for (float t : taps)
+        sum += t;
+    for (float& t : taps)
+        t = static_cast<float>(t / sum);
+    return taps;
+}
+
+/*!
+ * \brief Polyphase filter bank channelizer for M uniformly spaced channels
+ *
+ * \details
+ *   Splits a complex stream into M channels centered at k / M times the
+ *   input rate, k = 0 .. M - 1 (k > M / 2 are the negative frequencies).
+ *   Each channel is shifted to baseband, filtered by the prototype lowpass
+ *   and decimated by D: the M rotators and decimating filters of a bank of
+ *   narrowband receivers, at the cost of one polyphase filter and one
+ *   M-point FFT per D input samples.
+ *
+ *   sampling::critical decimates by D = M, so every channel comes out at
+ *   1 / M of the input rate and the band edges alias into the neighbours.
+ *   sampling::oversampled decimates by D = M / 2; the channels come out at
+ *   twice their spacing and the default prototype keeps the whole channel
+ *   free of aliases.
+ *
+ *   The filter stage runs one volk_32fc_32f_dot_prod_32fc per branch and
+ *   output, over per-branch delay lines the input is dealt into. The FFTs
+ *   of a block of outputs run as fftwf_plan_many_dft batches of
+ *   fft_group. Only the channels passed to select() are written; when
+ *   that selection is small enough, each one is a volk_32fc_x2_dot_prod_32fc
+ *   with its DFT row instead of the FFT.
+ *
+ *   Large blocks are split across the thread pool: the filter stage over
+ *   groups of branches, the FFT batches over groups of outputs and the
+ *   DFT / output stage over groups of selected channels.
+ *
+ * example code:
+ *   volk::channelizer bank(256, volk::channelizer::sampling::oversampled);
+ *   bank.select({ 3, 17, 200 });
+ *   std::vector<volk::vector<lv_32fc_t>> ch(
+ *       3, volk::vector<lv_32fc_t>(bank.max_output(n)));
+ *   lv_32fc_t* outs[] = { ch[0].data(), ch[1].data(), ch[2].data() };
+ *   std::size_t produced = bank.process(outs, in, n);
+ */
+class channelizer
+{
+public:
+    enum class sampling { critical, oversampled };
+
+    /*!
+     * \param channels number of channels M, even for sampling::oversampled
+     * \param mode critically sampled (D = M) or 2x oversampled (D = M / 2)
+     * \param taps_per_channel prototype length in units of M
+     * \param pool threads used for large blocks
+     */
+    channelizer(unsigned int channels,
+                sampling mode = sampling::critical,
+                unsigned int taps_per_channel = 16,
+                thread_pool& pool = thread_pool::global())
+        : channelizer(
+              channels, mode, default_taps(channels, mode, taps_per_channel), pool)
+    {
+    }
+
+    //! Uses the given prototype, zero padded to a multiple of channels
+    channelizer(unsigned int channels,
+                sampling mode,
+                const std::vector<float>& prototype,
+                thread_pool& pool = thread_pool::global())
+        : d_channels(channels),
+          d_mode(mode),
+          d_decim(mode == sampling::critical ? channels : channels / 2),
+          d_pool(&pool)
+    {
+        if (channels < 2)
+            throw std::invalid_argument("channelizer: at least 2 channels required");
+        if (mode == sampling::oversampled && channels % 2 != 0)
+            throw std::invalid_argument("channelizer: oversampling needs an even count");
+        if (prototype.empty())
+            throw std::invalid_argument("channelizer: no taps");
+
+        // branch r holds h[r + p * M], reversed to line up with its delay line
+        d_ntaps = static_cast<unsigned int>((prototype.size() + channels - 1) / channels);
+        d_taps.assign(static_cast<std::size_t>(channels) * d_ntaps, 0.0f);
+        for (unsigned int r = 0; r < channels; r++) {
+            for (unsigned int p = 0; p < d_ntaps; p++) {
+                const std::size_t i = r + static_cast<std::size_t>(p) * channels;
+                if (i < prototype.size())
+                    d_taps[static_cast<std::size_t>(r) * d_ntaps + (d_ntaps - 1 - p)] =
+                        prototype[i];
+            }
+        }
+
+        // a block covers at least four prototype lengths of input, so the
+        // per-block overheads stay small
+        const std::size_t span = std::max<std::size_t>(
+            4 * static_cast<std::size_t>(channels) * d_ntaps, 16384);
+        const unsigned int group = channelizer_detail::fft_group;
+        d_block = static_cast<unsigned int>((span / d_decim + group - 1) / group * group);
+        const std::size_t block_inputs = static_cast<std::size_t>(d_block) * d_decim;
+        d_rows = d_ntaps + 1 + (block_inputs + channels - 1) / channels;
+
+        const std::size_t block_points = static_cast<std::size_t>(d_block) * channels;
+        d_lines.assign(static_cast<std::size_t>(channels) * d_rows, lv_cmake(0.0f, 0.0f));
+        d_branch.assign(block_points, lv_cmake(0.0f, 0.0f));
+        d_spectrum.assign(block_points, lv_cmake(0.0f, 0.0f));
+
+        std::vector<unsigned int> all(channels);
+        for (unsigned int k = 0; k < channels; k++)
+            all[k] = k;
+        select(all);
+        reset();
+        // last, so that nothing can throw once the plans exist
+        make_plans();
+    }
+
+    ~channelizer()
+    {
+        std::lock_guard<std::mutex> guard(fftw_planner_lock());
+        fftwf_destroy_plan(d_plan_group);
+        fftwf_destroy_plan(d_plan_single);
+    }
+
+    channelizer(const channelizer&) = delete;
+    channelizer& operator=(const channelizer&) = delete;
+
+    unsigned int channels() const { return d_channels; }
+    sampling mode() const { return d_mode; }
+    unsigned int decimation() const { return d_decim; }
+    unsigned int taps_per_channel() const { return d_ntaps; }
+
+    //! Center of channel k in cycles per input sample, in [-0.5, 0.5)
+    double center_frequency(unsigned int k) const
+    {
+        const double f = double(k) / d_channels;
+        return f >= 0.5 ? f - 1.0 : f;
+    }
+
+    /*!
+     * \brief Sets the channels process() writes, in the order of its outputs
+     *
+     * \details
+     *   Channels may repeat. When computing them one by one is cheaper than
+     *   the FFT of all M, process() skips the FFT.
+     */
+    void select(const std::vector<unsigned int>& channels)
+    {
+        for (unsigned int k : channels)
+            if (k >= d_channels)
+                throw std::invalid_argument("channelizer: channel out of range");
+        d_selected = channels;
+
+        // an M-point complex dot product costs 8 M flops, the FFT about
+        // 5 M log2(M) for all channels
+        const double log2m = std::log2(double(d_channels));
+        d_direct = 8.0 * channels.size() < 5.0 * log2m;
+        d_dft.clear();
+        if (!d_direct)
+            return;
+        const double pi = 3.14159265358979323846;
+        d_dft.resize(channels.size() * static_cast<std::size_t>(d_channels));
+        for (std::size_t i = 0; i < channels.size(); i++) {
+            for (unsigned int r = 0; r < d_channels; r++) {
+                // same sign as the FFTW_BACKWARD transform
+                const double w = 2.0 * pi *
+                                 double((uint64_t(channels[i]) * r) % d_channels) /
+                                 d_channels;
+                d_dft[i * d_channels + r] = lv_cmake(static_cast<float>(std::cos(w)),
+                                                     static_cast<float>(std::sin(w)));
+            }
+        }
+    }
+
+    const std::vector<unsigned int>& selected() const { return d_selected; }
+
+    //! Upper bound on the outputs per channel of process(..., num_points)
+    std::size_t max_output(std::size_t num_points) const
+    {
+        return num_points / d_decim + 1;
+    }
+
+    //! Clears the delay lines; the next input is sample 0 again
+    void reset()
+    {
+        std::fill(d_lines.begin(), d_lines.end(), lv_cmake(0.0f, 0.0f));
+        d_first_row = -static_cast<int64_t>(d_ntaps);
+        d_inputs = 0;
+        d_outputs = 0;
+    }
+
+    /*!
+     * \brief Channelizes num_points inputs, returns the outputs per channel
+     *
+     * \details
+     *   outputs[i] receives channel selected()[i] and must hold
+     *   max_output(num_points) samples. Output m of a channel is aligned
+     *   with input m * D.
+     */
+    std::size_t
+    process(lv_32fc_t* const* outputs, const lv_32fc_t* in, std::size_t num_points)
+    {
+        const int64_t m = d_channels;
+        std::size_t produced = 0;
+        while (num_points > 0) {
+            // room left in the delay lines
+            const int64_t room =
+                (d_first_row + static_cast<int64_t>(d_rows)) * m - d_inputs;
+            const std::size_t n = static_cast<std::size_t>(
+                std::min<int64_t>(room, static_cast<int64_t>(num_points)));
+            deal(in, n);
+            in += n;
+            num_points -= n;
+
+            // output j needs input j * D
+            while (d_outputs * d_decim < d_inputs) {
+                const int64_t ready = (d_inputs - 1) / d_decim + 1 - d_outputs;
+                const unsigned int count =
+                    static_cast<unsigned int>(std::min<int64_t>(ready, d_block));
+                filter(count);
+                if (d_direct) {
+                    dft(outputs, produced, count);
+                } else {
+                    fft(count);
+                    scatter(outputs, produced, count);
+                }
+                d_outputs += count;
+                produced += count;
+            }
+
+            // drop the rows no later output reads
+            const int64_t oldest = d_outputs * d_decim - (m - 1);
+            const int64_t keep = channelizer_detail::floor_div(oldest, m) - d_ntaps + 1;
+            if (keep > d_first_row) {
+                const std::size_t drop = static_cast<std::size_t>(keep - d_first_row);
+                for (unsigned int s = 0; s < d_channels; s++) {
+                    lv_32fc_t* line = &d_lines[static_cast<std::size_t>(s) * d_rows];
+                    std::memmove(line, line + drop, sizeof(lv_32fc_t) * (d_rows - drop));
+                }
+                d_first_row = keep;
+            }
+        }
+        return produced;
+    }
+
+private:
+    static std::vector<float>
+    default_taps(unsigned int channels, sampling mode, unsigned int taps_per_channel)
+    {
+        if (channels < 2 || taps_per_channel == 0)
+            throw std::invalid_argument("channelizer: bad channel or tap count");
+        // oversampled: widen the passband by half the Kaiser transition
+        // width, (A - 8) / (14.36 P) channel spacings, so that it is flat
+        // to the channel edge while the stop band still starts before the
+        // first alias at 1.5 spacings
+        double cutoff = 0.5;
+        if (mode == sampling::oversampled)
+            cutoff =
+                std::min(0.75, 0.5 + 0.5 * (80.0 - 8.0) / (14.36 * taps_per_channel));
+        return channelizer_taps(channels, taps_per_channel, cutoff, 80.0);
+    }
+
+    void make_plans()
+    {
+        const int n = static_cast<int>(d_channels);
+        auto in = reinterpret_cast<fftwf_complex*>(d_branch.data());
+        auto out = reinterpret_cast<fftwf_complex*>(d_spectrum.data());
+        std::lock_guard<std::mutex> guard(fftw_planner_lock());
+        // planned on the member buffers, which FFTW_MEASURE overwrites
+        // before any input arrives
+        d_plan_group = fftwf_plan_many_dft(1,
+                                           &n,
+                                           channelizer_detail::fft_group,
+                                           in,
+                                           nullptr,
+                                           1,
+                                           n,
+                                           out,
+                                           nullptr,
+                                           1,
+                                           n,
+                                           FFTW_BACKWARD,
+                                           FFTW_MEASURE);
+        // the remainder of a block starts at any row
+        d_plan_single =
+            fftwf_plan_dft_1d(n, in, out, FFTW_BACKWARD, FFTW_MEASURE | FFTW_UNALIGNED);
+        if (!d_plan_group || !d_plan_single) {
+            // the destructor does not run for a throwing constructor
+            if (d_plan_group)
+                fftwf_destroy_plan(d_plan_group);
+            if (d_plan_single)
+                fftwf_destroy_plan(d_plan_single);
+            d_plan_group = d_plan_single = nullptr;
+            throw std::runtime_error("channelizer: fftwf planning failed");
+        }
+    }
+
+    // sample i goes to delay line i mod M, row i / M
+    void deal(const lv_32fc_t* in, std::size_t n)
+    {
+        const int64_t row = d_inputs / d_channels;
+        unsigned int s = static_cast<unsigned int>(d_inputs - row * d_channels);
+        std::size_t col = static_cast<std::size_t>(row - d_first_row);
+        for (std::size_t i = 0; i < n; i++) {
+            d_lines[static_cast<std::size_t>(s) * d_rows + col] = in[i];
+            if (++s == d_channels) {
+                s = 0;
+                col++;
+            }
+        }
+        d_inputs += static_cast<int64_t>(n);
+    }
+
+    // d_branch[t * M + r] = sum_p h[r + p M] x[(j + t) D - r - p M]
+    void filter(unsigned int count)
+    {
+        const int64_t m = d_channels;
+        const unsigned int work = count * d_ntaps;
+        parallel_for<lv_32fc_t>(
+            d_channels,
+            [&](unsigned int first, unsigned int length, unsigned int) {
+                for (unsigned int r = first; r < first + length; r++) {
+                    const float* taps = &d_taps[static_cast<std::size_t>(r) * d_ntaps];
+                    for (unsigned int t = 0; t < count; t++) {
+                        const int64_t a = (d_outputs + t) * d_decim - r;
+                        const int64_t row = channelizer_detail::floor_div(a, m);
+                        const std::size_t s = static_cast<std::size_t>(a - row * m);
+                        const std::size_t first_row =
+                            static_cast<std::size_t>(row - d_ntaps + 1 - d_first_row);
+                        const lv_32fc_t* x = &d_lines[s * d_rows + first_row];
+                        volk_32fc_32f_dot_prod_32fc(
+                            &d_branch[static_cast<std::size_t>(t) * d_channels + r],
+                            x,
+                            taps,
+                            d_ntaps);
+                    }
+                }
+            },
+            *d_pool,
+            std::max(1u, parallel_min_points / std::max(1u, work)));
+    }
+
+    void fft(unsigned int count)
+    {
+        const unsigned int groups = count / channelizer_detail::fft_group;
+        const std::size_t stride =
+            static_cast<std::size_t>(channelizer_detail::fft_group) * d_channels;
+        auto run_groups = [&](unsigned int first, unsigned int last) {
+            for (unsigned int g = first; g < last; g++)
+                fftwf_execute_dft(
+                    d_plan_group,
+                    reinterpret_cast<fftwf_complex*>(&d_branch[g * stride]),
+                    reinterpret_cast<fftwf_complex*>(&d_spectrum[g * stride]));
+        };
+
+        // about 5 M log2(M) flops per FFT against parallel_min_points
+        const double per_group =
+            5.0 * stride * std::log2(double(d_channels)) / parallel_min_points;
+        const unsigned int wanted = static_cast<unsigned int>(groups * per_group);
+        const unsigned int tasks =
+            std::max(1u, std::min({ d_pool->size(), groups, wanted }));
+        if (tasks == 1) {
+            run_groups(0, groups);
+        } else {
+            d_pool->run(tasks, [&](unsigned int task) {
+                run_groups(groups * task / tasks, groups * (task + 1) / tasks);
+            });
+        }
+
+        for (unsigned int t = groups * channelizer_detail::fft_group; t < count; t++) {
+            const std::size_t row = std::size_t(t) * d_channels;
+            fftwf_execute_dft(d_plan_single,
+                              reinterpret_cast<fftwf_complex*>(&d_branch[row]),
+                              reinterpret_cast<fftwf_complex*>(&d_spectrum[row]));
+        }
+    }
+
+    // with D = M / 2, channel k of output j turns by exp(-j pi k j)
+    bool negate(unsigned int k, unsigned int t) const
+    {
+        return d_mode == sampling::oversampled && (k & 1) && ((d_outputs + t) & 1);
+    }
+
+    void scatter(lv_32fc_t* const* outputs, std::size_t offset, unsigned int count)
+    {
+        const unsigned int num_selected = static_cast<unsigned int>(d_selected.size());
+        parallel_for<lv_32fc_t>(
+            num_selected,
+            [&](unsigned int first, unsigned int length, unsigned int) {
+                for (unsigned int i = first; i < first + length; i++) {
+                    const unsigned int k = d_selected[i];
+                    lv_32fc_t* out = outputs[i] + offset;
+                    for (unsigned int t = 0; t < count; t++) {
+                        const lv_32fc_t y = d_spectrum[std::size_t(t) * d_channels + k];
+                        out[t] = negate(k, t) ? -y : y;
+                    }
+                }
+            },
+            *d_pool,
+            std::max(1u, parallel_min_points / std::max(1u, count)));
+    }
+
+    void dft(lv_32fc_t* const* outputs, std::size_t offset, unsigned int count)
+    {
+        const unsigned int num_selected = static_cast<unsigned int>(d_selected.size());
+        parallel_for<lv_32fc_t>(
+            num_selected,
+            [&](unsigned int first, unsigned int length, unsigned int) {
+                for (unsigned int i = first; i < first + length; i++) {
+                    const unsigned int k = d_selected[i];
+                    const lv_32fc_t* row = &d_dft[std::size_t(i) * d_channels];
+                    lv_32fc_t* out = outputs[i] + offset;
+                    for (unsigned int t = 0; t < count; t++) {
+                        const lv_32fc_t* branch = &d_branch[std::size_t(t) * d_channels];
+                        volk_32fc_x2_dot_prod_32fc(out + t, branch, row, d_channels);
+                        if (negate(k, t))
+                            out[t] = -out[t];
+                    }
+                }
+            },
+            *d_pool,
+            std::max(1u, parallel_min_points / std::max(1u, count * d_channels)));
+    }
+
+    unsigned int d_channels;
+    sampling d_mode;
+    unsigned int d_decim;
+    thread_pool* d_pool;
+    unsigned int d_ntaps = 0;
+    volk::vector<float> d_taps;
+
+    // outputs per block and rows per delay line
+    unsigned int d_block = 0;
+    std::size_t d_rows = 0;
+
+    // delay line s holds x[s + q M] for rows q >= d_first_row
+    volk::vector<lv_32fc_t> d_lines;
+    int64_t d_first_row = 0;
+    int64_t d_inputs = 0;
+    int64_t d_outputs = 0;
+
+    // branch outputs and their transforms, one row of M per output
+    volk::vector<lv_32fc_t> d_branch;
+    volk::vector<lv_32fc_t> d_spectrum;
+    fftwf_plan d_plan_group = nullptr;
+    fftwf_plan d_plan_single = nullptr;
+
+    std::vector<unsigned int> d_selected;
+    bool d_direct = false;
+    volk::vector<lv_32fc_t> d_dft;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_CHANNELIZER_H
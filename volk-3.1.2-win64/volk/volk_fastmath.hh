@@ -0,0 +1,510 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_FASTMATH_H
+#define INCLUDED_VOLK_FASTMATH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <volk/volk.h>
+
+namespace volk {
+
+/*!
+ * \brief Worst-case errors of the fast transcendental tier
+ *
+ * \details
+ *   Measured against double precision libm over every float input in the
+ *   stated domain. sincos, atan2, log2 and log10 errors are absolute, the
+ *   exp error is relative.
+ *
+ *   - fast_sincos: |x| <= 1e5; outside, the range reduction loses accuracy.
+ *   - fast_atan2: all finite (y, x); atan2(0, 0) = 0.
+ *   - fast_log2 / fast_log10: all positive floats including subnormals;
+ *     0 gives -inf, negative inputs and NaN give NaN, +inf gives +inf.
+ *   - fast_exp: all floats; overflows to +inf, underflows through the
+ *     subnormal range to 0, NaN gives NaN.
+ */
+static const float fast_sincos_max_error = 2e-5f;
+static const float fast_atan2_max_error = 1e-4f;
+static const float fast_log2_max_error = 3e-5f;
+static const float fast_log10_max_error = 1.5e-5f;
+static const float fast_exp_max_error = 5e-6f;
+
+namespace fastmath_detail {
+
+#if defined(__AVX2__) && defined(__FMA__)
+typedef __m256 vec;
+typedef __m256i ivec;
+static const unsigned int lanes = 8;
+inline vec load(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, vec v) { _mm256_storeu_ps(p, v); }
+inline vec set1(float x) { return _mm256_set1_ps(x); }
+inline vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+inline vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+inline vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+inline vec div(vec a, vec b) { return _mm256_div_ps(a, b); }
+inline vec fmadd(vec a, vec b, vec c) { return _mm256_fmadd_ps(a, b, c); }
+inline vec fnmadd(vec a, vec b, vec c) { return _mm256_fnmadd_ps(a, b, c); }
+// NaN in b propagates, as MINPS / MAXPS return their second operand
+inline vec vmin(vec a, vec b) { return _mm256_min_ps(a, b); }
+inline vec vmax(vec a, vec b) { return _mm256_max_ps(a, b); }
+inline vec vand(vec a, vec b) { return _mm256_and_ps(a, b); }
+inline vec vor(vec a, vec b) { return _mm256_or_ps(a, b); }
+inline vec vxor(vec a, vec b) { return _mm256_xor_ps(a, b); }
+inline vec lt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline vec eq(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+inline vec not_ge(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_NGE_UQ); }
+inline vec select(vec mask, vec a, vec b) { return _mm256_blendv_ps(b, a, mask); }
+inline bool any(vec mask) { return _mm256_movemask_ps(mask) != 0; }
+inline ivec round_int(vec a) { return _mm256_cvtps_epi32(a); }
+inline vec to_float(ivec a) { return _mm256_cvtepi32_ps(a); }
+inline ivec iset1(int32_t x) { return _mm256_set1_epi32(x); }
+inline ivec iadd(ivec a, ivec b) { return _mm256_add_epi32(a, b); }
+inline ivec isub(ivec a, ivec b) { return _mm256_sub_epi32(a, b); }
+inline ivec iand(ivec a, ivec b) { return _mm256_and_si256(a, b); }
+inline ivec ior(ivec a, ivec b) { return _mm256_or_si256(a, b); }
+template <int n>
+inline ivec shl(ivec a)
+{
+    return _mm256_slli_epi32(a, n);
+}
+template <int n>
+inline ivec sra(ivec a)
+{
+    return _mm256_srai_epi32(a, n);
+}
+inline vec ieq_mask(ivec a, ivec b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+inline vec as_float(ivec a) { return _mm256_castsi256_ps(a); }
+inline ivec as_int(vec a) { return _mm256_castps_si256(a); }
+#elif defined(__SSE2__) || defined(_M_X64)
+typedef __m128 vec;
+typedef __m128i ivec;
+static const unsigned int lanes = 4;
+inline vec load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, vec v) { _mm_storeu_ps(p, v); }
+inline vec set1(float x) { return _mm_set1_ps(x); }
+inline vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+inline vec sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+inline vec mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+inline vec div(vec a, vec b) { return _mm_div_ps(a, b); }
+inline vec fmadd(vec a, vec b, vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline vec fnmadd(vec a, vec b, vec c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+inline vec vmin(vec a, vec b) { return _mm_min_ps(a, b); }
+inline vec vmax(vec a, vec b) { return _mm_max_ps(a, b); }
+inline vec vand(vec a, vec b) { return _mm_and_ps(a, b); }
+inline vec vor(vec a, vec b) { return _mm_or_ps(a, b); }
+inline vec vxor(vec a, vec b) { return _mm_xor_ps(a, b); }
+inline vec lt(vec a, vec b) { return _mm_cmplt_ps(a, b); }
+inline vec eq(vec a, vec b) { return _mm_cmpeq_ps(a, b); }
+inline vec not_ge(vec a, vec b) { return _mm_cmpnge_ps(a, b); }
+inline vec select(vec mask, vec a, vec b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+inline bool any(vec mask) { return _mm_movemask_ps(mask) != 0; }
+inline ivec round_int(vec a) { return _mm_cvtps_epi32(a); }
+inline vec to_float(ivec a) { return _mm_cvtepi32_ps(a); }
+inline ivec iset1(int32_t x) { return _mm_set1_epi32(x); }
+inline ivec iadd(ivec a, ivec b) { return _mm_add_epi32(a, b); }
+inline ivec isub(ivec a, ivec b) { return _mm_sub_epi32(a, b); }
+inline ivec iand(ivec a, ivec b) { return _mm_and_si128(a, b); }
+inline ivec ior(ivec a, ivec b) { return _mm_or_si128(a, b); }
+template <int n>
+inline ivec shl(ivec a)
+{
+    return _mm_slli_epi32(a, n);
+}
+template <int n>
+inline ivec sra(ivec a)
+{
+    return _mm_srai_epi32(a, n);
+}
+inline vec ieq_mask(ivec a, ivec b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+inline vec as_float(ivec a) { return _mm_castsi128_ps(a); }
+inline ivec as_int(vec a) { return _mm_castps_si128(a); }
+#else
+// one scalar lane with the SSE semantics of the vector paths
+typedef float vec;
+typedef int32_t ivec;
+static const unsigned int lanes = 1;
+inline vec as_float(ivec a)
+{
+    float f;
+    std::memcpy(&f, &a, sizeof(f));
+    return f;
+}
+inline ivec as_int(vec a)
+{
+    int32_t i;
+    std::memcpy(&i, &a, sizeof(i));
+    return i;
+}
+inline vec mask_of(bool b) { return as_float(b ? -1 : 0); }
+inline vec load(const float* p) { return *p; }
+inline void store(float* p, vec v) { *p = v; }
+inline vec set1(float x) { return x; }
+inline vec add(vec a, vec b) { return a + b; }
+inline vec sub(vec a, vec b) { return a - b; }
+inline vec mul(vec a, vec b) { return a * b; }
+inline vec div(vec a, vec b) { return a / b; }
+inline vec fmadd(vec a, vec b, vec c) { return a * b + c; }
+inline vec fnmadd(vec a, vec b, vec c) { return c - a * b; }
+inline vec vmin(vec a, vec b) { return a < b ? a : b; }
+inline vec vmax(vec a, vec b) { return a > b ? a : b; }
+inline vec vand(vec a, vec b) { return as_float(as_int(a) & as_int(b)); }
+inline vec vor(vec a, vec b) { return as_float(as_int(a) | as_int(b)); }
+inline vec vxor(vec a, vec b) { return as_float(as_int(a) ^ as_int(b)); }
+inline vec lt(vec a, vec b) { return mask_of(a < b); }
+inline vec eq(vec a, vec b) { return mask_of(a == b); }
+inline vec not_ge(vec a, vec b) { return mask_of(!(a >= b)); }
+inline vec select(vec mask, vec a, vec b) { return as_int(mask) ? a : b; }
+inline bool any(vec mask) { return as_int(mask) != 0; }
+inline ivec round_int(vec a)
+{
+    return std::fabs(a) < 2147483648.0f ? static_cast<int32_t>(std::nearbyint(a))
+                                        : std::numeric_limits<int32_t>::min();
+}
+inline vec to_float(ivec a) { return static_cast<float>(a); }
+inline ivec iset1(int32_t x) { return x; }
+inline ivec iadd(ivec a, ivec b) { return static_cast<int32_t>(static_cast<uint32_t>(a) + b); }
+inline ivec isub(ivec a, ivec b) { return static_cast<int32_t>(static_cast<uint32_t>(a) - b); }
+inline ivec iand(ivec a, ivec b) { return a & b; }
+inline ivec ior(ivec a, ivec b) { return a | b; }
+template <int n>
+inline ivec shl(ivec a)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(a) << n);
+}
+template <int n>
+inline ivec sra(ivec a)
+{
+    return a >> n;
+}
+inline vec ieq_mask(ivec a, ivec b) { return mask_of(a == b); }
+#endif
+
+inline vec sign_bits() { return set1(-0.0f); }
+
+inline void sincos(vec x, vec& s, vec& c)
+{
+    // x = k pi/2 + r with |r| <= pi/4, pi/2 split in three parts (Cody-Waite)
+    const ivec k = round_int(mul(x, set1(0.63661977236758134f)));
+    const vec kf = to_float(k);
+    vec r = fnmadd(kf, set1(1.5703125f), x);
+    r = fnmadd(kf, set1(4.837512969970703125e-4f), r);
+    r = fnmadd(kf, set1(7.54978995489188216e-8f), r);
+
+    // minimax polynomials on [-pi/4, pi/4]
+    const vec r2 = mul(r, r);
+    const vec ps = fmadd(mul(r, r2), fmadd(r2, set1(0.00815299f), set1(-0.16662833f)), r);
+    const vec pc =
+        fmadd(r2, fmadd(r2, set1(0.04048894f), set1(-0.4997763f)), set1(1.0f));
+
+    // odd quadrants swap sin and cos; quadrants 2, 3 negate sin, 1, 2 negate cos
+    const vec swap = ieq_mask(iand(k, iset1(1)), iset1(1));
+    const vec sin_sign = as_float(shl<30>(iand(k, iset1(2))));
+    const vec cos_sign = as_float(shl<30>(iand(iadd(k, iset1(1)), iset1(2))));
+    s = vxor(select(swap, pc, ps), sin_sign);
+    c = vxor(select(swap, ps, pc), cos_sign);
+}
+
+inline vec atan2(vec y, vec x)
+{
+    const vec sign = sign_bits();
+    const vec ax = vxor(x, vand(x, sign));
+    const vec ay = vxor(y, vand(y, sign));
+    const vec hi = vmax(ax, ay);
+    const vec lo = vmin(ax, ay);
+    // hi is at least the smallest subnormal so that atan2(0, 0) = 0
+    const vec t = div(lo, vmax(set1(1.40129846e-45f), hi));
+
+    // minimax atan on [0, 1]
+    const vec t2 = mul(t, t);
+    vec p = fmadd(t2, set1(-0.03898648f), set1(0.14626442f));
+    p = fmadd(t2, p, set1(-0.32117495f));
+    p = fmadd(t2, p, set1(0.9992138f));
+    vec a = mul(t, p);
+
+    a = select(lt(ax, ay), sub(set1(1.57079637f), a), a);
+    a = select(lt(x, set1(0.0f)), sub(set1(3.14159274f), a), a);
+    return vxor(a, vand(y, sign));
+}
+
+// log2 for positive normal x
+inline vec log2_normal(vec x)
+{
+    const ivec bits = as_int(x);
+    const vec e = to_float(isub(sra<23>(bits), iset1(127)));
+    const vec f =
+        sub(as_float(ior(iand(bits, iset1(0x007fffff)), iset1(0x3f800000))), set1(1.0f));
+
+    // minimax log2(1 + f) on [0, 1)
+    vec p = fmadd(f, set1(0.04638533f), set1(-0.19626956f));
+    p = fmadd(f, p, set1(0.4175957f));
+    p = fmadd(f, p, set1(-0.7096628f));
+    p = fmadd(f, p, set1(1.4419656f));
+    return fmadd(f, p, e);
+}
+
+inline vec log2(vec x)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const vec special = vor(not_ge(x, set1(1.17549435e-38f)), eq(x, set1(inf)));
+    if (!any(special))
+        return log2_normal(x);
+
+    // subnormals are scaled into the normal range
+    const vec tiny = lt(x, set1(1.17549435e-38f));
+    vec r = log2_normal(select(tiny, mul(x, set1(8388608.0f)), x));
+    r = sub(r, vand(tiny, set1(23.0f)));
+    r = select(eq(x, set1(inf)), set1(inf), r);
+    r = select(eq(x, set1(0.0f)), set1(-inf), r);
+    return select(not_ge(x, set1(0.0f)), set1(std::numeric_limits<float>::quiet_NaN()), r);
+}
+
+inline vec exp(vec x)
+{
+    // NaN passes through both clamps as the second operand
+    x = vmax(set1(-104.0f), vmin(set1(89.0f), x));
+
+    const ivec k = round_int(mul(x, set1(1.44269504f)));
+    const vec kf = to_float(k);
+    vec r = fnmadd(kf, set1(0.693145752f), x);
+    r = fnmadd(kf, set1(1.42860677e-6f), r);
+
+    // minimax exp on [-ln2/2, ln2/2]
+    vec p = fmadd(r, set1(0.04145861f), set1(0.16790907f));
+    p = fmadd(r, p, set1(0.5000436f));
+    p = fmadd(r, p, set1(0.9999634f));
+    p = fmadd(r, p, set1(0.9999993f));
+
+    // 2^k as two factors so that k in [-150, 128] stays representable
+    const ivec k1 = sra<1>(k);
+    const ivec k2 = isub(k, k1);
+    const vec s1 = as_float(shl<23>(iadd(k1, iset1(127))));
+    const vec s2 = as_float(shl<23>(iadd(k2, iset1(127))));
+    return mul(mul(p, s1), s2);
+}
+
+} // namespace fastmath_detail
+
+/*!
+ * \brief Fused sine and cosine, fast tier
+ *
+ * \details
+ *   Error below fast_sincos_max_error for |x| <= 1e5.
+ */
+inline void fast_sincos(float* sinVector,
+                        float* cosVector,
+                        const float* inVector,
+                        unsigned int num_points)
+{
+    namespace fm = fastmath_detail;
+    unsigned int number = 0;
+    for (; number + fm::lanes <= num_points; number += fm::lanes) {
+        fm::vec s, c;
+        fm::sincos(fm::load(inVector + number), s, c);
+        fm::store(sinVector + number, s);
+        fm::store(cosVector + number, c);
+    }
+    if (number < num_points) {
+        const std::size_t bytes = sizeof(float) * (num_points - number);
+        float x[fm::lanes] = {}, s[fm::lanes], c[fm::lanes];
+        std::memcpy(x, inVector + number, bytes);
+        fm::vec vs, vc;
+        fm::sincos(fm::load(x), vs, vc);
+        fm::store(s, vs);
+        fm::store(c, vc);
+        std::memcpy(sinVector + number, s, bytes);
+        std::memcpy(cosVector + number, c, bytes);
+    }
+}
+
+namespace fastmath_detail {
+
+// applies f lane-wise; the tail goes through a zero padded vector so that it
+// matches the vector results bit for bit
+template <class F>
+inline void map1(float* out, const float* in, unsigned int num_points, F f)
+{
+    unsigned int number = 0;
+    for (; number + lanes <= num_points; number += lanes)
+        store(out + number, f(load(in + number)));
+    if (number < num_points) {
+        float a[lanes] = {}, r[lanes];
+        std::memcpy(a, in + number, sizeof(float) * (num_points - number));
+        store(r, f(load(a)));
+        std::memcpy(out + number, r, sizeof(float) * (num_points - number));
+    }
+}
+
+} // namespace fastmath_detail
+
+/*!
+ * \brief atan2(y, x) for split inputs, fast tier
+ *
+ * \details
+ *   Error below fast_atan2_max_error for all finite inputs.
+ */
+inline void
+fast_atan2(float* outVector, const float* yVector, const float* xVector, unsigned int num_points)
+{
+    namespace fm = fastmath_detail;
+    unsigned int number = 0;
+    for (; number + fm::lanes <= num_points; number += fm::lanes)
+        fm::store(outVector + number,
+                  fm::atan2(fm::load(yVector + number), fm::load(xVector + number)));
+    if (number < num_points) {
+        float y[fm::lanes] = {}, x[fm::lanes] = {}, r[fm::lanes];
+        std::memcpy(y, yVector + number, sizeof(float) * (num_points - number));
+        std::memcpy(x, xVector + number, sizeof(float) * (num_points - number));
+        fm::store(r, fm::atan2(fm::load(y), fm::load(x)));
+        std::memcpy(outVector + number, r, sizeof(float) * (num_points - number));
+    }
+}
+
+/*!
+ * \brief Base 2 logarithm, fast tier
+ */
+inline void fast_log2(float* bVector, const float* aVector, unsigned int num_points)
+{
+    fastmath_detail::map1(
+        bVector, aVector, num_points, [](fastmath_detail::vec x) {
+            return fastmath_detail::log2(x);
+        });
+}
+
+/*!
+ * \brief Base 10 logarithm, fast tier
+ */
+inline void fast_log10(float* bVector, const float* aVector, unsigned int num_points)
+{
+    namespace fm = fastmath_detail;
+    fm::map1(bVector, aVector, num_points, [](fm::vec x) {
+        return fm::mul(fm::log2(x), fm::set1(0.30102999566f));
+    });
+}
+
+/*!
+ * \brief Natural exponential, fast tier
+ */
+inline void fast_exp(float* bVector, const float* aVector, unsigned int num_points)
+{
+    fastmath_detail::map1(
+        bVector, aVector, num_points, [](fastmath_detail::vec x) {
+            return fastmath_detail::exp(x);
+        });
+}
+
+/*!
+ * \brief Sine and cosine, picking the fast tier when max_error allows it
+ *
+ * \details
+ *   With max_error below fast_sincos_max_error (the default 0) this calls
+ *   volk_32f_sin_32f and volk_32f_cos_32f.
+ *
+ * example code:
+ *   // AGC / soft demodulation can live with 1e-4
+ *   volk::sincos(s, c, phase, n, 1e-4f);
+ */
+inline void sincos(float* sinVector,
+                   float* cosVector,
+                   const float* inVector,
+                   unsigned int num_points,
+                   float max_error = 0.0f)
+{
+    if (max_error >= fast_sincos_max_error) {
+        fast_sincos(sinVector, cosVector, inVector, num_points);
+        return;
+    }
+    volk_32f_sin_32f(sinVector, inVector, num_points);
+    volk_32f_cos_32f(cosVector, inVector, num_points);
+}
+
+/*!
+ * \brief atan2(y, x), picking the fast tier when max_error allows it
+ *
+ * \details
+ *   The accurate tier interleaves the inputs into blocks for
+ *   volk_32fc_s32f_atan2_32f.
+ */
+inline void atan2(float* outVector,
+                  const float* yVector,
+                  const float* xVector,
+                  unsigned int num_points,
+                  float max_error = 0.0f)
+{
+    if (max_error >= fast_atan2_max_error) {
+        fast_atan2(outVector, yVector, xVector, num_points);
+        return;
+    }
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t block[256];
+    for (unsigned int offset = 0; offset < num_points; offset += 256) {
+        const unsigned int len = std::min(256u, num_points - offset);
+        for (unsigned int i = 0; i < len; i++)
+            block[i] = lv_cmake(xVector[offset + i], yVector[offset + i]);
+        volk_32fc_s32f_atan2_32f(outVector + offset, block, 1.0f, len);
+    }
+}
+
+/*!
+ * \brief Base 2 logarithm, picking the fast tier when max_error allows it
+ */
+inline void
+log2(float* bVector, const float* aVector, unsigned int num_points, float max_error = 0.0f)
+{
+    if (max_error >= fast_log2_max_error)
+        fast_log2(bVector, aVector, num_points);
+    else
+        volk_32f_log2_32f(bVector, aVector, num_points);
+}
+
+/*!
+ * \brief Base 10 logarithm, picking the fast tier when max_error allows it
+ */
+inline void
+log10(float* bVector, const float* aVector, unsigned int num_points, float max_error = 0.0f)
+{
+    if (max_error >= fast_log10_max_error) {
+        fast_log10(bVector, aVector, num_points);
+        return;
+    }
+    volk_32f_log2_32f(bVector, aVector, num_points);
+    volk_32f_s32f_multiply_32f(bVector, bVector, 0.30102999566f, num_points);
+}
+
+/*!
+ * \brief Natural exponential, picking the fast tier when max_error allows it
+ *
+ * \details
+ *   max_error is relative here.
+ */
+inline void
+exp(float* bVector, const float* aVector, unsigned int num_points, float max_error = 0.0f)
+{
+    if (max_error >= fast_exp_max_error)
+        fast_exp(bVector, aVector, num_points);
+    else
+        volk_32f_exp_32f(bVector, aVector, num_points);
+}
+
+} // namespace volk
+#endif // INCLUDED_VOLK_FASTMATH_H
@@ -0,0 +1,37 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_FFTW_H
+#define INCLUDED_VOLK_FFTW_H
+
+#include <mutex>
+
+namespace volk {
+
+/*!
+ * \brief Lock shared by every FFTW planner call of the VOLK C++ headers
+ *
+ * \details
+ *   Only fftwf_execute* is thread safe; fftwf_plan_* and
+ *   fftwf_destroy_plan must not run concurrently anywhere in the process.
+ *   Hold this lock around them so that fir_filter, channelizer and any
+ *   other user serialize with each other.
+ *
+ * example code:
+ *   std::lock_guard<std::mutex> guard(volk::fftw_planner_lock());
+ *   plan = fftwf_plan_dft_1d(n, in, out, FFTW_FORWARD, FFTW_MEASURE);
+ */
+inline std::mutex& fftw_planner_lock()
+{
+    static std::mutex lock;
+    return lock;
+}
+
+} // namespace volk
+#endif // INCLUDED_VOLK_FFTW_H
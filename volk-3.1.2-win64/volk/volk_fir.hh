@@ -0,0 +1,340 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_FIR_H
+#define INCLUDED_VOLK_FIR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fftw3.h>
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+#include <volk/volk_fftw.hh>
+
+namespace volk {
+
+/*!
+ * \brief Streaming complex FIR filter, direct or FFT overlap-save
+ *
+ * \details
+ *   Computes y[n] = sum_k taps[k] * x[n - k] across process() calls. Each
+ *   call returns exactly as many outputs as it is given inputs, with no
+ *   added latency, whichever method is used.
+ *
+ *   Short filters run one volk_32fc_x2_dot_prod_32fc per output. Long
+ *   filters use overlap-save with fftwf. The FFT size is the smaller of
+ *   8 * ntaps and block_size + ntaps - 1, rounded up to a power of 2. A
+ *   shorter process() call still costs one full FFT block, so block_size
+ *   should match the typical call length.
+ *
+ *   method::automatic compares the tap count with fft_crossover(block_size),
+ *   which calibrate() can re-measure for the running machine.
+ *   fftwf plans are created once per FFT size with FFTW_MEASURE and shared
+ *   between filters; planning is serialized internally.
+ *
+ * example code:
+ *   volk::fir_filter fir(taps, 4096);
+ *   for (;;) {
+ *       fir.process(out, in, 4096);
+ *       ...
+ *   }
+ */
+class fir_filter
+{
+public:
+    enum class method { automatic, direct, fft };
+
+    /*!
+     * \param taps filter coefficients, taps[0] applies to the newest sample
+     * \param block_size typical number of samples per process() call
+     * \param m force a method instead of using the crossover table
+     */
+    fir_filter(const std::vector<lv_32fc_t>& taps,
+               std::size_t block_size,
+               method m = method::automatic)
+        : d_ntaps(taps.size()), d_block(block_size)
+    {
+        if (taps.empty())
+            throw std::invalid_argument("fir_filter: no taps");
+        if (block_size == 0)
+            throw std::invalid_argument("fir_filter: block size must be > 0");
+
+        if (m == method::automatic)
+            m = d_ntaps >= fft_crossover(block_size) ? method::fft : method::direct;
+        d_method = m;
+
+        if (d_method == method::direct) {
+            d_rtaps.assign(taps.rbegin(), taps.rend());
+            d_buf.assign(d_ntaps - 1 + d_block, lv_cmake(0.0f, 0.0f));
+        } else {
+            init_fft(taps);
+        }
+    }
+
+    fir_filter(const fir_filter&) = delete;
+    fir_filter& operator=(const fir_filter&) = delete;
+
+    std::size_t ntaps() const { return d_ntaps; }
+    std::size_t block_size() const { return d_block; }
+    method active_method() const { return d_method; }
+
+    //! FFT length of the overlap-save path, 0 for the direct path
+    std::size_t fft_size() const { return d_method == method::fft ? d_fft_size : 0; }
+
+    /*!
+     * \brief Smallest tap count for which overlap-save beats direct dot products
+     *
+     * \details
+     *   Interpolated linearly in block_size from the crossover table and
+     *   clamped at its ends. The built-in table was measured on an AVX2 / FMA
+     *   machine. There the per-call cost of volk_32fc_x2_dot_prod_32fc
+     *   dominates short filters, so overlap-save already wins at a few taps.
+     *   calibrate() replaces the table with measurements on the running host.
+     */
+    static std::size_t fft_crossover(std::size_t block_size)
+    {
+        std::lock_guard<std::mutex> guard(table_lock());
+        const auto& table = crossover_table();
+        if (block_size <= table.front().first)
+            return table.front().second;
+        for (std::size_t i = 1; i < table.size(); i++) {
+            if (block_size <= table[i].first) {
+                const double t = double(block_size - table[i - 1].first) /
+                                 double(table[i].first - table[i - 1].first);
+                return static_cast<std::size_t>(
+                    table[i - 1].second +
+                    t * (double(table[i].second) - double(table[i - 1].second)) + 0.5);
+            }
+        }
+        return table.back().second;
+    }
+
+    /*!
+     * \brief Re-measures the crossover table on this machine
+     *
+     * \details
+     *   For each block size of the table, times both methods on a growing
+     *   grid of tap counts up to 1024 and records the first count where
+     *   overlap-save wins. Returns the new table. Most of the time goes into
+     *   FFTW_MEASURE planning of sizes not seen before. Filters that already
+     *   exist keep their method.
+     */
+    static std::vector<std::pair<std::size_t, std::size_t>> calibrate()
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> table;
+        {
+            std::lock_guard<std::mutex> guard(table_lock());
+            table = crossover_table();
+        }
+        // tap counts 1, 2, 3, 4, 6, 8, 12, ... up to 1024
+        std::vector<std::size_t> grid;
+        for (std::size_t n = 1; n <= 1024; n = n < 4 ? n + 1 : n + n / 2)
+            grid.push_back(n);
+        grid.push_back(1024);
+
+        for (auto& entry : table) {
+            auto fft_wins = [&](std::size_t n) {
+                return time_per_sample(n, entry.first, method::fft) <
+                       time_per_sample(n, entry.first, method::direct);
+            };
+            // two consecutive wins, so that one noisy timing does not decide
+            entry.second = grid.back();
+            for (std::size_t i = 0; i + 1 < grid.size(); i++) {
+                if (fft_wins(grid[i]) && fft_wins(grid[i + 1])) {
+                    entry.second = grid[i];
+                    break;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> guard(table_lock());
+        crossover_table() = table;
+        return table;
+    }
+
+    //! Clears the filter history
+    void reset()
+    {
+        if (d_method == method::direct)
+            std::fill(d_buf.begin(), d_buf.end(), lv_cmake(0.0f, 0.0f));
+        else
+            std::fill(d_time.begin(), d_time.end(), lv_cmake(0.0f, 0.0f));
+    }
+
+    //! Filters num_points samples; in and out may not overlap
+    void process(lv_32fc_t* out, const lv_32fc_t* in, std::size_t num_points)
+    {
+        while (num_points > 0) {
+            const std::size_t n =
+                std::min(num_points, d_method == method::direct ? d_block : d_step);
+            if (d_method == method::direct)
+                process_direct(out, in, n);
+            else
+                process_fft(out, in, n);
+            out += n;
+            in += n;
+            num_points -= n;
+        }
+    }
+
+private:
+    struct plan_pair {
+        fftwf_plan forward;
+        fftwf_plan inverse;
+    };
+
+    static std::mutex& table_lock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static std::vector<std::pair<std::size_t, std::size_t>>& crossover_table()
+    {
+        static std::vector<std::pair<std::size_t, std::size_t>> table = {
+            { 16, 4 }, { 64, 3 }, { 256, 3 }, { 1024, 3 }, { 4096, 3 }, { 16384, 3 }
+        };
+        return table;
+    }
+
+    static double time_per_sample(std::size_t ntaps, std::size_t block_size, method m)
+    {
+        const std::vector<lv_32fc_t> taps(ntaps, lv_cmake(0.5f, 0.25f));
+        volk::vector<lv_32fc_t> in(block_size, lv_cmake(1.0f, -1.0f));
+        volk::vector<lv_32fc_t> out(block_size);
+        fir_filter f(taps, block_size, m);
+        f.process(out.data(), in.data(), block_size);
+
+        std::size_t samples = 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed(0.0);
+        do {
+            f.process(out.data(), in.data(), block_size);
+            samples += block_size;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < 2e-3);
+        return elapsed.count() / samples;
+    }
+
+    // plans live for the whole process, one pair per FFT size
+    static plan_pair get_plans(int size)
+    {
+        static std::map<int, plan_pair> cache;
+
+        // also guards the cache
+        std::lock_guard<std::mutex> guard(fftw_planner_lock());
+        auto it = cache.find(size);
+        if (it != cache.end())
+            return it->second;
+
+        // volk_malloc alignment is at least what fftwf_malloc gives, so the
+        // plans are valid for fftwf_execute_dft on the filter buffers
+        auto a = static_cast<fftwf_complex*>(fftwf_malloc(sizeof(fftwf_complex) * size));
+        auto b = static_cast<fftwf_complex*>(fftwf_malloc(sizeof(fftwf_complex) * size));
+        plan_pair p;
+        p.forward = fftwf_plan_dft_1d(size, a, b, FFTW_FORWARD, FFTW_MEASURE);
+        p.inverse = fftwf_plan_dft_1d(size, a, b, FFTW_BACKWARD, FFTW_MEASURE);
+        fftwf_free(a);
+        fftwf_free(b);
+        if (!p.forward || !p.inverse) {
+            if (p.forward)
+                fftwf_destroy_plan(p.forward);
+            if (p.inverse)
+                fftwf_destroy_plan(p.inverse);
+            throw std::runtime_error("fir_filter: fftwf planning failed");
+        }
+        cache.emplace(size, p);
+        return p;
+    }
+
+    void init_fft(const std::vector<lv_32fc_t>& taps)
+    {
+        const std::size_t span = d_ntaps - 1 + d_block;
+        const std::size_t target = std::min(8 * d_ntaps, span);
+        d_fft_size = 1;
+        while (d_fft_size < target || d_fft_size < d_ntaps)
+            d_fft_size <<= 1;
+        d_step = d_fft_size - (d_ntaps - 1);
+        d_plans = get_plans(static_cast<int>(d_fft_size));
+
+        d_time.assign(d_fft_size, lv_cmake(0.0f, 0.0f));
+        d_freq.resize(d_fft_size);
+        d_out.resize(d_fft_size);
+        d_response.assign(d_fft_size, lv_cmake(0.0f, 0.0f));
+
+        // 1/N of the inverse transform is folded into the response
+        const float scale = 1.0f / static_cast<float>(d_fft_size);
+        for (std::size_t i = 0; i < d_ntaps; i++)
+            d_out[i] = taps[i] * scale;
+        std::fill(d_out.begin() + d_ntaps, d_out.end(), lv_cmake(0.0f, 0.0f));
+        fftwf_execute_dft(d_plans.forward,
+                          reinterpret_cast<fftwf_complex*>(d_out.data()),
+                          reinterpret_cast<fftwf_complex*>(d_response.data()));
+    }
+
+    void process_direct(lv_32fc_t* out, const lv_32fc_t* in, std::size_t n)
+    {
+        const std::size_t hist = d_ntaps - 1;
+        std::memcpy(&d_buf[hist], in, sizeof(lv_32fc_t) * n);
+        for (std::size_t i = 0; i < n; i++)
+            volk_32fc_x2_dot_prod_32fc(
+                out + i, &d_buf[i], d_rtaps.data(), static_cast<unsigned int>(d_ntaps));
+        std::memmove(&d_buf[0], &d_buf[n], sizeof(lv_32fc_t) * hist);
+    }
+
+    void process_fft(lv_32fc_t* out, const lv_32fc_t* in, std::size_t n)
+    {
+        // d_time holds the ntaps - 1 previous inputs followed by the new ones.
+        // Past the new samples it keeps stale data, which only reaches the
+        // outputs beyond n.
+        const std::size_t hist = d_ntaps - 1;
+        std::memcpy(&d_time[hist], in, sizeof(lv_32fc_t) * n);
+
+        fftwf_execute_dft(d_plans.forward,
+                          reinterpret_cast<fftwf_complex*>(d_time.data()),
+                          reinterpret_cast<fftwf_complex*>(d_freq.data()));
+        volk_32fc_x2_multiply_32fc(d_freq.data(),
+                                   d_freq.data(),
+                                   d_response.data(),
+                                   static_cast<unsigned int>(d_fft_size));
+        fftwf_execute_dft(d_plans.inverse,
+                          reinterpret_cast<fftwf_complex*>(d_freq.data()),
+                          reinterpret_cast<fftwf_complex*>(d_out.data()));
+
+        std::memcpy(out, &d_out[hist], sizeof(lv_32fc_t) * n);
+        std::memmove(&d_time[0], &d_time[n], sizeof(lv_32fc_t) * hist);
+    }
+
+    std::size_t d_ntaps;
+    std::size_t d_block;
+    method d_method;
+
+    // direct: reversed taps and history followed by the current block
+    volk::vector<lv_32fc_t> d_rtaps;
+    volk::vector<lv_32fc_t> d_buf;
+
+    // overlap-save
+    std::size_t d_fft_size = 0;
+    std::size_t d_step = 0;
+    plan_pair d_plans = {};
+    volk::vector<lv_32fc_t> d_time;
+    volk::vector<lv_32fc_t> d_freq;
+    volk::vector<lv_32fc_t> d_out;
+    volk::vector<lv_32fc_t> d_response;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_FIR_H
@@ -0,0 +1,307 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_IQ_H
+#define INCLUDED_VOLK_IQ_H
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+
+// sets the LV_HAVE_* of this translation unit for the kernel header
+#include <volk/volk_bind.hh>
+
+#include <volk/volk_32fc_s32fc_x2_iq_correct_32fc.h>
+#include <volk/volk_accumulate.hh>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace volk {
+
+namespace iq_detail {
+
+//! Per-sample means of x, x^2 and |x|^2 over one block
+struct block_moments {
+    std::complex<double> mean;
+    std::complex<double> square;
+    double power;
+};
+
+// at most accumulation_block points, centered on c so the float lanes
+// keep the precision of the signal rather than of its DC offset
+inline block_moments moments(const lv_32fc_t* input, lv_32fc_t c, unsigned int num_points)
+{
+    const float* x = reinterpret_cast<const float*>(input);
+    const float cr = lv_creal(c);
+    const float ci = lv_cimag(c);
+    // lanes hold (re, im) pairs: sum d, sum d * d, sum d * swap(d)
+    float s1[2] = { 0.0f, 0.0f };
+    float s2[2] = { 0.0f, 0.0f };
+    float sx = 0.0f;
+    unsigned int i = 0;
+#if defined(__AVX__)
+    {
+        const __m256 center = _mm256_setr_ps(cr, ci, cr, ci, cr, ci, cr, ci);
+        __m256 a1 = _mm256_setzero_ps();
+        __m256 a2 = _mm256_setzero_ps();
+        __m256 ax = _mm256_setzero_ps();
+        for (; i + 4 <= num_points; i += 4) {
+            const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(x + 2 * i), center);
+            a1 = _mm256_add_ps(a1, d);
+            a2 = _mm256_add_ps(a2, _mm256_mul_ps(d, d));
+            ax = _mm256_add_ps(ax, _mm256_mul_ps(d, _mm256_permute_ps(d, 0xb1)));
+        }
+        float t1[8], t2[8], tx[8];
+        _mm256_storeu_ps(t1, a1);
+        _mm256_storeu_ps(t2, a2);
+        _mm256_storeu_ps(tx, ax);
+        for (int k = 0; k < 8; k++) {
+            s1[k & 1] += t1[k];
+            s2[k & 1] += t2[k];
+            sx += tx[k];
+        }
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    {
+        const __m128 center = _mm_setr_ps(cr, ci, cr, ci);
+        __m128 a1 = _mm_setzero_ps();
+        __m128 a2 = _mm_setzero_ps();
+        __m128 ax = _mm_setzero_ps();
+        for (; i + 2 <= num_points; i += 2) {
+            const __m128 d = _mm_sub_ps(_mm_loadu_ps(x + 2 * i), center);
+            a1 = _mm_add_ps(a1, d);
+            a2 = _mm_add_ps(a2, _mm_mul_ps(d, d));
+            ax = _mm_add_ps(ax, _mm_mul_ps(d, _mm_shuffle_ps(d, d, 0xb1)));
+        }
+        float t1[4], t2[4], tx[4];
+        _mm_storeu_ps(t1, a1);
+        _mm_storeu_ps(t2, a2);
+        _mm_storeu_ps(tx, ax);
+        for (int k = 0; k < 4; k++) {
+            s1[k & 1] += t1[k];
+            s2[k & 1] += t2[k];
+            sx += tx[k];
+        }
+    }
+#endif
+    for (; i < num_points; i++) {
+        const float dr = x[2 * i] - cr;
+        const float di = x[2 * i + 1] - ci;
+        s1[0] += dr;
+        s1[1] += di;
+        s2[0] += dr * dr;
+        s2[1] += di * di;
+        sx += 2.0f * dr * di; // both lanes of a pair hold dr * di
+    }
+
+    // d^2 = dr^2 - di^2 + 2j dr di, and sx holds the sum of 2 dr di
+    const double scale = 1.0 / num_points;
+    block_moments m;
+    m.mean = std::complex<double>(s1[0] * scale, s1[1] * scale);
+    m.square = std::complex<double>((double(s2[0]) - s2[1]) * scale, sx * scale);
+    m.power = (double(s2[0]) + s2[1]) * scale;
+    return m;
+}
+
+inline void iq_correct(lv_32fc_t* out,
+                       const lv_32fc_t* in,
+                       lv_32fc_t dc,
+                       lv_32fc_t balance,
+                       unsigned int num_points)
+{
+#if defined(LV_HAVE_AVX2) && defined(LV_HAVE_FMA)
+    volk_32fc_s32fc_x2_iq_correct_32fc_u_avx2_fma(out, in, dc, balance, num_points);
+#elif defined(LV_HAVE_AVX)
+    volk_32fc_s32fc_x2_iq_correct_32fc_u_avx(out, in, dc, balance, num_points);
+#elif defined(LV_HAVE_SSE)
+    volk_32fc_s32fc_x2_iq_correct_32fc_u_sse(out, in, dc, balance, num_points);
+#elif defined(LV_HAVE_NEON)
+    volk_32fc_s32fc_x2_iq_correct_32fc_neon(out, in, dc, balance, num_points);
+#else
+    volk_32fc_s32fc_x2_iq_correct_32fc_generic(out, in, dc, balance, num_points);
+#endif
+}
+
+} // namespace iq_detail
+
+/*!
+ * \brief Blind DC offset and IQ imbalance estimator and corrector
+ *
+ * \details
+ *   Gain and phase mismatch between the I and Q paths turn a received
+ *   signal s into x = a s + b conj(s), which leaks an image of every
+ *   signal to the mirrored frequency. A proper (circular) signal has
+ *   E[s^2] = 0, so the estimator tracks only the second-order statistics
+ *   of the DC-free input, c = E[x^2] and p = E[|x|^2], and picks the
+ *   correction y = x + w conj(x) that makes E[y^2] zero:
+ *
+ *     w = -c / (p + sqrt(p^2 - |c|^2))
+ *
+ *   This is exact for any imbalance, needs no training signal, and holds
+ *   while the band is not dominated by a single real-valued or otherwise
+ *   improper signal. The DC offset is the mean of x.
+ *
+ *   The statistics are averaged over time_constant samples with an
+ *   exponential window, one update per estimate() call. process() runs
+ *   one SIMD pass over the block for the statistics and one pass of
+ *   volk_32fc_s32fc_x2_iq_correct_32fc, which removes the DC offset and
+ *   applies the correction together.
+ *
+ *   For drivers whose hasIQBalance() / hasDCOffset() is true, push() hands
+ *   the estimate to the hardware and stops correcting it in software.
+ *
+ * example code:
+ *   volk::iq_corrector iq(1 << 18);
+ *   device->readStream(stream, buffs, n, flags, time_ns);
+ *   iq.process(buf, buf, n);
+ *   if (iq.samples() > (1u << 20) && !pushed)
+ *       pushed = iq.push(*device, SOAPY_SDR_RX, 0);
+ */
+class iq_corrector
+{
+public:
+    /*!
+     * \param time_constant averaging length in samples
+     * \param correct_dc estimate and remove the DC offset as well
+     */
+    explicit iq_corrector(double time_constant = 1 << 18, bool correct_dc = true)
+        : d_time_constant(time_constant), d_correct_dc(correct_dc)
+    {
+        if (!(time_constant >= 1.0))
+            throw std::invalid_argument("iq_corrector: time_constant must be >= 1");
+    }
+
+    //! Updates the estimates from num_points samples
+    void estimate(const lv_32fc_t* input, unsigned int num_points)
+    {
+        for (unsigned int offset = 0; offset < num_points; offset += accumulation_block) {
+            const unsigned int n = std::min(accumulation_block, num_points - offset);
+            const lv_32fc_t center = lv_cmake(static_cast<float>(d_dc.real()),
+                                              static_cast<float>(d_dc.imag()));
+            const iq_detail::block_moments m =
+                iq_detail::moments(input + offset, center, n);
+
+            // the first block sets the estimates, later ones are averaged in
+            const double a =
+                d_samples == 0 ? 1.0 : -std::expm1(-double(n) / d_time_constant);
+            if (d_correct_dc)
+                d_dc += a * m.mean;
+            const std::complex<double> square = m.square - m.mean * m.mean;
+            const double power = m.power - std::norm(m.mean);
+            d_square += a * (square - d_square);
+            d_power += a * (power - d_power);
+            d_samples += n;
+        }
+        update_balance();
+    }
+
+    //! Removes the current DC and IQ estimates; out may be input
+    void correct(lv_32fc_t* out, const lv_32fc_t* input, unsigned int num_points) const
+    {
+        iq_detail::iq_correct(out,
+                              input,
+                              lv_cmake(static_cast<float>(d_dc.real()),
+                                       static_cast<float>(d_dc.imag())),
+                              lv_cmake(static_cast<float>(d_balance.real()),
+                                       static_cast<float>(d_balance.imag())),
+                              num_points);
+    }
+
+    //! estimate() then correct() with the updated estimates
+    void process(lv_32fc_t* out, const lv_32fc_t* input, unsigned int num_points)
+    {
+        estimate(input, num_points);
+        correct(out, input, num_points);
+    }
+
+    //! DC offset removed by correct()
+    std::complex<double> dc_offset() const { return d_dc; }
+
+    //! Image correction coefficient w of correct()
+    std::complex<double> balance() const { return d_balance; }
+
+    //! Estimated image rejection of the uncorrected input, |a / b|^2 in dB
+    double image_rejection_dB() const
+    {
+        const double w = std::abs(d_balance);
+        return w > 0.0 ? -20.0 * std::log10(w) : HUGE_VAL;
+    }
+
+    //! Samples seen by estimate() since construction or reset()
+    unsigned long long samples() const { return d_samples; }
+
+    void reset()
+    {
+        d_dc = 0.0;
+        d_square = 0.0;
+        d_power = 0.0;
+        d_balance = 0.0;
+        d_samples = 0;
+    }
+
+    /*!
+     * \brief Moves the estimates into the device front end
+     *
+     * \details
+     *   Device is any class with the SoapySDR::Device IQ balance and DC
+     *   offset calls. The correction each call supports is added to the
+     *   value last pushed, written with setIQBalance() / setDCOffset(),
+     *   and cleared here, so the software keeps estimating only what the
+     *   hardware leaves. The DC correction is the value to add, minus the
+     *   offset, and the IQ balance is w, both relative to a full scale of
+     *   1.0; drivers that define the SoapySDR relative correction
+     *   differently need their own mapping.
+     *
+     * \returns true when the IQ balance was pushed
+     */
+    template <class Device>
+    bool push(Device& device, int direction, std::size_t channel)
+    {
+        if (d_correct_dc && device.hasDCOffset(direction, channel)) {
+            d_device_dc -= d_dc;
+            device.setDCOffset(direction, channel, d_device_dc);
+            d_dc = 0.0;
+        }
+        if (!device.hasIQBalance(direction, channel))
+            return false;
+        d_device_balance += d_balance;
+        device.setIQBalance(direction, channel, d_device_balance);
+        // the new input is balanced, restart from the residual
+        d_square = 0.0;
+        d_balance = 0.0;
+        return true;
+    }
+
+private:
+    void update_balance()
+    {
+        const double disc = std::max(d_power * d_power - std::norm(d_square), 0.0);
+        const double den = d_power + std::sqrt(disc);
+        d_balance = den > 0.0 ? -d_square / den : std::complex<double>(0.0);
+    }
+
+    double d_time_constant;
+    bool d_correct_dc;
+    std::complex<double> d_dc = 0.0;     // mean of the input
+    std::complex<double> d_square = 0.0; // E[x^2] about the mean
+    double d_power = 0.0;                // E[|x|^2] about the mean
+    std::complex<double> d_balance = 0.0;
+    std::complex<double> d_device_dc = 0.0;
+    std::complex<double> d_device_balance = 0.0;
+    unsigned long long d_samples = 0;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_IQ_H
@@ -0,0 +1,409 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_PARALLEL_H
+#define INCLUDED_VOLK_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <volk/volk.h>
+
+namespace volk {
+
+/*!
+ * \brief Smallest number of points handed to a single thread
+ *
+ * \details
+ *   Calls with fewer than twice this many points run entirely on the
+ *   calling thread, where the dispatch cost would exceed the work.
+ */
+static const unsigned int parallel_min_points = 32768;
+
+/*!
+ * \brief Byte boundary every chunk but the last one is rounded to
+ *
+ * \details
+ *   Chunks start on a cache line so that two threads never write the same
+ *   line, and an aligned input buffer stays aligned for every chunk so the
+ *   dispatcher can still pick the _a kernels.
+ */
+static const unsigned int parallel_chunk_alignment = 64;
+
+/*!
+ * \brief Persistent worker pool used by the volk::parallel_* wrappers
+ *
+ * \details
+ *   The calling thread always takes part in run(), so a pool of size N owns
+ *   N - 1 worker threads. Concurrent run() calls on the same pool are
+ *   serialized. A run() made from inside a task of the same pool, such as
+ *   a pool-backed wrapper called from a parallel_for body, executes its
+ *   tasks inline on the calling thread instead of waiting for itself.
+ *
+ * example code:
+ *   volk::thread_pool pool(4);
+ *   pool.run(8, [&](unsigned int task) { ... });
+ */
+class thread_pool
+{
+public:
+    explicit thread_pool(unsigned int num_threads = 0)
+    {
+        if (num_threads == 0)
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned int i = 1; i < num_threads; i++)
+            d_workers.emplace_back(&thread_pool::worker, this);
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            d_stop = true;
+        }
+        d_wake.notify_all();
+        for (auto& t : d_workers)
+            t.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    //! Number of threads taking part in run(), including the caller
+    unsigned int size() const { return static_cast<unsigned int>(d_workers.size()) + 1; }
+
+    //! Calls f(task) for every task in [0, num_tasks) and returns when all are done
+    template <class F>
+    void run(unsigned int num_tasks, F&& f)
+    {
+        if (num_tasks <= 1 || d_workers.empty() || current() == this) {
+            for (unsigned int task = 0; task < num_tasks; task++)
+                f(task);
+            return;
+        }
+
+        std::lock_guard<std::mutex> run_lock(d_run_mutex);
+        {
+            std::unique_lock<std::mutex> lock(d_mutex);
+            // a worker that woke late for the previous run may still be in
+            // drain() with its task count
+            d_done.wait(lock, [this] { return d_active == 0; });
+            d_task = std::ref(f);
+            d_num_tasks = num_tasks;
+            d_pending = num_tasks;
+            d_next = 0;
+            d_generation++;
+        }
+        d_wake.notify_all();
+
+        drain(num_tasks);
+
+        std::unique_lock<std::mutex> lock(d_mutex);
+        d_done.wait(lock, [this] { return d_pending == 0 && d_active == 0; });
+        d_task = nullptr;
+    }
+
+    //! Process wide pool sized to the hardware concurrency, created on first use
+    static thread_pool& global()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+private:
+    //! Pool whose task the calling thread is executing, if any
+    static thread_pool*& current()
+    {
+        static thread_local thread_pool* pool = nullptr;
+        return pool;
+    }
+
+    // num_tasks is read under d_mutex by the caller; the generation cannot
+    // change while a thread is in here, as run() waits for d_active == 0
+    // before starting and before returning
+    void drain(unsigned int num_tasks)
+    {
+        thread_pool* const outer = current();
+        current() = this;
+        unsigned int task;
+        while ((task = d_next.fetch_add(1)) < num_tasks) {
+            d_task(task);
+            if (d_pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(d_mutex);
+                d_done.notify_all();
+            }
+        }
+        current() = outer;
+    }
+
+    void worker()
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(d_mutex);
+        for (;;) {
+            d_wake.wait(lock, [&] { return d_stop || d_generation != seen; });
+            if (d_stop)
+                return;
+            seen = d_generation;
+            const unsigned int num_tasks = d_num_tasks;
+            d_active++;
+            lock.unlock();
+
+            drain(num_tasks);
+
+            lock.lock();
+            if (--d_active == 0 && d_pending == 0)
+                d_done.notify_all();
+        }
+    }
+
+    std::vector<std::thread> d_workers;
+    std::mutex d_run_mutex;
+    std::mutex d_mutex;
+    std::condition_variable d_wake;
+    std::condition_variable d_done;
+    std::function<void(unsigned int)> d_task;
+    unsigned int d_num_tasks = 0;
+    std::atomic<unsigned int> d_next{ 0 };
+    std::atomic<unsigned int> d_pending{ 0 };
+    unsigned int d_active = 0;
+    uint64_t d_generation = 0;
+    bool d_stop = false;
+};
+
+/*!
+ * \brief How num_points elements of type T are split across a pool
+ *
+ * \details
+ *   chunk_points is a multiple of parallel_chunk_alignment bytes; the last
+ *   chunk holds the remainder. num_chunks is 1 for small inputs.
+ */
+template <class T>
+struct parallel_split {
+    unsigned int chunk_points;
+    unsigned int num_chunks;
+
+    parallel_split(unsigned int num_points,
+                   const thread_pool& pool,
+                   unsigned int min_points = parallel_min_points)
+    {
+        const unsigned int line_points =
+            std::max<unsigned int>(1, parallel_chunk_alignment / sizeof(T));
+        const unsigned int max_chunks =
+            std::max(1u, std::min(pool.size(), num_points / std::max(1u, min_points)));
+
+        chunk_points = (num_points + max_chunks - 1) / max_chunks;
+        chunk_points = (chunk_points + line_points - 1) / line_points * line_points;
+        chunk_points = std::max(1u, chunk_points);
+        num_chunks = std::max(1u, (num_points + chunk_points - 1) / chunk_points);
+    }
+
+    unsigned int offset(unsigned int chunk) const { return chunk * chunk_points; }
+
+    unsigned int length(unsigned int chunk, unsigned int num_points) const
+    {
+        return std::min(chunk_points, num_points - offset(chunk));
+    }
+};
+
+/*!
+ * \brief Runs f(offset, length, chunk) over cache-line-aligned chunks of num_points
+ *
+ * \details
+ *   Small inputs are processed by a single f(0, num_points, 0) call on the
+ *   calling thread.
+ *
+ * example code:
+ *   volk::parallel_for<float>(n, [&](unsigned int off, unsigned int len, unsigned int) {
+ *       volk_32f_x2_add_32f(c + off, a + off, b + off, len);
+ *   });
+ */
+template <class T, class F>
+void parallel_for(unsigned int num_points,
+                  F&& f,
+                  thread_pool& pool = thread_pool::global(),
+                  unsigned int min_points = parallel_min_points)
+{
+    const parallel_split<T> split(num_points, pool, min_points);
+    if (split.num_chunks == 1) {
+        f(0u, num_points, 0u);
+        return;
+    }
+    pool.run(split.num_chunks, [&](unsigned int chunk) {
+        f(split.offset(chunk), split.length(chunk, num_points), chunk);
+    });
+}
+
+/*!
+ * \brief Parallel volk_32fc_x2_multiply_32fc
+ */
+inline void parallel_32fc_x2_multiply_32fc(lv_32fc_t* cVector,
+                                           const lv_32fc_t* aVector,
+                                           const lv_32fc_t* bVector,
+                                           unsigned int num_points,
+                                           thread_pool& pool = thread_pool::global())
+{
+    parallel_for<lv_32fc_t>(
+        num_points,
+        [&](unsigned int offset, unsigned int length, unsigned int) {
+            volk_32fc_x2_multiply_32fc(
+                cVector + offset, aVector + offset, bVector + offset, length);
+        },
+        pool);
+}
+
+/*!
+ * \brief Parallel volk_32f_x2_dot_prod_32f
+ *
+ * \details
+ *   Per-chunk partial sums are combined in chunk order in double precision,
+ *   so the result does not depend on thread scheduling.
+ */
+inline void parallel_32f_x2_dot_prod_32f(float* result,
+                                         const float* input,
+                                         const float* taps,
+                                         unsigned int num_points,
+                                         thread_pool& pool = thread_pool::global())
+{
+    const parallel_split<float> split(num_points, pool);
+    if (split.num_chunks == 1) {
+        volk_32f_x2_dot_prod_32f(result, input, taps, num_points);
+        return;
+    }
+
+    std::vector<float> partial(split.num_chunks);
+    pool.run(split.num_chunks, [&](unsigned int chunk) {
+        const unsigned int offset = split.offset(chunk);
+        volk_32f_x2_dot_prod_32f(&partial[chunk],
+                                 input + offset,
+                                 taps + offset,
+                                 split.length(chunk, num_points));
+    });
+
+    double sum = 0.0;
+    for (float p : partial)
+        sum += p;
+    *result = static_cast<float>(sum);
+}
+
+/*!
+ * \brief Parallel volk_32fc_x2_dot_prod_32fc
+ *
+ * \details
+ *   Partial sums are combined the same way as parallel_32f_x2_dot_prod_32f.
+ */
+inline void parallel_32fc_x2_dot_prod_32fc(lv_32fc_t* result,
+                                           const lv_32fc_t* input,
+                                           const lv_32fc_t* taps,
+                                           unsigned int num_points,
+                                           thread_pool& pool = thread_pool::global())
+{
+    const parallel_split<lv_32fc_t> split(num_points, pool);
+    if (split.num_chunks == 1) {
+        volk_32fc_x2_dot_prod_32fc(result, input, taps, num_points);
+        return;
+    }
+
+    std::vector<lv_32fc_t> partial(split.num_chunks);
+    pool.run(split.num_chunks, [&](unsigned int chunk) {
+        const unsigned int offset = split.offset(chunk);
+        volk_32fc_x2_dot_prod_32fc(&partial[chunk],
+                                   input + offset,
+                                   taps + offset,
+                                   split.length(chunk, num_points));
+    });
+
+    double re = 0.0, im = 0.0;
+    for (const lv_32fc_t& p : partial) {
+        re += lv_creal(p);
+        im += lv_cimag(p);
+    }
+    *result = lv_cmake(static_cast<float>(re), static_cast<float>(im));
+}
+
+/*!
+ * \brief Parallel volk_32f_index_max_32u
+ *
+ * \details
+ *   Ties resolve to the lowest index, as in the serial kernel.
+ */
+inline void parallel_32f_index_max_32u(uint32_t* target,
+                                       const float* src0,
+                                       uint32_t num_points,
+                                       thread_pool& pool = thread_pool::global())
+{
+    const parallel_split<float> split(num_points, pool);
+    if (split.num_chunks == 1) {
+        volk_32f_index_max_32u(target, src0, num_points);
+        return;
+    }
+
+    std::vector<uint32_t> index(split.num_chunks);
+    pool.run(split.num_chunks, [&](unsigned int chunk) {
+        const unsigned int offset = split.offset(chunk);
+        volk_32f_index_max_32u(
+            &index[chunk], src0 + offset, split.length(chunk, num_points));
+        index[chunk] += offset;
+    });
+
+    uint32_t best = index[0];
+    for (unsigned int chunk = 1; chunk < split.num_chunks; chunk++) {
+        if (src0[index[chunk]] > src0[best])
+            best = index[chunk];
+    }
+    *target = best;
+}
+
+/*!
+ * \brief Parallel volk_32fc_index_max_32u
+ *
+ * \details
+ *   Chunk winners are compared by squared magnitude; ties resolve to the
+ *   lowest index, as in the serial kernel.
+ */
+inline void parallel_32fc_index_max_32u(uint32_t* target,
+                                        lv_32fc_t* src0,
+                                        uint32_t num_points,
+                                        thread_pool& pool = thread_pool::global())
+{
+    const parallel_split<lv_32fc_t> split(num_points, pool);
+    if (split.num_chunks == 1) {
+        volk_32fc_index_max_32u(target, src0, num_points);
+        return;
+    }
+
+    std::vector<uint32_t> index(split.num_chunks);
+    pool.run(split.num_chunks, [&](unsigned int chunk) {
+        const unsigned int offset = split.offset(chunk);
+        volk_32fc_index_max_32u(
+            &index[chunk], src0 + offset, split.length(chunk, num_points));
+        index[chunk] += offset;
+    });
+
+    auto mag2 = [&](uint32_t i) {
+        return lv_creal(src0[i]) * lv_creal(src0[i]) +
+               lv_cimag(src0[i]) * lv_cimag(src0[i]);
+    };
+    uint32_t best = index[0];
+    for (unsigned int chunk = 1; chunk < split.num_chunks; chunk++) {
+        if (mag2(index[chunk]) > mag2(best))
+            best = index[chunk];
+    }
+    *target = best;
+}
+
+} // namespace volk
+#endif // INCLUDED_VOLK_PARALLEL_H
@@ -0,0 +1,606 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_POLAR_H
+#define INCLUDED_VOLK_POLAR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <volk/volk_alloc.hh>
+
+namespace volk {
+
+/*!
+ * \brief Successive-cancellation (list) decoder for the VOLK polar encoders
+ *
+ * \details
+ *   Decodes frames produced by volk_8u_x2_encodeframepolar_8u. Channel LLRs
+ *   are positive for a 0 bit, as for volk_32f_8u_polarbutterfly_32f.
+ *
+ *   With a list size of 1 the decoder walks the frame bit by bit through
+ *   volk_32f_8u_polarbutterfly_32f. Larger lists (up to 32) run an LLR based
+ *   SC-List decoder with lazily copied per-path buffers and SIMD min-sum
+ *   updates; when a CRC is configured the most likely path passing the CRC
+ *   is returned.
+ *
+ *   The frozen mask holds one flag per frame bit (1 = frozen to 0). The
+ *   remaining info positions carry the payload followed by crc_bits CRC bits,
+ *   computed MSB first over the payload with a zero initial register.
+ *
+ * example code:
+ *   // N=512, K=256 including a 5G CRC11
+ *   volk::polar_decoder dec(volk::polar_decoder::frozen_mask(512, 256), 8, 0x621, 11);
+ *   std::vector<unsigned char> payload(dec.payload_bits());
+ *   bool ok = dec.decode(payload.data(), llrs);
+ */
+class polar_decoder
+{
+public:
+    //! Largest supported list size
+    static const unsigned int max_list_size = 32;
+
+    /*!
+     * \param frozen one flag per frame bit, 1 = frozen; size must be a power of 2
+     * \param list_size number of surviving paths, 1 = plain SC
+     * \param crc_poly CRC generator without the leading x^crc_bits term
+     * \param crc_bits CRC length, 0 for no CRC
+     */
+    explicit polar_decoder(const std::vector<unsigned char>& frozen,
+                           unsigned int list_size = 1,
+                           uint32_t crc_poly = 0,
+                           unsigned int crc_bits = 0)
+        : d_size(static_cast<unsigned int>(frozen.size())),
+          d_list(list_size),
+          d_crc_poly(crc_poly),
+          d_crc_bits(crc_bits),
+          d_frozen(frozen)
+    {
+        if (d_size < 2 || (d_size & (d_size - 1)) != 0 || d_size > (1u << 15))
+            throw std::invalid_argument(
+                "polar_decoder: frame size must be a power of 2 in [2, 32768]");
+        if (d_list < 1 || d_list > max_list_size)
+            throw std::invalid_argument("polar_decoder: list size must be in [1, 32]");
+        if (d_crc_bits > 32)
+            throw std::invalid_argument("polar_decoder: CRC longer than 32 bits");
+
+        while ((1u << d_exp) < d_size)
+            d_exp++;
+        for (unsigned int i = 0; i < d_size; i++) {
+            if (!d_frozen[i])
+                d_info.push_back(i);
+        }
+        if (d_info.size() < d_crc_bits)
+            throw std::invalid_argument("polar_decoder: fewer info bits than CRC bits");
+
+        d_tree_llrs.resize(static_cast<size_t>(d_size) * (d_exp + 1));
+        d_tree_u.resize(static_cast<size_t>(d_size) * (d_exp + 1));
+        d_u.resize(d_size);
+
+        if (d_list > 1) {
+            d_channel.resize(d_size);
+            d_base.resize(d_exp + 1);
+            for (unsigned int d = 0; d < d_exp; d++)
+                d_base[d + 1] = d_base[d] + d_list * (d_size >> d);
+            d_alpha.resize(d_base[d_exp]);
+            d_beta.resize(d_base[d_exp]);
+            d_alpha_idx.resize(d_exp * d_list);
+            d_beta_idx.resize(d_exp * d_list);
+            d_alpha_ref.resize(d_exp * d_list);
+            d_beta_ref.resize(d_exp * d_list);
+            d_metric.resize(d_list);
+            d_trace_bit.resize(static_cast<size_t>(d_size) * d_list);
+            d_trace_parent.resize(static_cast<size_t>(d_size) * d_list);
+        }
+    }
+
+    unsigned int frame_size() const { return d_size; }
+    unsigned int list_size() const { return d_list; }
+    unsigned int info_bits() const { return static_cast<unsigned int>(d_info.size()); }
+    unsigned int payload_bits() const { return info_bits() - d_crc_bits; }
+
+    /*!
+     * \brief Frozen mask from the Bhattacharyya bound of a BPSK / AWGN channel
+     *
+     * \details
+     *   Freezes the frame_size - info_bits least reliable positions for the
+     *   given design Es/N0, in the bit order of volk_8u_x2_encodeframepolar_8u.
+     */
+    static std::vector<unsigned char>
+    frozen_mask(unsigned int frame_size, unsigned int info_bits, float design_snr_db = 0.0f)
+    {
+        if (frame_size == 0 || (frame_size & (frame_size - 1)) != 0 ||
+            info_bits > frame_size)
+            throw std::invalid_argument("polar_decoder: invalid frozen_mask geometry");
+
+        // the encoder bit-reverses u, so the split closest to the channel is
+        // the LSB of the bit index
+        std::vector<double> z(1, std::exp(-std::pow(10.0, design_snr_db / 10.0)));
+        for (unsigned int len = 1; len < frame_size; len <<= 1) {
+            std::vector<double> next(2 * len);
+            for (unsigned int i = 0; i < len; i++) {
+                next[2 * i] = 2.0 * z[i] - z[i] * z[i];
+                next[2 * i + 1] = z[i] * z[i];
+            }
+            z.swap(next);
+        }
+
+        std::vector<unsigned int> order(frame_size);
+        for (unsigned int i = 0; i < frame_size; i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+            return z[a] > z[b];
+        });
+        std::vector<unsigned char> frozen(frame_size, 0);
+        for (unsigned int i = 0; i < frame_size - info_bits; i++)
+            frozen[order[i]] = 1;
+        return frozen;
+    }
+
+    /*!
+     * \brief Encodes payload_bits() bits (one per byte) into a frame of hard bits
+     */
+    void encode(unsigned char* frame, const unsigned char* payload)
+    {
+        std::fill(d_u.begin(), d_u.end(), 0);
+        const unsigned int payload_len = payload_bits();
+        for (unsigned int i = 0; i < payload_len; i++)
+            d_u[d_info[i]] = payload[i] & 1;
+        const uint32_t crc = crc_of(payload, payload_len);
+        for (unsigned int i = 0; i < d_crc_bits; i++)
+            d_u[d_info[payload_len + i]] = crc >> (d_crc_bits - 1 - i) & 1;
+
+        volk_8u_x2_encodeframepolar_8u(frame, d_u.data(), d_size);
+    }
+
+    /*!
+     * \brief Decodes one frame of frame_size() channel LLRs
+     *
+     * \details
+     *   Writes payload_bits() bits, one per byte. Returns false when a CRC is
+     *   configured and no surviving path passes it; the most likely path is
+     *   returned in that case.
+     */
+    bool decode(unsigned char* payload, const float* llrs)
+    {
+        if (d_list == 1)
+            decode_sc(llrs);
+        else
+            decode_list(llrs);
+
+        // decode_list leaves the paths ordered by metric in d_order
+        const unsigned int candidates = d_list == 1 ? 1 : d_paths;
+        for (unsigned int c = 0; c < candidates; c++) {
+            if (d_list > 1)
+                trace(d_order[c]);
+            collect_info();
+            if (crc_ok()) {
+                std::copy(d_info_u.begin(), d_info_u.begin() + payload_bits(), payload);
+                return true;
+            }
+        }
+
+        if (d_list > 1) {
+            trace(d_order[0]);
+            collect_info();
+        }
+        std::copy(d_info_u.begin(), d_info_u.begin() + payload_bits(), payload);
+        return false;
+    }
+
+private:
+    uint32_t crc_of(const unsigned char* bits, unsigned int len) const
+    {
+        if (d_crc_bits == 0)
+            return 0;
+        const uint32_t top = 1u << (d_crc_bits - 1);
+        const uint32_t mask = d_crc_bits == 32 ? 0xffffffffu : (top << 1) - 1;
+        uint32_t reg = 0;
+        for (unsigned int i = 0; i < len; i++) {
+            const bool feedback = ((reg & top) != 0) != ((bits[i] & 1) != 0);
+            reg = (reg << 1) & mask;
+            if (feedback)
+                reg ^= d_crc_poly & mask;
+        }
+        return reg;
+    }
+
+    bool crc_ok() const
+    {
+        const unsigned int payload_len = payload_bits();
+        const uint32_t crc = crc_of(d_info_u.data(), payload_len);
+        for (unsigned int i = 0; i < d_crc_bits; i++) {
+            if ((crc >> (d_crc_bits - 1 - i) & 1) != d_info_u[payload_len + i])
+                return false;
+        }
+        return true;
+    }
+
+    void collect_info()
+    {
+        d_info_u.resize(d_info.size());
+        for (size_t i = 0; i < d_info.size(); i++)
+            d_info_u[i] = d_u[d_info[i]];
+    }
+
+    void decode_sc(const float* llrs)
+    {
+        float* tree = d_tree_llrs.data();
+        unsigned char* u = d_tree_u.data();
+        std::memcpy(tree + static_cast<size_t>(d_exp) * d_size, llrs, sizeof(float) * d_size);
+        std::memset(u, 0, d_size);
+
+        for (unsigned int bit = 0; bit < d_size; bit++) {
+            volk_32f_8u_polarbutterfly_32f(
+                tree, u, static_cast<int>(d_exp), 0, static_cast<int>(bit), static_cast<int>(bit));
+            u[bit] = d_frozen[bit] ? 0 : (tree[bit] > 0 ? 0 : 1);
+        }
+        std::copy(u, u + d_size, d_u.begin());
+    }
+
+    // min-sum check node: sign(a) sign(b) min(|a|, |b|)
+    static void f_llrs(float* dst, const float* a, const float* b, unsigned int len)
+    {
+        unsigned int i = 0;
+#if defined(__AVX2__)
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        for (; i + 8 <= len; i += 8) {
+            const __m256 va = _mm256_loadu_ps(a + i);
+            const __m256 vb = _mm256_loadu_ps(b + i);
+            const __m256 mag =
+                _mm256_min_ps(_mm256_andnot_ps(sign, va), _mm256_andnot_ps(sign, vb));
+            _mm256_storeu_ps(
+                dst + i, _mm256_or_ps(mag, _mm256_and_ps(sign, _mm256_xor_ps(va, vb))));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        for (; i + 4 <= len; i += 4) {
+            const __m128 va = _mm_loadu_ps(a + i);
+            const __m128 vb = _mm_loadu_ps(b + i);
+            const __m128 mag = _mm_min_ps(_mm_andnot_ps(sign, va), _mm_andnot_ps(sign, vb));
+            _mm_storeu_ps(dst + i, _mm_or_ps(mag, _mm_and_ps(sign, _mm_xor_ps(va, vb))));
+        }
+#endif
+        for (; i < len; i++) {
+            const float mag = std::min(std::fabs(a[i]), std::fabs(b[i]));
+            dst[i] = (a[i] < 0) != (b[i] < 0) ? -mag : mag;
+        }
+    }
+
+    // variable node given the partial sums u of the upper branch: b + (1 - 2u) a
+    static void
+    g_llrs(float* dst, const float* a, const float* b, const unsigned char* u, unsigned int len)
+    {
+        unsigned int i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= len; i += 8) {
+            const __m128i bits = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + i));
+            const __m256 flip = _mm256_castsi256_ps(
+                _mm256_slli_epi32(_mm256_cvtepu8_epi32(bits), 31));
+            _mm256_storeu_ps(dst + i,
+                             _mm256_add_ps(_mm256_loadu_ps(b + i),
+                                           _mm256_xor_ps(_mm256_loadu_ps(a + i), flip)));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 4 <= len; i += 4) {
+            int packed;
+            std::memcpy(&packed, u + i, sizeof(packed));
+            const __m128i bits = _mm_unpacklo_epi16(
+                _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+            const __m128 flip = _mm_castsi128_ps(_mm_slli_epi32(bits, 31));
+            _mm_storeu_ps(dst + i,
+                          _mm_add_ps(_mm_loadu_ps(b + i), _mm_xor_ps(_mm_loadu_ps(a + i), flip)));
+        }
+#endif
+        for (; i < len; i++)
+            dst[i] = u[i] ? b[i] - a[i] : b[i] + a[i];
+    }
+
+    // buffer s of depth d, N >> d entries
+    size_t offset(unsigned int d, unsigned int s) const
+    {
+        return d_base[d] + static_cast<size_t>(s) * (d_size >> d);
+    }
+
+    const float* alpha(unsigned int d, unsigned int path) const
+    {
+        return d == 0 ? d_channel.data()
+                      : d_alpha.data() + offset(d, d_alpha_idx[d * d_list + path]);
+    }
+
+    const unsigned char* beta(unsigned int d, unsigned int path) const
+    {
+        return d_beta.data() + offset(d, d_beta_idx[d * d_list + path]);
+    }
+
+    // makes path the only owner of its depth d buffer, copying shared contents
+    // when asked to
+    static unsigned int acquire(std::vector<unsigned int>& idx,
+                                std::vector<unsigned int>& ref,
+                                unsigned int d,
+                                unsigned int path,
+                                unsigned int list)
+    {
+        unsigned int& s = idx[d * list + path];
+        if (ref[d * list + s] == 1)
+            return s;
+        unsigned int free_s = 0;
+        while (ref[d * list + free_s] != 0)
+            free_s++;
+        ref[d * list + s]--;
+        ref[d * list + free_s] = 1;
+        s = free_s;
+        return s;
+    }
+
+    float* alpha_write(unsigned int d, unsigned int path)
+    {
+        return d_alpha.data() + offset(d, acquire(d_alpha_idx, d_alpha_ref, d, path, d_list));
+    }
+
+    unsigned char* beta_write(unsigned int d, unsigned int path, bool keep)
+    {
+        const unsigned int old_s = d_beta_idx[d * d_list + path];
+        const unsigned int s = acquire(d_beta_idx, d_beta_ref, d, path, d_list);
+        unsigned char* dst = d_beta.data() + offset(d, s);
+        if (keep && s != old_s)
+            std::memcpy(dst, d_beta.data() + offset(d, old_s), d_size >> d);
+        return dst;
+    }
+
+    void decode_list(const float* llrs)
+    {
+        // the encoder bit-reverses u; undo it on the channel side so the
+        // recursion below splits frames into contiguous halves
+        for (unsigned int i = 0; i < d_size; i++) {
+            unsigned int r = 0;
+            for (unsigned int b = 0; b < d_exp; b++)
+                r |= (i >> b & 1) << (d_exp - 1 - b);
+            d_channel[r] = llrs[i];
+        }
+
+        // a single path in slot 0 owning buffer 0 of every depth
+        std::fill(d_alpha_ref.begin(), d_alpha_ref.end(), 0);
+        std::fill(d_beta_ref.begin(), d_beta_ref.end(), 0);
+        for (unsigned int d = 0; d < d_exp; d++) {
+            d_alpha_idx[d * d_list] = 0;
+            d_beta_idx[d * d_list] = 0;
+            d_alpha_ref[d * d_list] = 1;
+            d_beta_ref[d * d_list] = 1;
+        }
+        d_paths = 1;
+        d_active[0] = 0;
+        d_metric[0] = 0.0f;
+
+        node(0, 0);
+
+        d_order.assign(d_active, d_active + d_paths);
+        std::sort(d_order.begin(), d_order.end(), [&](unsigned int a, unsigned int b) {
+            return d_metric[a] < d_metric[b] || (d_metric[a] == d_metric[b] && a < b);
+        });
+    }
+
+    void node(unsigned int d, unsigned int first)
+    {
+        if (d + 1 == d_exp) {
+            node_pair(first);
+            return;
+        }
+
+        const unsigned int half = d_size >> (d + 1);
+        for (unsigned int p = 0; p < d_paths; p++) {
+            const unsigned int l = d_active[p];
+            const float* a = alpha(d, l);
+            f_llrs(alpha_write(d + 1, l), a, a + half, half);
+        }
+        node(d + 1, first);
+
+        for (unsigned int p = 0; p < d_paths; p++) {
+            const unsigned int l = d_active[p];
+            unsigned char* upper = beta_write(d, l, false);
+            std::memcpy(upper, beta(d + 1, l), half);
+            const float* a = alpha(d, l);
+            g_llrs(alpha_write(d + 1, l), a, a + half, upper, half);
+        }
+        node(d + 1, first + half);
+
+        for (unsigned int p = 0; p < d_paths; p++) {
+            const unsigned int l = d_active[p];
+            unsigned char* out = beta_write(d, l, true);
+            const unsigned char* lower = beta(d + 1, l);
+            for (unsigned int i = 0; i < half; i++) {
+                out[i] ^= lower[i];
+                out[half + i] = lower[i];
+            }
+        }
+    }
+
+    // the last stage runs on scalars: the two leaf LLRs and bits of every
+    // path live in d_leaf_llr and d_leaf_bit instead of depth d_exp buffers
+    void node_pair(unsigned int first)
+    {
+        const unsigned int d = d_exp - 1;
+        for (unsigned int p = 0; p < d_paths; p++) {
+            const unsigned int l = d_active[p];
+            const float* a = alpha(d, l);
+            f_llrs(&d_leaf_llr[l], a, a + 1, 1);
+        }
+        leaf(first);
+
+        for (unsigned int p = 0; p < d_paths; p++) {
+            const unsigned int l = d_active[p];
+            beta_write(d, l, false)[0] = d_leaf_bit[l];
+            const float* a = alpha(d, l);
+            g_llrs(&d_leaf_llr[l], a, a + 1, &d_leaf_bit[l], 1);
+        }
+        leaf(first + 1);
+
+        for (unsigned int p = 0; p < d_paths; p++) {
+            const unsigned int l = d_active[p];
+            unsigned char* out = beta_write(d, l, true);
+            out[0] ^= d_leaf_bit[l];
+            out[1] = d_leaf_bit[l];
+        }
+    }
+
+    void leaf(unsigned int bit)
+    {
+        unsigned char* trace_bit = &d_trace_bit[static_cast<size_t>(bit) * d_list];
+        unsigned char* trace_parent = &d_trace_parent[static_cast<size_t>(bit) * d_list];
+
+        if (d_frozen[bit]) {
+            for (unsigned int p = 0; p < d_paths; p++) {
+                const unsigned int l = d_active[p];
+                if (d_leaf_llr[l] < 0)
+                    d_metric[l] -= d_leaf_llr[l];
+                d_leaf_bit[l] = 0;
+                trace_bit[l] = 0;
+                trace_parent[l] = static_cast<unsigned char>(l);
+            }
+            return;
+        }
+
+        // candidate 2 p + u extends active path p with bit u
+        const unsigned int candidates = 2 * d_paths;
+        for (unsigned int p = 0; p < d_paths; p++) {
+            const unsigned int l = d_active[p];
+            const float llr = d_leaf_llr[l];
+            d_cand_metric[2 * p] = d_metric[l] + (llr < 0 ? -llr : 0.0f);
+            d_cand_metric[2 * p + 1] = d_metric[l] + (llr > 0 ? llr : 0.0f);
+            d_keep[2 * p] = d_keep[2 * p + 1] = 1;
+        }
+        if (candidates > d_list) {
+            for (unsigned int c = 0; c < candidates; c++)
+                d_cand[c] = c;
+            std::nth_element(d_cand,
+                             d_cand + d_list,
+                             d_cand + candidates,
+                             [&](unsigned int a, unsigned int b) {
+                                 return d_cand_metric[a] < d_cand_metric[b] ||
+                                        (d_cand_metric[a] == d_cand_metric[b] && a < b);
+                             });
+            for (unsigned int c = d_list; c < candidates; c++)
+                d_keep[d_cand[c]] = 0;
+        }
+
+        // drop paths without surviving children first so their slots can be reused
+        unsigned int parents[max_list_size];
+        const unsigned int num_parents = d_paths;
+        std::copy(d_active, d_active + num_parents, parents);
+        unsigned int free_slots[max_list_size];
+        unsigned int num_free = 0;
+        bool used[max_list_size] = {};
+        for (unsigned int p = 0; p < num_parents; p++)
+            used[parents[p]] = true;
+        for (unsigned int p = 0; p < num_parents; p++) {
+            if (!d_keep[2 * p] && !d_keep[2 * p + 1]) {
+                release(parents[p]);
+                used[parents[p]] = false;
+            }
+        }
+        for (unsigned int l = 0; l < d_list; l++) {
+            if (!used[l])
+                free_slots[num_free++] = l;
+        }
+
+        // a path keeps its slot for its first surviving child, a second
+        // child is cloned into a free slot
+        d_paths = 0;
+        for (unsigned int p = 0; p < num_parents; p++) {
+            const unsigned int l = parents[p];
+            for (unsigned int u = 0; u < 2; u++) {
+                if (!d_keep[2 * p + u])
+                    continue;
+                unsigned int slot = l;
+                if (u == 1 && d_keep[2 * p]) {
+                    slot = free_slots[--num_free];
+                    clone(l, slot);
+                }
+                d_metric[slot] = d_cand_metric[2 * p + u];
+                trace_bit[slot] = static_cast<unsigned char>(u);
+                trace_parent[slot] = static_cast<unsigned char>(l);
+                d_leaf_bit[slot] = static_cast<unsigned char>(u);
+                d_active[d_paths++] = slot;
+            }
+        }
+    }
+
+    void release(unsigned int path)
+    {
+        for (unsigned int d = 0; d < d_exp; d++) {
+            d_alpha_ref[d * d_list + d_alpha_idx[d * d_list + path]]--;
+            d_beta_ref[d * d_list + d_beta_idx[d * d_list + path]]--;
+        }
+    }
+
+    void clone(unsigned int from, unsigned int to)
+    {
+        for (unsigned int d = 0; d < d_exp; d++) {
+            const unsigned int a = d_alpha_idx[d * d_list + to] = d_alpha_idx[d * d_list + from];
+            const unsigned int b = d_beta_idx[d * d_list + to] = d_beta_idx[d * d_list + from];
+            d_alpha_ref[d * d_list + a]++;
+            d_beta_ref[d * d_list + b]++;
+        }
+    }
+
+    // rebuilds d_u for the surviving path ending in slot path
+    void trace(unsigned int path)
+    {
+        for (unsigned int bit = d_size; bit-- > 0;) {
+            d_u[bit] = d_trace_bit[static_cast<size_t>(bit) * d_list + path];
+            path = d_trace_parent[static_cast<size_t>(bit) * d_list + path];
+        }
+    }
+
+    unsigned int d_size;
+    unsigned int d_exp = 0;
+    unsigned int d_list;
+    uint32_t d_crc_poly;
+    unsigned int d_crc_bits;
+    std::vector<unsigned char> d_frozen;
+    std::vector<unsigned int> d_info;
+    std::vector<unsigned char> d_u;
+    std::vector<unsigned char> d_info_u;
+
+    // list size 1: volk_32f_8u_polarbutterfly_32f work buffers
+    volk::vector<float> d_tree_llrs;
+    volk::vector<unsigned char> d_tree_u;
+
+    // list decoding state
+    volk::vector<float> d_channel;
+    volk::vector<float> d_alpha;
+    volk::vector<unsigned char> d_beta;
+    std::vector<size_t> d_base;
+    std::vector<unsigned int> d_alpha_idx, d_beta_idx;
+    std::vector<unsigned int> d_alpha_ref, d_beta_ref;
+    std::vector<float> d_metric;
+    std::vector<unsigned char> d_trace_bit, d_trace_parent;
+    std::vector<unsigned int> d_order;
+    unsigned int d_paths = 0;
+    unsigned int d_active[max_list_size];
+    float d_leaf_llr[max_list_size];
+    unsigned char d_leaf_bit[max_list_size];
+    float d_cand_metric[2 * max_list_size];
+    unsigned int d_cand[2 * max_list_size];
+    unsigned char d_keep[2 * max_list_size];
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_POLAR_H
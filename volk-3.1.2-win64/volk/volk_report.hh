@@ -0,0 +1,592 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_REPORT_H
+#define INCLUDED_VOLK_REPORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if defined(__has_include) && __has_include(<json-c/json.h>)
+#include <json-c/json.h>
+#else
+#include <json.h>
+#endif
+
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+#include <volk/volk_cpu.h>
+#include <volk/volk_prefs.h>
+
+__VOLK_DECL_BEGIN
+// exported by libvolk, declared in the private volk_rank_archs.h
+VOLK_API int volk_get_index(const char* impl_names[], const size_t n_impls, const char* impl_name);
+VOLK_API int volk_rank_archs(const char* kern_name,
+                             const char* impl_names[],
+                             const int* impl_deps,
+                             const bool* alignment,
+                             size_t n_impls,
+                             const bool align);
+__VOLK_DECL_END
+
+namespace volk {
+
+namespace report_detail {
+
+// every dispatcher declared in volk.h
+#define VOLK_REPORT_KERNELS(X) \
+    X(volk_16i_32fc_dot_prod_32fc) \
+    X(volk_16i_branch_4_state_8) \
+    X(volk_16i_convert_8i) \
+    X(volk_16i_max_star_16i) \
+    X(volk_16i_max_star_horizontal_16i) \
+    X(volk_16i_permute_and_scalar_add) \
+    X(volk_16i_s32f_convert_32f) \
+    X(volk_16i_x4_quad_max_star_16i) \
+    X(volk_16i_x5_add_quad_16i_x4) \
+    X(volk_16ic_convert_32fc) \
+    X(volk_16ic_deinterleave_16i_x2) \
+    X(volk_16ic_deinterleave_real_16i) \
+    X(volk_16ic_deinterleave_real_8i) \
+    X(volk_16ic_magnitude_16i) \
+    X(volk_16ic_s32f_deinterleave_32f_x2) \
+    X(volk_16ic_s32f_deinterleave_real_32f) \
+    X(volk_16ic_s32f_magnitude_32f) \
+    X(volk_16ic_x2_dot_prod_16ic) \
+    X(volk_16ic_x2_multiply_16ic) \
+    X(volk_16u_byteswap) \
+    X(volk_16u_byteswappuppet_16u) \
+    X(volk_32f_64f_add_64f) \
+    X(volk_32f_64f_multiply_64f) \
+    X(volk_32f_8u_polarbutterfly_32f) \
+    X(volk_32f_8u_polarbutterflypuppet_32f) \
+    X(volk_32f_accumulator_s32f) \
+    X(volk_32f_acos_32f) \
+    X(volk_32f_asin_32f) \
+    X(volk_32f_atan_32f) \
+    X(volk_32f_binary_slicer_32i) \
+    X(volk_32f_binary_slicer_8i) \
+    X(volk_32f_convert_64f) \
+    X(volk_32f_cos_32f) \
+    X(volk_32f_exp_32f) \
+    X(volk_32f_expfast_32f) \
+    X(volk_32f_index_max_16u) \
+    X(volk_32f_index_max_32u) \
+    X(volk_32f_index_min_16u) \
+    X(volk_32f_index_min_32u) \
+    X(volk_32f_invsqrt_32f) \
+    X(volk_32f_log2_32f) \
+    X(volk_32f_null_32f) \
+    X(volk_32f_s32f_32f_fm_detect_32f) \
+    X(volk_32f_s32f_add_32f) \
+    X(volk_32f_s32f_calc_spectral_noise_floor_32f) \
+    X(volk_32f_s32f_clamppuppet_32f) \
+    X(volk_32f_s32f_convert_16i) \
+    X(volk_32f_s32f_convert_32i) \
+    X(volk_32f_s32f_convert_8i) \
+    X(volk_32f_s32f_convertpuppet_8u) \
+    X(volk_32f_s32f_mod_rangepuppet_32f) \
+    X(volk_32f_s32f_multiply_32f) \
+    X(volk_32f_s32f_normalize) \
+    X(volk_32f_s32f_power_32f) \
+    X(volk_32f_s32f_s32f_mod_range_32f) \
+    X(volk_32f_s32f_stddev_32f) \
+    X(volk_32f_s32f_x2_clamp_32f) \
+    X(volk_32f_s32f_x2_convert_8u) \
+    X(volk_32f_sin_32f) \
+    X(volk_32f_sqrt_32f) \
+    X(volk_32f_stddev_and_mean_32f_x2) \
+    X(volk_32f_tan_32f) \
+    X(volk_32f_tanh_32f) \
+    X(volk_32f_x2_add_32f) \
+    X(volk_32f_x2_divide_32f) \
+    X(volk_32f_x2_dot_prod_16i) \
+    X(volk_32f_x2_dot_prod_32f) \
+    X(volk_32f_x2_fm_detectpuppet_32f) \
+    X(volk_32f_x2_interleave_32fc) \
+    X(volk_32f_x2_max_32f) \
+    X(volk_32f_x2_min_32f) \
+    X(volk_32f_x2_multiply_32f) \
+    X(volk_32f_x2_pow_32f) \
+    X(volk_32f_x2_powpuppet_32f) \
+    X(volk_32f_x2_s32f_interleave_16ic) \
+    X(volk_32f_x2_subtract_32f) \
+    X(volk_32f_x3_sum_of_poly_32f) \
+    X(volk_32fc_32f_add_32fc) \
+    X(volk_32fc_32f_dot_prod_32fc) \
+    X(volk_32fc_32f_multiply_32fc) \
+    X(volk_32fc_accumulator_s32fc) \
+    X(volk_32fc_conjugate_32fc) \
+    X(volk_32fc_convert_16ic) \
+    X(volk_32fc_deinterleave_32f_x2) \
+    X(volk_32fc_deinterleave_64f_x2) \
+    X(volk_32fc_deinterleave_imag_32f) \
+    X(volk_32fc_deinterleave_real_32f) \
+    X(volk_32fc_deinterleave_real_64f) \
+    X(volk_32fc_index_max_16u) \
+    X(volk_32fc_index_max_32u) \
+    X(volk_32fc_index_min_16u) \
+    X(volk_32fc_index_min_32u) \
+    X(volk_32fc_magnitude_32f) \
+    X(volk_32fc_magnitude_squared_32f) \
+    X(volk_32fc_s32f_atan2_32f) \
+    X(volk_32fc_s32f_deinterleave_real_16i) \
+    X(volk_32fc_s32f_magnitude_16i) \
+    X(volk_32fc_s32f_power_32fc) \
+    X(volk_32fc_s32f_power_spectral_densitypuppet_32f) \
+    X(volk_32fc_s32f_power_spectrum_32f) \
+    X(volk_32fc_s32f_x2_power_spectral_density_32f) \
+    X(volk_32fc_s32fc_multiply2_32fc) \
+    X(volk_32fc_s32fc_multiply_32fc) \
+    X(volk_32fc_s32fc_rotator2puppet_32fc) \
+    X(volk_32fc_s32fc_x2_rotator2_32fc) \
+    X(volk_32fc_s32fc_x2_rotator_32fc) \
+    X(volk_32fc_x2_add_32fc) \
+    X(volk_32fc_x2_conjugate_dot_prod_32fc) \
+    X(volk_32fc_x2_divide_32fc) \
+    X(volk_32fc_x2_dot_prod_32fc) \
+    X(volk_32fc_x2_multiply_32fc) \
+    X(volk_32fc_x2_multiply_conjugate_32fc) \
+    X(volk_32fc_x2_s32f_square_dist_scalar_mult_32f) \
+    X(volk_32fc_x2_s32fc_multiply_conjugate_add2_32fc) \
+    X(volk_32fc_x2_s32fc_multiply_conjugate_add_32fc) \
+    X(volk_32fc_x2_square_dist_32f) \
+    X(volk_32i_s32f_convert_32f) \
+    X(volk_32i_x2_and_32i) \
+    X(volk_32i_x2_or_32i) \
+    X(volk_32u_byteswap) \
+    X(volk_32u_byteswappuppet_32u) \
+    X(volk_32u_popcnt) \
+    X(volk_32u_popcntpuppet_32u) \
+    X(volk_32u_reverse_32u) \
+    X(volk_64f_convert_32f) \
+    X(volk_64f_x2_add_64f) \
+    X(volk_64f_x2_max_64f) \
+    X(volk_64f_x2_min_64f) \
+    X(volk_64f_x2_multiply_64f) \
+    X(volk_64u_byteswap) \
+    X(volk_64u_byteswappuppet_64u) \
+    X(volk_64u_popcnt) \
+    X(volk_64u_popcntpuppet_64u) \
+    X(volk_8i_convert_16i) \
+    X(volk_8i_s32f_convert_32f) \
+    X(volk_8ic_deinterleave_16i_x2) \
+    X(volk_8ic_deinterleave_real_16i) \
+    X(volk_8ic_deinterleave_real_8i) \
+    X(volk_8ic_s32f_deinterleave_32f_x2) \
+    X(volk_8ic_s32f_deinterleave_real_32f) \
+    X(volk_8ic_x2_multiply_conjugate_16ic) \
+    X(volk_8ic_x2_s32f_multiply_conjugate_32fc) \
+    X(volk_8u_conv_k7_r2puppet_8u) \
+    X(volk_8u_x2_encodeframepolar_8u) \
+    X(volk_8u_x3_encodepolar_8u_x2) \
+    X(volk_8u_x3_encodepolarpuppet_8u) \
+    X(volk_8u_x4_conv_k7_r2_8u)
+
+struct kernel_entry {
+    const char* name;
+    volk_func_desc_t (*desc)(void);
+};
+
+inline const std::vector<kernel_entry>& kernel_table()
+{
+#define VOLK_REPORT_ENTRY(k) { #k, k##_get_func_desc },
+    static const std::vector<kernel_entry> table = { VOLK_REPORT_KERNELS(
+        VOLK_REPORT_ENTRY) };
+#undef VOLK_REPORT_ENTRY
+    return table;
+}
+
+// bit names of volk_get_lvarch(), indexed by the LV_* constants
+inline const char* arch_name(unsigned int bit)
+{
+    static const char* const names[] = {
+        "generic", "softfp",  "hardfp", "32",     "64",     "popcount", "mmx",
+        "fma",     "sse",     "sse2",   "orc",    "norc",   "neon",     "neonv7",
+        "neonv8",  "sse3",    "ssse3",  "sse4_a", "sse4_1", "sse4_2",   "avx",
+        "avx2",    "avx512f", "avx512cd", "riscv64"
+    };
+    return bit < sizeof(names) / sizeof(names[0]) ? names[bit] : nullptr;
+}
+
+inline bool is_generic(const std::string& impl)
+{
+    return impl.find("generic") != std::string::npos;
+}
+
+inline std::string selected_impl(const char* name, const volk_func_desc_t& desc, bool align)
+{
+    if (desc.n_impls == 0)
+        return std::string();
+    const int index = volk_rank_archs(
+        name, desc.impl_names, desc.impl_deps, desc.impl_alignment, desc.n_impls, align);
+    return index >= 0 && std::size_t(index) < desc.n_impls ? desc.impl_names[index]
+                                                           : std::string();
+}
+
+//! volk_config entries, loaded once per process as volk_rank_archs does
+inline const std::vector<volk_arch_pref_t>& preferences()
+{
+    static const std::vector<volk_arch_pref_t> prefs = [] {
+        volk_arch_pref_t* loaded = nullptr;
+        const std::size_t n = volk_load_preferences(&loaded);
+        // the buffer comes from the C runtime libvolk links, which need not
+        // be ours, so it is copied and left to libvolk like its own table
+        return loaded ? std::vector<volk_arch_pref_t>(loaded, loaded + n)
+                      : std::vector<volk_arch_pref_t>();
+    }();
+    return prefs;
+}
+
+inline json_object* string_array(const std::vector<std::string>& v)
+{
+    json_object* array = json_object_new_array();
+    for (const auto& s : v)
+        json_object_array_add(array, json_object_new_string(s.c_str()));
+    return array;
+}
+
+} // namespace report_detail
+
+/*!
+ * \brief How the dispatcher picked the implementation of a kernel
+ *
+ * \details
+ *   ranked: no volk_config entry, the implementation with the most
+ *   architecture dependencies wins. profiled: taken from volk_config.
+ *   stale: volk_config names an implementation this machine does not
+ *   provide, so libvolk silently falls back to generic.
+ */
+enum class profile_status { ranked, profiled, stale };
+
+inline const char* to_string(profile_status s)
+{
+    switch (s) {
+    case profile_status::profiled:
+        return "profiled";
+    case profile_status::stale:
+        return "stale";
+    default:
+        return "ranked";
+    }
+}
+
+//! Dispatch state of one kernel
+struct kernel_selection {
+    std::string name;
+    std::vector<std::string> impls; //!< implementations built for the machine
+    std::string impl_a;             //!< used for aligned buffers
+    std::string impl_u;             //!< used for unaligned buffers
+    profile_status profile = profile_status::ranked;
+    //! a generic implementation is selected although a usable SIMD one exists
+    bool generic_fallback = false;
+};
+
+//! Host, machine and per kernel dispatch state
+struct machine_report {
+    std::string version;
+    std::string machine;
+    std::size_t alignment = 0;
+    unsigned int lvarch = 0;
+    std::vector<std::string> features; //!< names of the set volk_get_lvarch() bits
+    bool generic_forced = false;       //!< VOLK_GENERIC is set
+    std::string profile_path;          //!< empty when no volk_config was found
+    std::size_t profile_entries = 0;
+    std::size_t profile_missing = 0; //!< kernels without a volk_config entry
+    std::size_t profile_stale = 0;   //!< entries naming unavailable impls
+    std::vector<std::string> profile_unknown; //!< entries for kernels not in this build
+    std::size_t generic_fallbacks = 0;
+    std::vector<kernel_selection> kernels;
+
+    //! volk_config exists but no longer matches this machine or library
+    bool profile_outdated() const
+    {
+        return !profile_path.empty() &&
+               (profile_missing > 0 || profile_stale > 0 || !profile_unknown.empty());
+    }
+};
+
+/*!
+ * \brief Collects the machine selection of the running process
+ *
+ * \details
+ *   The aligned and unaligned implementation of every kernel are resolved
+ *   with the same ranking libvolk applies on the first call of a
+ *   dispatcher, including volk_config preferences and VOLK_GENERIC, so
+ *   the result matches what the process actually runs.
+ *
+ * example code:
+ *   json_object* obj = volk::to_json(volk::get_machine_report());
+ *   puts(json_object_to_json_string_ext(obj, JSON_C_TO_STRING_PRETTY));
+ *   json_object_put(obj);
+ */
+inline machine_report get_machine_report()
+{
+    machine_report r;
+    r.version = std::to_string(VOLK_VERSION_MAJOR) + "." + std::to_string(VOLK_VERSION_MINOR) +
+                "." + std::to_string(VOLK_VERSION_MAINT);
+    r.machine = volk_get_machine();
+    r.alignment = volk_get_alignment();
+    r.lvarch = volk_get_lvarch();
+    for (unsigned int bit = 0; bit < 32; bit++) {
+        if ((r.lvarch >> bit) & 1) {
+            const char* name = report_detail::arch_name(bit);
+            r.features.push_back(name ? name : "bit" + std::to_string(bit));
+        }
+    }
+    r.generic_forced = std::getenv("VOLK_GENERIC") != nullptr;
+
+    char path[512];
+    volk_get_config_path(path, true);
+    r.profile_path = path;
+    const auto& prefs = report_detail::preferences();
+    const std::size_t n_prefs = prefs.size();
+    r.profile_entries = n_prefs;
+    std::vector<bool> pref_used(n_prefs, false);
+
+    const auto& table = report_detail::kernel_table();
+    r.kernels.reserve(table.size());
+    for (const auto& k : table) {
+        const volk_func_desc_t desc = k.desc();
+        kernel_selection s;
+        s.name = k.name;
+        s.impls.assign(desc.impl_names, desc.impl_names + desc.n_impls);
+        s.impl_a = report_detail::selected_impl(k.name, desc, true);
+        s.impl_u = report_detail::selected_impl(k.name, desc, false);
+
+        for (std::size_t i = 0; i < n_prefs; i++) {
+            if (std::strcmp(prefs[i].name, k.name) != 0)
+                continue;
+            pref_used[i] = true;
+            const auto available = [&](const char* impl) {
+                return std::find(s.impls.begin(), s.impls.end(), impl) != s.impls.end();
+            };
+            s.profile = available(prefs[i].impl_a) && available(prefs[i].impl_u)
+                            ? profile_status::profiled
+                            : profile_status::stale;
+            break;
+        }
+        if (s.profile == profile_status::stale)
+            r.profile_stale++;
+        else if (s.profile == profile_status::ranked && n_prefs > 0)
+            r.profile_missing++;
+
+        // aligned-only SIMD implementations cannot serve unaligned calls
+        bool simd_a = false, simd_u = false;
+        for (std::size_t i = 0; i < desc.n_impls; i++) {
+            if (report_detail::is_generic(desc.impl_names[i]))
+                continue;
+            simd_a = true;
+            simd_u = simd_u || !desc.impl_alignment[i];
+        }
+        s.generic_fallback = (simd_a && report_detail::is_generic(s.impl_a)) ||
+                             (simd_u && report_detail::is_generic(s.impl_u));
+        if (s.generic_fallback)
+            r.generic_fallbacks++;
+        r.kernels.push_back(std::move(s));
+    }
+
+    for (std::size_t i = 0; i < n_prefs; i++) {
+        if (!pref_used[i])
+            r.profile_unknown.push_back(prefs[i].name);
+    }
+    return r;
+}
+
+//! Timing of one kernel in the self-benchmark
+struct benchmark_result {
+    std::string kernel;
+    std::string impl;             //!< aligned implementation picked by the dispatcher
+    double ns_per_point = 0.0;    //!< through the dispatcher
+    double generic_ns_per_point = 0.0;
+
+    double speedup() const
+    {
+        return ns_per_point > 0.0 ? generic_ns_per_point / ns_per_point : 0.0;
+    }
+};
+
+/*!
+ * \brief Times a fixed set of common kernels on this host
+ *
+ * \details
+ *   Each kernel runs on aligned buffers of num_points through its
+ *   dispatcher and through its generic implementation. The best of three
+ *   runs of at least `seconds` each is kept, so the whole benchmark takes
+ *   roughly 6 * seconds per kernel. The generic time gives a host
+ *   independent reference: a speedup near 1 means the host runs scalar
+ *   code, a drop against earlier runs on similar hardware is a regression.
+ */
+inline std::vector<benchmark_result> run_self_benchmark(unsigned int num_points = 8192,
+                                                        double seconds = 5e-3)
+{
+    volk::vector<float> fa(num_points), fb(num_points), fc(num_points);
+    volk::vector<lv_32fc_t> ca(num_points), cb(num_points), cc(num_points);
+    volk::vector<lv_16sc_t> sa(num_points);
+    for (unsigned int i = 0; i < num_points; i++) {
+        fa[i] = 1.5f + std::sin(0.01f * i);
+        fb[i] = 0.5f + 0.25f * std::cos(0.03f * i);
+        ca[i] = lv_cmake(0.7f * std::cos(0.02f * i), 0.7f * std::sin(0.02f * i));
+        cb[i] = lv_cmake(fb[i], -0.5f * fa[i]);
+    }
+    float f_result;
+    lv_32fc_t c_result;
+    uint32_t index;
+    const lv_32fc_t phase_inc = lv_cmake(std::cos(0.001f), std::sin(0.001f));
+    lv_32fc_t phase = lv_cmake(1.0f, 0.0f);
+    const unsigned int n = num_points;
+
+    struct bench_case {
+        const char* name;
+        std::function<void(const char*)> run; //!< nullptr runs the dispatcher
+    };
+#define VOLK_REPORT_BENCH(kernel, ...)                  \
+    {                                                   \
+        #kernel, [&](const char* impl) {                \
+            if (impl)                                   \
+                kernel##_manual(__VA_ARGS__, impl);     \
+            else                                        \
+                kernel(__VA_ARGS__);                    \
+        }                                               \
+    }
+    const bench_case cases[] = {
+        VOLK_REPORT_BENCH(volk_32f_x2_add_32f, fc.data(), fa.data(), fb.data(), n),
+        VOLK_REPORT_BENCH(volk_32f_x2_multiply_32f, fc.data(), fa.data(), fb.data(), n),
+        VOLK_REPORT_BENCH(volk_32f_s32f_multiply_32f, fc.data(), fa.data(), 0.5f, n),
+        VOLK_REPORT_BENCH(volk_32f_x2_dot_prod_32f, &f_result, fa.data(), fb.data(), n),
+        VOLK_REPORT_BENCH(volk_32f_index_max_32u, &index, fa.data(), n),
+        VOLK_REPORT_BENCH(volk_32f_log2_32f, fc.data(), fa.data(), n),
+        VOLK_REPORT_BENCH(volk_32f_sin_32f, fc.data(), fa.data(), n),
+        VOLK_REPORT_BENCH(volk_32fc_x2_multiply_32fc, cc.data(), ca.data(), cb.data(), n),
+        VOLK_REPORT_BENCH(
+            volk_32fc_x2_multiply_conjugate_32fc, cc.data(), ca.data(), cb.data(), n),
+        VOLK_REPORT_BENCH(volk_32fc_x2_dot_prod_32fc, &c_result, ca.data(), cb.data(), n),
+        VOLK_REPORT_BENCH(volk_32fc_32f_dot_prod_32fc, &c_result, ca.data(), fb.data(), n),
+        VOLK_REPORT_BENCH(volk_32fc_magnitude_32f, fc.data(), ca.data(), n),
+        VOLK_REPORT_BENCH(volk_32fc_magnitude_squared_32f, fc.data(), ca.data(), n),
+        VOLK_REPORT_BENCH(volk_32fc_s32f_atan2_32f, fc.data(), ca.data(), 1.0f, n),
+        VOLK_REPORT_BENCH(
+            volk_32fc_s32fc_x2_rotator2_32fc, cc.data(), ca.data(), &phase_inc, &phase, n),
+        VOLK_REPORT_BENCH(volk_32fc_convert_16ic, sa.data(), ca.data(), n),
+        VOLK_REPORT_BENCH(volk_16ic_convert_32fc, cc.data(), sa.data(), n),
+    };
+#undef VOLK_REPORT_BENCH
+
+    const auto ns_per_point = [&](const bench_case& c, const char* impl) {
+        c.run(impl); // warm up caches and resolve the dispatcher
+        double best = std::numeric_limits<double>::infinity();
+        for (int rep = 0; rep < 3; rep++) {
+            std::size_t calls = 0;
+            const auto start = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed(0.0);
+            do {
+                c.run(impl);
+                calls++;
+                elapsed = std::chrono::steady_clock::now() - start;
+            } while (elapsed.count() < seconds);
+            best = std::min(best, elapsed.count() / (double(calls) * num_points));
+        }
+        return best * 1e9;
+    };
+
+    std::vector<benchmark_result> results;
+    for (const auto& c : cases) {
+        benchmark_result r;
+        r.kernel = c.name;
+        for (const auto& k : report_detail::kernel_table()) {
+            if (std::strcmp(k.name, c.name) == 0)
+                r.impl = report_detail::selected_impl(k.name, k.desc(), true);
+        }
+        r.ns_per_point = ns_per_point(c, nullptr);
+        r.generic_ns_per_point = ns_per_point(c, "generic");
+        results.push_back(r);
+    }
+    return results;
+}
+
+/*!
+ * \brief Converts a machine report to a new json-c object
+ *
+ * \details
+ *   The caller owns the returned object and releases it with
+ *   json_object_put(). Kernels are keyed by name; profile is null when no
+ *   volk_config was found.
+ */
+inline json_object* to_json(const machine_report& r)
+{
+    json_object* obj = json_object_new_object();
+    json_object_object_add(obj, "volk_version", json_object_new_string(r.version.c_str()));
+    json_object_object_add(obj, "machine", json_object_new_string(r.machine.c_str()));
+    json_object_object_add(obj, "alignment", json_object_new_int64(int64_t(r.alignment)));
+    json_object_object_add(obj, "lvarch", json_object_new_int64(int64_t(r.lvarch)));
+    json_object_object_add(obj, "features", report_detail::string_array(r.features));
+    json_object_object_add(obj, "generic_forced", json_object_new_boolean(r.generic_forced));
+    json_object_object_add(
+        obj, "generic_fallbacks", json_object_new_int64(int64_t(r.generic_fallbacks)));
+
+    json_object* profile = nullptr;
+    if (!r.profile_path.empty()) {
+        profile = json_object_new_object();
+        json_object_object_add(profile, "path", json_object_new_string(r.profile_path.c_str()));
+        json_object_object_add(
+            profile, "entries", json_object_new_int64(int64_t(r.profile_entries)));
+        json_object_object_add(
+            profile, "missing", json_object_new_int64(int64_t(r.profile_missing)));
+        json_object_object_add(profile, "stale", json_object_new_int64(int64_t(r.profile_stale)));
+        json_object_object_add(
+            profile, "unknown_kernels", report_detail::string_array(r.profile_unknown));
+        json_object_object_add(profile, "outdated", json_object_new_boolean(r.profile_outdated()));
+    }
+    json_object_object_add(obj, "profile", profile);
+
+    json_object* kernels = json_object_new_object();
+    for (const auto& k : r.kernels) {
+        json_object* kobj = json_object_new_object();
+        json_object_object_add(kobj, "impl_a", json_object_new_string(k.impl_a.c_str()));
+        json_object_object_add(kobj, "impl_u", json_object_new_string(k.impl_u.c_str()));
+        json_object_object_add(kobj, "impls", report_detail::string_array(k.impls));
+        json_object_object_add(kobj, "profile", json_object_new_string(to_string(k.profile)));
+        json_object_object_add(
+            kobj, "generic_fallback", json_object_new_boolean(k.generic_fallback));
+        json_object_object_add(kernels, k.name.c_str(), kobj);
+    }
+    json_object_object_add(obj, "kernels", kernels);
+    return obj;
+}
+
+//! Converts self-benchmark results to a new json-c array, see to_json(machine_report)
+inline json_object* to_json(const std::vector<benchmark_result>& results)
+{
+    json_object* array = json_object_new_array();
+    for (const auto& r : results) {
+        json_object* obj = json_object_new_object();
+        json_object_object_add(obj, "kernel", json_object_new_string(r.kernel.c_str()));
+        json_object_object_add(obj, "impl", json_object_new_string(r.impl.c_str()));
+        json_object_object_add(obj, "ns_per_point", json_object_new_double(r.ns_per_point));
+        json_object_object_add(
+            obj, "generic_ns_per_point", json_object_new_double(r.generic_ns_per_point));
+        json_object_object_add(obj, "speedup", json_object_new_double(r.speedup()));
+        json_object_array_add(array, obj);
+    }
+    return array;
+}
+
+} // namespace volk
+
+#undef VOLK_REPORT_KERNELS
+#endif // INCLUDED_VOLK_REPORT_H
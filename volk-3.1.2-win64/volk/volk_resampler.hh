@@ -0,0 +1,324 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_RESAMPLER_H
+#define INCLUDED_VOLK_RESAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+
+namespace volk {
+
+namespace resampler_detail {
+
+inline void dot(float* result, const float* x, const float* taps, unsigned int n)
+{
+    volk_32f_x2_dot_prod_32f(result, x, taps, n);
+}
+
+inline void dot(lv_32fc_t* result, const lv_32fc_t* x, const float* taps, unsigned int n)
+{
+    volk_32fc_32f_dot_prod_32fc(result, x, taps, n);
+}
+
+inline double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+inline unsigned int gcd(unsigned int a, unsigned int b)
+{
+    while (b != 0) {
+        const unsigned int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+} // namespace resampler_detail
+
+/*!
+ * \brief Kaiser windowed-sinc prototype for a polyphase filter bank
+ *
+ * \details
+ *   Returns phases * taps_per_phase + 1 taps at phases times the input
+ *   rate, summing to phases (unity gain after interpolation). cutoff is in
+ *   cycles per input sample (0.5 = input Nyquist). The extra last tap lets
+ *   fractional phases interpolate up to a whole sample offset.
+ */
+inline std::vector<float> resampler_taps(unsigned int phases,
+                                         unsigned int taps_per_phase,
+                                         double cutoff,
+                                         double atten_db = 80.0)
+{
+    const std::size_t len = static_cast<std::size_t>(phases) * taps_per_phase + 1;
+    const double beta = atten_db > 50.0   ? 0.1102 * (atten_db - 8.7)
+                        : atten_db > 21.0 ? 0.5842 * std::pow(atten_db - 21.0, 0.4) +
+                                                0.07886 * (atten_db - 21.0)
+                                          : 0.0;
+    const double center = 0.5 * (len - 1);
+    const double fc = cutoff / phases;
+    const double norm = resampler_detail::bessel_i0(beta);
+    const double pi = 3.14159265358979323846;
+
+    std::vector<double> h(len);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < len; i++) {
+        const double t = i - center;
+        const double sinc = t == 0.0 ? 2.0 * fc : std::sin(2.0 * pi * fc * t) / (pi * t);
+        const double r = center > 0.0 ? t / center : 0.0;
+        h[i] = sinc * resampler_detail::bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) /
+               norm;
+        sum += h[i];
+    }
+
+    std::vector<float> taps(len);
+    for (std::size_t i = 0; i < len; i++)
+        taps[i] = static_cast<float>(h[i] * phases / sum);
+    return taps;
+}
+
+/*!
+ * \brief Streaming polyphase resampler for float or lv_32fc_t samples
+ *
+ * \details
+ *   The constructor builds the exact rational mode. interp / decim is
+ *   reduced by their gcd, and the L phases of the bank are walked with
+ *   integer arithmetic.
+ *
+ *   arbitrary() builds the arbitrary ratio mode. The output time is tracked in double precision.
+ *   The filter is interpolated linearly between the two nearest of
+ *   `phases` precomputed phases, at the cost of two dot products per
+ *   output. With the defaults, this interpolation error stays below the
+ *   80 dB stop band.
+ *
+ *   Each output is one volk_32f_x2_dot_prod_32f or
+ *   volk_32fc_32f_dot_prod_32fc over a phase of the bank, stored reversed
+ *   so that it lines up with the input history. taps_per_phase sets the
+ *   filter span in output-rate zero crossings. When downsampling it is
+ *   scaled by the rate ratio, so the transition band stays the same
+ *   fraction of the output bandwidth. bandwidth is the passband edge as a
+ *   fraction of the lower Nyquist frequency.
+ *
+ * example code:
+ *   volk::resampler<float> audio(1, 50);          // 2.4 MS/s -> 48 kHz
+ *   auto sdr = volk::resampler<lv_32fc_t>::arbitrary(48000.0 / 44100.0);
+ *   std::vector<float> out(audio.max_output(n));
+ *   out.resize(audio.process(out.data(), in, n));
+ */
+template <class T>
+class resampler
+{
+public:
+    //! Largest reduced interpolation factor of the rational mode
+    static const unsigned int max_interp = 4096;
+
+    resampler(unsigned int interp,
+              unsigned int decim,
+              unsigned int taps_per_phase = 32,
+              double bandwidth = 0.9,
+              double atten_db = 80.0)
+        : d_rational(true)
+    {
+        if (interp == 0 || decim == 0)
+            throw std::invalid_argument("resampler: interp and decim must be > 0");
+        const unsigned int g = resampler_detail::gcd(interp, decim);
+        d_interp = interp / g;
+        d_decim = decim / g;
+        if (d_interp > max_interp)
+            throw std::invalid_argument(
+                "resampler: reduced interp factor too large, use a fractional ratio");
+        d_ratio = double(d_interp) / d_decim;
+        init(d_interp, taps_per_phase, bandwidth, atten_db);
+    }
+
+    //! Resampler for an arbitrary output / input rate ratio
+    static resampler arbitrary(double ratio,
+                               unsigned int phases = 256,
+                               unsigned int taps_per_phase = 32,
+                               double bandwidth = 0.9,
+                               double atten_db = 80.0)
+    {
+        return resampler(ratio, phases, taps_per_phase, bandwidth, atten_db);
+    }
+
+    bool is_rational() const { return d_rational; }
+    double ratio() const { return d_ratio; }
+    unsigned int interp() const { return d_interp; }
+    unsigned int decim() const { return d_decim; }
+    unsigned int taps_per_phase() const { return d_ntaps; }
+
+    //! Filter delay in input samples
+    double group_delay() const { return 0.5 * d_ntaps; }
+
+    //! Upper bound on the outputs of process(..., num_points)
+    std::size_t max_output(std::size_t num_points) const
+    {
+        return static_cast<std::size_t>(std::ceil(num_points * d_ratio)) + 2;
+    }
+
+    //! Clears the history and restarts the output time at the next input
+    void reset()
+    {
+        std::fill(d_buf.begin(), d_buf.end(), T());
+        d_fill = d_ntaps - 1;
+        d_base = d_ntaps - 1;
+        d_phase = 0;
+        d_frac = 0.0;
+    }
+
+    /*!
+     * \brief Resamples num_points inputs, returns the number of outputs
+     *
+     * \details
+     *   out must hold max_output(num_points) samples.
+     */
+    std::size_t process(T* out, const T* in, std::size_t num_points)
+    {
+        std::size_t produced = 0;
+        while (num_points > 0) {
+            const std::size_t n = std::min(num_points, chunk);
+            std::copy(in, in + n, &d_buf[d_fill]);
+            d_fill += n;
+            in += n;
+            num_points -= n;
+
+            produced += d_rational ? run_rational(out + produced) : run_fractional(out + produced);
+
+            // keep the ntaps - 1 samples preceding the next output
+            const std::size_t keep_from = std::min(d_base - (d_ntaps - 1), d_fill);
+            std::copy(&d_buf[keep_from], &d_buf[0] + d_fill, &d_buf[0]);
+            d_fill -= keep_from;
+            d_base -= keep_from;
+        }
+        return produced;
+    }
+
+private:
+    static const std::size_t chunk = 4096;
+
+    resampler(double ratio,
+              unsigned int phases,
+              unsigned int taps_per_phase,
+              double bandwidth,
+              double atten_db)
+        : d_rational(false), d_ratio(ratio)
+    {
+        if (!(ratio > 0.0) || !std::isfinite(ratio))
+            throw std::invalid_argument("resampler: ratio must be positive");
+        if (phases < 2)
+            throw std::invalid_argument("resampler: at least 2 phases required");
+        d_step = 1.0 / ratio;
+        init(phases, taps_per_phase, bandwidth, atten_db);
+    }
+
+    void init(unsigned int phases,
+              unsigned int taps_per_phase,
+              double bandwidth,
+              double atten_db)
+    {
+        if (taps_per_phase == 0)
+            throw std::invalid_argument("resampler: taps_per_phase must be > 0");
+        if (!(bandwidth > 0.0 && bandwidth <= 1.0))
+            throw std::invalid_argument("resampler: bandwidth must be in (0, 1]");
+
+        d_phases = phases;
+        const double down = std::max(1.0, 1.0 / d_ratio);
+        d_ntaps = static_cast<unsigned int>(std::ceil(taps_per_phase * down));
+        const double cutoff = 0.5 * bandwidth * std::min(1.0, d_ratio);
+
+        // bank[p] holds h[p + k * phases] for k = ntaps - 1 down to 0
+        const std::vector<float> proto = resampler_taps(phases, d_ntaps, cutoff, atten_db);
+        const unsigned int banks = d_rational ? phases : phases + 1;
+        d_bank.resize(static_cast<std::size_t>(banks) * d_ntaps);
+        for (unsigned int p = 0; p < banks; p++) {
+            for (unsigned int k = 0; k < d_ntaps; k++)
+                d_bank[static_cast<std::size_t>(p) * d_ntaps + (d_ntaps - 1 - k)] =
+                    proto[p + static_cast<std::size_t>(k) * phases];
+        }
+
+        d_buf.resize(d_ntaps - 1 + chunk);
+        reset();
+    }
+
+    const float* bank(unsigned int p) const
+    {
+        return &d_bank[static_cast<std::size_t>(p) * d_ntaps];
+    }
+
+    std::size_t run_rational(T* out)
+    {
+        std::size_t produced = 0;
+        while (d_base < d_fill) {
+            resampler_detail::dot(
+                out + produced++, &d_buf[d_base - (d_ntaps - 1)], bank(d_phase), d_ntaps);
+            d_phase += d_decim;
+            d_base += d_phase / d_interp;
+            d_phase %= d_interp;
+        }
+        return produced;
+    }
+
+    std::size_t run_fractional(T* out)
+    {
+        std::size_t produced = 0;
+        const std::size_t step_int = static_cast<std::size_t>(d_step);
+        const double step_frac = d_step - step_int;
+        while (d_base < d_fill) {
+            const double pos = d_frac * d_phases;
+            const unsigned int p = std::min(static_cast<unsigned int>(pos), d_phases - 1);
+            const float mu = static_cast<float>(pos - p);
+            const T* x = &d_buf[d_base - (d_ntaps - 1)];
+
+            T a, b;
+            resampler_detail::dot(&a, x, bank(p), d_ntaps);
+            resampler_detail::dot(&b, x, bank(p + 1), d_ntaps);
+            out[produced++] = a + (b - a) * mu;
+
+            d_frac += step_frac;
+            d_base += step_int;
+            if (d_frac >= 1.0) {
+                d_frac -= 1.0;
+                d_base++;
+            }
+        }
+        return produced;
+    }
+
+    bool d_rational;
+    double d_ratio;
+    double d_step = 0.0;
+    unsigned int d_interp = 0;
+    unsigned int d_decim = 0;
+    unsigned int d_phases = 0;
+    unsigned int d_ntaps = 0;
+    volk::vector<float> d_bank;
+
+    // input history followed by the current chunk
+    volk::vector<T> d_buf;
+    std::size_t d_fill = 0;
+    std::size_t d_base = 0;
+    unsigned int d_phase = 0;
+    double d_frac = 0.0;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_RESAMPLER_H
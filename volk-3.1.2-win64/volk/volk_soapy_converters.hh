@@ -0,0 +1,247 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_SOAPY_CONVERTERS_H
+#define INCLUDED_VOLK_SOAPY_CONVERTERS_H
+
+#include <cstddef>
+
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Formats.hpp>
+
+// sets the LV_HAVE_* of this translation unit for the kernel header
+#include <volk/volk_bind.hh>
+
+#include <volk/volk_16ic_s32f_byteswap_convert_32fc.h>
+#include <volk/volk_32fc_s32f_convert_byteswap_16ic.h>
+#include <volk/volk_32fc_s32f_convert_byteswap_32ic.h>
+#include <volk/volk_32ic_s32f_byteswap_convert_32fc.h>
+#include <volk/volk_quantize.hh>
+
+namespace volk {
+
+//! Big-endian complex int16 markup, the wire format of netSDR and VITA-49
+constexpr const char* soapy_format_cs16_be = "CS16BE";
+
+//! Big-endian complex int32 markup
+constexpr const char* soapy_format_cs32_be = "CS32BE";
+
+namespace soapy_detail {
+
+constexpr float s16_full_scale = 32768.0f;
+constexpr float s32_full_scale = 2147483648.0f;
+constexpr float s8_full_scale = 128.0f;
+constexpr float s4_full_scale = 8.0f;
+
+inline void byteswap_convert(lv_32fc_t* out,
+                             const lv_16sc_t* in,
+                             float scalar,
+                             unsigned int num_points)
+{
+#if defined(LV_HAVE_AVX2)
+    volk_16ic_s32f_byteswap_convert_32fc_u_avx2(out, in, scalar, num_points);
+#elif defined(LV_HAVE_SSSE3)
+    volk_16ic_s32f_byteswap_convert_32fc_u_ssse3(out, in, scalar, num_points);
+#elif defined(LV_HAVE_NEON)
+    volk_16ic_s32f_byteswap_convert_32fc_neon(out, in, scalar, num_points);
+#else
+    volk_16ic_s32f_byteswap_convert_32fc_generic(out, in, scalar, num_points);
+#endif
+}
+
+inline void byteswap_convert(lv_32fc_t* out,
+                             const lv_32sc_t* in,
+                             float scalar,
+                             unsigned int num_points)
+{
+#if defined(LV_HAVE_AVX2)
+    volk_32ic_s32f_byteswap_convert_32fc_u_avx2(out, in, scalar, num_points);
+#elif defined(LV_HAVE_SSSE3)
+    volk_32ic_s32f_byteswap_convert_32fc_u_ssse3(out, in, scalar, num_points);
+#elif defined(LV_HAVE_NEON)
+    volk_32ic_s32f_byteswap_convert_32fc_neon(out, in, scalar, num_points);
+#else
+    volk_32ic_s32f_byteswap_convert_32fc_generic(out, in, scalar, num_points);
+#endif
+}
+
+inline void convert_byteswap(lv_16sc_t* out,
+                             const lv_32fc_t* in,
+                             float scalar,
+                             unsigned int num_points)
+{
+#if defined(LV_HAVE_AVX2)
+    volk_32fc_s32f_convert_byteswap_16ic_u_avx2(out, in, scalar, num_points);
+#elif defined(LV_HAVE_SSSE3)
+    volk_32fc_s32f_convert_byteswap_16ic_u_ssse3(out, in, scalar, num_points);
+#elif defined(LV_HAVE_NEONV8)
+    volk_32fc_s32f_convert_byteswap_16ic_neonv8(out, in, scalar, num_points);
+#else
+    volk_32fc_s32f_convert_byteswap_16ic_generic(out, in, scalar, num_points);
+#endif
+}
+
+inline void convert_byteswap(lv_32sc_t* out,
+                             const lv_32fc_t* in,
+                             float scalar,
+                             unsigned int num_points)
+{
+#if defined(LV_HAVE_AVX2)
+    volk_32fc_s32f_convert_byteswap_32ic_u_avx2(out, in, scalar, num_points);
+#elif defined(LV_HAVE_SSSE3)
+    volk_32fc_s32f_convert_byteswap_32ic_u_ssse3(out, in, scalar, num_points);
+#elif defined(LV_HAVE_NEONV8)
+    volk_32fc_s32f_convert_byteswap_32ic_neonv8(out, in, scalar, num_points);
+#else
+    volk_32fc_s32f_convert_byteswap_32ic_generic(out, in, scalar, num_points);
+#endif
+}
+
+/*
+ * SoapySDR::ConverterFunction signatures. As in the SoapySDR default
+ * converters, integers are relative to a full scale of 1 << 15 or 1 << 31
+ * and the scaler multiplies the float side.
+ */
+
+inline void
+cs16_be_to_cf32(const void* src, void* dst, const size_t n, const double scaler)
+{
+    byteswap_convert(static_cast<lv_32fc_t*>(dst),
+                     static_cast<const lv_16sc_t*>(src),
+                     static_cast<float>(s16_full_scale / scaler),
+                     static_cast<unsigned int>(n));
+}
+
+inline void
+cs32_be_to_cf32(const void* src, void* dst, const size_t n, const double scaler)
+{
+    byteswap_convert(static_cast<lv_32fc_t*>(dst),
+                     static_cast<const lv_32sc_t*>(src),
+                     static_cast<float>(s32_full_scale / scaler),
+                     static_cast<unsigned int>(n));
+}
+
+inline void
+cf32_to_cs16_be(const void* src, void* dst, const size_t n, const double scaler)
+{
+    convert_byteswap(static_cast<lv_16sc_t*>(dst),
+                     static_cast<const lv_32fc_t*>(src),
+                     static_cast<float>(s16_full_scale * scaler),
+                     static_cast<unsigned int>(n));
+}
+
+inline void
+cf32_to_cs32_be(const void* src, void* dst, const size_t n, const double scaler)
+{
+    convert_byteswap(static_cast<lv_32sc_t*>(dst),
+                     static_cast<const lv_32fc_t*>(src),
+                     static_cast<float>(s32_full_scale * scaler),
+                     static_cast<unsigned int>(n));
+}
+
+inline void cs8_to_cf32(const void* src, void* dst, const size_t n, const double scaler)
+{
+    volk_8i_s32f_convert_32f(static_cast<float*>(dst),
+                             static_cast<const int8_t*>(src),
+                             static_cast<float>(s8_full_scale / scaler),
+                             static_cast<unsigned int>(2 * n));
+}
+
+inline void cf32_to_cs8(const void* src, void* dst, const size_t n, const double scaler)
+{
+    volk_32f_s32f_convert_8i(static_cast<int8_t*>(dst),
+                             static_cast<const float*>(src),
+                             static_cast<float>(s8_full_scale * scaler),
+                             static_cast<unsigned int>(2 * n));
+}
+
+inline void cs4_to_cf32(const void* src, void* dst, const size_t n, const double scaler)
+{
+    quantize_detail::from_cs4(static_cast<lv_32fc_t*>(dst),
+                              static_cast<const uint8_t*>(src),
+                              static_cast<float>(s4_full_scale / scaler),
+                              static_cast<unsigned int>(n));
+}
+
+inline void cf32_to_cs4(const void* src, void* dst, const size_t n, const double scaler)
+{
+    quantize_detail::to_cs4(static_cast<uint8_t*>(dst),
+                            static_cast<const lv_32fc_t*>(src),
+                            static_cast<float>(s4_full_scale * scaler),
+                            static_cast<unsigned int>(n));
+}
+
+} // namespace soapy_detail
+
+/*!
+ * \brief Registers the fused big-endian and narrow converters with SoapySDR
+ *
+ * \details
+ *   Adds VECTORIZED priority entries to the SoapySDR::ConverterRegistry
+ *   between CF32 and soapy_format_cs16_be / soapy_format_cs32_be, so a
+ *   network-backed driver that receives big-endian samples converts them
+ *   to and from CF32 in one pass instead of a byteswap and a convert. The
+ *   conversions use the kernels this translation unit was compiled for.
+ *
+ *   Also adds CF32 to and from SOAPY_SDR_CS8 and SOAPY_SDR_CS4, relative to
+ *   a full scale of 128 and 8, ahead of the generic defaults. CS4 carries I
+ *   in the high nibble of each byte, as volk_32fc_s32f_convert_4ic.
+ *
+ *   The registry logs an error for a second entry with the same formats
+ *   and priority, so this registers only on its first call; call it from
+ *   the driver's registration code or before the first getFunction().
+ *
+ * example code:
+ *   volk::register_soapy_converters();
+ *   auto convert = SoapySDR::ConverterRegistry::getFunction(
+ *       volk::soapy_format_cs16_be, SOAPY_SDR_CF32);
+ *   convert(payload, buffs[0], num_samples, 1.0);
+ */
+inline void register_soapy_converters()
+{
+    using SoapySDR::ConverterRegistry;
+    static const ConverterRegistry registered[] = {
+        ConverterRegistry(soapy_format_cs16_be,
+                          SOAPY_SDR_CF32,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cs16_be_to_cf32),
+        ConverterRegistry(soapy_format_cs32_be,
+                          SOAPY_SDR_CF32,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cs32_be_to_cf32),
+        ConverterRegistry(SOAPY_SDR_CF32,
+                          soapy_format_cs16_be,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cf32_to_cs16_be),
+        ConverterRegistry(SOAPY_SDR_CF32,
+                          soapy_format_cs32_be,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cf32_to_cs32_be),
+        ConverterRegistry(SOAPY_SDR_CS8,
+                          SOAPY_SDR_CF32,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cs8_to_cf32),
+        ConverterRegistry(SOAPY_SDR_CF32,
+                          SOAPY_SDR_CS8,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cf32_to_cs8),
+        ConverterRegistry(SOAPY_SDR_CS4,
+                          SOAPY_SDR_CF32,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cs4_to_cf32),
+        ConverterRegistry(SOAPY_SDR_CF32,
+                          SOAPY_SDR_CS4,
+                          ConverterRegistry::VECTORIZED,
+                          &soapy_detail::cf32_to_cs4),
+    };
+    (void)registered;
+}
+
+} // namespace volk
+#endif // INCLUDED_VOLK_SOAPY_CONVERTERS_H
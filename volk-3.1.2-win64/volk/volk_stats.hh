@@ -0,0 +1,640 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_STATS_H
+#define INCLUDED_VOLK_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <volk/volk.h>
+#include <volk/volk_accumulate.hh>
+#include <volk/volk_parallel.hh>
+
+namespace volk {
+
+namespace stats_detail {
+
+// Lanes of the block sums; even, so a lane always holds the same complex part
+#if defined(__AVX__)
+static const unsigned int lanes = 8;
+#elif defined(__SSE2__) || defined(_M_X64)
+static const unsigned int lanes = 4;
+#else
+static const unsigned int lanes = 2;
+#endif
+
+/*
+ * Count, mean and central moment sums M2..M4 of one real variable.
+ * merge() is the pairwise update of Chan et al. extended to M3 / M4 by
+ * Pebay, so blocks, threads and single points all combine the same way.
+ */
+struct moments {
+    double count = 0.0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double m3 = 0.0;
+    double m4 = 0.0;
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+
+    void merge(const moments& b)
+    {
+        if (b.count == 0.0)
+            return;
+        if (count == 0.0) {
+            *this = b;
+            return;
+        }
+        const double na = count, nb = b.count, n = na + nb;
+        const double delta = b.mean - mean;
+        const double d_n = delta / n;
+        const double d_n2 = d_n * d_n;
+        const double t = delta * d_n * na * nb;
+
+        m4 += b.m4 + t * d_n2 * (na * na - na * nb + nb * nb) +
+              6.0 * d_n2 * (na * na * b.m2 + nb * nb * m2) +
+              4.0 * d_n * (na * b.m3 - nb * m3);
+        m3 += b.m3 + t * d_n * (na - nb) + 3.0 * d_n * (na * b.m2 - nb * m2);
+        m2 += b.m2 + t;
+        mean += d_n * nb;
+        count = n;
+        min = std::min(min, b.min);
+        max = std::max(max, b.max);
+    }
+
+    // moments of lane sums S1..S4 of x - center over count points
+    void from_sums(double n,
+                   double center,
+                   double s1,
+                   double s2,
+                   double s3,
+                   double s4,
+                   float lo,
+                   float hi)
+    {
+        // shift from the center to the block mean, delta is a rounding residue
+        const double delta = s1 / n;
+        const double d2 = delta * delta;
+        count = n;
+        mean = center + delta;
+        m2 = std::max(0.0, s2 - n * d2);
+        m3 = s3 - 3.0 * delta * s2 + 2.0 * n * d2 * delta;
+        m4 = std::max(0.0, s4 - 4.0 * delta * s3 + 6.0 * d2 * s2 - 3.0 * n * d2 * d2);
+        min = lo;
+        max = hi;
+    }
+};
+
+// Per-lane sums of powers of x - center[lane]
+struct lane_sums {
+    float s1[lanes], s2[lanes], s3[lanes], s4[lanes], cross[lanes];
+    float min[lanes], max[lanes];
+};
+
+// per-lane sum, min and max over num_floats floats
+inline void lane_extent(const float* x, unsigned int num_floats, lane_sums& out)
+{
+    unsigned int i = 0;
+#if defined(__AVX__)
+    __m256 sum = _mm256_setzero_ps();
+    __m256 lo = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    __m256 hi = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    for (; i + lanes <= num_floats; i += lanes) {
+        const __m256 v = _mm256_loadu_ps(x + i);
+        sum = _mm256_add_ps(sum, v);
+        lo = _mm256_min_ps(lo, v);
+        hi = _mm256_max_ps(hi, v);
+    }
+    _mm256_storeu_ps(out.s1, sum);
+    _mm256_storeu_ps(out.min, lo);
+    _mm256_storeu_ps(out.max, hi);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 sum = _mm_setzero_ps();
+    __m128 lo = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 hi = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+    for (; i + lanes <= num_floats; i += lanes) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        sum = _mm_add_ps(sum, v);
+        lo = _mm_min_ps(lo, v);
+        hi = _mm_max_ps(hi, v);
+    }
+    _mm_storeu_ps(out.s1, sum);
+    _mm_storeu_ps(out.min, lo);
+    _mm_storeu_ps(out.max, hi);
+#else
+    for (unsigned int l = 0; l < lanes; l++) {
+        out.s1[l] = 0.0f;
+        out.min[l] = std::numeric_limits<float>::infinity();
+        out.max[l] = -std::numeric_limits<float>::infinity();
+    }
+#endif
+    for (; i < num_floats; i++) {
+        const unsigned int l = i % lanes;
+        out.s1[l] += x[i];
+        out.min[l] = std::min(out.min[l], x[i]);
+        out.max[l] = std::max(out.max[l], x[i]);
+    }
+}
+
+// per-lane sums of d, d^2, d^3, d^4 with d = x - center[lane], and with
+// Cross the products of neighbouring (I, Q) deviations
+template <bool Cross>
+inline void lane_powers(const float* x,
+                        unsigned int num_floats,
+                        const float* center,
+                        lane_sums& out)
+{
+    unsigned int i = 0;
+#if defined(__AVX__)
+    const __m256 c = _mm256_loadu_ps(center);
+    __m256 s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps();
+    __m256 s3 = _mm256_setzero_ps(), s4 = _mm256_setzero_ps();
+    __m256 sx = _mm256_setzero_ps();
+    for (; i + lanes <= num_floats; i += lanes) {
+        const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(x + i), c);
+        const __m256 dd = _mm256_mul_ps(d, d);
+        s1 = _mm256_add_ps(s1, d);
+        s2 = _mm256_add_ps(s2, dd);
+        s3 = _mm256_add_ps(s3, _mm256_mul_ps(dd, d));
+        s4 = _mm256_add_ps(s4, _mm256_mul_ps(dd, dd));
+        if (Cross)
+            sx = _mm256_add_ps(sx, _mm256_mul_ps(d, _mm256_permute_ps(d, 0xb1)));
+    }
+    _mm256_storeu_ps(out.s1, s1);
+    _mm256_storeu_ps(out.s2, s2);
+    _mm256_storeu_ps(out.s3, s3);
+    _mm256_storeu_ps(out.s4, s4);
+    _mm256_storeu_ps(out.cross, sx);
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128 c = _mm_loadu_ps(center);
+    __m128 s1 = _mm_setzero_ps(), s2 = _mm_setzero_ps();
+    __m128 s3 = _mm_setzero_ps(), s4 = _mm_setzero_ps();
+    __m128 sx = _mm_setzero_ps();
+    for (; i + lanes <= num_floats; i += lanes) {
+        const __m128 d = _mm_sub_ps(_mm_loadu_ps(x + i), c);
+        const __m128 dd = _mm_mul_ps(d, d);
+        s1 = _mm_add_ps(s1, d);
+        s2 = _mm_add_ps(s2, dd);
+        s3 = _mm_add_ps(s3, _mm_mul_ps(dd, d));
+        s4 = _mm_add_ps(s4, _mm_mul_ps(dd, dd));
+        if (Cross)
+            sx = _mm_add_ps(sx, _mm_mul_ps(d, _mm_shuffle_ps(d, d, 0xb1)));
+    }
+    _mm_storeu_ps(out.s1, s1);
+    _mm_storeu_ps(out.s2, s2);
+    _mm_storeu_ps(out.s3, s3);
+    _mm_storeu_ps(out.s4, s4);
+    _mm_storeu_ps(out.cross, sx);
+#else
+    for (unsigned int l = 0; l < lanes; l++)
+        out.s1[l] = out.s2[l] = out.s3[l] = out.s4[l] = out.cross[l] = 0.0f;
+#endif
+    for (; i < num_floats; i++) {
+        const unsigned int l = i % lanes;
+        const float d = x[i] - center[l];
+        out.s1[l] += d;
+        out.s2[l] += d * d;
+        out.s3[l] += d * d * d;
+        out.s4[l] += d * d * d * d;
+        if (Cross)
+            out.cross[l] += d * (x[i ^ 1u] - center[l ^ 1u]);
+    }
+}
+
+// moments of the lanes l = first, first + step, ... of a block
+inline moments reduce_lanes(const lane_sums& s,
+                            const float* center,
+                            unsigned int first,
+                            unsigned int step,
+                            double n)
+{
+    double s1 = 0.0, s2 = 0.0, s3 = 0.0, s4 = 0.0;
+    float lo = std::numeric_limits<float>::infinity();
+    float hi = -std::numeric_limits<float>::infinity();
+    for (unsigned int l = first; l < lanes; l += step) {
+        s1 += s.s1[l];
+        s2 += s.s2[l];
+        s3 += s.s3[l];
+        s4 += s.s4[l];
+        lo = std::min(lo, s.min[l]);
+        hi = std::max(hi, s.max[l]);
+    }
+    moments m;
+    m.from_sums(n, center[first], s1, s2, s3, s4, lo, hi);
+    return m;
+}
+
+// Two passes over at most accumulation_block points: the first finds a
+// center, the second sums powers of the small deviations from it in float
+// lanes; num_floats holds whole points of parts floats
+inline void block_lanes(const float* x,
+                        unsigned int num_floats,
+                        unsigned int parts,
+                        bool cross,
+                        float* center,
+                        lane_sums& s)
+{
+    lane_sums extent;
+    lane_extent(x, num_floats, extent);
+    const double n = num_floats / parts;
+    for (unsigned int p = 0; p < parts; p++) {
+        double sum = 0.0;
+        for (unsigned int l = p; l < lanes; l += parts)
+            sum += extent.s1[l];
+        for (unsigned int l = p; l < lanes; l += parts)
+            center[l] = static_cast<float>(sum / n);
+    }
+    if (cross)
+        lane_powers<true>(x, num_floats, center, s);
+    else
+        lane_powers<false>(x, num_floats, center, s);
+    std::copy(extent.min, extent.min + lanes, s.min);
+    std::copy(extent.max, extent.max + lanes, s.max);
+}
+
+} // namespace stats_detail
+
+class complex_running_stats;
+
+/*!
+ * \brief Mergeable mean, variance, skewness, kurtosis, min and max of a float stream
+ *
+ * \details
+ *   Extends volk_32f_stddev_and_mean_32f_x2 across calls: update() folds a
+ *   block into the running moments and merge() combines accumulators, e.g.
+ *   of several threads or channels, exactly as if one had seen both
+ *   streams. Blocks are summed in SIMD float lanes about their own mean,
+ *   accumulation_block points at a time, and combined in double with the
+ *   pairwise formulas of Chan et al. and Pebay, so the result does not
+ *   drift over long streams. Moments are population moments; NaN inputs
+ *   are not filtered.
+ *
+ * example code:
+ *   volk::running_stats level;
+ *   level.update(block, n);
+ *   if (level.kurtosis() > 3.0)
+ *       impulsive_noise();
+ */
+class running_stats
+{
+public:
+    running_stats() = default;
+
+    void reset() { d_m = stats_detail::moments(); }
+
+    void update(float x)
+    {
+        stats_detail::moments one;
+        one.count = 1.0;
+        one.mean = x;
+        one.min = one.max = x;
+        d_m.merge(one);
+    }
+
+    void update(const float* input, unsigned int num_points)
+    {
+        float center[stats_detail::lanes];
+        stats_detail::lane_sums s;
+        for (unsigned int offset = 0; offset < num_points; offset += accumulation_block) {
+            const unsigned int n = std::min(accumulation_block, num_points - offset);
+            stats_detail::block_lanes(input + offset, n, 1, false, center, s);
+            d_m.merge(stats_detail::reduce_lanes(s, center, 0, 1, n));
+        }
+    }
+
+    //! Adds the points seen by other, as if this had seen them too
+    void merge(const running_stats& other) { d_m.merge(other.d_m); }
+
+    uint64_t count() const { return static_cast<uint64_t>(d_m.count); }
+    double mean() const { return d_m.mean; }
+    float min() const { return d_m.min; }
+    float max() const { return d_m.max; }
+
+    //! Population variance, as volk_32f_stddev_and_mean_32f_x2
+    double variance() const { return d_m.count > 0.0 ? d_m.m2 / d_m.count : 0.0; }
+
+    //! Unbiased variance, dividing by count - 1
+    double sample_variance() const
+    {
+        return d_m.count > 1.0 ? d_m.m2 / (d_m.count - 1.0) : 0.0;
+    }
+
+    double stddev() const { return std::sqrt(variance()); }
+
+    double skewness() const
+    {
+        return d_m.m2 > 0.0 ? std::sqrt(d_m.count) * d_m.m3 / std::pow(d_m.m2, 1.5) : 0.0;
+    }
+
+    //! Excess kurtosis, 0 for Gaussian samples
+    double kurtosis() const
+    {
+        return d_m.m2 > 0.0 ? d_m.count * d_m.m4 / (d_m.m2 * d_m.m2) - 3.0 : 0.0;
+    }
+
+private:
+    friend class complex_running_stats;
+
+    stats_detail::moments d_m;
+};
+
+/*!
+ * \brief Mergeable statistics of a complex stream
+ *
+ * \details
+ *   Tracks the moments of I and Q and their covariance in one pass over
+ *   the interleaved samples, with the same block and merge scheme as
+ *   running_stats. The I / Q powers and covariance are what IQ imbalance
+ *   estimation needs; power() and variance() serve AGC and SNR telemetry.
+ *
+ * example code:
+ *   volk::complex_running_stats iq;
+ *   iq.update(samples, n);
+ *   const double gain = std::sqrt(iq.real().variance() / iq.imag().variance());
+ */
+class complex_running_stats
+{
+public:
+    complex_running_stats() = default;
+
+    void reset()
+    {
+        d_real.reset();
+        d_imag.reset();
+        d_cross = 0.0;
+    }
+
+    void update(const lv_32fc_t* input, unsigned int num_points)
+    {
+        const float* x = reinterpret_cast<const float*>(input);
+        float center[stats_detail::lanes];
+        stats_detail::lane_sums s;
+        for (unsigned int offset = 0; offset < num_points; offset += accumulation_block) {
+            const unsigned int n = std::min(accumulation_block, num_points - offset);
+            stats_detail::block_lanes(x + 2 * offset, 2 * n, 2, true, center, s);
+            const stats_detail::moments re =
+                stats_detail::reduce_lanes(s, center, 0, 2, n);
+            const stats_detail::moments im =
+                stats_detail::reduce_lanes(s, center, 1, 2, n);
+
+            // even lanes hold dI dQ about the centers; move it to the block means
+            double cross = 0.0;
+            for (unsigned int l = 0; l < stats_detail::lanes; l += 2)
+                cross += s.cross[l];
+            cross -= n * (re.mean - center[0]) * (im.mean - center[1]);
+            merge(re, im, cross);
+        }
+    }
+
+    void merge(const complex_running_stats& other)
+    {
+        merge(other.d_real.d_m, other.d_imag.d_m, other.d_cross);
+    }
+
+    uint64_t count() const { return d_real.count(); }
+    lv_32fc_t mean() const
+    {
+        return lv_cmake(static_cast<float>(d_real.mean()),
+                        static_cast<float>(d_imag.mean()));
+    }
+
+    const running_stats& real() const { return d_real; }
+    const running_stats& imag() const { return d_imag; }
+
+    //! E[(I - mean I)(Q - mean Q)]
+    double covariance() const
+    {
+        return d_real.d_m.count > 0.0 ? d_cross / d_real.d_m.count : 0.0;
+    }
+
+    //! E|x - mean|^2
+    double variance() const { return d_real.variance() + d_imag.variance(); }
+
+    //! E|x|^2
+    double power() const
+    {
+        return variance() + d_real.mean() * d_real.mean() + d_imag.mean() * d_imag.mean();
+    }
+
+private:
+    void
+    merge(const stats_detail::moments& re, const stats_detail::moments& im, double cross)
+    {
+        const double na = d_real.d_m.count, nb = re.count;
+        if (nb == 0.0)
+            return;
+        if (na > 0.0)
+            cross += (re.mean - d_real.d_m.mean) * (im.mean - d_imag.d_m.mean) * na * nb /
+                     (na + nb);
+        d_cross += cross;
+        d_real.d_m.merge(re);
+        d_imag.d_m.merge(im);
+    }
+
+    running_stats d_real;
+    running_stats d_imag;
+    double d_cross = 0.0; // sum of (I - mean I)(Q - mean Q)
+};
+
+/*!
+ * \brief Mergeable fixed-bin histogram of a float stream
+ *
+ * \details
+ *   num_bins equal bins cover [lo, hi); points below lo, and NaN, count as
+ *   underflow, points at or above hi as overflow. Bin indices are computed
+ *   in SIMD lanes and counted into interleaved partial histograms, so
+ *   repeated values do not serialize on one counter.
+ *
+ * example code:
+ *   volk::histogram h(-1.0f, 1.0f, 64);
+ *   h.update(samples, n);
+ *   const float p99 = h.quantile(0.99);
+ */
+class histogram
+{
+public:
+    histogram(float lo, float hi, unsigned int num_bins)
+        : d_lo(lo), d_hi(hi), d_bins(num_bins), d_counts(ways * (num_bins + 2), 0)
+    {
+        if (num_bins == 0)
+            throw std::invalid_argument("histogram: num_bins must be positive");
+        if (!(hi > lo))
+            throw std::invalid_argument("histogram: hi must be above lo");
+        d_scale = num_bins / (hi - lo);
+    }
+
+    void reset() { std::fill(d_counts.begin(), d_counts.end(), 0); }
+
+    void update(const float* input, unsigned int num_points)
+    {
+        // slot 0 is underflow, 1..num_bins the bins, num_bins + 1 overflow
+        const unsigned int slots = d_bins + 2;
+        uint64_t* counts = d_counts.data();
+        const float top = static_cast<float>(d_bins + 1);
+        const float origin = 1.0f - d_lo * d_scale;
+        unsigned int i = 0;
+#if defined(__AVX__)
+        const __m256 scale = _mm256_set1_ps(d_scale);
+        const __m256 shift = _mm256_set1_ps(origin);
+        const __m256 upper = _mm256_set1_ps(top);
+        __VOLK_ATTR_ALIGNED(32) int32_t slot[8];
+        for (; i + 8 <= num_points; i += 8) {
+            __m256 u =
+                _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(input + i), scale), shift);
+            // max returns the second operand for NaN
+            u = _mm256_min_ps(_mm256_max_ps(u, _mm256_setzero_ps()), upper);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(slot), _mm256_cvttps_epi32(u));
+            for (unsigned int k = 0; k < 8; k++)
+                counts[(k % ways) * slots + slot[k]]++;
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 scale = _mm_set1_ps(d_scale);
+        const __m128 shift = _mm_set1_ps(origin);
+        const __m128 upper = _mm_set1_ps(top);
+        __VOLK_ATTR_ALIGNED(16) int32_t slot[4];
+        for (; i + 4 <= num_points; i += 4) {
+            __m128 u = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(input + i), scale), shift);
+            u = _mm_min_ps(_mm_max_ps(u, _mm_setzero_ps()), upper);
+            _mm_store_si128(reinterpret_cast<__m128i*>(slot), _mm_cvttps_epi32(u));
+            for (unsigned int k = 0; k < 4; k++)
+                counts[k * slots + slot[k]]++;
+        }
+#endif
+        for (; i < num_points; i++) {
+            const float u = input[i] * d_scale + origin;
+            counts[u >= 0.0f ? static_cast<unsigned int>(std::min(u, top)) : 0]++;
+        }
+    }
+
+    void merge(const histogram& other)
+    {
+        if (other.d_bins != d_bins || other.d_lo != d_lo || other.d_hi != d_hi)
+            throw std::invalid_argument(
+                "histogram: merging histograms of different bins");
+        for (std::size_t i = 0; i < d_counts.size(); i++)
+            d_counts[i] += other.d_counts[i];
+    }
+
+    unsigned int num_bins() const { return d_bins; }
+    float bin_low(unsigned int bin) const { return d_lo + bin / d_scale; }
+    float bin_center(unsigned int bin) const { return d_lo + (bin + 0.5f) / d_scale; }
+
+    uint64_t count(unsigned int bin) const { return slot_count(bin + 1); }
+    uint64_t underflow() const { return slot_count(0); }
+    uint64_t overflow() const { return slot_count(d_bins + 1); }
+
+    uint64_t total() const
+    {
+        uint64_t n = 0;
+        for (uint64_t c : d_counts)
+            n += c;
+        return n;
+    }
+
+    //! Counts of the num_bins bins
+    std::vector<uint64_t> counts() const
+    {
+        std::vector<uint64_t> out(d_bins);
+        for (unsigned int b = 0; b < d_bins; b++)
+            out[b] = count(b);
+        return out;
+    }
+
+    /*!
+     * \brief Value below which a fraction q of the points lie
+     *
+     * \details
+     *   Interpolates linearly inside the bin; underflow points sit at lo
+     *   and overflow points at hi.
+     */
+    float quantile(double q) const
+    {
+        const double n = static_cast<double>(total());
+        if (n == 0.0)
+            return d_lo;
+        double rank = std::min(std::max(q, 0.0), 1.0) * n - underflow();
+        if (rank <= 0.0)
+            return d_lo;
+        for (unsigned int b = 0; b < d_bins; b++) {
+            const double c = static_cast<double>(count(b));
+            if (rank <= c)
+                return d_lo + static_cast<float>((b + rank / c) / d_scale);
+            rank -= c;
+        }
+        return d_hi;
+    }
+
+private:
+    // partial histograms interleaved over the lanes of one SIMD block
+    static const unsigned int ways = 4;
+
+    uint64_t slot_count(unsigned int slot) const
+    {
+        uint64_t n = 0;
+        for (unsigned int w = 0; w < ways; w++)
+            n += d_counts[w * (d_bins + 2) + slot];
+        return n;
+    }
+
+    float d_lo;
+    float d_hi;
+    unsigned int d_bins;
+    float d_scale;
+    std::vector<uint64_t> d_counts;
+};
+
+/*!
+ * \brief Updates a running_stats, complex_running_stats or histogram on a pool
+ *
+ * \details
+ *   Each chunk is accumulated into an empty copy of stats and the copies
+ *   are merged in chunk order, so the result does not depend on thread
+ *   scheduling.
+ *
+ * example code:
+ *   volk::complex_running_stats iq;
+ *   volk::parallel_update(iq, samples, n);
+ */
+template <class Stats, class T>
+void parallel_update(Stats& stats,
+                     const T* input,
+                     unsigned int num_points,
+                     thread_pool& pool = thread_pool::global())
+{
+    const parallel_split<T> split(num_points, pool);
+    if (split.num_chunks == 1) {
+        stats.update(input, num_points);
+        return;
+    }
+
+    Stats empty = stats;
+    empty.reset();
+    std::vector<Stats> partial(split.num_chunks, empty);
+    pool.run(split.num_chunks, [&](unsigned int chunk) {
+        partial[chunk].update(input + split.offset(chunk),
+                              split.length(chunk, num_points));
+    });
+    for (const Stats& p : partial)
+        stats.merge(p);
+}
+
+} // namespace volk
+#endif // INCLUDED_VOLK_STATS_H
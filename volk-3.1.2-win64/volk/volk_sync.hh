@@ -0,0 +1,327 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_SYNC_H
+#define INCLUDED_VOLK_SYNC_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// sets the LV_HAVE_* of this translation unit for the kernel header
+#include <volk/volk_bind.hh>
+
+#include <volk/volk_8u_x2_hamming_distance_8u.h>
+#include <volk/volk_alloc.hh>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace volk {
+
+namespace sync_detail {
+
+inline void hamming_distance(uint8_t* distances,
+                             const uint8_t* packed,
+                             const uint8_t* pattern,
+                             unsigned int pattern_bits,
+                             unsigned int num_points)
+{
+#if defined(LV_HAVE_AVX2)
+    volk_8u_x2_hamming_distance_8u_u_avx2(
+        distances, packed, pattern, pattern_bits, num_points);
+#elif defined(LV_HAVE_SSSE3)
+    volk_8u_x2_hamming_distance_8u_u_ssse3(
+        distances, packed, pattern, pattern_bits, num_points);
+#elif defined(LV_HAVE_NEON)
+    volk_8u_x2_hamming_distance_8u_neon(
+        distances, packed, pattern, pattern_bits, num_points);
+#else
+    volk_8u_x2_hamming_distance_8u_generic(
+        distances, packed, pattern, pattern_bits, num_points);
+#endif
+}
+
+} // namespace sync_detail
+
+//! One sync word detection
+struct sync_hit {
+    uint64_t offset;       //!< stream bit index of the first sync word bit
+    unsigned int distance; //!< Hamming distance to the (inverted) sync word
+    bool inverted;         //!< matched the inverted word, e.g. a BPSK phase flip
+};
+
+/*!
+ * \brief Streaming sync word search over hard decision bits
+ *
+ * \details
+ *   Packs the 0 / 1 decisions of volk_32f_binary_slicer_8i MSB first and
+ *   computes the Hamming distance to a 1 to 128 bit sync word at every bit
+ *   offset with volk_8u_x2_hamming_distance_8u. Offsets within threshold
+ *   bit errors are reported, and with detect_inverted also those within
+ *   threshold errors of the inverted word. The last pattern_bits - 1 bits
+ *   are kept between calls, so a word split across two calls is found, and
+ *   offsets count from the first bit after construction or reset().
+ *
+ * example code:
+ *   volk::sync_correlator sync(0x1ACFFC1D, 32, 3, true);
+ *   volk_32f_binary_slicer_8i(bits, soft, n);
+ *   for (const volk::sync_hit& hit : sync.process(bits, n))
+ *       frame_start(hit.offset + 32, hit.inverted);
+ */
+class sync_correlator
+{
+public:
+    static constexpr unsigned int max_pattern_bits = 128;
+
+    //! Sync word of 1 to 64 bits, given by the low pattern_bits of word
+    sync_correlator(uint64_t word,
+                    unsigned int pattern_bits,
+                    unsigned int threshold,
+                    bool detect_inverted = false)
+        : sync_correlator(
+              word_bytes(word, pattern_bits), pattern_bits, threshold, detect_inverted)
+    {
+    }
+
+    //! Sync word of 1 to 128 bits, packed MSB first
+    sync_correlator(const std::vector<uint8_t>& pattern,
+                    unsigned int pattern_bits,
+                    unsigned int threshold,
+                    bool detect_inverted = false)
+        : d_pattern(pattern),
+          d_bits(pattern_bits),
+          // no distance exceeds pattern_bits; clamping also keeps the
+          // threshold within the 8-bit lanes of the prefilter
+          d_threshold(std::min(threshold, pattern_bits)),
+          d_inverted(detect_inverted)
+    {
+        if (pattern_bits == 0 || pattern_bits > max_pattern_bits)
+            throw std::invalid_argument(
+                "sync_correlator: pattern_bits must be in [1, 128]");
+        if (pattern.size() < (pattern_bits + 7) / 8)
+            throw std::invalid_argument(
+                "sync_correlator: pattern shorter than pattern_bits");
+        if (detect_inverted && 2 * d_threshold >= pattern_bits)
+            throw std::invalid_argument(
+                "sync_correlator: threshold too large to tell the inverted word apart");
+        d_pattern.resize((pattern_bits + 7) / 8);
+        reset();
+    }
+
+    unsigned int pattern_bits() const { return d_bits; }
+    unsigned int threshold() const { return d_threshold; }
+
+    //! Number of bits consumed since construction or reset()
+    uint64_t bits_consumed() const { return d_base + 8 * d_fill + d_pending_bits; }
+
+    void reset()
+    {
+        d_base = 0;
+        d_next = 0;
+        d_fill = 0;
+        d_pending = 0;
+        d_pending_bits = 0;
+        d_hits.clear();
+    }
+
+    /*!
+     * \brief Packs n 0 / 1 bytes MSB first into (n + 7) / 8 bytes
+     *
+     * \details
+     *   A last partial byte is padded with zeros.
+     */
+    static void pack_bits(uint8_t* packed, const int8_t* bits, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t v;
+            std::memcpy(&v, bits + i, 8);
+            // byte k of v lands in bit 7 - k of the top byte, little endian hosts
+            *packed++ = static_cast<uint8_t>(
+                ((v & 0x0101010101010101ull) * 0x8040201008040201ull) >> 56);
+        }
+        if (i < n) {
+            uint8_t last = 0;
+            for (unsigned int b = 0; i < n; i++, b++)
+                last |= (bits[i] & 1) << (7 - b);
+            *packed = last;
+        }
+    }
+
+    /*!
+     * \brief Searches n hard decisions (0 or 1 per byte)
+     *
+     * \details
+     *   Returns the hits completed by these bits, valid until the next call.
+     *   A word ending in a byte that is not complete yet is reported by the
+     *   call that completes the byte.
+     */
+    const std::vector<sync_hit>& process(const int8_t* bits, std::size_t n)
+    {
+        d_hits.clear();
+        while (n > 0) {
+            // complete a byte left over from the last call
+            while (d_pending_bits != 0 && n > 0) {
+                d_pending |= (*bits++ & 1) << (7 - d_pending_bits);
+                n--;
+                if (++d_pending_bits == 8) {
+                    append_bytes(&d_pending, 1);
+                    d_pending = 0;
+                    d_pending_bits = 0;
+                }
+            }
+
+            const std::size_t whole = std::min(n / 8, chunk_bytes);
+            if (whole > 0) {
+                reserve(whole);
+                pack_bits(&d_buf[d_fill], bits, 8 * whole);
+                d_fill += whole;
+                bits += 8 * whole;
+                n -= 8 * whole;
+                scan();
+            } else {
+                for (; n > 0; n--)
+                    d_pending |= (*bits++ & 1) << (7 - d_pending_bits++);
+            }
+        }
+        scan();
+        return d_hits;
+    }
+
+    /*!
+     * \brief Searches num_bytes bytes already packed MSB first
+     *
+     * \details
+     *   Only valid on a byte boundary of the stream, with no partial byte
+     *   left by process().
+     */
+    const std::vector<sync_hit>& process_packed(const uint8_t* bytes,
+                                                std::size_t num_bytes)
+    {
+        if (d_pending_bits != 0)
+            throw std::logic_error("sync_correlator: stream not on a byte boundary");
+        d_hits.clear();
+        while (num_bytes > 0) {
+            const std::size_t n = std::min(num_bytes, chunk_bytes);
+            append_bytes(bytes, n);
+            bytes += n;
+            num_bytes -= n;
+        }
+        return d_hits;
+    }
+
+private:
+    static constexpr std::size_t chunk_bytes = 8192;
+
+    static std::vector<uint8_t> word_bytes(uint64_t word, unsigned int pattern_bits)
+    {
+        if (pattern_bits == 0 || pattern_bits > 64)
+            throw std::invalid_argument(
+                "sync_correlator: word patterns hold 1 to 64 bits");
+        std::vector<uint8_t> bytes((pattern_bits + 7) / 8);
+        const uint64_t aligned = pattern_bits == 64 ? word : word << (64 - pattern_bits);
+        for (std::size_t i = 0; i < bytes.size(); i++)
+            bytes[i] = static_cast<uint8_t>(aligned >> (56 - 8 * i));
+        return bytes;
+    }
+
+    void reserve(std::size_t bytes)
+    {
+        if (d_buf.size() < d_fill + bytes)
+            d_buf.resize(d_fill + bytes);
+    }
+
+    void append_bytes(const uint8_t* bytes, std::size_t n)
+    {
+        reserve(n);
+        std::memcpy(&d_buf[d_fill], bytes, n);
+        d_fill += n;
+        scan();
+    }
+
+    // every offset whose word lies in the buffer; the kernel starts on a
+    // byte, so the up to 7 offsets of a partly scanned byte are recomputed
+    void scan()
+    {
+        const uint64_t end = d_base + 8 * d_fill;
+        if (end < d_next + d_bits)
+            return;
+        const std::size_t start = static_cast<std::size_t>((d_next - d_base) / 8);
+        const uint64_t first = d_base + 8 * start;
+        const std::size_t count = static_cast<std::size_t>(end - d_bits + 1 - first);
+
+        if (d_dist.size() < count)
+            d_dist.resize(count);
+        sync_detail::hamming_distance(d_dist.data(),
+                                      &d_buf[start],
+                                      d_pattern.data(),
+                                      d_bits,
+                                      static_cast<unsigned int>(count));
+        collect(first, static_cast<std::size_t>(d_next - first), count);
+        d_next = first + count;
+
+        // keep the bytes of the offsets not scanned yet
+        const std::size_t drop = static_cast<std::size_t>((d_next - d_base) / 8);
+        std::memmove(&d_buf[0], &d_buf[drop], d_fill - drop);
+        d_fill -= drop;
+        d_base += 8 * drop;
+    }
+
+    bool is_hit(unsigned int distance) const
+    {
+        return distance <= d_threshold ||
+               (d_inverted && distance >= d_bits - d_threshold);
+    }
+
+    void collect(uint64_t first, std::size_t i, std::size_t count)
+    {
+        const uint8_t* dist = d_dist.data();
+#if defined(__SSE2__) || defined(_M_X64)
+        // skip 16 offsets at a time while none is near either word
+        const __m128i low = _mm_set1_epi8(static_cast<char>(d_threshold));
+        const __m128i high = _mm_set1_epi8(
+            static_cast<char>(d_inverted ? d_bits - d_threshold : max_pattern_bits + 1));
+        for (; i + 16 <= count; i += 16) {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dist + i));
+            const __m128i near_word = _mm_cmpeq_epi8(_mm_min_epu8(d, low), d);
+            const __m128i near_inverse = _mm_cmpeq_epi8(_mm_max_epu8(d, high), d);
+            if (_mm_movemask_epi8(_mm_or_si128(near_word, near_inverse)) == 0)
+                continue;
+            for (std::size_t j = i; j < i + 16; j++)
+                if (is_hit(dist[j]))
+                    d_hits.push_back({ first + j, dist[j], dist[j] > d_threshold });
+        }
+#endif
+        for (; i < count; i++)
+            if (is_hit(dist[i]))
+                d_hits.push_back({ first + i, dist[i], dist[i] > d_threshold });
+    }
+
+    std::vector<uint8_t> d_pattern;
+    unsigned int d_bits;
+    unsigned int d_threshold;
+    bool d_inverted;
+
+    volk::vector<uint8_t> d_buf;  // packed stream from bit d_base
+    volk::vector<uint8_t> d_dist; // distances of the last scan
+    std::vector<sync_hit> d_hits;
+    std::size_t d_fill = 0;       // bytes in d_buf
+    uint64_t d_base = 0;          // stream bit of d_buf[0]
+    uint64_t d_next = 0;          // first offset not scanned yet
+    uint8_t d_pending = 0;        // bits of an incomplete byte
+    unsigned int d_pending_bits = 0;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_SYNC_H
@@ -0,0 +1,444 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_VITERBI_H
+#define INCLUDED_VOLK_VITERBI_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <volk/volk_alloc.hh>
+
+namespace volk {
+
+/*!
+ * \brief Soft-decision Viterbi decoder for rate 1/n convolutional codes
+ *
+ * \details
+ *   Generalizes the K=7 r=1/2 butterfly of volk_8u_x4_conv_k7_r2_8u to any
+ *   constraint length 2 <= K <= 10, n = 1..6 generator polynomials and an
+ *   optional puncturing pattern.
+ *
+ *   Frames are decoded batch_size at a time with one frame per SIMD lane:
+ *   all frames share the trellis, so add-compare-select runs on 16 x 16-bit
+ *   path metrics per instruction (AVX2, SSE2 or portable fallback, picked at
+ *   compile time). Traceback follows all lanes together, using AVX2 gathers
+ *   for the decision lookups when available.
+ *
+ *   Conventions match volk_8u_conv_k7_r2puppet_8u: the encoder shifts each
+ *   new bit into the LSB of its register, symbol i of a step is
+ *   parity(register & polys[i]), and soft symbols are unsigned chars with 0
+ *   for a certain 0 bit and 255 for a certain 1 bit. Frames start in state 0;
+ *   terminated frames are followed by K - 1 zero tail bits.
+ *
+ * example code:
+ *   // K=7 r=1/2 (CCSDS), punctured to r=3/4
+ *   volk::viterbi_decoder dec(7, { 79, 109 }, { 1, 1, 0, 1, 1, 0 });
+ *   std::vector<const unsigned char*> in(frames);  // dec.frame_symbols(bits) each
+ *   std::vector<unsigned char*> out(frames);       // bits entries each
+ *   dec.decode(out.data(), in.data(), frames, bits);
+ */
+class viterbi_decoder
+{
+public:
+    //! Number of frames decoded side by side
+    static const unsigned int batch_size = 16;
+
+    /*!
+     * \param k constraint length
+     * \param polys one generator polynomial per output symbol
+     * \param puncture keep (1) / drop (0) flags over whole steps of n symbols,
+     *        empty for an unpunctured code
+     * \param terminated frames end with K - 1 zero tail bits
+     */
+    viterbi_decoder(unsigned int k,
+                    const std::vector<unsigned int>& polys,
+                    const std::vector<unsigned char>& puncture = {},
+                    bool terminated = true)
+        : d_k(k),
+          d_rate(static_cast<unsigned int>(polys.size())),
+          d_polys(polys),
+          d_puncture(puncture),
+          d_terminated(terminated)
+    {
+        if (k < 2 || k > 10)
+            throw std::invalid_argument("viterbi_decoder: K must be in [2, 10]");
+        d_states = 1u << (k - 1);
+        if (d_rate < 1 || d_rate > 6)
+            throw std::invalid_argument("viterbi_decoder: 1 to 6 polynomials supported");
+        if (d_puncture.empty())
+            d_puncture.assign(d_rate, 1);
+        if (d_puncture.size() % d_rate != 0 ||
+            std::find(d_puncture.begin(), d_puncture.end(), 1) == d_puncture.end())
+            throw std::invalid_argument(
+                "viterbi_decoder: puncture pattern must cover whole steps");
+
+        // codeword emitted for every (state, input bit) encoder register
+        d_codeword.resize(2 * d_states);
+        for (unsigned int reg = 0; reg < 2 * d_states; reg++) {
+            unsigned int cw = 0;
+            for (unsigned int i = 0; i < d_rate; i++)
+                cw |= parity(reg & d_polys[i]) << i;
+            d_codeword[reg] = static_cast<unsigned char>(cw);
+        }
+
+        d_metrics.resize(2 * d_states * batch_size);
+        d_branch.resize((1u << d_rate) * batch_size);
+        d_syms.resize(batch_size);
+    }
+
+    unsigned int k() const { return d_k; }
+    unsigned int rate() const { return d_rate; }
+
+    //! Trellis steps for a frame of info_bits, including the tail
+    unsigned int frame_steps(unsigned int info_bits) const
+    {
+        return info_bits + (d_terminated ? d_k - 1 : 0);
+    }
+
+    //! Transmitted (post-puncturing) soft symbols for a frame of info_bits
+    unsigned int frame_symbols(unsigned int info_bits) const
+    {
+        const unsigned int total = frame_steps(info_bits) * d_rate;
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < total; i++)
+            kept += d_puncture[i % d_puncture.size()];
+        return kept;
+    }
+
+    /*!
+     * \brief Reference encoder producing hard soft-symbols (0 / 255)
+     *
+     * \details
+     *   syms must hold frame_symbols(info_bits) entries; bits holds one bit
+     *   per byte.
+     */
+    void encode(unsigned char* syms, const unsigned char* bits, unsigned int info_bits) const
+    {
+        const unsigned int steps = frame_steps(info_bits);
+        unsigned int reg = 0;
+        unsigned int pos = 0;
+        for (unsigned int t = 0; t < steps; t++) {
+            const unsigned int bit = t < info_bits ? (bits[t] & 1) : 0;
+            reg = ((reg << 1) | bit) & (2 * d_states - 1);
+            for (unsigned int i = 0; i < d_rate; i++, pos++) {
+                if (d_puncture[pos % d_puncture.size()])
+                    *syms++ = d_codeword[reg] >> i & 1 ? 255 : 0;
+            }
+        }
+    }
+
+    /*!
+     * \brief Decodes num_frames frames of info_bits each
+     *
+     * \details
+     *   syms[f] holds frame_symbols(info_bits) soft symbols of frame f and
+     *   bits[f] receives info_bits decoded bits, one per byte.
+     */
+    void decode(unsigned char* const* bits,
+                const unsigned char* const* syms,
+                unsigned int num_frames,
+                unsigned int info_bits)
+    {
+        const unsigned int steps = frame_steps(info_bits);
+        if (num_frames == 0 || steps == 0)
+            return;
+
+        d_decisions.resize(static_cast<size_t>(steps) * d_states);
+
+        for (unsigned int first = 0; first < num_frames; first += batch_size) {
+            const unsigned int lanes = std::min(batch_size, num_frames - first);
+            const unsigned char* lane_syms[batch_size];
+            for (unsigned int l = 0; l < batch_size; l++)
+                lane_syms[l] = syms[first + (l < lanes ? l : 0)];
+
+            forward(lane_syms, steps);
+            traceback(bits + first, lanes, steps, info_bits);
+        }
+    }
+
+private:
+    static unsigned int parity(unsigned int x)
+    {
+        x ^= x >> 16;
+        x ^= x >> 8;
+        x ^= x >> 4;
+        x ^= x >> 2;
+        x ^= x >> 1;
+        return x & 1;
+    }
+
+    // 16 lanes of unsigned 16-bit path metrics
+#if defined(__AVX2__)
+    typedef __m256i lanes_t;
+    static lanes_t load(const uint16_t* p)
+    {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static void store(uint16_t* p, lanes_t v)
+    {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    static lanes_t splat(uint16_t x) { return _mm256_set1_epi16(static_cast<short>(x)); }
+    static lanes_t add(lanes_t a, lanes_t b) { return _mm256_adds_epu16(a, b); }
+    static lanes_t sub(lanes_t a, lanes_t b) { return _mm256_subs_epu16(a, b); }
+    static lanes_t vmin(lanes_t a, lanes_t b) { return _mm256_min_epu16(a, b); }
+    // two bits per lane, set where b < a
+    static uint32_t less_mask(lanes_t a, lanes_t b)
+    {
+        return ~static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi16(a, _mm256_min_epu16(a, b))));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    struct lanes_t {
+        __m128i lo, hi;
+    };
+    static lanes_t load(const uint16_t* p)
+    {
+        return { _mm_load_si128(reinterpret_cast<const __m128i*>(p)),
+                 _mm_load_si128(reinterpret_cast<const __m128i*>(p + 8)) };
+    }
+    static void store(uint16_t* p, lanes_t v)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i*>(p), v.lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(p + 8), v.hi);
+    }
+    static lanes_t splat(uint16_t x)
+    {
+        const __m128i v = _mm_set1_epi16(static_cast<short>(x));
+        return { v, v };
+    }
+    static lanes_t add(lanes_t a, lanes_t b)
+    {
+        return { _mm_adds_epu16(a.lo, b.lo), _mm_adds_epu16(a.hi, b.hi) };
+    }
+    static lanes_t sub(lanes_t a, lanes_t b)
+    {
+        return { _mm_subs_epu16(a.lo, b.lo), _mm_subs_epu16(a.hi, b.hi) };
+    }
+    // SSE2 has no unsigned 16-bit min: a - (a -sat b) == min(a, b)
+    static __m128i min_epu16(__m128i a, __m128i b)
+    {
+        return _mm_sub_epi16(a, _mm_subs_epu16(a, b));
+    }
+    static lanes_t vmin(lanes_t a, lanes_t b)
+    {
+        return { min_epu16(a.lo, b.lo), min_epu16(a.hi, b.hi) };
+    }
+    static uint32_t less_mask(lanes_t a, lanes_t b)
+    {
+        const uint32_t lo = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi16(a.lo, min_epu16(a.lo, b.lo))));
+        const uint32_t hi = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi16(a.hi, min_epu16(a.hi, b.hi))));
+        return ~(lo | hi << 16);
+    }
+#else
+    struct lanes_t {
+        uint16_t v[16];
+    };
+    static lanes_t load(const uint16_t* p)
+    {
+        lanes_t r;
+        std::memcpy(r.v, p, sizeof(r.v));
+        return r;
+    }
+    static void store(uint16_t* p, const lanes_t& v) { std::memcpy(p, v.v, sizeof(v.v)); }
+    static lanes_t splat(uint16_t x)
+    {
+        lanes_t r;
+        std::fill(r.v, r.v + 16, x);
+        return r;
+    }
+    static lanes_t add(const lanes_t& a, const lanes_t& b)
+    {
+        lanes_t r;
+        for (int l = 0; l < 16; l++)
+            r.v[l] = static_cast<uint16_t>(std::min(0xffff, a.v[l] + b.v[l]));
+        return r;
+    }
+    static lanes_t sub(const lanes_t& a, const lanes_t& b)
+    {
+        lanes_t r;
+        for (int l = 0; l < 16; l++)
+            r.v[l] = static_cast<uint16_t>(a.v[l] > b.v[l] ? a.v[l] - b.v[l] : 0);
+        return r;
+    }
+    static lanes_t vmin(const lanes_t& a, const lanes_t& b)
+    {
+        lanes_t r;
+        for (int l = 0; l < 16; l++)
+            r.v[l] = std::min(a.v[l], b.v[l]);
+        return r;
+    }
+    static uint32_t less_mask(const lanes_t& a, const lanes_t& b)
+    {
+        uint32_t m = 0;
+        for (int l = 0; l < 16; l++)
+            m |= (b.v[l] < a.v[l] ? 3u : 0u) << (2 * l);
+        return m;
+    }
+#endif
+
+    void forward(const unsigned char* const* lane_syms, unsigned int steps)
+    {
+        const unsigned int states = d_states;
+        const unsigned int half = states / 2;
+        const unsigned int codewords = 1u << d_rate;
+        const unsigned char* codeword = d_codeword.data();
+        uint16_t* branch = d_branch.data();
+        uint16_t* syms = d_syms.data();
+        uint16_t* old_metrics = d_metrics.data();
+        uint16_t* new_metrics = d_metrics.data() + states * batch_size;
+
+        // start in state 0. Within K - 1 steps its paths reach every state
+        // with a metric of at most (K - 1) * n * 255, so a larger head start
+        // wins every compare until then. For K = 10, n = 6 that is 13771,
+        // which leaves room for the 16 * n * 255 gained between
+        // renormalizations below 0xffff.
+        const uint16_t head_start = static_cast<uint16_t>((d_k - 1) * d_rate * 255 + 1);
+        std::fill(old_metrics, old_metrics + states * batch_size, head_start);
+        std::fill(old_metrics, old_metrics + batch_size, 0);
+
+        const lanes_t full = splat(255);
+        const unsigned int period = static_cast<unsigned int>(d_puncture.size());
+        unsigned int sym_pos = 0;
+        unsigned int pattern = 0;
+        for (unsigned int t = 0; t < steps; t++) {
+            // branch metric of every codeword: distance to the soft symbols,
+            // punctured symbols do not contribute
+            std::fill(branch, branch + codewords * batch_size, 0);
+            for (unsigned int i = 0; i < d_rate; i++) {
+                if (!d_puncture[(pattern + i) % period])
+                    continue;
+                for (unsigned int l = 0; l < batch_size; l++)
+                    syms[l] = lane_syms[l][sym_pos];
+                sym_pos++;
+
+                const lanes_t zero_dist = load(syms);
+                const lanes_t one_dist = sub(full, zero_dist);
+                for (unsigned int cw = 0; cw < codewords; cw++) {
+                    uint16_t* bm = branch + cw * batch_size;
+                    store(bm, add(load(bm), cw >> i & 1 ? one_dist : zero_dist));
+                }
+            }
+            pattern = (pattern + d_rate) % period;
+
+            // add-compare-select over all butterflies
+            uint32_t* dec = &d_decisions[static_cast<size_t>(t) * states];
+            for (unsigned int j = 0; j < half; j++) {
+                const lanes_t m0 = load(old_metrics + j * batch_size);
+                const lanes_t m1 = load(old_metrics + (j + half) * batch_size);
+                for (unsigned int b = 0; b < 2; b++) {
+                    const unsigned int reg = 2 * j + b;
+                    const lanes_t c0 = add(m0, load(branch + codeword[reg] * batch_size));
+                    const lanes_t c1 =
+                        add(m1, load(branch + codeword[reg | states] * batch_size));
+                    store(new_metrics + reg * batch_size, vmin(c0, c1));
+                    dec[reg] = less_mask(c0, c1);
+                }
+            }
+            std::swap(old_metrics, new_metrics);
+
+            // keep the metrics in range: subtract the per-lane minimum
+            if ((t & 15) == 15) {
+                lanes_t lo = load(old_metrics);
+                for (unsigned int s = 1; s < states; s++)
+                    lo = vmin(lo, load(old_metrics + s * batch_size));
+                for (unsigned int s = 0; s < states; s++)
+                    store(old_metrics + s * batch_size,
+                          sub(load(old_metrics + s * batch_size), lo));
+            }
+        }
+
+        d_final = old_metrics;
+    }
+
+    void traceback(unsigned char* const* bits,
+                   unsigned int lanes,
+                   unsigned int steps,
+                   unsigned int info_bits)
+    {
+        uint32_t state[batch_size];
+        for (unsigned int l = 0; l < batch_size; l++) {
+            state[l] = 0;
+            if (!d_terminated) {
+                for (unsigned int s = 1; s < d_states; s++) {
+                    if (d_final[s * batch_size + l] < d_final[state[l] * batch_size + l])
+                        state[l] = s;
+                }
+            }
+        }
+
+        const uint32_t high_shift = d_k - 2;
+        unsigned int t = steps;
+#if defined(__AVX2__)
+        const __m256i lane_shift0 = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+        const __m256i lane_shift1 = _mm256_setr_epi32(16, 18, 20, 22, 24, 26, 28, 30);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i vhigh = _mm256_set1_epi32(static_cast<int>(high_shift));
+        __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state));
+        __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state + 8));
+        const int* base = reinterpret_cast<const int*>(d_decisions.data());
+        __VOLK_ATTR_ALIGNED(32) uint32_t out_bits[batch_size];
+        while (t-- > 0) {
+            const __m256i row = _mm256_set1_epi32(static_cast<int>(t * d_states));
+            if (t < info_bits) {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(out_bits),
+                                   _mm256_and_si256(s0, one));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(out_bits + 8),
+                                   _mm256_and_si256(s1, one));
+                for (unsigned int l = 0; l < lanes; l++)
+                    bits[l][t] = static_cast<unsigned char>(out_bits[l]);
+            }
+            const __m256i w0 = _mm256_i32gather_epi32(base, _mm256_add_epi32(row, s0), 4);
+            const __m256i w1 = _mm256_i32gather_epi32(base, _mm256_add_epi32(row, s1), 4);
+            const __m256i d0 = _mm256_and_si256(_mm256_srlv_epi32(w0, lane_shift0), one);
+            const __m256i d1 = _mm256_and_si256(_mm256_srlv_epi32(w1, lane_shift1), one);
+            s0 = _mm256_or_si256(_mm256_srli_epi32(s0, 1), _mm256_sllv_epi32(d0, vhigh));
+            s1 = _mm256_or_si256(_mm256_srli_epi32(s1, 1), _mm256_sllv_epi32(d1, vhigh));
+        }
+#else
+        while (t-- > 0) {
+            const uint32_t* dec = &d_decisions[static_cast<size_t>(t) * d_states];
+            for (unsigned int l = 0; l < lanes; l++) {
+                if (t < info_bits)
+                    bits[l][t] = static_cast<unsigned char>(state[l] & 1);
+                const uint32_t d = dec[state[l]] >> (2 * l) & 1;
+                state[l] = (state[l] >> 1) | (d << high_shift);
+            }
+        }
+#endif
+    }
+
+    unsigned int d_k;
+    unsigned int d_rate;
+    unsigned int d_states = 0;
+    std::vector<unsigned int> d_polys;
+    std::vector<unsigned char> d_puncture;
+    bool d_terminated;
+    std::vector<unsigned char> d_codeword;
+    volk::vector<uint16_t> d_metrics;
+    volk::vector<uint16_t> d_branch;
+    volk::vector<uint16_t> d_syms;
+    volk::vector<uint32_t> d_decisions;
+    const uint16_t* d_final = nullptr;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_VITERBI_H
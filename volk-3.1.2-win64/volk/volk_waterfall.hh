@@ -0,0 +1,206 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2024 Free Software Foundation, Inc.
+ *
+ * This file is part of VOLK
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef INCLUDED_VOLK_WATERFALL_H
+#define INCLUDED_VOLK_WATERFALL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// sets the LV_HAVE_* of this translation unit for the kernel header
+#include <volk/volk_bind.hh>
+
+#include <volk/volk_32f_s32f_x2_colormap_32u.h>
+#include <volk/volk_alloc.hh>
+
+namespace volk {
+
+//! A color packed as the bytes R, G, B, A in memory, as RGBA8 textures expect
+inline uint32_t pack_rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255)
+{
+    const uint8_t bytes[4] = { r, g, b, a };
+    uint32_t color;
+    std::memcpy(&color, bytes, sizeof(color));
+    return color;
+}
+
+//! Palette color at position 0 (min_dB) to 1 (max_dB)
+struct color_stop {
+    float position;
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+/*!
+ * \brief 256 entry palette for volk_32f_s32f_x2_colormap_32u
+ *
+ * \details
+ *   Interpolates linearly between stops sorted by position; entries before
+ *   the first or after the last stop take its color.
+ */
+inline std::vector<uint32_t> make_palette(const std::vector<color_stop>& stops)
+{
+    if (stops.empty())
+        throw std::invalid_argument("make_palette: no color stops");
+    std::vector<uint32_t> palette(256);
+    std::size_t s = 0;
+    for (unsigned int i = 0; i < 256; i++) {
+        const float x = i / 255.0f;
+        while (s + 1 < stops.size() && stops[s + 1].position <= x)
+            s++;
+        const color_stop& a = stops[s];
+        const color_stop& b = stops[std::min(s + 1, stops.size() - 1)];
+        const float span = b.position - a.position;
+        const float t =
+            span > 0.0f ? std::min(std::max((x - a.position) / span, 0.0f), 1.0f) : 0.0f;
+        auto mix = [t](uint8_t u, uint8_t v) {
+            return static_cast<uint8_t>(u + (v - u) * t + 0.5f);
+        };
+        palette[i] = pack_rgba(mix(a.r, b.r), mix(a.g, b.g), mix(a.b, b.b));
+    }
+    return palette;
+}
+
+//! Black to white
+inline std::vector<uint32_t> gray_palette()
+{
+    return make_palette({ { 0.0f, 0, 0, 0 }, { 1.0f, 255, 255, 255 } });
+}
+
+//! Black, blue, cyan, yellow, red, white: the usual SDR waterfall
+inline std::vector<uint32_t> spectrum_palette()
+{
+    return make_palette({ { 0.0f, 0, 0, 0 },
+                          { 0.2f, 0, 0, 160 },
+                          { 0.4f, 0, 200, 220 },
+                          { 0.6f, 240, 240, 0 },
+                          { 0.8f, 230, 0, 0 },
+                          { 1.0f, 255, 255, 255 } });
+}
+
+/*!
+ * \brief volk_32f_s32f_x2_colormap_32u with the best implementation this
+ *        translation unit is built for
+ */
+inline void colormap(uint32_t* rgba,
+                     const float* dB,
+                     const uint32_t* palette,
+                     float min_dB,
+                     float max_dB,
+                     unsigned int num_bins,
+                     unsigned int num_pixels)
+{
+#if defined(LV_HAVE_AVX2)
+    volk_32f_s32f_x2_colormap_32u_u_avx2(
+        rgba, dB, palette, min_dB, max_dB, num_bins, num_pixels);
+#elif defined(LV_HAVE_SSE4_1)
+    volk_32f_s32f_x2_colormap_32u_u_sse4_1(
+        rgba, dB, palette, min_dB, max_dB, num_bins, num_pixels);
+#else
+    volk_32f_s32f_x2_colormap_32u_generic(
+        rgba, dB, palette, min_dB, max_dB, num_bins, num_pixels);
+#endif
+}
+
+/*!
+ * \brief Scrolling RGBA waterfall image
+ *
+ * \details
+ *   Each push() renders one spectrum into the next row of a width x height
+ *   ring of RGBA pixels, overwriting the oldest row. The image can be
+ *   uploaded as one texture and drawn with a vertical offset of
+ *   newest_row(), or copied row by row through row(age).
+ *
+ * example code:
+ *   volk::waterfall wf(65536, 3840, 1080, -120.0f, -20.0f);
+ *   wf.push(psd_dB);
+ *   upload(wf.image(), wf.width(), wf.height(), wf.newest_row());
+ */
+class waterfall
+{
+public:
+    waterfall(unsigned int num_bins,
+              unsigned int width,
+              unsigned int height,
+              float min_dB,
+              float max_dB,
+              const std::vector<uint32_t>& palette = spectrum_palette())
+        : d_bins(num_bins), d_width(width), d_height(height)
+    {
+        if (num_bins == 0 || width == 0 || height == 0)
+            throw std::invalid_argument("waterfall: empty spectrum or image");
+        set_palette(palette);
+        set_levels(min_dB, max_dB);
+        d_image.assign(static_cast<std::size_t>(width) * height, d_palette[0]);
+    }
+
+    void set_levels(float min_dB, float max_dB)
+    {
+        if (!(max_dB > min_dB))
+            throw std::invalid_argument("waterfall: max_dB must be above min_dB");
+        d_min = min_dB;
+        d_max = max_dB;
+    }
+
+    void set_palette(const std::vector<uint32_t>& palette)
+    {
+        if (palette.size() != 256)
+            throw std::invalid_argument("waterfall: palette needs 256 colors");
+        d_palette = palette;
+    }
+
+    //! Renders num_bins dB values as the newest row
+    void push(const float* psd_dB)
+    {
+        d_newest = d_count == 0 ? 0 : (d_newest + 1) % d_height;
+        d_count++;
+        colormap(&d_image[static_cast<std::size_t>(d_newest) * d_width],
+                 psd_dB,
+                 d_palette.data(),
+                 d_min,
+                 d_max,
+                 d_bins,
+                 d_width);
+    }
+
+    unsigned int width() const { return d_width; }
+    unsigned int height() const { return d_height; }
+    float min_dB() const { return d_min; }
+    float max_dB() const { return d_max; }
+
+    //! The width x height ring, row newest_row() holding the latest spectrum
+    const uint32_t* image() const { return d_image.data(); }
+    unsigned int newest_row() const { return d_newest; }
+
+    //! Row pushed age pushes ago, 0 for the newest
+    const uint32_t* row(unsigned int age) const
+    {
+        const unsigned int r = (d_newest + d_height - age % d_height) % d_height;
+        return &d_image[static_cast<std::size_t>(r) * d_width];
+    }
+
+private:
+    unsigned int d_bins;
+    unsigned int d_width;
+    unsigned int d_height;
+    float d_min = 0.0f;
+    float d_max = 0.0f;
+    std::vector<uint32_t> d_palette;
+    volk::vector<uint32_t> d_image;
+    unsigned int d_newest = 0;
+    uint64_t d_count = 0;
+};
+
+} // namespace volk
+#endif // INCLUDED_VOLK_WATERFALL_H